@@ -0,0 +1,390 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+
+/**
+ * Micro-benchmark of dsosdcoord transform_ip. dsosdcoordsynth attaches
+ * synthetic batches to RGBA frames, which are pushed through dsosdcoord
+ * with gst_harness once per feature toggle. The time and the allocations
+ * spent in dsosdcoord are written as JSON; run with --help for the
+ * options.
+ *
+ * Built against the stub DeepStream headers and meta library in stubs/,
+ * so it needs neither the DeepStream SDK nor CUDA.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <gst/gst.h>
+#include <gst/check/gstharness.h>
+
+GST_PLUGIN_STATIC_DECLARE (nvdsgst_dsosdcoord);
+
+/* Every allocation of the process is counted while counting is set, so
+ * those made by the export and worker threads for the buffer in flight
+ * are included. */
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+
+static gint counting;
+static gint64 allocations;
+
+static inline void
+count_allocation (void)
+{
+  if (__atomic_load_n (&counting, __ATOMIC_RELAXED))
+    __atomic_fetch_add (&allocations, 1, __ATOMIC_RELAXED);
+}
+
+void *
+malloc (size_t size)
+{
+  count_allocation ();
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+  count_allocation ();
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+  count_allocation ();
+  return __libc_realloc (ptr, size);
+}
+
+void *
+memalign (size_t alignment, size_t size)
+{
+  count_allocation ();
+  return __libc_memalign (alignment, size);
+}
+
+void *
+aligned_alloc (size_t alignment, size_t size)
+{
+  count_allocation ();
+  return __libc_memalign (alignment, size);
+}
+
+int
+posix_memalign (void **ptr, size_t alignment, size_t size)
+{
+  void *p;
+
+  count_allocation ();
+  p = __libc_memalign (alignment, size);
+  if (!p)
+    return ENOMEM;
+  *ptr = p;
+  return 0;
+}
+
+typedef struct
+{
+  gint width;
+  gint height;
+  gint batch_size;
+  gint objects_per_frame;
+  gint display_meta_per_frame;
+  gint label_length;
+  gint mask_size;
+  gint frames;
+  gint warmup;
+  gchar *osd_backend;
+  gchar *meta_traversal;
+  gchar *output;
+} BenchConfig;
+
+/** Feature toggles measured, each on its own and all together. */
+typedef struct
+{
+  const gchar *name;
+  gboolean display_bbox;
+  gboolean display_text;
+  gboolean display_coord;
+  gboolean display_mask;
+} BenchToggle;
+
+static const BenchToggle toggles[] = {
+  {"none", FALSE, FALSE, FALSE, FALSE},
+  {"display-bbox", TRUE, FALSE, FALSE, FALSE},
+  {"display-text", FALSE, TRUE, FALSE, FALSE},
+  {"display-coord", FALSE, FALSE, TRUE, FALSE},
+  {"display-mask", FALSE, FALSE, FALSE, TRUE},
+  {"all", TRUE, TRUE, TRUE, TRUE},
+};
+
+typedef struct
+{
+  GstClockTime elapsed;
+  gint64 allocations;
+} BenchResult;
+
+static GstHarness *
+bench_synth_new (const BenchConfig * config, const gchar * caps)
+{
+  GstElement *synth = gst_element_factory_make ("dsosdcoordsynth", NULL);
+  GstHarness *h;
+
+  g_object_set (synth, "batch-size", config->batch_size,
+      "objects-per-frame", config->objects_per_frame,
+      "display-meta-per-frame", config->display_meta_per_frame,
+      "label-length", config->label_length,
+      "mask-size", config->mask_size, "seed", 1, NULL);
+  h = gst_harness_new_with_element (synth, "sink", "src");
+  gst_object_unref (synth);
+  gst_harness_set_src_caps_str (h, caps);
+  return h;
+}
+
+/**
+ * dsosdcoord with the toggle applied. Records go to a shared memory ring
+ * nobody reads, which never blocks, so that stdout stays free for the
+ * results.
+ */
+static GstHarness *
+bench_dsosdcoord_new (const BenchConfig * config, const BenchToggle * toggle,
+    const gchar * caps)
+{
+  GstElement *dsosdcoord = gst_element_factory_make ("dsosdcoord", NULL);
+  gchar *shm_name = g_strdup_printf ("/dsosdcoord-bench-%d", (gint) getpid ());
+  GstHarness *h;
+
+  g_object_set (dsosdcoord, "display-bbox", toggle->display_bbox,
+      "display-text", toggle->display_text,
+      "display-coord", toggle->display_coord,
+      "display-mask", toggle->display_mask, "shm-name", shm_name, NULL);
+  gst_util_set_object_arg (G_OBJECT (dsosdcoord), "export-sink", "shm");
+  gst_util_set_object_arg (G_OBJECT (dsosdcoord), "osd-backend",
+      config->osd_backend);
+  if (config->meta_traversal)
+    gst_util_set_object_arg (G_OBJECT (dsosdcoord), "meta-traversal",
+        config->meta_traversal);
+  g_free (shm_name);
+
+  h = gst_harness_new_with_element (dsosdcoord, "sink", "src");
+  gst_object_unref (dsosdcoord);
+  gst_harness_set_src_caps_str (h, caps);
+  return h;
+}
+
+/**
+ * Push warmup and then frames buffers through dsosdcoord, timing only the
+ * measured ones from the push into dsosdcoord until they come out of it.
+ * The batch is attached beforehand and released afterwards, outside the
+ * measurement.
+ */
+static gboolean
+bench_run (const BenchConfig * config, const BenchToggle * toggle,
+    BenchResult * result)
+{
+  gsize size = (gsize) config->width * config->height * 4;
+  guint8 *frame = g_malloc0 (size);
+  gchar *caps = g_strdup_printf ("video/x-raw,format=RGBA,width=%d,"
+      "height=%d,framerate=30/1", config->width, config->height);
+  GstHarness *synth = bench_synth_new (config, caps);
+  GstHarness *dsosdcoord = bench_dsosdcoord_new (config, toggle, caps);
+  gboolean ok = TRUE;
+  gint i;
+
+  memset (result, 0, sizeof (*result));
+
+  for (i = 0; ok && i < config->warmup + config->frames; i++) {
+    gboolean measured = i >= config->warmup;
+    GstBuffer *buf = gst_buffer_new_wrapped_full (0, frame, size, 0, size,
+        NULL, NULL);
+    GstClockTime start = 0;
+    gint64 start_allocations = 0;
+    GstFlowReturn ret;
+
+    GST_BUFFER_PTS (buf) = gst_util_uint64_scale (i, GST_SECOND, 30);
+    buf = gst_harness_push_and_pull (synth, buf);
+    if (!buf) {
+      g_printerr ("dsosdcoordsynth produced no buffer\n");
+      ok = FALSE;
+      break;
+    }
+
+    if (measured) {
+      start_allocations = __atomic_load_n (&allocations, __ATOMIC_RELAXED);
+      __atomic_store_n (&counting, 1, __ATOMIC_RELAXED);
+      start = gst_util_get_timestamp ();
+    }
+
+    ret = gst_harness_push (dsosdcoord, buf);
+    buf = ret == GST_FLOW_OK ? gst_harness_pull (dsosdcoord) : NULL;
+
+    if (measured) {
+      result->elapsed += gst_util_get_timestamp () - start;
+      __atomic_store_n (&counting, 0, __ATOMIC_RELAXED);
+      result->allocations +=
+          __atomic_load_n (&allocations, __ATOMIC_RELAXED) - start_allocations;
+    }
+
+    if (!buf) {
+      g_printerr ("dsosdcoord failed with %s for %s\n",
+          gst_flow_get_name (ret), toggle->name);
+      ok = FALSE;
+      break;
+    }
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (dsosdcoord);
+  gst_harness_teardown (synth);
+  g_free (caps);
+  g_free (frame);
+  return ok;
+}
+
+static void
+bench_write_result (FILE * out, const BenchConfig * config,
+    const BenchToggle * toggle, const BenchResult * result, gboolean last)
+{
+  gdouble frames = (gdouble) config->frames * config->batch_size;
+  gdouble objects = frames * config->objects_per_frame;
+
+  fprintf (out, "    {\"toggle\": \"%s\", \"display_bbox\": %s, "
+      "\"display_text\": %s, \"display_coord\": %s, \"display_mask\": %s,\n",
+      toggle->name, toggle->display_bbox ? "true" : "false",
+      toggle->display_text ? "true" : "false",
+      toggle->display_coord ? "true" : "false",
+      toggle->display_mask ? "true" : "false");
+  fprintf (out, "     \"ns_per_frame\": %.1f, ", result->elapsed / frames);
+  if (objects > 0)
+    fprintf (out, "\"ns_per_object\": %.1f, ", result->elapsed / objects);
+  else
+    fputs ("\"ns_per_object\": null, ", out);
+  fprintf (out, "\"allocations_per_frame\": %.2f}%s\n",
+      result->allocations / frames, last ? "" : ",");
+}
+
+static void
+usage (GOptionContext * context)
+{
+  gchar *help = g_option_context_get_help (context, TRUE, NULL);
+
+  g_printerr ("%s", help);
+  g_free (help);
+}
+
+int
+main (int argc, char *argv[])
+{
+  BenchConfig config = {
+    .width = 1920,
+    .height = 1080,
+    .batch_size = 1,
+    .objects_per_frame = 64,
+    .display_meta_per_frame = 4,
+    .label_length = 16,
+    .mask_size = 32,
+    .frames = 500,
+    .warmup = 50,
+  };
+  GOptionEntry entries[] = {
+    {"width", 0, 0, G_OPTION_ARG_INT, &config.width, "Frame width", "N"},
+    {"height", 0, 0, G_OPTION_ARG_INT, &config.height, "Frame height", "N"},
+    {"batch-size", 'b', 0, G_OPTION_ARG_INT, &config.batch_size,
+        "Frames in each batch", "N"},
+    {"objects", 'o', 0, G_OPTION_ARG_INT, &config.objects_per_frame,
+        "Objects in each frame", "N"},
+    {"display-meta", 'd', 0, G_OPTION_ARG_INT,
+          &config.display_meta_per_frame, "Display metas in each frame",
+        "N"},
+    {"label-length", 'l', 0, G_OPTION_ARG_INT, &config.label_length,
+        "Characters of each object label", "N"},
+    {"mask-size", 'm', 0, G_OPTION_ARG_INT, &config.mask_size,
+        "Width and height of the object masks, 0 for none", "N"},
+    {"frames", 'n', 0, G_OPTION_ARG_INT, &config.frames,
+        "Measured buffers for each toggle", "N"},
+    {"warmup", 'w', 0, G_OPTION_ARG_INT, &config.warmup,
+        "Buffers pushed before measuring", "N"},
+    {"osd-backend", 0, 0, G_OPTION_ARG_STRING, &config.osd_backend,
+        "osd-backend of dsosdcoord, cpu or null", "NAME"},
+    {"meta-traversal", 0, 0, G_OPTION_ARG_STRING, &config.meta_traversal,
+        "meta-traversal of dsosdcoord, default of the element if unset",
+        "NAME"},
+    {"output", 0, 0, G_OPTION_ARG_FILENAME, &config.output,
+        "Write the JSON to FILE instead of stdout", "FILE"},
+    {NULL}
+  };
+  GOptionContext *context =
+      g_option_context_new ("- benchmark dsosdcoord transform_ip");
+  GError *error = NULL;
+  FILE *out = stdout;
+  gboolean ok = TRUE;
+  guint i;
+
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_add_group (context, gst_init_get_option_group ());
+  if (!g_option_context_parse (context, &argc, &argv, &error)) {
+    g_printerr ("%s\n", error->message);
+    g_clear_error (&error);
+    usage (context);
+    return 2;
+  }
+  if (config.width <= 0 || config.height <= 0 || config.batch_size <= 0 ||
+      config.objects_per_frame < 0 || config.display_meta_per_frame < 0 ||
+      config.label_length < 0 || config.mask_size < 0 ||
+      config.frames <= 0 || config.warmup < 0) {
+    usage (context);
+    return 2;
+  }
+  g_option_context_free (context);
+  if (!config.osd_backend)
+    config.osd_backend = g_strdup ("cpu");
+
+  GST_PLUGIN_STATIC_REGISTER (nvdsgst_dsosdcoord);
+
+  if (config.output && !(out = fopen (config.output, "w"))) {
+    g_printerr ("%s: %s\n", config.output, g_strerror (errno));
+    return 1;
+  }
+
+  fprintf (out, "{\n  \"width\": %d, \"height\": %d, \"batch_size\": %d,\n"
+      "  \"objects_per_frame\": %d, \"display_meta_per_frame\": %d,\n"
+      "  \"label_length\": %d, \"mask_size\": %d,\n"
+      "  \"frames\": %d, \"warmup\": %d, \"osd_backend\": \"%s\",\n"
+      "  \"results\": [\n", config.width, config.height, config.batch_size,
+      config.objects_per_frame, config.display_meta_per_frame,
+      config.label_length, config.mask_size, config.frames, config.warmup,
+      config.osd_backend);
+
+  for (i = 0; ok && i < G_N_ELEMENTS (toggles); i++) {
+    BenchResult result;
+
+    ok = bench_run (&config, &toggles[i], &result);
+    if (ok)
+      bench_write_result (out, &config, &toggles[i], &result,
+          i + 1 == G_N_ELEMENTS (toggles));
+  }
+
+  fputs ("  ]\n}\n", out);
+  if (out != stdout)
+    fclose (out);
+
+  g_free (config.osd_backend);
+  g_free (config.meta_traversal);
+  g_free (config.output);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Stand-in for the DeepStream gstnvdsmeta.h: the NvDsMeta GstMeta that
+ * carries NvDsBatchMeta on a buffer. Implemented by nvdsmeta_stub.c.
+ */
+
+#ifndef GST_NVDS_META_API_H
+#define GST_NVDS_META_API_H
+
+#include <gst/gst.h>
+#include "nvdsmeta.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NVDS_META_STRING "nvdsmeta"
+
+typedef enum
+{
+  NVDS_GST_INVALID_META = -1,
+  NVDS_BATCH_GST_META = NVDS_GST_CUSTOM_META + 1,
+  NVDS_DECODER_GST_META,
+  NVDS_DEWARPER_GST_META,
+  NVDS_RESERVED_GST_META = NVDS_GST_CUSTOM_META + 4096,
+  NVDS_GST_META_FORCE32 = 0x7FFFFFFF
+} GstNvDsMetaType;
+
+typedef struct _NvDsMeta
+{
+  GstMeta meta;
+  gpointer meta_data;
+  gpointer user_data;
+  gint meta_type;
+  NvDsMetaCopyFunc copyfunc;
+  NvDsMetaReleaseFunc freefunc;
+  NvDsMetaCopyFunc gst_to_nvds_meta_transform_func;
+  NvDsMetaReleaseFunc gst_to_nvds_meta_release_func;
+} NvDsMeta;
+
+GType nvds_meta_api_get_type (void);
+#define NVDS_META_API_TYPE (nvds_meta_api_get_type())
+
+const GstMetaInfo *nvds_meta_get_info (void);
+#define NVDS_META_INFO (nvds_meta_get_info())
+
+/**
+ * Attach meta_data to buffer. copy_func and release_func are called with
+ * the NvDsMeta and user_data when the buffer is copied and freed.
+ */
+NvDsMeta *gst_buffer_add_nvds_meta (GstBuffer * buffer, gpointer meta_data,
+    gpointer user_data, NvDsMetaCopyFunc copy_func,
+    NvDsMetaReleaseFunc release_func);
+
+NvDsBatchMeta *gst_buffer_get_nvds_batch_meta (GstBuffer * buffer);
+
+/** Latency measurement is not implemented; these only return TRUE. */
+gboolean nvds_set_input_system_timestamp (GstBuffer * buffer,
+    gchar * element_name);
+
+gboolean nvds_set_output_system_timestamp (GstBuffer * buffer,
+    gchar * element_name);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* GST_NVDS_META_API_H */
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Stand-in for the DeepStream nvbufsurface.h with the DeepStream 6.0
+ * layout of the types dsosdcoord uses, for building the benchmark and the
+ * tests without the DeepStream SDK. No surface API is provided.
+ */
+
+#ifndef NVBUFSURFACE_H_
+#define NVBUFSURFACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NVBUF_MAX_PLANES 4
+#define STRUCTURE_PADDING 4
+
+typedef enum
+{
+  NVBUF_COLOR_FORMAT_INVALID,
+  NVBUF_COLOR_FORMAT_GRAY8,
+  NVBUF_COLOR_FORMAT_YUV420,
+  NVBUF_COLOR_FORMAT_RGBA = 19,
+  NVBUF_COLOR_FORMAT_BGRA,
+  NVBUF_COLOR_FORMAT_ARGB,
+  NVBUF_COLOR_FORMAT_ABGR,
+  NVBUF_COLOR_FORMAT_LAST = 50,
+} NvBufSurfaceColorFormat;
+
+typedef enum
+{
+  NVBUF_LAYOUT_PITCH,
+  NVBUF_LAYOUT_BLOCK_LINEAR,
+} NvBufSurfaceLayout;
+
+typedef enum
+{
+  NVBUF_MEM_DEFAULT,
+  NVBUF_MEM_CUDA_PINNED,
+  NVBUF_MEM_CUDA_DEVICE,
+  NVBUF_MEM_CUDA_UNIFIED,
+  NVBUF_MEM_SURFACE_ARRAY,
+  NVBUF_MEM_HANDLE,
+  NVBUF_MEM_SYSTEM,
+} NvBufSurfaceMemType;
+
+typedef struct NvBufSurfacePlaneParams
+{
+  uint32_t num_planes;
+  uint32_t width[NVBUF_MAX_PLANES];
+  uint32_t height[NVBUF_MAX_PLANES];
+  uint32_t pitch[NVBUF_MAX_PLANES];
+  uint32_t offset[NVBUF_MAX_PLANES];
+  uint32_t psize[NVBUF_MAX_PLANES];
+  uint32_t bytesPerPix[NVBUF_MAX_PLANES];
+  void *_reserved[STRUCTURE_PADDING * NVBUF_MAX_PLANES];
+} NvBufSurfacePlaneParams;
+
+typedef struct NvBufSurfaceMappedAddr
+{
+  void *addr[NVBUF_MAX_PLANES];
+  void *eglImage;
+  void *_reserved[STRUCTURE_PADDING];
+} NvBufSurfaceMappedAddr;
+
+typedef struct NvBufSurfaceParams
+{
+  uint32_t width;
+  uint32_t height;
+  uint32_t pitch;
+  NvBufSurfaceColorFormat colorFormat;
+  NvBufSurfaceLayout layout;
+  uint64_t bufferDesc;
+  uint32_t dataSize;
+  void *dataPtr;
+  NvBufSurfacePlaneParams planeParams;
+  NvBufSurfaceMappedAddr mappedAddr;
+  void *_reserved[STRUCTURE_PADDING];
+} NvBufSurfaceParams;
+
+typedef struct NvBufSurface
+{
+  uint32_t gpuId;
+  uint32_t batchSize;
+  uint32_t numFilled;
+  bool isContiguous;
+  NvBufSurfaceMemType memType;
+  NvBufSurfaceParams *surfaceList;
+  void *_reserved[STRUCTURE_PADDING];
+} NvBufSurface;
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* NVBUFSURFACE_H_ */
@@ -0,0 +1,236 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Stand-in for the DeepStream nvdsmeta.h with the DeepStream 6.0 layout of
+ * the batch, frame, object, classifier, label, user and display metas and
+ * the pool functions dsosdcoord and its source elements use. Implemented
+ * by nvdsmeta_stub.c.
+ */
+
+#ifndef _NVDSMETA_NEW_H_
+#define _NVDSMETA_NEW_H_
+
+#include <glib.h>
+#include "nvll_osd_struct.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define MAX_USER_FIELDS 4
+#define MAX_RESERVED_FIELDS 4
+#define MAX_LABEL_SIZE 128
+#define MAX_ELEMENTS_IN_DISPLAY_META 16
+#define UNTRACKED_OBJECT_ID 0xFFFFFFFFFFFFFFFF
+
+typedef GList NvDsFrameMetaList;
+typedef GList NvDsUserMetaList;
+typedef GList NvDsObjectMetaList;
+typedef GList NvDisplayMetaList;
+typedef GList NvDsClassifierMetaList;
+typedef GList NvDsLabelInfoList;
+typedef GList NvDsMetaList;
+
+typedef gpointer (*NvDsMetaCopyFunc) (gpointer data, gpointer user_data);
+typedef void (*NvDsMetaReleaseFunc) (gpointer data, gpointer user_data);
+
+typedef enum
+{
+  NVDS_INVALID_META = -1,
+  NVDS_BATCH_META = 1,
+  NVDS_FRAME_META,
+  NVDS_OBJ_META,
+  NVDS_DISPLAY_META,
+  NVDS_CLASSIFIER_META,
+  NVDS_LABEL_INFO_META,
+  NVDS_USER_META,
+  NVDS_RESERVED_META = 4095,
+  NVDS_GST_CUSTOM_META = 4096,
+  NVDS_START_USER_META = NVDS_GST_CUSTOM_META + 4096 + 1,
+  NVDS_FORCE32_META = 0x7FFFFFFF
+} NvDsMetaType;
+
+typedef struct _NvDsMetaPool
+{
+  NvDsMetaType meta_type;
+  guint max_elements_in_pool;
+  guint element_size;
+  guint num_empty_elements;
+  guint num_full_elements;
+  NvDsMetaList *empty_list;
+  NvDsMetaList *full_list;
+  NvDsMetaCopyFunc copy_func;
+  NvDsMetaReleaseFunc release_func;
+} NvDsMetaPool;
+
+typedef struct _NvDsBaseMeta
+{
+  struct _NvDsBatchMeta *batch_meta;
+  NvDsMetaType meta_type;
+  void *uContext;
+  NvDsMetaCopyFunc copy_func;
+  NvDsMetaReleaseFunc release_func;
+} NvDsBaseMeta;
+
+typedef struct _NvDsBatchMeta
+{
+  NvDsBaseMeta base_meta;
+  guint max_frames_in_batch;
+  guint num_frames_in_batch;
+  NvDsMetaPool *frame_meta_pool;
+  NvDsMetaPool *obj_meta_pool;
+  NvDsMetaPool *classifier_meta_pool;
+  NvDsMetaPool *display_meta_pool;
+  NvDsMetaPool *user_meta_pool;
+  NvDsMetaPool *label_info_meta_pool;
+  NvDsFrameMetaList *frame_meta_list;
+  NvDsUserMetaList *batch_user_meta_list;
+  GRecMutex meta_mutex;
+  gint64 misc_batch_info[MAX_USER_FIELDS];
+  gint64 reserved[MAX_RESERVED_FIELDS];
+} NvDsBatchMeta;
+
+typedef struct _NvDsFrameMeta
+{
+  NvDsBaseMeta base_meta;
+  guint pad_index;
+  guint batch_id;
+  gint frame_num;
+  guint64 buf_pts;
+  guint64 ntp_timestamp;
+  guint source_id;
+  gint num_surfaces_per_frame;
+  guint source_frame_width;
+  guint source_frame_height;
+  guint surface_type;
+  guint surface_index;
+  guint num_obj_meta;
+  gboolean bInferDone;
+  NvDsObjectMetaList *obj_meta_list;
+  NvDisplayMetaList *display_meta_list;
+  NvDsUserMetaList *frame_user_meta_list;
+  gint64 misc_frame_info[MAX_USER_FIELDS];
+  guint pipeline_width;
+  guint pipeline_height;
+  gint64 reserved[MAX_RESERVED_FIELDS];
+} NvDsFrameMeta;
+
+typedef struct _NvBbox_Coords
+{
+  float left;
+  float top;
+  float width;
+  float height;
+} NvBbox_Coords;
+
+typedef struct _NvDsComp_BboxInfo
+{
+  NvBbox_Coords org_bbox_coords;
+} NvDsComp_BboxInfo;
+
+typedef struct _NvDsObjectMeta
+{
+  NvDsBaseMeta base_meta;
+  struct _NvDsObjectMeta *parent;
+  gint unique_component_id;
+  gint class_id;
+  guint64 object_id;
+  NvDsComp_BboxInfo detector_bbox_info;
+  NvDsComp_BboxInfo tracker_bbox_info;
+  gfloat confidence;
+  gfloat tracker_confidence;
+  NvOSD_RectParams rect_params;
+  NvOSD_MaskParams mask_params;
+  NvOSD_TextParams text_params;
+  gchar obj_label[MAX_LABEL_SIZE];
+  NvDsClassifierMetaList *classifier_meta_list;
+  NvDsUserMetaList *obj_user_meta_list;
+  gint64 misc_obj_info[MAX_USER_FIELDS];
+  gint64 reserved[MAX_RESERVED_FIELDS];
+} NvDsObjectMeta;
+
+typedef struct _NvDsClassifierMeta
+{
+  NvDsBaseMeta base_meta;
+  guint num_labels;
+  gint unique_component_id;
+  NvDsLabelInfoList *label_info_list;
+  const gchar *classifier_type;
+} NvDsClassifierMeta;
+
+typedef struct _NvDsLabelInfo
+{
+  NvDsBaseMeta base_meta;
+  guint num_classes;
+  gchar result_label[MAX_LABEL_SIZE];
+  gchar *pResult_label;
+  guint result_class_id;
+  guint label_id;
+  gfloat result_prob;
+} NvDsLabelInfo;
+
+typedef struct _NvDsDisplayMeta
+{
+  NvDsBaseMeta base_meta;
+  guint num_rects;
+  guint num_labels;
+  guint num_lines;
+  guint num_arrows;
+  guint num_circles;
+  NvOSD_RectParams rect_params[MAX_ELEMENTS_IN_DISPLAY_META];
+  NvOSD_TextParams text_params[MAX_ELEMENTS_IN_DISPLAY_META];
+  NvOSD_LineParams line_params[MAX_ELEMENTS_IN_DISPLAY_META];
+  NvOSD_ArrowParams arrow_params[MAX_ELEMENTS_IN_DISPLAY_META];
+  NvOSD_CircleParams circle_params[MAX_ELEMENTS_IN_DISPLAY_META];
+  gint64 misc_osd_data[MAX_USER_FIELDS];
+  gint64 reserved[MAX_RESERVED_FIELDS];
+} NvDsDisplayMeta;
+
+typedef struct _NvDsUserMeta
+{
+  NvDsBaseMeta base_meta;
+  void *user_meta_data;
+} NvDsUserMeta;
+
+NvDsBatchMeta *nvds_create_batch_meta (guint max_batch_size);
+
+gboolean nvds_destroy_batch_meta (NvDsBatchMeta * batch_meta);
+
+NvDsFrameMeta *nvds_acquire_frame_meta_from_pool (NvDsBatchMeta * batch_meta);
+
+void nvds_add_frame_meta_to_batch (NvDsBatchMeta * batch_meta,
+    NvDsFrameMeta * frame_meta);
+
+void nvds_clear_frame_meta_list (NvDsBatchMeta * batch_meta,
+    NvDsFrameMetaList * meta_list);
+
+NvDsObjectMeta *nvds_acquire_obj_meta_from_pool (NvDsBatchMeta * batch_meta);
+
+void nvds_add_obj_meta_to_frame (NvDsFrameMeta * frame_meta,
+    NvDsObjectMeta * obj_meta, NvDsObjectMeta * obj_parent);
+
+NvDsDisplayMeta *nvds_acquire_display_meta_from_pool (NvDsBatchMeta *
+    batch_meta);
+
+void nvds_add_display_meta_to_frame (NvDsFrameMeta * frame_meta,
+    NvDsDisplayMeta * display_meta);
+
+gpointer nvds_batch_meta_copy_func (gpointer data, gpointer user_data);
+
+void nvds_batch_meta_release_func (gpointer data, gpointer user_data);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NVDSMETA_NEW_H_ */
@@ -0,0 +1,452 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+
+/**
+ * Minimal implementation of the DeepStream meta library for the stub
+ * headers. Metas come from per-batch pools that grow on demand and are
+ * reused on release, like the DeepStream pools, so a steady stream of
+ * batches of the same size does not allocate meta structures.
+ */
+
+#include <string.h>
+#include "gstnvdsmeta.h"
+
+/**
+ * Every pool element is preceded by its node in the full or empty list of
+ * the pool, so it moves between them without a search or an allocation.
+ */
+typedef union
+{
+  GList *link;
+  gint64 align[2];
+} NvDsMetaHeader;
+
+#define META_HEADER(meta) (((NvDsMetaHeader *) (meta)) - 1)
+
+static NvDsMetaPool *
+meta_pool_new (NvDsMetaType meta_type, guint element_size, guint max_elements)
+{
+  NvDsMetaPool *pool = g_new0 (NvDsMetaPool, 1);
+
+  pool->meta_type = meta_type;
+  pool->element_size = element_size;
+  pool->max_elements_in_pool = max_elements;
+  return pool;
+}
+
+static void
+meta_pool_free (NvDsMetaPool * pool)
+{
+  GList *l;
+
+  for (l = pool->full_list; l; l = l->next)
+    g_free (META_HEADER (l->data));
+  for (l = pool->empty_list; l; l = l->next)
+    g_free (META_HEADER (l->data));
+  g_list_free (pool->full_list);
+  g_list_free (pool->empty_list);
+  g_free (pool);
+}
+
+static gpointer
+meta_pool_acquire (NvDsBatchMeta * batch_meta, NvDsMetaPool * pool)
+{
+  NvDsBaseMeta *base_meta;
+  GList *link = pool->empty_list;
+
+  if (link) {
+    pool->empty_list = g_list_remove_link (pool->empty_list, link);
+    pool->num_empty_elements--;
+  } else {
+    NvDsMetaHeader *header =
+        g_malloc (sizeof (NvDsMetaHeader) + pool->element_size);
+
+    link = g_list_alloc ();
+    link->data = header + 1;
+    header->link = link;
+  }
+  pool->full_list = g_list_concat (link, pool->full_list);
+  pool->num_full_elements++;
+
+  base_meta = (NvDsBaseMeta *) link->data;
+  memset (base_meta, 0, pool->element_size);
+  base_meta->batch_meta = batch_meta;
+  base_meta->meta_type = pool->meta_type;
+  return base_meta;
+}
+
+static void
+meta_pool_release (NvDsMetaPool * pool, gpointer meta)
+{
+  GList *link = META_HEADER (meta)->link;
+
+  pool->full_list = g_list_remove_link (pool->full_list, link);
+  pool->num_full_elements--;
+  pool->empty_list = g_list_concat (link, pool->empty_list);
+  pool->num_empty_elements++;
+}
+
+static void
+release_user_meta_list (NvDsBatchMeta * batch_meta, NvDsUserMetaList * list)
+{
+  GList *l;
+
+  for (l = list; l; l = l->next) {
+    NvDsUserMeta *user_meta = (NvDsUserMeta *) l->data;
+
+    if (user_meta->base_meta.release_func)
+      user_meta->base_meta.release_func (user_meta, NULL);
+    meta_pool_release (batch_meta->user_meta_pool, user_meta);
+  }
+  g_list_free (list);
+}
+
+static void
+release_obj_meta (NvDsBatchMeta * batch_meta, NvDsObjectMeta * obj_meta)
+{
+  GList *l, *ll;
+
+  for (l = obj_meta->classifier_meta_list; l; l = l->next) {
+    NvDsClassifierMeta *classifier_meta = (NvDsClassifierMeta *) l->data;
+
+    for (ll = classifier_meta->label_info_list; ll; ll = ll->next) {
+      NvDsLabelInfo *label_info = (NvDsLabelInfo *) ll->data;
+
+      g_free (label_info->pResult_label);
+      meta_pool_release (batch_meta->label_info_meta_pool, label_info);
+    }
+    g_list_free (classifier_meta->label_info_list);
+    meta_pool_release (batch_meta->classifier_meta_pool, classifier_meta);
+  }
+  g_list_free (obj_meta->classifier_meta_list);
+  release_user_meta_list (batch_meta, obj_meta->obj_user_meta_list);
+
+  g_free (obj_meta->text_params.display_text);
+  g_free (obj_meta->mask_params.data);
+  meta_pool_release (batch_meta->obj_meta_pool, obj_meta);
+}
+
+static void
+release_display_meta (NvDsBatchMeta * batch_meta,
+    NvDsDisplayMeta * display_meta)
+{
+  guint i;
+
+  for (i = 0; i < display_meta->num_labels &&
+      i < MAX_ELEMENTS_IN_DISPLAY_META; i++)
+    g_free (display_meta->text_params[i].display_text);
+  meta_pool_release (batch_meta->display_meta_pool, display_meta);
+}
+
+static void
+release_frame_meta (NvDsBatchMeta * batch_meta, NvDsFrameMeta * frame_meta)
+{
+  GList *l;
+
+  for (l = frame_meta->obj_meta_list; l; l = l->next)
+    release_obj_meta (batch_meta, (NvDsObjectMeta *) l->data);
+  g_list_free (frame_meta->obj_meta_list);
+  for (l = frame_meta->display_meta_list; l; l = l->next)
+    release_display_meta (batch_meta, (NvDsDisplayMeta *) l->data);
+  g_list_free (frame_meta->display_meta_list);
+  release_user_meta_list (batch_meta, frame_meta->frame_user_meta_list);
+  meta_pool_release (batch_meta->frame_meta_pool, frame_meta);
+}
+
+NvDsBatchMeta *
+nvds_create_batch_meta (guint max_batch_size)
+{
+  NvDsBatchMeta *batch_meta = g_new0 (NvDsBatchMeta, 1);
+
+  batch_meta->base_meta.batch_meta = batch_meta;
+  batch_meta->base_meta.meta_type = NVDS_BATCH_META;
+  batch_meta->max_frames_in_batch = max_batch_size;
+  batch_meta->frame_meta_pool = meta_pool_new (NVDS_FRAME_META,
+      sizeof (NvDsFrameMeta), max_batch_size);
+  batch_meta->obj_meta_pool = meta_pool_new (NVDS_OBJ_META,
+      sizeof (NvDsObjectMeta), 0);
+  batch_meta->classifier_meta_pool = meta_pool_new (NVDS_CLASSIFIER_META,
+      sizeof (NvDsClassifierMeta), 0);
+  batch_meta->display_meta_pool = meta_pool_new (NVDS_DISPLAY_META,
+      sizeof (NvDsDisplayMeta), 0);
+  batch_meta->user_meta_pool = meta_pool_new (NVDS_USER_META,
+      sizeof (NvDsUserMeta), 0);
+  batch_meta->label_info_meta_pool = meta_pool_new (NVDS_LABEL_INFO_META,
+      sizeof (NvDsLabelInfo), 0);
+  g_rec_mutex_init (&batch_meta->meta_mutex);
+  return batch_meta;
+}
+
+gboolean
+nvds_destroy_batch_meta (NvDsBatchMeta * batch_meta)
+{
+  if (!batch_meta)
+    return FALSE;
+
+  nvds_clear_frame_meta_list (batch_meta, batch_meta->frame_meta_list);
+  release_user_meta_list (batch_meta, batch_meta->batch_user_meta_list);
+  meta_pool_free (batch_meta->frame_meta_pool);
+  meta_pool_free (batch_meta->obj_meta_pool);
+  meta_pool_free (batch_meta->classifier_meta_pool);
+  meta_pool_free (batch_meta->display_meta_pool);
+  meta_pool_free (batch_meta->user_meta_pool);
+  meta_pool_free (batch_meta->label_info_meta_pool);
+  g_rec_mutex_clear (&batch_meta->meta_mutex);
+  g_free (batch_meta);
+  return TRUE;
+}
+
+NvDsFrameMeta *
+nvds_acquire_frame_meta_from_pool (NvDsBatchMeta * batch_meta)
+{
+  return (NvDsFrameMeta *) meta_pool_acquire (batch_meta,
+      batch_meta->frame_meta_pool);
+}
+
+void
+nvds_add_frame_meta_to_batch (NvDsBatchMeta * batch_meta,
+    NvDsFrameMeta * frame_meta)
+{
+  batch_meta->frame_meta_list =
+      g_list_append (batch_meta->frame_meta_list, frame_meta);
+  batch_meta->num_frames_in_batch++;
+}
+
+void
+nvds_clear_frame_meta_list (NvDsBatchMeta * batch_meta,
+    NvDsFrameMetaList * meta_list)
+{
+  GList *l;
+
+  for (l = meta_list; l; l = l->next)
+    release_frame_meta (batch_meta, (NvDsFrameMeta *) l->data);
+  g_list_free (meta_list);
+  if (meta_list == batch_meta->frame_meta_list) {
+    batch_meta->frame_meta_list = NULL;
+    batch_meta->num_frames_in_batch = 0;
+  }
+}
+
+NvDsObjectMeta *
+nvds_acquire_obj_meta_from_pool (NvDsBatchMeta * batch_meta)
+{
+  NvDsObjectMeta *obj_meta = (NvDsObjectMeta *) meta_pool_acquire (batch_meta,
+      batch_meta->obj_meta_pool);
+
+  obj_meta->object_id = UNTRACKED_OBJECT_ID;
+  return obj_meta;
+}
+
+void
+nvds_add_obj_meta_to_frame (NvDsFrameMeta * frame_meta,
+    NvDsObjectMeta * obj_meta, NvDsObjectMeta * obj_parent)
+{
+  obj_meta->parent = obj_parent;
+  frame_meta->obj_meta_list =
+      g_list_append (frame_meta->obj_meta_list, obj_meta);
+  frame_meta->num_obj_meta++;
+}
+
+NvDsDisplayMeta *
+nvds_acquire_display_meta_from_pool (NvDsBatchMeta * batch_meta)
+{
+  return (NvDsDisplayMeta *) meta_pool_acquire (batch_meta,
+      batch_meta->display_meta_pool);
+}
+
+void
+nvds_add_display_meta_to_frame (NvDsFrameMeta * frame_meta,
+    NvDsDisplayMeta * display_meta)
+{
+  frame_meta->display_meta_list =
+      g_list_append (frame_meta->display_meta_list, display_meta);
+}
+
+/**
+ * Copy of the frames, objects and display metas of the batch carried by
+ * the NvDsMeta data. Classifier and user metas are not copied.
+ */
+gpointer
+nvds_batch_meta_copy_func (gpointer data, gpointer user_data)
+{
+  NvDsBatchMeta *src = (NvDsBatchMeta *) ((NvDsMeta *) data)->meta_data;
+  NvDsBatchMeta *dst = nvds_create_batch_meta (src->max_frames_in_batch);
+  GList *l_frame, *l;
+  guint i;
+
+  for (l_frame = src->frame_meta_list; l_frame; l_frame = l_frame->next) {
+    NvDsFrameMeta *src_frame = (NvDsFrameMeta *) l_frame->data;
+    NvDsFrameMeta *frame = nvds_acquire_frame_meta_from_pool (dst);
+    NvDsBaseMeta base_meta = frame->base_meta;
+
+    *frame = *src_frame;
+    frame->base_meta = base_meta;
+    frame->obj_meta_list = NULL;
+    frame->display_meta_list = NULL;
+    frame->frame_user_meta_list = NULL;
+    frame->num_obj_meta = 0;
+    nvds_add_frame_meta_to_batch (dst, frame);
+
+    for (l = src_frame->obj_meta_list; l; l = l->next) {
+      NvDsObjectMeta *src_obj = (NvDsObjectMeta *) l->data;
+      NvDsObjectMeta *obj = nvds_acquire_obj_meta_from_pool (dst);
+
+      base_meta = obj->base_meta;
+      *obj = *src_obj;
+      obj->base_meta = base_meta;
+      obj->classifier_meta_list = NULL;
+      obj->obj_user_meta_list = NULL;
+      obj->text_params.display_text =
+          g_strdup (src_obj->text_params.display_text);
+      if (src_obj->mask_params.data) {
+        obj->mask_params.data = g_malloc (src_obj->mask_params.size);
+        memcpy (obj->mask_params.data, src_obj->mask_params.data,
+            src_obj->mask_params.size);
+      }
+      nvds_add_obj_meta_to_frame (frame, obj, NULL);
+    }
+
+    for (l = src_frame->display_meta_list; l; l = l->next) {
+      NvDsDisplayMeta *src_display = (NvDsDisplayMeta *) l->data;
+      NvDsDisplayMeta *display = nvds_acquire_display_meta_from_pool (dst);
+
+      base_meta = display->base_meta;
+      *display = *src_display;
+      display->base_meta = base_meta;
+      for (i = 0; i < display->num_labels &&
+          i < MAX_ELEMENTS_IN_DISPLAY_META; i++)
+        display->text_params[i].display_text =
+            g_strdup (src_display->text_params[i].display_text);
+      nvds_add_display_meta_to_frame (frame, display);
+    }
+  }
+  return dst;
+}
+
+void
+nvds_batch_meta_release_func (gpointer data, gpointer user_data)
+{
+  nvds_destroy_batch_meta ((NvDsBatchMeta *) ((NvDsMeta *) data)->meta_data);
+}
+
+static gboolean
+nvds_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  NvDsMeta *dsmeta = (NvDsMeta *) meta;
+
+  dsmeta->meta_data = NULL;
+  dsmeta->user_data = NULL;
+  dsmeta->meta_type = NVDS_GST_INVALID_META;
+  dsmeta->copyfunc = NULL;
+  dsmeta->freefunc = NULL;
+  dsmeta->gst_to_nvds_meta_transform_func = NULL;
+  dsmeta->gst_to_nvds_meta_release_func = NULL;
+  return TRUE;
+}
+
+static void
+nvds_meta_free (GstMeta * meta, GstBuffer * buffer)
+{
+  NvDsMeta *dsmeta = (NvDsMeta *) meta;
+
+  if (dsmeta->freefunc)
+    dsmeta->freefunc (dsmeta, dsmeta->user_data);
+}
+
+static gboolean
+nvds_meta_transform (GstBuffer * dest, GstMeta * meta, GstBuffer * buffer,
+    GQuark type, gpointer data)
+{
+  NvDsMeta *dsmeta = (NvDsMeta *) meta, *copy;
+
+  if (!GST_META_TRANSFORM_IS_COPY (type) || !dsmeta->copyfunc)
+    return FALSE;
+
+  copy = gst_buffer_add_nvds_meta (dest,
+      dsmeta->copyfunc (dsmeta, dsmeta->user_data), dsmeta->user_data,
+      dsmeta->copyfunc, dsmeta->freefunc);
+  copy->meta_type = dsmeta->meta_type;
+  return TRUE;
+}
+
+GType
+nvds_meta_api_get_type (void)
+{
+  static GType type = 0;
+  static const gchar *tags[] = { NVDS_META_STRING, NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("NvDsMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+const GstMetaInfo *
+nvds_meta_get_info (void)
+{
+  static const GstMetaInfo *info = NULL;
+
+  if (g_once_init_enter ((GstMetaInfo **) & info)) {
+    const GstMetaInfo *_info = gst_meta_register (NVDS_META_API_TYPE,
+        "NvDsMeta", sizeof (NvDsMeta), nvds_meta_init, nvds_meta_free,
+        nvds_meta_transform);
+    g_once_init_leave ((GstMetaInfo **) & info, (GstMetaInfo *) _info);
+  }
+  return info;
+}
+
+NvDsMeta *
+gst_buffer_add_nvds_meta (GstBuffer * buffer, gpointer meta_data,
+    gpointer user_data, NvDsMetaCopyFunc copy_func,
+    NvDsMetaReleaseFunc release_func)
+{
+  NvDsMeta *dsmeta;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+
+  dsmeta = (NvDsMeta *) gst_buffer_add_meta (buffer, NVDS_META_INFO, NULL);
+  dsmeta->meta_data = meta_data;
+  dsmeta->user_data = user_data;
+  dsmeta->copyfunc = copy_func;
+  dsmeta->freefunc = release_func;
+  return dsmeta;
+}
+
+NvDsBatchMeta *
+gst_buffer_get_nvds_batch_meta (GstBuffer * buffer)
+{
+  gpointer state = NULL;
+  GstMeta *meta;
+
+  while ((meta = gst_buffer_iterate_meta_filtered (buffer, &state,
+              NVDS_META_API_TYPE))) {
+    NvDsMeta *dsmeta = (NvDsMeta *) meta;
+
+    if (dsmeta->meta_type == NVDS_BATCH_GST_META)
+      return (NvDsBatchMeta *) dsmeta->meta_data;
+  }
+  return NULL;
+}
+
+gboolean
+nvds_set_input_system_timestamp (GstBuffer * buffer, gchar * element_name)
+{
+  return TRUE;
+}
+
+gboolean
+nvds_set_output_system_timestamp (GstBuffer * buffer, gchar * element_name)
+{
+  return TRUE;
+}
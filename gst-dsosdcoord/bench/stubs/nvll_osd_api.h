@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Stand-in for the DeepStream nvll_osd_api.h. Only the frame parameter
+ * types are provided; the benchmark and the tests are built with
+ * DSOSDCOORD_NO_NVLL, so nothing calls nvll_osd.
+ */
+
+#ifndef __NVLL_OSD_API_DEFS__
+#define __NVLL_OSD_API_DEFS__
+
+#include "nvll_osd_struct.h"
+#include "nvbufsurface.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct _NvOSD_FrameTextParams
+{
+  NvOSD_Mode mode;
+  NvBufSurfaceParams *buf_ptr;
+  int num_strings;
+  NvOSD_TextParams *text_params_list;
+} NvOSD_FrameTextParams;
+
+typedef struct _NvOSD_FrameRectParams
+{
+  NvOSD_Mode mode;
+  NvBufSurfaceParams *buf_ptr;
+  int num_rects;
+  NvOSD_RectParams *rect_params_list;
+} NvOSD_FrameRectParams;
+
+typedef struct _NvOSD_FrameSegmentMaskParams
+{
+  NvOSD_Mode mode;
+  NvBufSurfaceParams *buf_ptr;
+  int num_segments;
+  NvOSD_RectParams *rect_params_list;
+  NvOSD_MaskParams *mask_params_list;
+} NvOSD_FrameSegmentMaskParams;
+
+typedef struct _NvOSD_FrameLineParams
+{
+  NvOSD_Mode mode;
+  NvBufSurfaceParams *buf_ptr;
+  int num_lines;
+  NvOSD_LineParams *line_params_list;
+} NvOSD_FrameLineParams;
+
+typedef struct _NvOSD_FrameArrowParams
+{
+  NvOSD_Mode mode;
+  NvBufSurfaceParams *buf_ptr;
+  int num_arrows;
+  NvOSD_ArrowParams *arrow_params_list;
+} NvOSD_FrameArrowParams;
+
+typedef struct _NvOSD_FrameCircleParams
+{
+  NvOSD_Mode mode;
+  NvBufSurfaceParams *buf_ptr;
+  int num_circles;
+  NvOSD_CircleParams *circle_params_list;
+} NvOSD_FrameCircleParams;
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __NVLL_OSD_API_DEFS__ */
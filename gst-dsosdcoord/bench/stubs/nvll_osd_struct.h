@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Stand-in for the DeepStream nvll_osd_struct.h with the DeepStream 6.0
+ * layout of the osd parameter types.
+ */
+
+#ifndef __NVLL_OSD_STRUCT_DEFS__
+#define __NVLL_OSD_STRUCT_DEFS__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum
+{
+  MODE_CPU,
+  MODE_GPU,
+  MODE_HW
+} NvOSD_Mode;
+
+typedef enum
+{
+  START_HEAD,
+  END_HEAD,
+  BOTH_HEAD
+} NvOSD_Arrow_Head_Direction;
+
+typedef struct _NvOSD_ColorParams
+{
+  double red;
+  double green;
+  double blue;
+  double alpha;
+} NvOSD_ColorParams;
+
+typedef struct _NvOSD_FontParams
+{
+  char *font_name;
+  unsigned int font_size;
+  NvOSD_ColorParams font_color;
+} NvOSD_FontParams;
+
+typedef struct _NvOSD_TextParams
+{
+  char *display_text;
+  unsigned int x_offset;
+  unsigned int y_offset;
+  NvOSD_FontParams font_params;
+  int set_bg_clr;
+  NvOSD_ColorParams text_bg_clr;
+} NvOSD_TextParams;
+
+typedef struct _NvOSD_Color_info
+{
+  int id;
+  NvOSD_ColorParams color;
+} NvOSD_Color_info;
+
+typedef struct _NvOSD_RectParams
+{
+  float left;
+  float top;
+  float width;
+  float height;
+  unsigned int border_width;
+  NvOSD_ColorParams border_color;
+  unsigned int has_bg_color;
+  unsigned int reserved;
+  NvOSD_ColorParams bg_color;
+  int has_color_info;
+  int color_id;
+} NvOSD_RectParams;
+
+typedef struct _NvOSD_MaskParams
+{
+  float *data;
+  unsigned int size;
+  float threshold;
+  unsigned int width;
+  unsigned int height;
+} NvOSD_MaskParams;
+
+typedef struct _NvOSD_LineParams
+{
+  unsigned int x1;
+  unsigned int y1;
+  unsigned int x2;
+  unsigned int y2;
+  unsigned int line_width;
+  NvOSD_ColorParams line_color;
+} NvOSD_LineParams;
+
+typedef struct _NvOSD_ArrowParams
+{
+  unsigned int x1;
+  unsigned int y1;
+  unsigned int x2;
+  unsigned int y2;
+  unsigned int arrow_width;
+  NvOSD_Arrow_Head_Direction arrow_head;
+  NvOSD_ColorParams arrow_color;
+  unsigned int reserved;
+} NvOSD_ArrowParams;
+
+typedef struct _NvOSD_CircleParams
+{
+  unsigned int xc;
+  unsigned int yc;
+  unsigned int radius;
+  NvOSD_ColorParams circle_color;
+  unsigned int has_bg_color;
+  NvOSD_ColorParams bg_color;
+  unsigned int reserved;
+} NvOSD_CircleParams;
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __NVLL_OSD_STRUCT_DEFS__ */
@@ -0,0 +1,34 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Stand-in for the NVTX header of the CUDA toolkit; the ranges are not
+ * recorded.
+ */
+
+#ifndef NVTOOLSEXT_V3
+#define NVTOOLSEXT_V3
+
+static inline int
+nvtxRangePushA (const char *message)
+{
+  (void) message;
+  return 0;
+}
+
+static inline int
+nvtxRangePop (void)
+{
+  return 0;
+}
+
+#endif /* NVTOOLSEXT_V3 */
@@ -0,0 +1,408 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Convert the output of dsosdcoord export-format=binary, or a segment file
+ * of export-sink=file, to JSON or CSV.
+ *
+ *   dsosdcoord-decode [-f json|csv] [-s SOURCE [-t PTS | -n FRAME]] [FILE]
+ *
+ * Reads FILE, or stdin if none is given. JSON output has one line per frame
+ * chunk, CSV output one row per object, with the classifier labels of an
+ * object joined by ';' and without its user meta and mask. Masks are
+ * printed in the uncompressed RLE of the COCO API, column-major relative to
+ * the box of their object. -s only prints the frames
+ * of one source; in a segment file -t and -n start at the index entry of
+ * that source before the given PTS in nanoseconds or frame number.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dsosdcoord_log.h"
+
+typedef enum
+{
+  DECODE_FORMAT_JSON,
+  DECODE_FORMAT_CSV,
+} DecodeFormat;
+
+static const char *event_names[] = {
+  "none",
+  "appear",
+  "move",
+  "keyframe",
+  "disappear",
+};
+
+static const char *
+event_name (uint32_t event)
+{
+  if (event >= sizeof (event_names) / sizeof (event_names[0]))
+    return "unknown";
+  return event_names[event];
+}
+
+static void
+print_json_string (const char *s)
+{
+  putchar ('"');
+  for (; *s; s++) {
+    unsigned char c = (unsigned char) *s;
+
+    if (c == '"' || c == '\\')
+      printf ("\\%c", c);
+    else if (c < 0x20)
+      printf ("\\u%04x", c);
+    else
+      putchar (c);
+  }
+  putchar ('"');
+}
+
+static void
+print_csv_string (const char *s)
+{
+  if (!strpbrk (s, ",\"\r\n")) {
+    fputs (s, stdout);
+    return;
+  }
+  putchar ('"');
+  for (; *s; s++) {
+    if (*s == '"')
+      putchar ('"');
+    putchar (*s);
+  }
+  putchar ('"');
+}
+
+static void
+print_pts_json (uint64_t pts)
+{
+  if (pts == UINT64_MAX)
+    fputs ("null", stdout);
+  else
+    printf ("%llu", (unsigned long long) pts);
+}
+
+/**
+ * Print the export-fields of an object as members of its JSON object.
+ */
+static void
+print_fields_json (const DsOsdCoordBinReader * reader,
+    const DsOsdCoordBinObject * object, const DsOsdCoordBinObjectFields * fields)
+{
+  uint32_t i;
+
+  if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CONFIDENCE)
+    printf (",\"confidence\":%g", fields->confidence);
+  if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACKER_CONFIDENCE)
+    printf (",\"tracker_confidence\":%g", fields->tracker_confidence);
+  if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASSIFIER) {
+    fputs (",\"classifier\":[", stdout);
+    for (i = 0; i < fields->num_classifier_results; i++) {
+      const DsOsdCoordBinClassifierResult *result =
+          &fields->classifier_results[i];
+
+      if (i > 0)
+        putchar (',');
+      printf ("{\"component_id\":%d,\"class_id\":%u,\"label\":",
+          result->component_id, result->class_id);
+      print_json_string (dsosdcoord_bin_reader_label (reader,
+              result->label_id));
+      printf (",\"prob\":%g}", result->prob);
+    }
+    putchar (']');
+  }
+  if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_USER_META) {
+    fputs (",\"user_meta\":[", stdout);
+    for (i = 0; i < fields->num_user_meta; i++)
+      printf ("%s%u", i > 0 ? "," : "", fields->user_meta_types[i]);
+    putchar (']');
+  }
+}
+
+/**
+ * Print the mask of object i as COCO RLE. The stream holds the runs in
+ * row-major order, COCO counts them column by column, so the mask is
+ * expanded and counted again. A mask whose runs do not cover it exactly is
+ * printed as null.
+ */
+static void
+print_mask_json (const DsOsdCoordBinReader * reader, uint32_t i)
+{
+  static unsigned char *pixels;
+  static size_t max_pixels;
+  const uint32_t *counts;
+  uint32_t width, height, num_counts, j, run = 0;
+  uint64_t n = 0, k;
+  unsigned char value = 0;
+  size_t x, y;
+
+  counts = dsosdcoord_bin_reader_mask (reader, i, &width, &height,
+      &num_counts);
+  if (!counts)
+    return;
+  fputs (",\"mask\":", stdout);
+
+  for (j = 0; j < num_counts; j++)
+    n += counts[j];
+  if (n != (uint64_t) width * height || n > SIZE_MAX) {
+    fputs ("null", stdout);
+    return;
+  }
+  if (n > max_pixels) {
+    unsigned char *p = (unsigned char *) realloc (pixels, n);
+
+    if (!p) {
+      fputs ("null", stdout);
+      return;
+    }
+    pixels = p;
+    max_pixels = n;
+  }
+  for (j = 0, k = 0; j < num_counts; j++, value ^= 1) {
+    memset (pixels + k, value, counts[j]);
+    k += counts[j];
+  }
+
+  printf ("{\"size\":[%u,%u],\"counts\":[", height, width);
+  value = 0;
+  for (x = 0; x < width; x++) {
+    for (y = 0; y < height; y++) {
+      if (pixels[y * width + x] != value) {
+        printf ("%u,", run);
+        value ^= 1;
+        run = 0;
+      }
+      run++;
+    }
+  }
+  printf ("%u]}", run);
+}
+
+/**
+ * Print the classifier labels of an object as one CSV field.
+ */
+static void
+print_classifier_csv (const DsOsdCoordBinReader * reader,
+    const DsOsdCoordBinObjectFields * fields)
+{
+  char buf[DSOSDCOORD_BIN_MAX_CLASSIFIER_RESULTS *
+      (DSOSDCOORD_BIN_MAX_STRING_LENGTH + 1)];
+  size_t len = 0;
+  uint32_t i;
+
+  buf[0] = '\0';
+  for (i = 0; i < fields->num_classifier_results; i++)
+    len += snprintf (buf + len, sizeof (buf) - len, "%s%s", i > 0 ? ";" : "",
+        dsosdcoord_bin_reader_label (reader,
+            fields->classifier_results[i].label_id));
+  print_csv_string (buf);
+}
+
+static void
+print_frame_json (const DsOsdCoordBinReader * reader)
+{
+  const DsOsdCoordBinFrame *frame = &reader->frame;
+  uint32_t i;
+
+  printf ("{\"frame_num\":%u,\"pts\":", frame->frame_num);
+  print_pts_json (frame->pts);
+  if (frame->flags & DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE)
+    printf (",\"source_id\":%u,\"batch_id\":%u", frame->source_id,
+        frame->batch_id);
+  fputs (",\"objects\":[", stdout);
+  for (i = 0; i < frame->num_objects; i++) {
+    const DsOsdCoordBinObject *object = &reader->objects[i];
+
+    if (i > 0)
+      putchar (',');
+    fputs ("{\"label\":", stdout);
+    print_json_string (dsosdcoord_bin_reader_label (reader, object->label_id));
+    if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASS)
+      printf (",\"class_id\":%d", object->class_id);
+    printf (",\"left\":%g,\"top\":%g,\"width\":%g,\"height\":%g",
+        object->left, object->top, object->width, object->height);
+    if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK)
+      printf (",\"object_id\":%llu,\"event\":\"%s\"",
+          (unsigned long long) object->object_id, event_name (object->event));
+    print_fields_json (reader, object, &reader->fields[i]);
+    print_mask_json (reader, i);
+    putchar ('}');
+  }
+  fputs ("]}\n", stdout);
+}
+
+static void
+print_frame_csv (const DsOsdCoordBinReader * reader)
+{
+  const DsOsdCoordBinFrame *frame = &reader->frame;
+  int has_source = frame->flags & DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE;
+  uint32_t i;
+
+  for (i = 0; i < frame->num_objects; i++) {
+    const DsOsdCoordBinObject *object = &reader->objects[i];
+    const DsOsdCoordBinObjectFields *fields = &reader->fields[i];
+    int has_track = object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK;
+
+    printf ("%u,", frame->frame_num);
+    if (frame->pts != UINT64_MAX)
+      printf ("%llu", (unsigned long long) frame->pts);
+    putchar (',');
+    if (has_source)
+      printf ("%u,%u,", frame->source_id, frame->batch_id);
+    else
+      fputs (",,", stdout);
+    print_csv_string (dsosdcoord_bin_reader_label (reader, object->label_id));
+    putchar (',');
+    if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASS)
+      printf ("%d", object->class_id);
+    printf (",%g,%g,%g,%g,", object->left, object->top, object->width,
+        object->height);
+    if (has_track)
+      printf ("%llu,%s,", (unsigned long long) object->object_id,
+          event_name (object->event));
+    else
+      fputs (",,", stdout);
+    if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CONFIDENCE)
+      printf ("%g", fields->confidence);
+    putchar (',');
+    if (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACKER_CONFIDENCE)
+      printf ("%g", fields->tracker_confidence);
+    putchar (',');
+    print_classifier_csv (reader, fields);
+    putchar ('\n');
+  }
+}
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr, "Usage: %s [-f json|csv] [-s SOURCE [-t PTS | -n FRAME]] "
+      "[FILE]\n", prog);
+}
+
+/**
+ * Whether the file at path starts with the magic of a segment file.
+ */
+static int
+is_segment (const char *path)
+{
+  uint32_t magic = 0;
+  FILE *file = fopen (path, "rb");
+
+  if (!file)
+    return 0;
+  if (fread (&magic, sizeof (magic), 1, file) != 1)
+    magic = 0;
+  fclose (file);
+  return magic == DSOSDCOORD_LOG_MAGIC;
+}
+
+int
+main (int argc, char *argv[])
+{
+  DecodeFormat format = DECODE_FORMAT_JSON;
+  DsOsdCoordLogReader log;
+  DsOsdCoordBinReader *reader = &log.bin;
+  const char *path = NULL;
+  FILE *file = stdin;
+  long long source = -1;
+  unsigned long long start = 0;
+  int by_frame_num = -1, segment, i, ret;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp (argv[i], "-f") == 0 && i + 1 < argc) {
+      i++;
+      if (strcmp (argv[i], "json") == 0) {
+        format = DECODE_FORMAT_JSON;
+      } else if (strcmp (argv[i], "csv") == 0) {
+        format = DECODE_FORMAT_CSV;
+      } else {
+        usage (argv[0]);
+        return 2;
+      }
+    } else if (strcmp (argv[i], "-s") == 0 && i + 1 < argc) {
+      source = strtoll (argv[++i], NULL, 0);
+    } else if ((strcmp (argv[i], "-t") == 0 || strcmp (argv[i], "-n") == 0)
+        && i + 1 < argc) {
+      by_frame_num = argv[i][1] == 'n';
+      start = strtoull (argv[++i], NULL, 0);
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      usage (argv[0]);
+      return 2;
+    } else if (!path) {
+      path = argv[i];
+    } else {
+      usage (argv[0]);
+      return 2;
+    }
+  }
+
+  if (by_frame_num >= 0 && source < 0) {
+    usage (argv[0]);
+    return 2;
+  }
+
+  segment = path && strcmp (path, "-") != 0 && is_segment (path);
+  if (segment) {
+    if (dsosdcoord_log_reader_open (&log, path) < 0) {
+      fprintf (stderr, "%s: invalid segment file\n", path);
+      return 1;
+    }
+    /* Without an index entry for the source the segment is read whole. */
+    if (by_frame_num >= 0)
+      dsosdcoord_log_reader_seek (&log, (uint32_t) source, start,
+          by_frame_num);
+  } else if (path && strcmp (path, "-") != 0) {
+    file = fopen (path, "rb");
+    if (!file) {
+      perror (path);
+      return 1;
+    }
+  }
+
+  if (format == DECODE_FORMAT_CSV)
+    puts ("frame_num,pts,source_id,batch_id,label,class_id,left,top,width,"
+        "height,object_id,event,confidence,tracker_confidence,classifier");
+
+  if (!segment)
+    dsosdcoord_bin_reader_init (reader, file);
+  while ((ret = dsosdcoord_bin_reader_next (reader)) > 0) {
+    const DsOsdCoordBinFrame *frame = &reader->frame;
+
+    if (source >= 0 && (!(frame->flags & DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE)
+            || frame->source_id != source))
+      continue;
+    if (by_frame_num >= 0 &&
+        (by_frame_num ? frame->frame_num : frame->pts) < start)
+      continue;
+    if (format == DECODE_FORMAT_CSV)
+      print_frame_csv (reader);
+    else
+      print_frame_json (reader);
+  }
+  if (segment) {
+    dsosdcoord_log_reader_close (&log);
+  } else {
+    dsosdcoord_bin_reader_clear (reader);
+    if (file != stdin)
+      fclose (file);
+  }
+
+  if (ret < 0) {
+    fprintf (stderr, "%s: truncated or invalid stream\n", argv[0]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,570 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Binary record format written by dsosdcoord with export-format=binary, and
+ * a header-only reader for consumer processes.
+ *
+ * The stream is a sequence of chunks, each a DsOsdCoordBinChunk followed by
+ * `size` bytes of payload, in the byte order of the writer:
+ *
+ * - STREAM starts a stream and clears the string table. Its payload is a
+ *   DsOsdCoordBinStream. It is always the first chunk and is repeated when
+ *   the writer restarts its string table.
+ * - STRING adds a label to the string table: a DsOsdCoordBinString followed
+ *   by `length` bytes, not NUL-terminated.
+ * - FRAME holds the objects of a frame: a DsOsdCoordBinFrame followed by
+ *   `num_objects` records of `object_size` bytes each. Every label_id of the
+ *   objects has been defined by an earlier STRING chunk. The objects of one
+ *   frame may be spread over several FRAME chunks. When the writer exports
+ *   more than the box and label (export-fields), each record is a
+ *   DsOsdCoordBinObject followed by a DsOsdCoordBinObjectFields, the labels
+ *   of its classifier results being in the string table as well.
+ * - MASK holds the instance masks of objects of the FRAME chunk that
+ *   follows it: a DsOsdCoordBinMasks followed by `num_masks`
+ *   DsOsdCoordBinMask, each followed by `num_counts` uint32_t run lengths.
+ *
+ * Readers skip chunks of unknown type. Later versions of the same major
+ * version only add chunk types and append fields to the object record,
+ * readers take the fields they know of from the first bytes of each record.
+ */
+
+#ifndef __DSOSDCOORD_BIN_H__
+#define __DSOSDCOORD_BIN_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSOSDCOORD_BIN_MAGIC 0x424f5344u        /* "DSOB" */
+#define DSOSDCOORD_BIN_VERSION 1
+/** Largest number of labels in the string table of a stream. */
+#define DSOSDCOORD_BIN_MAX_STRINGS 65536
+/** Longest label in bytes. */
+#define DSOSDCOORD_BIN_MAX_STRING_LENGTH 4096
+
+/** Values of DsOsdCoordBinChunk::type. */
+#define DSOSDCOORD_BIN_CHUNK_STREAM 1
+#define DSOSDCOORD_BIN_CHUNK_STRING 2
+#define DSOSDCOORD_BIN_CHUNK_FRAME 3
+#define DSOSDCOORD_BIN_CHUNK_MASK 4
+
+/** The frame carries source_id and batch_id. */
+#define DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE (1 << 0)
+/** The object carries object_id and event of a track. */
+#define DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK (1 << 1)
+/** The object carries class_id. Writers before it left the field 0. */
+#define DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASS (1 << 2)
+/** Fields of DsOsdCoordBinObjectFields the object carries. */
+#define DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CONFIDENCE (1 << 3)
+#define DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACKER_CONFIDENCE (1 << 4)
+#define DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASSIFIER (1 << 5)
+#define DSOSDCOORD_BIN_OBJECT_FLAG_HAS_USER_META (1 << 6)
+/** The object has a mask in the MASK chunk before its FRAME chunk. */
+#define DSOSDCOORD_BIN_OBJECT_FLAG_HAS_MASK (1 << 7)
+
+#define DSOSDCOORD_BIN_MAX_CLASSIFIER_RESULTS 4
+#define DSOSDCOORD_BIN_MAX_USER_META 4
+/** Most run lengths of a mask. */
+#define DSOSDCOORD_BIN_MAX_MASK_COUNTS 4096
+/** Value of DsOsdCoordBinReader::mask_offsets for objects without mask. */
+#define DSOSDCOORD_BIN_NO_MASK UINT32_MAX
+
+/** Values of DsOsdCoordBinObject::event, as DSOSDCOORD_SHM_EVENT_*. */
+#define DSOSDCOORD_BIN_EVENT_NONE 0
+#define DSOSDCOORD_BIN_EVENT_APPEAR 1
+#define DSOSDCOORD_BIN_EVENT_MOVE 2
+#define DSOSDCOORD_BIN_EVENT_KEYFRAME 3
+#define DSOSDCOORD_BIN_EVENT_DISAPPEAR 4
+
+typedef struct _DsOsdCoordBinChunk
+{
+  /** DSOSDCOORD_BIN_CHUNK_* */
+  uint32_t type;
+  /** Bytes of payload following the chunk header. */
+  uint32_t size;
+} DsOsdCoordBinChunk;
+
+typedef struct _DsOsdCoordBinStream
+{
+  uint32_t magic;
+  uint32_t version;
+  /** sizeof (DsOsdCoordBinObject) of the writer. */
+  uint32_t object_size;
+  uint32_t reserved;
+} DsOsdCoordBinStream;
+
+typedef struct _DsOsdCoordBinString
+{
+  /** Index of the label in the string table. */
+  uint32_t id;
+  uint32_t length;
+} DsOsdCoordBinString;
+
+typedef struct _DsOsdCoordBinFrame
+{
+  uint32_t source_id;
+  uint32_t batch_id;
+  uint32_t frame_num;
+  /** DSOSDCOORD_BIN_FRAME_FLAG_* */
+  uint32_t flags;
+  /** Buffer PTS of the frame in nanoseconds, UINT64_MAX if unknown. */
+  uint64_t pts;
+  uint32_t num_objects;
+  uint32_t reserved;
+} DsOsdCoordBinFrame;
+
+typedef struct _DsOsdCoordBinObject
+{
+  /** Index of the label in the string table. */
+  uint32_t label_id;
+  /** DSOSDCOORD_BIN_OBJECT_FLAG_* */
+  uint32_t flags;
+  /** DSOSDCOORD_BIN_EVENT_* */
+  uint32_t event;
+  /** class_id of the object meta, see DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASS.
+      Consumers can tell classes apart by it without parsing labels. */
+  int32_t class_id;
+  float left;
+  float top;
+  float width;
+  float height;
+  uint64_t object_id;
+} DsOsdCoordBinObject;
+
+typedef struct _DsOsdCoordBinClassifierResult
+{
+  /** unique_component_id of the classifier. */
+  int32_t component_id;
+  uint32_t class_id;
+  float prob;
+  /** Index of the label in the string table. */
+  uint32_t label_id;
+} DsOsdCoordBinClassifierResult;
+
+/**
+ * Optional part of an object record, see DSOSDCOORD_BIN_OBJECT_FLAG_HAS_*
+ * for which fields are set.
+ */
+typedef struct _DsOsdCoordBinObjectFields
+{
+  float confidence;
+  float tracker_confidence;
+  uint32_t num_classifier_results;
+  uint32_t num_user_meta;
+  DsOsdCoordBinClassifierResult
+      classifier_results[DSOSDCOORD_BIN_MAX_CLASSIFIER_RESULTS];
+  /** meta_type of the user meta of the object. */
+  uint32_t user_meta_types[DSOSDCOORD_BIN_MAX_USER_META];
+} DsOsdCoordBinObjectFields;
+
+typedef struct _DsOsdCoordBinMasks
+{
+  uint32_t num_masks;
+  uint32_t reserved;
+} DsOsdCoordBinMasks;
+
+/**
+ * Mask of an object, the mask_params of its object meta thresholded at
+ * their threshold and scaled to the box by the consumer. The run lengths
+ * that follow are of pixels in row-major order, alternately at or below
+ * and above the threshold, starting with the former; they add up to
+ * width * height.
+ */
+typedef struct _DsOsdCoordBinMask
+{
+  /** Index of the object in the FRAME chunk. */
+  uint32_t object_index;
+  uint32_t width;
+  uint32_t height;
+  uint32_t num_counts;
+} DsOsdCoordBinMask;
+
+/**
+ * Reader state. The reader owns the string table and the objects of the
+ * last frame read. fields[i] belongs to objects[i] and is all 0 if the
+ * stream has no such part; see dsosdcoord_bin_reader_mask() for masks.
+ */
+typedef struct _DsOsdCoordBinReader
+{
+  FILE *file;
+  /** Record size of the stream being read, 0 before its STREAM chunk. */
+  uint32_t object_size;
+  /** Labels by id, NULL for ids not defined. */
+  char **strings;
+  uint32_t max_strings;
+  /** Last frame read and its objects. */
+  DsOsdCoordBinFrame frame;
+  DsOsdCoordBinObject *objects;
+  DsOsdCoordBinObjectFields *fields;
+  /** Offset in masks of the DsOsdCoordBinMask of each object. */
+  uint32_t *mask_offsets;
+  uint32_t max_objects;
+  /** Payload of the last MASK chunk, after its DsOsdCoordBinMasks, in
+      32-bit words, and the number of masks in it not yet assigned to a
+      frame. */
+  uint32_t *masks;
+  uint32_t masks_size;
+  uint32_t max_masks_size;
+  uint32_t num_masks;
+} DsOsdCoordBinReader;
+
+static inline void
+dsosdcoord_bin_reader_init (DsOsdCoordBinReader * reader, FILE * file)
+{
+  memset (reader, 0, sizeof (*reader));
+  reader->file = file;
+}
+
+static inline void
+dsosdcoord_bin_reader_clear_strings (DsOsdCoordBinReader * reader)
+{
+  uint32_t i;
+
+  for (i = 0; i < reader->max_strings; i++) {
+    free (reader->strings[i]);
+    reader->strings[i] = NULL;
+  }
+}
+
+/** Free what the reader allocated. The file is not closed. */
+static inline void
+dsosdcoord_bin_reader_clear (DsOsdCoordBinReader * reader)
+{
+  dsosdcoord_bin_reader_clear_strings (reader);
+  free (reader->strings);
+  free (reader->objects);
+  free (reader->fields);
+  free (reader->mask_offsets);
+  free (reader->masks);
+  memset (reader, 0, sizeof (*reader));
+}
+
+/**
+ * Label of the given id in the current string table, "" if undefined.
+ */
+static inline const char *
+dsosdcoord_bin_reader_label (const DsOsdCoordBinReader * reader, uint32_t id)
+{
+  if (id >= reader->max_strings || !reader->strings[id])
+    return "";
+  return reader->strings[id];
+}
+
+/**
+ * Mask of object i of the last frame read: its size is stored in *width
+ * and *height and the number of its run lengths, which are returned, in
+ * *num_counts. Returns NULL if the object has no mask.
+ */
+static inline const uint32_t *
+dsosdcoord_bin_reader_mask (const DsOsdCoordBinReader * reader, uint32_t i,
+    uint32_t * width, uint32_t * height, uint32_t * num_counts)
+{
+  const DsOsdCoordBinMask *mask;
+
+  if (i >= reader->frame.num_objects ||
+      reader->mask_offsets[i] == DSOSDCOORD_BIN_NO_MASK)
+    return NULL;
+  mask = (const DsOsdCoordBinMask *) (reader->masks +
+      reader->mask_offsets[i]);
+  *width = mask->width;
+  *height = mask->height;
+  *num_counts = mask->num_counts;
+  return (const uint32_t *) (mask + 1);
+}
+
+/**
+ * Read exactly size bytes. Returns 1 on success, 0 at end of file before
+ * the first byte if eof_ok, -1 otherwise.
+ */
+static inline int
+dsosdcoord_bin_reader_read (DsOsdCoordBinReader * reader, void *data,
+    size_t size, int eof_ok)
+{
+  size_t n = fread (data, 1, size, reader->file);
+
+  if (n == size)
+    return 1;
+  return (n == 0 && eof_ok && feof (reader->file)) ? 0 : -1;
+}
+
+static inline int
+dsosdcoord_bin_reader_skip (DsOsdCoordBinReader * reader, uint32_t size)
+{
+  char buf[256];
+
+  while (size > 0) {
+    uint32_t n = size < sizeof (buf) ? size : (uint32_t) sizeof (buf);
+
+    if (dsosdcoord_bin_reader_read (reader, buf, n, 0) < 0)
+      return -1;
+    size -= n;
+  }
+  return 0;
+}
+
+static inline int
+dsosdcoord_bin_reader_read_stream (DsOsdCoordBinReader * reader,
+    uint32_t size)
+{
+  DsOsdCoordBinStream stream;
+
+  if (size < sizeof (stream) ||
+      dsosdcoord_bin_reader_read (reader, &stream, sizeof (stream), 0) < 0)
+    return -1;
+  if (stream.magic != DSOSDCOORD_BIN_MAGIC ||
+      stream.version != DSOSDCOORD_BIN_VERSION ||
+      stream.object_size < sizeof (DsOsdCoordBinObject))
+    return -1;
+  reader->object_size = stream.object_size;
+  reader->num_masks = 0;
+  dsosdcoord_bin_reader_clear_strings (reader);
+  return dsosdcoord_bin_reader_skip (reader, size - sizeof (stream));
+}
+
+static inline int
+dsosdcoord_bin_reader_read_string (DsOsdCoordBinReader * reader,
+    uint32_t size)
+{
+  DsOsdCoordBinString string;
+  char *label;
+
+  if (size < sizeof (string) ||
+      dsosdcoord_bin_reader_read (reader, &string, sizeof (string), 0) < 0)
+    return -1;
+  if (string.id >= DSOSDCOORD_BIN_MAX_STRINGS ||
+      string.length > DSOSDCOORD_BIN_MAX_STRING_LENGTH ||
+      string.length != size - sizeof (string))
+    return -1;
+
+  if (string.id >= reader->max_strings) {
+    uint32_t max = reader->max_strings ? reader->max_strings : 64;
+    char **strings;
+
+    while (max <= string.id)
+      max *= 2;
+    strings = (char **) realloc (reader->strings, max * sizeof (char *));
+    if (!strings)
+      return -1;
+    memset (strings + reader->max_strings, 0,
+        (max - reader->max_strings) * sizeof (char *));
+    reader->strings = strings;
+    reader->max_strings = max;
+  }
+
+  label = (char *) malloc (string.length + 1);
+  if (!label)
+    return -1;
+  if (dsosdcoord_bin_reader_read (reader, label, string.length, 0) < 0) {
+    free (label);
+    return -1;
+  }
+  label[string.length] = '\0';
+  free (reader->strings[string.id]);
+  reader->strings[string.id] = label;
+  return 0;
+}
+
+/**
+ * Read the masks of a MASK chunk mask by mask, so that no more is allocated
+ * than the stream holds.
+ */
+static inline int
+dsosdcoord_bin_reader_read_masks (DsOsdCoordBinReader * reader, uint32_t size)
+{
+  DsOsdCoordBinMasks masks;
+  uint32_t i, words = 0;
+
+  reader->num_masks = 0;
+  if (size < sizeof (masks) ||
+      dsosdcoord_bin_reader_read (reader, &masks, sizeof (masks), 0) < 0)
+    return -1;
+  size -= sizeof (masks);
+
+  for (i = 0; i < masks.num_masks; i++) {
+    DsOsdCoordBinMask mask;
+    uint32_t mask_words;
+
+    if (size < sizeof (mask) ||
+        dsosdcoord_bin_reader_read (reader, &mask, sizeof (mask), 0) < 0)
+      return -1;
+    size -= sizeof (mask);
+    if (mask.num_counts == 0 ||
+        mask.num_counts > DSOSDCOORD_BIN_MAX_MASK_COUNTS ||
+        mask.num_counts > (uint64_t) mask.width * mask.height + 1 ||
+        size < mask.num_counts * sizeof (uint32_t))
+      return -1;
+    size -= mask.num_counts * sizeof (uint32_t);
+
+    mask_words = sizeof (mask) / sizeof (uint32_t) + mask.num_counts;
+    if (words + mask_words > reader->max_masks_size) {
+      uint32_t max = reader->max_masks_size ? reader->max_masks_size : 1024;
+      uint32_t *data;
+
+      while (max < words + mask_words)
+        max *= 2;
+      data = (uint32_t *) realloc (reader->masks, max * sizeof (uint32_t));
+      if (!data)
+        return -1;
+      reader->masks = data;
+      reader->max_masks_size = max;
+    }
+    memcpy (reader->masks + words, &mask, sizeof (mask));
+    if (dsosdcoord_bin_reader_read (reader,
+            reader->masks + words + sizeof (mask) / sizeof (uint32_t),
+            mask.num_counts * sizeof (uint32_t), 0) < 0)
+      return -1;
+    words += mask_words;
+  }
+  reader->masks_size = words;
+  reader->num_masks = masks.num_masks;
+  return dsosdcoord_bin_reader_skip (reader, size);
+}
+
+/**
+ * Assign the masks of the last MASK chunk to the objects of the frame just
+ * read.
+ */
+static inline int
+dsosdcoord_bin_reader_assign_masks (DsOsdCoordBinReader * reader)
+{
+  uint32_t i, offset = 0;
+
+  for (i = 0; i < reader->frame.num_objects; i++)
+    reader->mask_offsets[i] = DSOSDCOORD_BIN_NO_MASK;
+  for (i = 0; i < reader->num_masks; i++) {
+    const DsOsdCoordBinMask *mask =
+        (const DsOsdCoordBinMask *) (reader->masks + offset);
+
+    if (mask->object_index >= reader->frame.num_objects)
+      return -1;
+    reader->mask_offsets[mask->object_index] = offset;
+    offset += sizeof (*mask) / sizeof (uint32_t) + mask->num_counts;
+  }
+  reader->num_masks = 0;
+  return 0;
+}
+
+static inline int
+dsosdcoord_bin_reader_read_frame (DsOsdCoordBinReader * reader, uint32_t size)
+{
+  DsOsdCoordBinFrame *frame = &reader->frame;
+  uint32_t extra, i;
+
+  if (size < sizeof (*frame) ||
+      dsosdcoord_bin_reader_read (reader, frame, sizeof (*frame), 0) < 0)
+    return -1;
+  if (reader->object_size == 0 ||
+      (uint64_t) frame->num_objects * reader->object_size !=
+      size - sizeof (*frame))
+    return -1;
+
+  if (frame->num_objects > reader->max_objects) {
+    DsOsdCoordBinObject *objects = (DsOsdCoordBinObject *)
+        realloc (reader->objects,
+        (size_t) frame->num_objects * sizeof (DsOsdCoordBinObject));
+    DsOsdCoordBinObjectFields *fields;
+    uint32_t *mask_offsets;
+
+    if (!objects)
+      return -1;
+    reader->objects = objects;
+    fields = (DsOsdCoordBinObjectFields *) realloc (reader->fields,
+        (size_t) frame->num_objects * sizeof (DsOsdCoordBinObjectFields));
+    if (!fields)
+      return -1;
+    reader->fields = fields;
+    mask_offsets = (uint32_t *) realloc (reader->mask_offsets,
+        (size_t) frame->num_objects * sizeof (uint32_t));
+    if (!mask_offsets)
+      return -1;
+    reader->mask_offsets = mask_offsets;
+    reader->max_objects = frame->num_objects;
+  }
+
+  extra = reader->object_size - sizeof (DsOsdCoordBinObject);
+  for (i = 0; i < frame->num_objects; i++) {
+    DsOsdCoordBinObjectFields *fields = &reader->fields[i];
+
+    if (dsosdcoord_bin_reader_read (reader, &reader->objects[i],
+            sizeof (DsOsdCoordBinObject), 0) < 0)
+      return -1;
+    if (extra >= sizeof (*fields)) {
+      if (dsosdcoord_bin_reader_read (reader, fields, sizeof (*fields),
+              0) < 0 ||
+          dsosdcoord_bin_reader_skip (reader, extra - sizeof (*fields)) < 0)
+        return -1;
+      if (fields->num_classifier_results >
+          DSOSDCOORD_BIN_MAX_CLASSIFIER_RESULTS ||
+          fields->num_user_meta > DSOSDCOORD_BIN_MAX_USER_META)
+        return -1;
+    } else {
+      memset (fields, 0, sizeof (*fields));
+      if (dsosdcoord_bin_reader_skip (reader, extra) < 0)
+        return -1;
+    }
+  }
+  return dsosdcoord_bin_reader_assign_masks (reader);
+}
+
+/**
+ * Read chunks up to and including the next FRAME chunk, whose header and
+ * objects are then in reader->frame and reader->objects, and their masks
+ * available from dsosdcoord_bin_reader_mask().
+ * Returns 1 if a frame was read, 0 at the end of the stream and -1 if the
+ * stream is truncated, malformed or of an unsupported version.
+ */
+static inline int
+dsosdcoord_bin_reader_next (DsOsdCoordBinReader * reader)
+{
+  DsOsdCoordBinChunk chunk;
+  int ret;
+
+  for (;;) {
+    ret = dsosdcoord_bin_reader_read (reader, &chunk, sizeof (chunk), 1);
+    if (ret <= 0)
+      return ret;
+
+    switch (chunk.type) {
+      case DSOSDCOORD_BIN_CHUNK_STREAM:
+        ret = dsosdcoord_bin_reader_read_stream (reader, chunk.size);
+        break;
+      case DSOSDCOORD_BIN_CHUNK_STRING:
+        ret = reader->object_size ?
+            dsosdcoord_bin_reader_read_string (reader, chunk.size) : -1;
+        break;
+      case DSOSDCOORD_BIN_CHUNK_MASK:
+        ret = reader->object_size ?
+            dsosdcoord_bin_reader_read_masks (reader, chunk.size) : -1;
+        break;
+      case DSOSDCOORD_BIN_CHUNK_FRAME:
+        if (dsosdcoord_bin_reader_read_frame (reader, chunk.size) < 0)
+          return -1;
+        return 1;
+      default:
+        ret = dsosdcoord_bin_reader_skip (reader, chunk.size);
+        break;
+    }
+    if (ret < 0)
+      return -1;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DSOSDCOORD_BIN_H__ */
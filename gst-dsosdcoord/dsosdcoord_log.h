@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Layout of the segment files written by dsosdcoord with export-sink=file,
+ * and a header-only reader that seeks through their index.
+ *
+ * A segment is a DsOsdCoordLogHeader followed by a stream in the format of
+ * dsosdcoord_bin.h, starting with a STREAM chunk, up to data_end. When the
+ * segment is closed the writer appends a footer:
+ *
+ * - index_count DsOsdCoordLogIndexEntry at index_offset, data_end rounded
+ *   up to a multiple of 8, in file order. A source gets an entry for its
+ *   first frame chunk and then for the first one after every
+ *   DSOSDCOORD_LOG_INDEX_INTERVAL bytes.
+ * - strings_size bytes at strings_offset: a STREAM chunk and the STRING
+ *   chunks of the segment, so a reader that seeks to an entry knows every
+ *   label without reading what comes before it.
+ *
+ * If the writer restarts its string table within a segment, entries before
+ * the restart are left out of the index. Segments that were not closed
+ * (DSOSDCOORD_LOG_FLAG_CLOSED unset) have no footer; their data_end is
+ * updated as the data is synced and they can still be read from the start.
+ */
+
+#ifndef __DSOSDCOORD_LOG_H__
+#define __DSOSDCOORD_LOG_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dsosdcoord_bin.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSOSDCOORD_LOG_MAGIC 0x4c4f5344u        /* "DSOL" */
+#define DSOSDCOORD_LOG_VERSION 1
+/** Bytes of a source's frames between two of its index entries. */
+#define DSOSDCOORD_LOG_INDEX_INTERVAL (64 * 1024)
+
+/** The segment was closed and has a footer. */
+#define DSOSDCOORD_LOG_FLAG_CLOSED (1 << 0)
+
+typedef struct _DsOsdCoordLogHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  /** DSOSDCOORD_LOG_FLAG_* */
+  uint32_t flags;
+  uint32_t index_count;
+  /** End of the stream, where the footer starts. */
+  uint64_t data_end;
+  uint64_t index_offset;
+  uint64_t strings_offset;
+  uint64_t strings_size;
+  /** Wall clock time the segment was opened and closed, in microseconds
+      since the epoch. end_time is 0 until the segment is closed. */
+  int64_t start_time;
+  int64_t end_time;
+  uint8_t reserved[64];
+} DsOsdCoordLogHeader;
+
+typedef struct _DsOsdCoordLogIndexEntry
+{
+  /** Source of the frame, 0 for frames without DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE. */
+  uint32_t source_id;
+  uint32_t frame_num;
+  uint64_t pts;
+  /** File offset of the FRAME chunk. */
+  uint64_t offset;
+} DsOsdCoordLogIndexEntry;
+
+/**
+ * Reader state. Frames are read with dsosdcoord_log_reader_next() and are
+ * then in bin.frame and bin.objects, labels are looked up with
+ * dsosdcoord_bin_reader_label (&reader->bin, id).
+ */
+typedef struct _DsOsdCoordLogReader
+{
+  DsOsdCoordBinReader bin;
+  const uint8_t *map;
+  size_t size;
+  DsOsdCoordLogHeader header;
+  const DsOsdCoordLogIndexEntry *index;
+  uint32_t index_count;
+} DsOsdCoordLogReader;
+
+static inline void
+dsosdcoord_log_reader_close (DsOsdCoordLogReader * reader)
+{
+  if (reader->bin.file)
+    fclose (reader->bin.file);
+  dsosdcoord_bin_reader_clear (&reader->bin);
+  if (reader->map)
+    munmap ((void *) reader->map, reader->size);
+  memset (reader, 0, sizeof (*reader));
+}
+
+/**
+ * Load the string table of a closed segment from its footer.
+ */
+static inline int
+dsosdcoord_log_reader_load_strings (DsOsdCoordLogReader * reader)
+{
+  FILE *file;
+  int ret;
+
+  file = fmemopen ((void *) (reader->map + reader->header.strings_offset),
+      reader->header.strings_size, "r");
+  if (!file)
+    return -1;
+  reader->bin.file = file;
+  /* The footer holds no frames, only the chunks defining the labels. */
+  while ((ret = dsosdcoord_bin_reader_next (&reader->bin)) > 0);
+  fclose (file);
+  reader->bin.file = NULL;
+  return ret;
+}
+
+/**
+ * Map the segment at path and position the reader at its first frame.
+ * Returns 0 on success, -1 if the file cannot be read or is not a segment.
+ */
+static inline int
+dsosdcoord_log_reader_open (DsOsdCoordLogReader * reader, const char *path)
+{
+  const DsOsdCoordLogHeader *header;
+  struct stat st;
+  void *addr;
+  int fd;
+
+  memset (reader, 0, sizeof (*reader));
+
+  fd = open (path, O_RDONLY);
+  if (fd < 0)
+    return -1;
+  if (fstat (fd, &st) < 0 || (size_t) st.st_size < sizeof (*header)) {
+    close (fd);
+    return -1;
+  }
+  addr = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (addr == MAP_FAILED)
+    return -1;
+  reader->map = (const uint8_t *) addr;
+  reader->size = st.st_size;
+
+  header = (const DsOsdCoordLogHeader *) reader->map;
+  memcpy (&reader->header, header, sizeof (reader->header));
+  reader->header.data_end =
+      __atomic_load_n (&header->data_end, __ATOMIC_ACQUIRE);
+  if (reader->header.magic != DSOSDCOORD_LOG_MAGIC ||
+      reader->header.version != DSOSDCOORD_LOG_VERSION ||
+      reader->header.data_end < sizeof (*header) ||
+      reader->header.data_end > reader->size)
+    goto error;
+
+  if (reader->header.flags & DSOSDCOORD_LOG_FLAG_CLOSED) {
+    if (reader->header.index_offset + (uint64_t) reader->header.index_count *
+        sizeof (DsOsdCoordLogIndexEntry) > reader->size ||
+        reader->header.strings_offset + reader->header.strings_size >
+        reader->size)
+      goto error;
+    reader->index = (const DsOsdCoordLogIndexEntry *)
+        (reader->map + reader->header.index_offset);
+    reader->index_count = reader->header.index_count;
+    if (reader->header.strings_size > 0 &&
+        dsosdcoord_log_reader_load_strings (reader) < 0)
+      goto error;
+  }
+
+  reader->bin.file = fmemopen ((void *) reader->map, reader->header.data_end,
+      "rb");
+  if (!reader->bin.file ||
+      fseek (reader->bin.file, sizeof (DsOsdCoordLogHeader), SEEK_SET) < 0)
+    goto error;
+  return 0;
+
+error:
+  dsosdcoord_log_reader_close (reader);
+  return -1;
+}
+
+/**
+ * Position the reader at the last index entry of source_id whose PTS, or
+ * frame number if by_frame_num is non-zero, is not past value, or at the
+ * first entry of the source if all are. Frames read afterwards include
+ * those of other sources. Returns 0 on success, -1 if the index has no
+ * entry for the source, in which case the position is unchanged.
+ */
+static inline int
+dsosdcoord_log_reader_seek (DsOsdCoordLogReader * reader, uint32_t source_id,
+    uint64_t value, int by_frame_num)
+{
+  const DsOsdCoordLogIndexEntry *found = NULL;
+  uint32_t i;
+
+  for (i = 0; i < reader->index_count; i++) {
+    const DsOsdCoordLogIndexEntry *entry = &reader->index[i];
+    uint64_t key = by_frame_num ? entry->frame_num : entry->pts;
+
+    if (entry->source_id != source_id)
+      continue;
+    if (!found || key <= value)
+      found = entry;
+    if (key > value)
+      break;
+  }
+  if (!found || found->offset >= reader->header.data_end)
+    return -1;
+  return fseek (reader->bin.file, (long) found->offset, SEEK_SET) < 0 ? -1 : 0;
+}
+
+/**
+ * Read the next frame chunk. Returns 1 if a frame was read, 0 at data_end
+ * and -1 if the segment is malformed.
+ */
+static inline int
+dsosdcoord_log_reader_next (DsOsdCoordLogReader * reader)
+{
+  return dsosdcoord_bin_reader_next (&reader->bin);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DSOSDCOORD_LOG_H__ */
@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Layout of the shared memory ring written by dsosdcoord with
+ * export-sink=shm, and a header-only reader for consumer processes.
+ *
+ * The ring is a header followed by `capacity` fixed-size record slots. The
+ * single writer publishes record N into slot N % capacity under a per-slot
+ * sequence lock and then advances write_index. Readers never block the
+ * writer: they map the segment read-only, poll write_index and copy slots
+ * out, retrying when a slot is being written and skipping ahead when they
+ * fall more than `capacity` records behind. No system call is made per
+ * record.
+ */
+
+#ifndef __DSOSDCOORD_SHM_H__
+#define __DSOSDCOORD_SHM_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSOSDCOORD_SHM_MAGIC 0x434f5344u        /* "DSOC" */
+#define DSOSDCOORD_SHM_VERSION 4
+#define DSOSDCOORD_SHM_LABEL_SIZE 128
+
+/** The record carries source_id and batch_id of its frame. */
+#define DSOSDCOORD_SHM_FLAG_HAS_SOURCE (1 << 0)
+/** The record carries object_id and event of a track. */
+#define DSOSDCOORD_SHM_FLAG_HAS_TRACK (1 << 1)
+
+/** Values of DsOsdCoordShmRecord::event. */
+#define DSOSDCOORD_SHM_EVENT_NONE 0
+#define DSOSDCOORD_SHM_EVENT_APPEAR 1
+#define DSOSDCOORD_SHM_EVENT_MOVE 2
+#define DSOSDCOORD_SHM_EVENT_KEYFRAME 3
+#define DSOSDCOORD_SHM_EVENT_DISAPPEAR 4
+
+typedef struct _DsOsdCoordShmHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  /** sizeof (DsOsdCoordShmRecord) of the writer. */
+  uint32_t record_size;
+  /** Number of record slots following the header. */
+  uint32_t capacity;
+  /** Number of records published so far. */
+  uint64_t write_index;
+  uint8_t reserved[40];
+} DsOsdCoordShmHeader;
+
+typedef struct _DsOsdCoordShmRecord
+{
+  /** Sequence lock, odd while the writer is updating the slot. */
+  uint32_t seq;
+  uint32_t flags;
+  /** Position of the record in the stream, i.e. write_index when written. */
+  uint64_t index;
+  /** PTS of the frame in nanoseconds, UINT64_MAX if unknown. */
+  uint64_t pts;
+  uint32_t frame_num;
+  uint32_t source_id;
+  uint32_t batch_id;
+  /** DSOSDCOORD_SHM_EVENT_* */
+  uint32_t event;
+  float left;
+  float top;
+  float width;
+  float height;
+  uint64_t object_id;
+  /** class_id of the object meta. */
+  int32_t class_id;
+  uint32_t reserved;
+  char label[DSOSDCOORD_SHM_LABEL_SIZE];
+} DsOsdCoordShmRecord;
+
+/** Total size of a ring with the given number of slots. */
+static inline size_t
+dsosdcoord_shm_size (uint32_t capacity)
+{
+  return sizeof (DsOsdCoordShmHeader) +
+      (size_t) capacity * sizeof (DsOsdCoordShmRecord);
+}
+
+static inline DsOsdCoordShmRecord *
+dsosdcoord_shm_records (DsOsdCoordShmHeader * header)
+{
+  return (DsOsdCoordShmRecord *) (header + 1);
+}
+
+/**
+ * Reader state. Each consumer keeps its own read position, any number of
+ * readers can attach to the same ring.
+ */
+typedef struct _DsOsdCoordShmReader
+{
+  const DsOsdCoordShmHeader *header;
+  const DsOsdCoordShmRecord *records;
+  size_t size;
+  /** Index of the next record to read. */
+  uint64_t read_index;
+  /** Number of records overwritten before they could be read. */
+  uint64_t lost;
+} DsOsdCoordShmReader;
+
+/**
+ * Map the ring created by dsosdcoord under `name` (the shm-name property).
+ * Reading starts at the oldest record still in the ring if from_start is
+ * non-zero, otherwise at the next record to be written.
+ * Returns 0 on success, -1 with errno set on failure: EPROTO if `name` is
+ * not a ring of this version, or is not initialized yet.
+ */
+static inline int
+dsosdcoord_shm_reader_open (DsOsdCoordShmReader * reader, const char *name,
+    int from_start)
+{
+  struct stat st;
+  void *addr;
+  int fd;
+
+  memset (reader, 0, sizeof (*reader));
+
+  fd = shm_open (name, O_RDONLY, 0);
+  if (fd < 0)
+    return -1;
+  if (fstat (fd, &st) < 0) {
+    close (fd);
+    return -1;
+  }
+  if ((size_t) st.st_size < sizeof (DsOsdCoordShmHeader)) {
+    close (fd);
+    errno = EPROTO;
+    return -1;
+  }
+  addr = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (addr == MAP_FAILED)
+    return -1;
+
+  reader->header = (const DsOsdCoordShmHeader *) addr;
+  reader->size = st.st_size;
+  if (reader->header->magic != DSOSDCOORD_SHM_MAGIC ||
+      reader->header->version != DSOSDCOORD_SHM_VERSION ||
+      reader->header->record_size != sizeof (DsOsdCoordShmRecord) ||
+      dsosdcoord_shm_size (reader->header->capacity) > reader->size) {
+    munmap (addr, st.st_size);
+    memset (reader, 0, sizeof (*reader));
+    errno = EPROTO;
+    return -1;
+  }
+  reader->records = (const DsOsdCoordShmRecord *) (reader->header + 1);
+  reader->read_index =
+      __atomic_load_n (&reader->header->write_index, __ATOMIC_ACQUIRE);
+  if (from_start) {
+    reader->read_index = reader->read_index > reader->header->capacity ?
+        reader->read_index - reader->header->capacity : 0;
+  }
+  return 0;
+}
+
+static inline void
+dsosdcoord_shm_reader_close (DsOsdCoordShmReader * reader)
+{
+  if (reader->header)
+    munmap ((void *) reader->header, reader->size);
+  memset (reader, 0, sizeof (*reader));
+}
+
+/** Number of records published but not yet read. */
+static inline uint64_t
+dsosdcoord_shm_reader_available (const DsOsdCoordShmReader * reader)
+{
+  return __atomic_load_n (&reader->header->write_index, __ATOMIC_ACQUIRE) -
+      reader->read_index;
+}
+
+/**
+ * Copy the next record into `record`.
+ * Returns 1 if a record was read, 0 if none is available yet. Records the
+ * writer lapped are skipped and counted in `lost`.
+ */
+static inline int
+dsosdcoord_shm_reader_next (DsOsdCoordShmReader * reader,
+    DsOsdCoordShmRecord * record)
+{
+  const uint32_t capacity = reader->header->capacity;
+
+  for (;;) {
+    uint64_t write_index =
+        __atomic_load_n (&reader->header->write_index, __ATOMIC_ACQUIRE);
+    const DsOsdCoordShmRecord *slot;
+    uint32_t seq0, seq1;
+
+    if (reader->read_index >= write_index)
+      return 0;
+
+    if (write_index - reader->read_index > capacity) {
+      reader->lost += write_index - capacity - reader->read_index;
+      reader->read_index = write_index - capacity;
+    }
+
+    slot = &reader->records[reader->read_index % capacity];
+    seq0 = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq0 & 1)
+      continue;
+    memcpy (record, slot, sizeof (*record));
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+    seq1 = __atomic_load_n (&slot->seq, __ATOMIC_RELAXED);
+    if (seq0 != seq1)
+      continue;
+
+    if (record->index != reader->read_index) {
+      /* The writer lapped us while we were reading; resynchronize. */
+      continue;
+    }
+    reader->read_index++;
+    return 1;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __DSOSDCOORD_SHM_H__ */
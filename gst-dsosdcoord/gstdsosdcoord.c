@@ -16,19 +16,65 @@
 #include <gst/video/video.h>
 #include <gst/base/gstbasetransform.h>
 #include "gstdsosdcoord.h"
-#include <cuda.h>
-#include <cuda_runtime.h>
+#include "gstdsosdcoord_exporter.h"
+#include "gstdsosdcoord_labels.h"
+#include "gstdsosdcoord_log.h"
+#include "gstdsosdcoord_synth.h"
+#include "gstdsosdcoord_replay.h"
+#include "gstdsosdcoord_rle.h"
+#include "gstdsosdcoord_trace.h"
 
 #include "nvbufsurface.h"
 #include "nvtx3/nvToolsExt.h"
 
-GST_DEBUG_CATEGORY_STATIC (gst_ds_osdcoord_debug);
+GST_DEBUG_CATEGORY (gst_ds_osdcoord_debug);
 #define GST_CAT_DEFAULT gst_ds_osdcoord_debug
 
 /* For hw blending, color should be of the form:
    class_id1, R, G, B, A:class_id2, R, G, B, A */
 #define DEFAULT_CLR "0,0.0,1.0,0.0,0.3:1,0.0,1.0,1.0,0.3:2,0.0,0.0,1.0,0.3:3,1.0,1.0,0.0,0.3"
-#define MAX_OSD_ELEMS 1024
+/* Initial number of elements of a draw list. */
+#define DEFAULT_DRAW_LIST_SIZE 64
+#define DEFAULT_DRAW_SHRINK_INTERVAL 300
+#define DEFAULT_EXPORT_QUEUE_SIZE 4096
+#define DEFAULT_EXPORT_OVERFLOW_POLICY DSOSDCOORD_OVERFLOW_BLOCK
+#define DEFAULT_META_TRAVERSAL DSOSDCOORD_TRAVERSAL_BATCH_POOL
+#define DEFAULT_NUM_WORKERS 1
+#define DEFAULT_EXPORT_SINK DSOSDCOORD_EXPORT_SINK_STDOUT
+#define DEFAULT_EXPORT_FORMAT DSOSDCOORD_EXPORT_FORMAT_TEXT
+#define DEFAULT_SHM_NAME "/dsosdcoord"
+#define DEFAULT_SHM_SLOTS 4096
+#define DEFAULT_UDS_PATH "/tmp/dsosdcoord.sock"
+#define DEFAULT_UDS_FLUSH_US 0
+#define DEFAULT_FILE_LOCATION "/tmp/dsosdcoord"
+#define DEFAULT_FILE_SEGMENT_SIZE (64 * 1024 * 1024)
+#define DEFAULT_FILE_SEGMENT_SECONDS 0
+#define DEFAULT_FILE_SYNC_INTERVAL 1000
+#define DEFAULT_EXPORT_SHARED FALSE
+#define DEFAULT_EXPORT_FIELDS 0
+#define DEFAULT_OPERATION DSOSDCOORD_OPERATION_OSD
+#define DEFAULT_OSD_BACKEND DSOSDCOORD_BACKEND_NVLL
+#define DEFAULT_STATS_INTERVAL 0
+#define DEFAULT_MIN_CONFIDENCE -1.0
+#define DEFAULT_MIN_AREA 0
+#define DEFAULT_MAX_AREA 0
+#define DEFAULT_EXPORT_MODE DSOSDCOORD_EXPORT_MODE_ALL
+#define DEFAULT_TRACK_GRACE_FRAMES 30
+#define DEFAULT_TRACK_MOVE_THRESHOLD 4.0
+#define DEFAULT_TRACK_IOU_THRESHOLD 0.0
+#define DEFAULT_TRACK_KEYFRAME_INTERVAL 0
+#define DEFAULT_EXPORT_INTERVAL_FRAMES 1
+#define DEFAULT_EXPORT_MAX_HZ 0.0
+#define DEFAULT_COORD_SPACE DSOSDCOORD_COORD_SPACE_MUXER
+#define DEFAULT_COORD_FORMAT DSOSDCOORD_COORD_FORMAT_FLOAT
+#define DEFAULT_COORD_CLAMP FALSE
+#define MAX_NUM_WORKERS 64
+/* Initial number of export records a worker can hold before growing. */
+#define DEFAULT_WORKER_RECORDS 256
+/* Initial scratch arena of a worker: the default records and their boxes. */
+#define DEFAULT_WORKER_ARENA_SIZE \
+    (DEFAULT_WORKER_RECORDS * (sizeof (GstDsOsdCoordExportRecord) + \
+        4 * sizeof (gfloat)) + 4 * DSOSDCOORD_ARENA_ALIGN)
 
 /* Filter signals and args */
 enum
@@ -54,24 +100,73 @@ enum
   PROP_SHOW_BBOX,
   PROP_SHOW_MASK,
   PROP_SHOW_COORD,
+  PROP_EXPORT_QUEUE_SIZE,
+  PROP_EXPORT_OVERFLOW_POLICY,
+  PROP_EXPORT_DROPPED,
+  PROP_META_TRAVERSAL,
+  PROP_NUM_WORKERS,
+  PROP_EXPORT_SINK,
+  PROP_SHM_NAME,
+  PROP_SHM_SLOTS,
+  PROP_OPERATION,
+  PROP_DRAW_SHRINK_INTERVAL,
+  PROP_MEMORY_USAGE,
+  PROP_OSD_BACKEND,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
+  PROP_CLASS_IDS,
+  PROP_EXCLUDE_CLASS_IDS,
+  PROP_MIN_CONFIDENCE,
+  PROP_MIN_AREA,
+  PROP_MAX_AREA,
+  PROP_ROI,
+  PROP_EXPORT_MODE,
+  PROP_TRACK_GRACE_FRAMES,
+  PROP_TRACK_MOVE_THRESHOLD,
+  PROP_TRACK_IOU_THRESHOLD,
+  PROP_TRACK_KEYFRAME_INTERVAL,
+  PROP_EXPORT_INTERVAL_FRAMES,
+  PROP_EXPORT_MAX_HZ,
+  PROP_COORD_SPACE,
+  PROP_COORD_FORMAT,
+  PROP_COORD_CLAMP,
+  PROP_EXPORT_FORMAT,
+  PROP_UDS_PATH,
+  PROP_UDS_FLUSH_US,
+  PROP_FILE_LOCATION,
+  PROP_FILE_SEGMENT_SIZE,
+  PROP_FILE_SEGMENT_SECONDS,
+  PROP_FILE_SYNC_INTERVAL,
+  PROP_EXPORT_SHARED,
+  PROP_EXPORT_FIELDS,
 };
 
-/* the capabilities of the inputs and outputs. */
+/* the capabilities of the inputs and outputs. Only those the mode and the
+ * osd-backend support are offered, see gst_ds_osdcoord_transform_caps(). */
+#define DSOSDCOORD_NVMM_CAPS \
+    GST_VIDEO_CAPS_MAKE_WITH_FEATURES (GST_CAPS_FEATURE_MEMORY_NVMM, \
+        "{ RGBA }")
+#define DSOSDCOORD_CAPS \
+    DSOSDCOORD_NVMM_CAPS ";" \
+    GST_VIDEO_CAPS_MAKE (GST_VIDEO_FORMATS_ALL)
+
+static GstStaticCaps dsosdcoord_nvmm_caps =
+GST_STATIC_CAPS (DSOSDCOORD_NVMM_CAPS);
+
+static GstStaticCaps dsosdcoord_system_rgba_caps =
+GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("RGBA"));
+
 static GstStaticPadTemplate dsosdcoord_sink_factory =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE_WITH_FEATURES
-        (GST_CAPS_FEATURE_MEMORY_NVMM,
-            "{ RGBA }")));
+    GST_STATIC_CAPS (DSOSDCOORD_CAPS));
 
 static GstStaticPadTemplate dsosdcoord_src_factory =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE_WITH_FEATURES
-        (GST_CAPS_FEATURE_MEMORY_NVMM,
-            "{ RGBA }")));
+    GST_STATIC_CAPS (DSOSDCOORD_CAPS));
 
 /* Default values for properties */
 #define DEFAULT_FONT_SIZE 12
@@ -114,6 +209,236 @@ gst_ds_osdcoord_process_mode_get_type (void)
   return qtype;
 }
 
+#define GST_TYPE_DS_OSDCOORD_OVERFLOW_POLICY \
+    (gst_ds_osdcoord_overflow_policy_get_type ())
+
+static GType
+gst_ds_osdcoord_overflow_policy_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_OVERFLOW_BLOCK, "Block until the exporter catches up",
+          "block"},
+      {DSOSDCOORD_OVERFLOW_DROP_OLDEST, "Drop the oldest queued record",
+          "drop-oldest"},
+      {DSOSDCOORD_OVERFLOW_DROP_NEWEST, "Drop the record being queued",
+          "drop-newest"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordOverflowPolicy", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_META_TRAVERSAL \
+    (gst_ds_osdcoord_meta_traversal_get_type ())
+
+static GType
+gst_ds_osdcoord_meta_traversal_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_TRAVERSAL_BATCH_POOL,
+            "Walk the object pool of the batch, draw on the first surface",
+          "batch-pool"},
+      {DSOSDCOORD_TRAVERSAL_FRAME,
+            "Walk the objects of each frame, draw on the frame's surface",
+          "frame"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordMetaTraversal", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_EXPORT_SINK \
+    (gst_ds_osdcoord_export_sink_get_type ())
+
+static GType
+gst_ds_osdcoord_export_sink_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_EXPORT_SINK_STDOUT, "Records on stdout", "stdout"},
+      {DSOSDCOORD_EXPORT_SINK_SHM, "Shared memory ring buffer", "shm"},
+      {DSOSDCOORD_EXPORT_SINK_UDS, "Unix domain datagram socket", "uds"},
+      {DSOSDCOORD_EXPORT_SINK_FILE, "Rotating indexed segment files", "file"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordExportSink", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_EXPORT_FORMAT \
+    (gst_ds_osdcoord_export_format_get_type ())
+
+static GType
+gst_ds_osdcoord_export_format_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_EXPORT_FORMAT_TEXT, "One text line per object", "text"},
+      {DSOSDCOORD_EXPORT_FORMAT_BINARY,
+            "Binary frames with a string table, see dsosdcoord_bin.h",
+            "binary"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordExportFormat", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_EXPORT_FIELDS \
+    (gst_ds_osdcoord_export_fields_get_type ())
+
+static GType
+gst_ds_osdcoord_export_fields_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GFlagsValue values[] = {
+      {DSOSDCOORD_EXPORT_FIELD_CONFIDENCE, "Detector confidence",
+          "confidence"},
+      {DSOSDCOORD_EXPORT_FIELD_TRACKER_CONFIDENCE, "Tracker confidence",
+          "tracker-confidence"},
+      {DSOSDCOORD_EXPORT_FIELD_CLASSIFIER,
+            "Labels of the secondary classifiers", "classifier"},
+      {DSOSDCOORD_EXPORT_FIELD_USER_META, "Types of the object user meta",
+          "user-meta"},
+      {DSOSDCOORD_EXPORT_FIELD_MASK, "Run-length encoded instance mask",
+          "mask"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_flags_register_static ("GstDsOsdCoordExportFields", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_OPERATION \
+    (gst_ds_osdcoord_operation_get_type ())
+
+static GType
+gst_ds_osdcoord_operation_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_OPERATION_OSD, "Draw the metadata and export coordinates",
+          "osd"},
+      {DSOSDCOORD_OPERATION_EXTRACT_ONLY,
+            "Only export coordinates, without mapping the buffer or using CUDA",
+          "extract-only"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordOperation", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_EXPORT_MODE \
+    (gst_ds_osdcoord_export_mode_get_type ())
+
+static GType
+gst_ds_osdcoord_export_mode_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_EXPORT_MODE_ALL, "Every object of every frame", "all"},
+      {DSOSDCOORD_EXPORT_MODE_CHANGES,
+            "Tracked objects when they appear, move or disappear", "changes"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordExportMode", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_COORD_SPACE \
+    (gst_ds_osdcoord_coord_space_get_type ())
+
+static GType
+gst_ds_osdcoord_coord_space_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_COORD_SPACE_MUXER, "Pixels of the muxer output", "muxer"},
+      {DSOSDCOORD_COORD_SPACE_NORMALIZED,
+            "Fractions of the frame size, 0 to 1", "normalized"},
+      {DSOSDCOORD_COORD_SPACE_SOURCE, "Pixels of the original source",
+            "source"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordCoordSpace", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_COORD_FORMAT \
+    (gst_ds_osdcoord_coord_format_get_type ())
+
+static GType
+gst_ds_osdcoord_coord_format_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_COORD_FORMAT_FLOAT, "Floating point", "float"},
+      {DSOSDCOORD_COORD_FORMAT_INT, "Rounded to integers", "int"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordCoordFormat", values);
+  }
+  return qtype;
+}
+
+#define GST_TYPE_DS_OSDCOORD_OSD_BACKEND \
+    (gst_ds_osdcoord_osd_backend_get_type ())
+
+static GType
+gst_ds_osdcoord_osd_backend_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_BACKEND_NVLL, "DeepStream nvll_osd on NVMM surfaces",
+          "nvll"},
+      {DSOSDCOORD_BACKEND_NULL, "Only count draw commands", "null"},
+      {DSOSDCOORD_BACKEND_CPU,
+            "Reference rasterizer on system memory RGBA frames", "cpu"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordOsdBackend", values);
+  }
+  return qtype;
+}
+
 static void gst_ds_osdcoord_finalize (GObject * object);
 static void gst_ds_osdcoord_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -126,10 +451,57 @@ static gboolean gst_ds_osdcoord_stop (GstBaseTransform * btrans);
 static gboolean gst_ds_osdcoord_parse_color (GstDsOsdCoord * dsosdcoord,
     guint clock_color);
 
-static gboolean gst_ds_osdcoord_parse_hw_blend_color_attrs (GstDsOsdCoord * dsosdcoord,
-    const gchar * arr);
-static gboolean gst_ds_osdcoord_get_hw_blend_color_attrs (GValue * value,
-    GstDsOsdCoord * dsosdcoord);
+/**
+ * Caps of the current mode and osd-backend: any format in system memory
+ * and RGBA in NVMM with mode=extract-only, otherwise RGBA in the memory the
+ * backend draws into.
+ */
+static GstCaps *
+gst_ds_osdcoord_get_supported_caps (GstDsOsdCoord * dsosdcoord)
+{
+  const GstDsOsdCoordBackend *backend;
+  GstCaps *caps;
+
+  if (dsosdcoord->operation == DSOSDCOORD_OPERATION_EXTRACT_ONLY)
+    return gst_pad_get_pad_template_caps (GST_BASE_TRANSFORM_SINK_PAD
+        (dsosdcoord));
+
+  caps = gst_caps_new_empty ();
+  backend = gst_ds_osdcoord_backend_get (dsosdcoord->backend_type);
+  if (backend && (backend->memory & DSOSDCOORD_BACKEND_MEMORY_NVMM))
+    caps = gst_caps_merge (caps, gst_static_caps_get (&dsosdcoord_nvmm_caps));
+  if (backend && (backend->memory & DSOSDCOORD_BACKEND_MEMORY_SYSTEM))
+    caps = gst_caps_merge (caps,
+        gst_static_caps_get (&dsosdcoord_system_rgba_caps));
+  return caps;
+}
+
+/**
+ * Buffers pass through in place, so both sides have the same caps, limited
+ * to those gst_ds_osdcoord_get_supported_caps() returns. Caps the backend
+ * cannot draw on are thereby refused during negotiation.
+ */
+static GstCaps *
+gst_ds_osdcoord_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter)
+{
+  GstCaps *supported = gst_ds_osdcoord_get_supported_caps (GST_DSOSDCOORD
+      (trans));
+  GstCaps *ret;
+
+  ret = gst_caps_intersect_full (caps, supported, GST_CAPS_INTERSECT_FIRST);
+  gst_caps_unref (supported);
+  if (filter) {
+    GstCaps *tmp = gst_caps_intersect_full (filter, ret,
+        GST_CAPS_INTERSECT_FIRST);
+
+    gst_caps_unref (ret);
+    ret = tmp;
+  }
+  GST_DEBUG_OBJECT (trans, "transformed %" GST_PTR_FORMAT " into %"
+      GST_PTR_FORMAT, caps, ret);
+  return ret;
+}
 
 /**
  * Called when source / sink pad capabilities have been negotiated.
@@ -138,478 +510,1696 @@ static gboolean
 gst_ds_osdcoord_set_caps (GstBaseTransform * trans, GstCaps * incaps,
     GstCaps * outcaps)
 {
-  gboolean ret = TRUE;
-
   GstDsOsdCoord *dsosdcoord = GST_DSOSDCOORD (trans);
   gint width = 0, height = 0;
-  cudaError_t CUerr = cudaSuccess;
+  const GstDsOsdCoordBackend *backend = dsosdcoord->backend;
+  guint memory;
+  guint i;
 
   dsosdcoord->frame_num = 0;
 
   GstStructure *structure = gst_caps_get_structure (incaps, 0);
 
-  GST_OBJECT_LOCK (dsosdcoord);
   if (!gst_structure_get_int (structure, "width", &width) ||
       !gst_structure_get_int (structure, "height", &height)) {
     GST_ELEMENT_ERROR (dsosdcoord, STREAM, FAILED,
         ("caps without width/height"), NULL);
-    ret = FALSE;
+    return FALSE;
+  }
+
+  /* Posting an error message takes the object lock, so the errors below
+   * are posted after releasing it. */
+  GST_OBJECT_LOCK (dsosdcoord);
+
+  if (dsosdcoord->operation == DSOSDCOORD_OPERATION_EXTRACT_ONLY) {
+    dsosdcoord->width = width;
+    dsosdcoord->height = height;
     goto exit_set_caps;
   }
+
+  /* NVMM buffers carry an NvBufSurface; system memory frames are wrapped
+   * into one in transform_ip and must be RGBA. */
+  dsosdcoord->sysmem =
+      !gst_caps_features_contains (gst_caps_get_features (incaps, 0),
+      GST_CAPS_FEATURE_MEMORY_NVMM);
+  memory = dsosdcoord->sysmem ? DSOSDCOORD_BACKEND_MEMORY_SYSTEM :
+      DSOSDCOORD_BACKEND_MEMORY_NVMM;
+  if (!(backend->memory & memory)) {
+    GST_OBJECT_UNLOCK (dsosdcoord);
+    GST_ELEMENT_ERROR (dsosdcoord, STREAM, FORMAT,
+        ("osd-backend %s cannot draw on %s memory", backend->name,
+            memory == DSOSDCOORD_BACKEND_MEMORY_SYSTEM ? "system" :
+            GST_CAPS_FEATURE_MEMORY_NVMM),
+        ("use mode=extract-only or another osd-backend for %" GST_PTR_FORMAT,
+            incaps));
+    return FALSE;
+  }
+  if (dsosdcoord->sysmem &&
+      (!gst_video_info_from_caps (&dsosdcoord->video_info, incaps) ||
+          GST_VIDEO_INFO_FORMAT (&dsosdcoord->video_info) !=
+          GST_VIDEO_FORMAT_RGBA)) {
+    GST_OBJECT_UNLOCK (dsosdcoord);
+    GST_ELEMENT_ERROR (dsosdcoord, STREAM, FORMAT,
+        ("drawing on system memory requires RGBA"),
+        ("%" GST_PTR_FORMAT, incaps));
+    return FALSE;
+  }
+
   if (dsosdcoord->dsosdcoord_context && dsosdcoord->width == width
       && dsosdcoord->height == height) {
     goto exit_set_caps;
   }
 
-  CUerr = cudaSetDevice (dsosdcoord->gpu_id);
-  if (CUerr != cudaSuccess) {
-    ret = FALSE;
+  if (backend->set_device && !backend->set_device (dsosdcoord->gpu_id)) {
+    GST_OBJECT_UNLOCK (dsosdcoord);
     GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
         ("Unable to set device"), NULL);
-    goto exit_set_caps;
+    return FALSE;
   }
 
   dsosdcoord->width = width;
   dsosdcoord->height = height;
 
   if (dsosdcoord->show_clock)
-    nvll_osd_set_clock_params (dsosdcoord->dsosdcoord_context,
+    backend->set_clock_params (dsosdcoord->dsosdcoord_context,
         &dsosdcoord->clock_text_params);
 
   dsosdcoord->conv_buf =
-      nvll_osd_set_params (dsosdcoord->dsosdcoord_context, dsosdcoord->width,
+      backend->set_params (dsosdcoord->dsosdcoord_context, dsosdcoord->width,
       dsosdcoord->height);
 
+  for (i = 0; i < dsosdcoord->num_started_workers; i++) {
+    GstDsOsdCoordWorker *worker = &dsosdcoord->workers[i];
+
+    if (worker->context == dsosdcoord->dsosdcoord_context)
+      continue;
+    if (dsosdcoord->show_clock)
+      backend->set_clock_params (worker->context,
+          &dsosdcoord->clock_text_params);
+    backend->set_params (worker->context, dsosdcoord->width,
+        dsosdcoord->height);
+  }
+
 exit_set_caps:
   GST_OBJECT_UNLOCK (dsosdcoord);
-  return ret;
+  return TRUE;
+}
+
+static void gst_ds_osdcoord_worker_func (gpointer data, gpointer user_data);
+
+static void
+gst_ds_osdcoord_draw_list_init (GstDsOsdCoordDrawList * list, gsize elem_size)
+{
+  list->elem_size = elem_size;
+  list->max = DEFAULT_DRAW_LIST_SIZE;
+  list->data = g_malloc0_n (list->max, elem_size);
+  list->len = 0;
+  list->peak = 0;
+}
+
+static void
+gst_ds_osdcoord_draw_list_clear (GstDsOsdCoordDrawList * list)
+{
+  g_free (list->data);
+  list->data = NULL;
+  list->max = 0;
+  list->len = 0;
+  list->peak = 0;
 }
 
 /**
- * Initialize all resources.
+ * Return a pointer to a new element at the end of the list, doubling the
+ * allocation when it is full.
  */
-static gboolean
-gst_ds_osdcoord_start (GstBaseTransform * btrans)
+static inline gpointer
+gst_ds_osdcoord_draw_list_append (GstDsOsdCoordWorker * worker,
+    GstDsOsdCoordDrawList * list)
 {
-  GstDsOsdCoord *dsosdcoord = GST_DSOSDCOORD (btrans);
-
-  cudaError_t CUerr = cudaSuccess;
-  CUerr = cudaSetDevice (dsosdcoord->gpu_id);
-  if (CUerr != cudaSuccess) {
-    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-        ("Unable to set device"), NULL);
-    return FALSE;
+  if (G_UNLIKELY (list->len == list->max)) {
+    list->max = MAX (list->max * 2, DEFAULT_DRAW_LIST_SIZE);
+    list->data = g_realloc_n (list->data, list->max, list->elem_size);
+    worker->resized = TRUE;
+    DSOSDCOORD_TRACE_DRAW_LIST_GROW (list->elem_size, list->max);
   }
-  GST_LOG_OBJECT (dsosdcoord, "SETTING CUDA DEVICE = %d in dsosdcoord func=%s\n",
-      dsosdcoord->gpu_id, __func__);
-
-  dsosdcoord->dsosdcoord_context = nvll_osd_create_context ();
+  if (list->len == list->peak)
+    list->peak++;
+  return (guint8 *) list->data + (gsize) list->len++ * list->elem_size;
+}
 
-  if (dsosdcoord->dsosdcoord_context == NULL) {
-    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-        ("Unable to create context dsosdcoord"), NULL);
-    return FALSE;
-  }
+/**
+ * Shrink the list to the largest length it reached since the last call, if
+ * that is less than half of what is allocated, and start a new period.
+ */
+static gboolean
+gst_ds_osdcoord_draw_list_shrink (GstDsOsdCoordDrawList * list)
+{
+  guint target = MAX (list->peak, DEFAULT_DRAW_LIST_SIZE);
+  gboolean shrunk = FALSE;
 
-  int flag_integrated = -1;
-  cudaDeviceGetAttribute(&flag_integrated, cudaDevAttrIntegrated, dsosdcoord->gpu_id);
-  if(!flag_integrated && dsosdcoord->dsosdcoord_mode == MODE_HW) {
-    dsosdcoord->dsosdcoord_mode = MODE_GPU;
+  if (list->data && target < list->max / 2) {
+    list->max = target;
+    list->data = g_realloc_n (list->data, list->max, list->elem_size);
+    shrunk = TRUE;
   }
+  list->peak = list->len;
+  return shrunk;
+}
 
-  if (dsosdcoord->num_class_entries == 0) {
-    gst_ds_osdcoord_parse_hw_blend_color_attrs (dsosdcoord, DEFAULT_CLR);
+/**
+ * Allocate the draw lists of a worker. If the backend can draw in parallel
+ * (nvll_osd in CPU mode, the null and cpu backends) every worker but the
+ * first gets its own dsosdcoord context so frames are rasterized in
+ * parallel; otherwise draw calls go through the shared context under
+ * draw_lock.
+ */
+static gboolean
+gst_ds_osdcoord_worker_init (GstDsOsdCoord * dsosdcoord,
+    GstDsOsdCoordWorker * worker, guint index)
+{
+  worker->dsosdcoord = dsosdcoord;
+  worker->context = dsosdcoord->dsosdcoord_context;
+  worker->draw_lock = NULL;
+  worker->stats = &dsosdcoord->worker_stats[index];
+
+  gst_ds_osdcoord_arena_init (&worker->arena, DEFAULT_WORKER_ARENA_SIZE);
+  worker->max_records = DEFAULT_WORKER_RECORDS;
+  worker->records = NULL;
+  worker->num_records = 0;
+
+  /* Nothing is drawn in extract-only mode. */
+  if (dsosdcoord->operation == DSOSDCOORD_OPERATION_EXTRACT_ONLY)
+    return TRUE;
+
+  if (dsosdcoord->num_started_workers > 1) {
+    const GstDsOsdCoordBackend *backend = dsosdcoord->backend;
+    gboolean parallel =
+        backend->can_draw_in_parallel (dsosdcoord->dsosdcoord_mode);
+
+    if (index > 0 && parallel) {
+      worker->context = backend->create_context ();
+      if (worker->context == NULL)
+        return FALSE;
+      if (dsosdcoord->show_clock)
+        backend->set_clock_params (worker->context,
+            &dsosdcoord->clock_text_params);
+    } else if (!parallel) {
+      worker->draw_lock = &dsosdcoord->draw_lock;
+    }
   }
 
-  nvll_osd_init_colors_for_hw_blend (dsosdcoord->dsosdcoord_context,
-      dsosdcoord->color_info, dsosdcoord->num_class_entries);
-
-  if (dsosdcoord->show_clock) {
-    nvll_osd_set_clock_params (dsosdcoord->dsosdcoord_context,
-        &dsosdcoord->clock_text_params);
-  }
+  gst_ds_osdcoord_draw_list_init (&worker->rects, sizeof (NvOSD_RectParams));
+  gst_ds_osdcoord_draw_list_init (&worker->mask_rects,
+      sizeof (NvOSD_RectParams));
+  gst_ds_osdcoord_draw_list_init (&worker->masks, sizeof (NvOSD_MaskParams));
+  gst_ds_osdcoord_draw_list_init (&worker->texts, sizeof (NvOSD_TextParams));
+  gst_ds_osdcoord_draw_list_init (&worker->lines, sizeof (NvOSD_LineParams));
+  gst_ds_osdcoord_draw_list_init (&worker->arrows,
+      sizeof (NvOSD_ArrowParams));
+  gst_ds_osdcoord_draw_list_init (&worker->circles,
+      sizeof (NvOSD_CircleParams));
 
   return TRUE;
 }
 
+static void
+gst_ds_osdcoord_worker_deinit (GstDsOsdCoordWorker * worker)
+{
+  if (worker->context &&
+      worker->context != worker->dsosdcoord->dsosdcoord_context)
+    worker->dsosdcoord->backend->destroy_context (worker->context);
+  worker->context = NULL;
+
+  gst_ds_osdcoord_draw_list_clear (&worker->rects);
+  gst_ds_osdcoord_draw_list_clear (&worker->mask_rects);
+  gst_ds_osdcoord_draw_list_clear (&worker->masks);
+  gst_ds_osdcoord_draw_list_clear (&worker->texts);
+  gst_ds_osdcoord_draw_list_clear (&worker->lines);
+  gst_ds_osdcoord_draw_list_clear (&worker->arrows);
+  gst_ds_osdcoord_draw_list_clear (&worker->circles);
+
+  gst_ds_osdcoord_arena_clear (&worker->arena);
+  worker->records = NULL;
+}
+
 /**
- * Free up all the resources
+ * Shrink the draw lists of every worker once per draw-shrink-interval
+ * buffers. Returns TRUE if any memory was released.
  */
 static gboolean
-gst_ds_osdcoord_stop (GstBaseTransform * btrans)
+gst_ds_osdcoord_shrink_draw_lists (GstDsOsdCoord * dsosdcoord)
 {
-  GstDsOsdCoord *dsosdcoord = GST_DSOSDCOORD (btrans);
+  gboolean shrunk = FALSE;
+  guint i;
 
-  cudaError_t CUerr = cudaSuccess;
-  CUerr = cudaSetDevice (dsosdcoord->gpu_id);
-  if (CUerr != cudaSuccess) {
-    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-        ("Unable to set device"), NULL);
+  if (dsosdcoord->draw_shrink_interval == 0)
     return FALSE;
-  }
-  GST_LOG_OBJECT (dsosdcoord, "SETTING CUDA DEVICE = %d in dsosdcoord func=%s\n",
-      dsosdcoord->gpu_id, __func__);
 
-  if (dsosdcoord->dsosdcoord_context)
-    nvll_osd_destroy_context (dsosdcoord->dsosdcoord_context);
+  for (i = 0; i < dsosdcoord->num_started_workers; i++) {
+    GstDsOsdCoordWorker *worker = &dsosdcoord->workers[i];
+
+    if (++worker->idle_buffers < dsosdcoord->draw_shrink_interval)
+      continue;
+    worker->idle_buffers = 0;
+    shrunk |= gst_ds_osdcoord_draw_list_shrink (&worker->rects);
+    shrunk |= gst_ds_osdcoord_draw_list_shrink (&worker->mask_rects);
+    shrunk |= gst_ds_osdcoord_draw_list_shrink (&worker->masks);
+    shrunk |= gst_ds_osdcoord_draw_list_shrink (&worker->texts);
+    shrunk |= gst_ds_osdcoord_draw_list_shrink (&worker->lines);
+    shrunk |= gst_ds_osdcoord_draw_list_shrink (&worker->arrows);
+    shrunk |= gst_ds_osdcoord_draw_list_shrink (&worker->circles);
+  }
+  return shrunk;
+}
 
-  dsosdcoord->dsosdcoord_context = NULL;
-  dsosdcoord->width = 0;
-  dsosdcoord->height = 0;
+/**
+ * Recompute the memory-usage property from the current allocations.
+ */
+static void
+gst_ds_osdcoord_update_memory_usage (GstDsOsdCoord * dsosdcoord)
+{
+  guint64 total = 0;
+  guint i;
+
+  if (dsosdcoord->workers) {
+    for (i = 0; i < dsosdcoord->num_started_workers; i++) {
+      GstDsOsdCoordWorker *worker = &dsosdcoord->workers[i];
+
+      total += sizeof (*worker);
+      total += (guint64) worker->rects.max * worker->rects.elem_size;
+      total += (guint64) worker->mask_rects.max * worker->mask_rects.elem_size;
+      total += (guint64) worker->masks.max * worker->masks.elem_size;
+      total += (guint64) worker->texts.max * worker->texts.elem_size;
+      total += (guint64) worker->lines.max * worker->lines.elem_size;
+      total += (guint64) worker->arrows.max * worker->arrows.elem_size;
+      total += (guint64) worker->circles.max * worker->circles.elem_size;
+      total += worker->arena.capacity;
+      total += sizeof (GstDsOsdCoordStats);
+      worker->resized = FALSE;
+    }
+  }
+  if (dsosdcoord->exporter)
+    total += gst_ds_osdcoord_exporter_get_memory_usage (dsosdcoord->exporter);
+  if (dsosdcoord->active_filter)
+    total += gst_ds_osdcoord_filter_get_size (dsosdcoord->active_filter);
+  if (dsosdcoord->tracker)
+    total += gst_ds_osdcoord_tracker_get_memory_usage (dsosdcoord->tracker);
 
-  return TRUE;
+  GST_OBJECT_LOCK (dsosdcoord);
+  dsosdcoord->memory_usage = total;
+  GST_OBJECT_UNLOCK (dsosdcoord);
 }
 
-int frame_num = 0;
-
 /**
- * Called when element recieves an input buffer from upstream element.
+ * Select the CUDA device and create the dsosdcoord context used for drawing.
  */
-static GstFlowReturn
-gst_ds_osdcoord_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+static gboolean
+gst_ds_osdcoord_start_osd (GstDsOsdCoord * dsosdcoord)
 {
-  GstDsOsdCoord *dsosdcoord = GST_DSOSDCOORD (trans);
-  GstMapInfo inmap = GST_MAP_INFO_INIT;
-  unsigned int rect_cnt = 0;
-  unsigned int segment_cnt = 0;
-  unsigned int text_cnt = 0;
-  unsigned int line_cnt = 0;
-  unsigned int arrow_cnt = 0;
-  unsigned int circle_cnt = 0;
-  unsigned int i = 0;
-  int idx = 0;
-  typedef struct coord {
-    double x;
-    double y;
-  } COORD;
-  gpointer state = NULL;
-  NvBufSurface *surface = NULL;
-  NvDsBatchMeta *batch_meta = NULL;
+  const GstDsOsdCoordBackend *backend;
 
-  if (!gst_buffer_map (buf, &inmap, GST_MAP_READ)) {
+  backend = gst_ds_osdcoord_backend_get (dsosdcoord->backend_type);
+  if (backend == NULL) {
     GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-        ("Unable to map info from buffer"), NULL);
-    return GST_FLOW_ERROR;
+        ("osd-backend is not built in"),
+        ("rebuild with WITH_NVLL=1 or select another osd-backend"));
+    return FALSE;
   }
+  dsosdcoord->backend = backend;
 
-  nvds_set_input_system_timestamp (buf, GST_ELEMENT_NAME (dsosdcoord));
-
-  cudaError_t CUerr = cudaSuccess;
-  CUerr = cudaSetDevice (dsosdcoord->gpu_id);
-  if (CUerr != cudaSuccess) {
+  if (backend->open_device &&
+      !backend->open_device (dsosdcoord->gpu_id,
+          &dsosdcoord->dsosdcoord_mode)) {
     GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
         ("Unable to set device"), NULL);
-    return GST_FLOW_ERROR;
+    return FALSE;
   }
-  GST_LOG_OBJECT (dsosdcoord, "SETTING CUDA DEVICE = %d in dsosdcoord func=%s\n",
-      dsosdcoord->gpu_id, __func__);
 
-  surface = (NvBufSurface *) inmap.data;
+  dsosdcoord->dsosdcoord_context = backend->create_context ();
 
-  /* Get metadata. Update rectangle and text params */
-  GstMeta *gst_meta;
-  NvDsMeta *dsmeta;
-  char context_name[100];
-  snprintf (context_name, sizeof (context_name), "%s_(Frame=%u)",
-      GST_ELEMENT_NAME (dsosdcoord), dsosdcoord->frame_num);
-  nvtxRangePushA (context_name);
-  while ((gst_meta = gst_buffer_iterate_meta (buf, &state))) {
-    if (gst_meta_api_type_has_tag (gst_meta->info->api, _dsmeta_quark)) {
-      dsmeta = (NvDsMeta *) gst_meta;
-      if (dsmeta->meta_type == NVDS_BATCH_GST_META) {
-        batch_meta = (NvDsBatchMeta *) dsmeta->meta_data;
-        break;
+  if (dsosdcoord->dsosdcoord_context == NULL) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to create context dsosdcoord"), NULL);
+    return FALSE;
+  }
+
+  GST_OBJECT_LOCK (dsosdcoord);
+  dsosdcoord->active_colors =
+      gst_ds_osdcoord_color_table_ref (dsosdcoord->colors);
+  GST_OBJECT_UNLOCK (dsosdcoord);
+  backend->init_colors_for_hw_blend (dsosdcoord->dsosdcoord_context,
+      dsosdcoord->active_colors->entries,
+      dsosdcoord->active_colors->num_entries);
+
+  if (dsosdcoord->show_clock) {
+    backend->set_clock_params (dsosdcoord->dsosdcoord_context,
+        &dsosdcoord->clock_text_params);
+  }
+
+  return TRUE;
+}
+
+/**
+ * Free what start() allocated for drawing and traversal. Also called by
+ * start() when it fails part way; everything freed is reset to NULL, so
+ * partly initialised state is handled.
+ */
+static void
+gst_ds_osdcoord_release (GstDsOsdCoord * dsosdcoord)
+{
+  const GstDsOsdCoordBackend *backend = dsosdcoord->backend;
+  guint i;
+
+  if (dsosdcoord->worker_pool) {
+    g_thread_pool_free (dsosdcoord->worker_pool, FALSE, TRUE);
+    dsosdcoord->worker_pool = NULL;
+  }
+
+  if (dsosdcoord->workers) {
+    for (i = 0; i < dsosdcoord->num_started_workers; i++)
+      gst_ds_osdcoord_worker_deinit (&dsosdcoord->workers[i]);
+    g_free (dsosdcoord->workers);
+    dsosdcoord->workers = NULL;
+  }
+
+  /* Keep the statistics of the run readable until the next start. */
+  g_mutex_lock (&dsosdcoord->stats_lock);
+  if (dsosdcoord->worker_stats) {
+    for (i = 0; i < dsosdcoord->num_started_workers; i++)
+      gst_ds_osdcoord_stats_add (dsosdcoord->stats_total,
+          &dsosdcoord->worker_stats[i]);
+    g_free (dsosdcoord->worker_stats);
+    dsosdcoord->worker_stats = NULL;
+  }
+  g_mutex_unlock (&dsosdcoord->stats_lock);
+
+  if (dsosdcoord->dsosdcoord_context)
+    backend->destroy_context (dsosdcoord->dsosdcoord_context);
+
+  dsosdcoord->dsosdcoord_context = NULL;
+  dsosdcoord->backend = NULL;
+
+  gst_ds_osdcoord_color_table_unref (dsosdcoord->active_colors);
+  dsosdcoord->active_colors = NULL;
+  gst_ds_osdcoord_filter_unref (dsosdcoord->active_filter);
+  dsosdcoord->active_filter = NULL;
+
+  if (dsosdcoord->tracker) {
+    gst_ds_osdcoord_tracker_free (dsosdcoord->tracker);
+    dsosdcoord->tracker = NULL;
+  }
+}
+
+/**
+ * Write out the queued records, count the dropped ones and free the
+ * exporter. This drops the reference on a shared engine, which closes the
+ * sink once no other element uses it.
+ */
+static void
+gst_ds_osdcoord_release_exporter (GstDsOsdCoord * dsosdcoord)
+{
+  GstDsOsdCoordExporter *exporter = dsosdcoord->exporter;
+
+  if (!exporter)
+    return;
+
+  /* Returns once all queued records are written. */
+  gst_ds_osdcoord_exporter_stop (exporter);
+  g_mutex_lock (&dsosdcoord->stats_lock);
+  dsosdcoord->export_dropped +=
+      gst_ds_osdcoord_exporter_get_dropped (exporter);
+  dsosdcoord->exporter = NULL;
+  g_mutex_unlock (&dsosdcoord->stats_lock);
+  gst_ds_osdcoord_exporter_free (exporter);
+}
+
+/**
+ * Initialize all resources.
+ */
+static gboolean
+gst_ds_osdcoord_start (GstBaseTransform * btrans)
+{
+  GstDsOsdCoord *dsosdcoord = GST_DSOSDCOORD (btrans);
+  GstDsOsdCoordExportConfig export_config;
+  GError *error = NULL;
+  guint i;
+
+  if (dsosdcoord->operation == DSOSDCOORD_OPERATION_OSD &&
+      !gst_ds_osdcoord_start_osd (dsosdcoord))
+    goto fail;
+
+  export_config.queue_size = dsosdcoord->export_queue_size;
+  export_config.overflow_policy = dsosdcoord->export_overflow_policy;
+  export_config.sink = dsosdcoord->export_sink;
+  export_config.format = dsosdcoord->export_format;
+  export_config.shm_name = dsosdcoord->shm_name;
+  export_config.shm_slots = dsosdcoord->shm_slots;
+  export_config.uds_path = dsosdcoord->uds_path;
+  export_config.uds_flush_us = dsosdcoord->uds_flush_us;
+  export_config.file_location = dsosdcoord->file_location;
+  export_config.file_segment_size = dsosdcoord->file_segment_size;
+  export_config.file_segment_seconds = dsosdcoord->file_segment_seconds;
+  export_config.file_sync_interval = dsosdcoord->file_sync_interval;
+  export_config.integer_coords =
+      dsosdcoord->coord_format == DSOSDCOORD_COORD_FORMAT_INT;
+  export_config.shared = dsosdcoord->export_shared;
+  export_config.fields = dsosdcoord->export_fields;
+  dsosdcoord->exporter = gst_ds_osdcoord_exporter_new (&export_config, &error);
+  if (!dsosdcoord->exporter) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, OPEN_WRITE,
+        ("Unable to open export sink"), ("%s", error->message));
+    g_error_free (error);
+    goto fail;
+  }
+
+  if (dsosdcoord->export_mode == DSOSDCOORD_EXPORT_MODE_CHANGES)
+    dsosdcoord->tracker =
+        gst_ds_osdcoord_tracker_new (&dsosdcoord->track_config);
+
+  g_mutex_lock (&dsosdcoord->stats_lock);
+  /* Only frame traversal spreads a batch across workers; the object pool
+   * is walked by workers[0] alone, so no other worker is set up. */
+  dsosdcoord->num_started_workers =
+      dsosdcoord->meta_traversal == DSOSDCOORD_TRAVERSAL_FRAME ?
+      dsosdcoord->num_workers : 1;
+  /* The rates of the previous run stay readable until now. */
+  if (dsosdcoord->rate_limiter)
+    gst_ds_osdcoord_rate_limiter_free (dsosdcoord->rate_limiter);
+  dsosdcoord->rate_limiter =
+      gst_ds_osdcoord_rate_limiter_new (&dsosdcoord->rate_config);
+  memset (dsosdcoord->stats_total, 0, sizeof (GstDsOsdCoordStats));
+  dsosdcoord->worker_stats =
+      g_new0 (GstDsOsdCoordStats, dsosdcoord->num_started_workers);
+  g_mutex_unlock (&dsosdcoord->stats_lock);
+  memset (dsosdcoord->stats_posted, 0, sizeof (GstDsOsdCoordStats));
+  dsosdcoord->stats_last_post = GST_CLOCK_TIME_NONE;
+
+  dsosdcoord->workers =
+      g_new0 (GstDsOsdCoordWorker, dsosdcoord->num_started_workers);
+  for (i = 0; i < dsosdcoord->num_started_workers; i++) {
+    if (!gst_ds_osdcoord_worker_init (dsosdcoord, &dsosdcoord->workers[i], i)) {
+      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+          ("Unable to create context dsosdcoord for worker %u", i), NULL);
+      goto fail;
+    }
+  }
+
+  if (dsosdcoord->num_started_workers > 1) {
+    /* workers[0] always runs on the streaming thread. */
+    dsosdcoord->worker_pool =
+        g_thread_pool_new (gst_ds_osdcoord_worker_func, dsosdcoord,
+        dsosdcoord->num_started_workers - 1, TRUE, &error);
+    if (!dsosdcoord->worker_pool) {
+      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+          ("Unable to create worker threads"), ("%s", error->message));
+      g_error_free (error);
+      goto fail;
+    }
+  }
+
+  gst_ds_osdcoord_update_memory_usage (dsosdcoord);
+
+  return TRUE;
+
+fail:
+  /* base transform does not call stop() after a failed start(). */
+  gst_ds_osdcoord_release (dsosdcoord);
+  gst_ds_osdcoord_release_exporter (dsosdcoord);
+  g_mutex_lock (&dsosdcoord->stats_lock);
+  if (dsosdcoord->rate_limiter) {
+    gst_ds_osdcoord_rate_limiter_free (dsosdcoord->rate_limiter);
+    dsosdcoord->rate_limiter = NULL;
+  }
+  g_mutex_unlock (&dsosdcoord->stats_lock);
+  return FALSE;
+}
+
+/**
+ * Free up all the resources
+ */
+static gboolean
+gst_ds_osdcoord_stop (GstBaseTransform * btrans)
+{
+  GstDsOsdCoord *dsosdcoord = GST_DSOSDCOORD (btrans);
+  const GstDsOsdCoordBackend *backend = dsosdcoord->backend;
+
+  if (dsosdcoord->operation == DSOSDCOORD_OPERATION_OSD && backend &&
+      backend->set_device && !backend->set_device (dsosdcoord->gpu_id)) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to set device"), NULL);
+    return FALSE;
+  }
+
+  gst_ds_osdcoord_release (dsosdcoord);
+  gst_ds_osdcoord_release_exporter (dsosdcoord);
+
+  dsosdcoord->width = 0;
+  dsosdcoord->height = 0;
+
+  gst_ds_osdcoord_update_memory_usage (dsosdcoord);
+
+  return TRUE;
+}
+
+/* Helpers to hand the accumulated draw lists of a worker to nvll_osd. Each
+ * posts an element error and returns FALSE if drawing fails. */
+static gboolean
+gst_ds_osdcoord_draw_rects (GstDsOsdCoordWorker * worker,
+    NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+  GstClockTime start;
+  int ret;
+
+  worker->frame_rect_params.num_rects = worker->rects.len;
+  worker->frame_rect_params.rect_params_list =
+      (NvOSD_RectParams *) worker->rects.data;
+  worker->frame_rect_params.buf_ptr = dst;
+  worker->frame_rect_params.mode = dsosdcoord->dsosdcoord_mode;
+  start = gst_util_get_timestamp ();
+  if (worker->draw_lock)
+    g_mutex_lock (worker->draw_lock);
+  ret = dsosdcoord->backend->draw_rectangles (worker->context,
+      &worker->frame_rect_params);
+  if (worker->draw_lock)
+    g_mutex_unlock (worker->draw_lock);
+  gst_ds_osdcoord_stats_record (worker->stats,
+      DSOSDCOORD_STAGE_DRAW_RECTS, start);
+  DSOSDCOORD_TRACE_DRAW ("rects", worker->rects.len);
+  if (ret == -1) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to draw rectangles"), NULL);
+    return FALSE;
+  }
+  worker->rects.len = 0;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_draw_segment_masks (GstDsOsdCoordWorker * worker,
+    NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+  GstClockTime start;
+  int ret;
+
+  worker->frame_mask_params.num_segments = worker->masks.len;
+  worker->frame_mask_params.rect_params_list =
+      (NvOSD_RectParams *) worker->mask_rects.data;
+  worker->frame_mask_params.mask_params_list =
+      (NvOSD_MaskParams *) worker->masks.data;
+  worker->frame_mask_params.buf_ptr = dst;
+  worker->frame_mask_params.mode = dsosdcoord->dsosdcoord_mode;
+  start = gst_util_get_timestamp ();
+  if (worker->draw_lock)
+    g_mutex_lock (worker->draw_lock);
+  ret = dsosdcoord->backend->draw_segment_masks (worker->context,
+      &worker->frame_mask_params);
+  if (worker->draw_lock)
+    g_mutex_unlock (worker->draw_lock);
+  gst_ds_osdcoord_stats_record (worker->stats,
+      DSOSDCOORD_STAGE_DRAW_MASKS, start);
+  DSOSDCOORD_TRACE_DRAW ("masks", worker->masks.len);
+  if (ret == -1) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to draw segment masks"), NULL);
+    return FALSE;
+  }
+  worker->mask_rects.len = 0;
+  worker->masks.len = 0;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_draw_text (GstDsOsdCoordWorker * worker,
+    NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+  GstClockTime start;
+  int ret;
+
+  worker->frame_text_params.num_strings = worker->texts.len;
+  worker->frame_text_params.text_params_list =
+      (NvOSD_TextParams *) worker->texts.data;
+  worker->frame_text_params.buf_ptr = dst;
+  worker->frame_text_params.mode = dsosdcoord->dsosdcoord_mode;
+  start = gst_util_get_timestamp ();
+  if (worker->draw_lock)
+    g_mutex_lock (worker->draw_lock);
+  ret = dsosdcoord->backend->put_text (worker->context,
+      &worker->frame_text_params);
+  if (worker->draw_lock)
+    g_mutex_unlock (worker->draw_lock);
+  gst_ds_osdcoord_stats_record (worker->stats,
+      DSOSDCOORD_STAGE_DRAW_TEXT, start);
+  DSOSDCOORD_TRACE_DRAW ("text", worker->texts.len);
+  if (ret == -1) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to draw text"), NULL);
+    return FALSE;
+  }
+  worker->texts.len = 0;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_draw_lines (GstDsOsdCoordWorker * worker,
+    NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+  GstClockTime start;
+  int ret;
+
+  worker->frame_line_params.num_lines = worker->lines.len;
+  worker->frame_line_params.line_params_list =
+      (NvOSD_LineParams *) worker->lines.data;
+  worker->frame_line_params.buf_ptr = dst;
+  worker->frame_line_params.mode = dsosdcoord->dsosdcoord_mode;
+  start = gst_util_get_timestamp ();
+  if (worker->draw_lock)
+    g_mutex_lock (worker->draw_lock);
+  ret = dsosdcoord->backend->draw_lines (worker->context,
+      &worker->frame_line_params);
+  if (worker->draw_lock)
+    g_mutex_unlock (worker->draw_lock);
+  gst_ds_osdcoord_stats_record (worker->stats,
+      DSOSDCOORD_STAGE_DRAW_LINES, start);
+  DSOSDCOORD_TRACE_DRAW ("lines", worker->lines.len);
+  if (ret == -1) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to draw lines"), NULL);
+    return FALSE;
+  }
+  worker->lines.len = 0;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_draw_arrows (GstDsOsdCoordWorker * worker,
+    NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+  GstClockTime start;
+  int ret;
+
+  worker->frame_arrow_params.num_arrows = worker->arrows.len;
+  worker->frame_arrow_params.arrow_params_list =
+      (NvOSD_ArrowParams *) worker->arrows.data;
+  worker->frame_arrow_params.buf_ptr = dst;
+  worker->frame_arrow_params.mode = dsosdcoord->dsosdcoord_mode;
+  start = gst_util_get_timestamp ();
+  if (worker->draw_lock)
+    g_mutex_lock (worker->draw_lock);
+  ret = dsosdcoord->backend->draw_arrows (worker->context,
+      &worker->frame_arrow_params);
+  if (worker->draw_lock)
+    g_mutex_unlock (worker->draw_lock);
+  gst_ds_osdcoord_stats_record (worker->stats,
+      DSOSDCOORD_STAGE_DRAW_ARROWS, start);
+  DSOSDCOORD_TRACE_DRAW ("arrows", worker->arrows.len);
+  if (ret == -1) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to draw arrows"), NULL);
+    return FALSE;
+  }
+  worker->arrows.len = 0;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_draw_circles (GstDsOsdCoordWorker * worker,
+    NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+  GstClockTime start;
+  int ret;
+
+  worker->frame_circle_params.num_circles = worker->circles.len;
+  worker->frame_circle_params.circle_params_list =
+      (NvOSD_CircleParams *) worker->circles.data;
+  worker->frame_circle_params.buf_ptr = dst;
+  worker->frame_circle_params.mode = dsosdcoord->dsosdcoord_mode;
+  start = gst_util_get_timestamp ();
+  if (worker->draw_lock)
+    g_mutex_lock (worker->draw_lock);
+  ret = dsosdcoord->backend->draw_circles (worker->context,
+      &worker->frame_circle_params);
+  if (worker->draw_lock)
+    g_mutex_unlock (worker->draw_lock);
+  gst_ds_osdcoord_stats_record (worker->stats,
+      DSOSDCOORD_STAGE_DRAW_CIRCLES, start);
+  DSOSDCOORD_TRACE_DRAW ("circles", worker->circles.len);
+  if (ret == -1) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to draw circles"), NULL);
+    return FALSE;
+  }
+  worker->circles.len = 0;
+  return TRUE;
+}
+
+/**
+ * Append a record for export to the worker. Records are moved to the export
+ * queue in frame order once all workers are done with the batch. When full
+ * the records move to twice the room in the arena; the old room is only
+ * given back at the end of the batch.
+ */
+static GstDsOsdCoordExportRecord *
+gst_ds_osdcoord_worker_add_record (GstDsOsdCoordWorker * worker)
+{
+  if (worker->num_records == worker->max_records) {
+    GstDsOsdCoordExportRecord *records = (GstDsOsdCoordExportRecord *)
+        gst_ds_osdcoord_arena_alloc (&worker->arena,
+        (gsize) worker->max_records * 2 * sizeof (GstDsOsdCoordExportRecord));
+
+    memcpy (records, worker->records,
+        (gsize) worker->num_records * sizeof (GstDsOsdCoordExportRecord));
+    worker->records = records;
+    worker->max_records *= 2;
+  }
+  return &worker->records[worker->num_records++];
+}
+
+/**
+ * Threshold and run-length encode the mask of an object into the scratch
+ * arena of the worker. An object without mask data is exported without
+ * DSOSDCOORD_EXPORT_FIELD_MASK; one with too many runs keeps the flag
+ * without counts, for gst_ds_osdcoord_exporter_push_mask() to count it as
+ * dropped.
+ */
+static void
+gst_ds_osdcoord_extract_mask (GstDsOsdCoordWorker * worker,
+    GstDsOsdCoordExportRecord * record, const NvOSD_MaskParams * mask)
+{
+  guint n = mask->width * mask->height;
+
+  record->mask_width = mask->width;
+  record->mask_height = mask->height;
+  if (!mask->data || n == 0 || mask->size < n * sizeof (gfloat)) {
+    record->fields &= ~DSOSDCOORD_EXPORT_FIELD_MASK;
+    return;
+  }
+  record->mask_counts =
+      gst_ds_osdcoord_rle_encode (gst_ds_osdcoord_rle_get_impl (),
+      &worker->arena, mask->data, n, mask->threshold,
+      DSOSDCOORD_MAX_MASK_COUNTS, &record->num_mask_counts);
+}
+
+/**
+ * Collect the export-fields selected in record->fields from the object
+ * meta. Classifier labels and user meta beyond the room in the record are
+ * left out.
+ */
+static void
+gst_ds_osdcoord_extract_fields (GstDsOsdCoordWorker * worker,
+    GstDsOsdCoordExportRecord * record, NvDsObjectMeta * object_meta)
+{
+  NvDsMetaList *l, *ll;
+
+  record->confidence = object_meta->confidence;
+  record->tracker_confidence = object_meta->tracker_confidence;
+  record->num_classifier_results = 0;
+  record->num_user_meta = 0;
+  record->num_mask_counts = 0;
+  record->mask_counts = NULL;
+
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_CLASSIFIER) {
+    for (l = object_meta->classifier_meta_list; l; l = l->next) {
+      NvDsClassifierMeta *classifier_meta = (NvDsClassifierMeta *) l->data;
+
+      for (ll = classifier_meta->label_info_list; ll; ll = ll->next) {
+        NvDsLabelInfo *label_info = (NvDsLabelInfo *) ll->data;
+        GstDsOsdCoordClassifierResult *result;
+
+        if (record->num_classifier_results ==
+            DSOSDCOORD_MAX_CLASSIFIER_RESULTS)
+          break;
+        result = &record->classifier_results[record->num_classifier_results++];
+        result->component_id = classifier_meta->unique_component_id;
+        result->class_id = label_info->result_class_id;
+        result->prob = label_info->result_prob;
+        result->label_hash = gst_ds_osdcoord_label_copy (result->label,
+            label_info->result_label[0] ? label_info->result_label :
+            label_info->pResult_label, sizeof (result->label));
       }
     }
   }
 
-  NvDsMetaList *l = NULL;
-  NvDsMetaList *full_obj_meta_list = NULL;
-  if (batch_meta)
-    full_obj_meta_list = batch_meta->obj_meta_pool->full_list;
-  NvDsObjectMeta *object_meta = NULL;
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_USER_META) {
+    for (l = object_meta->obj_user_meta_list;
+        l && record->num_user_meta < DSOSDCOORD_MAX_USER_META; l = l->next) {
+      NvDsUserMeta *user_meta = (NvDsUserMeta *) l->data;
+
+      record->user_meta_types[record->num_user_meta++] =
+          (guint) user_meta->base_meta.meta_type;
+    }
+  }
+
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_MASK)
+    gst_ds_osdcoord_extract_mask (worker, record, &object_meta->mask_params);
+}
+
+/**
+ * Build the export record of an object. frame_meta is NULL when walking the
+ * object pool of the whole batch.
+ */
+static void
+gst_ds_osdcoord_extract_object (GstDsOsdCoordWorker * worker,
+    NvDsObjectMeta * object_meta, NvDsFrameMeta * frame_meta)
+{
+  GstDsOsdCoordExportRecord *record =
+      gst_ds_osdcoord_worker_add_record (worker);
+
+  if (frame_meta) {
+    record->frame_num = (guint) frame_meta->frame_num;
+    record->pts = frame_meta->buf_pts;
+    record->source_id = frame_meta->source_id;
+    record->batch_id = frame_meta->batch_id;
+    record->flags = DSOSDCOORD_RECORD_FLAG_HAS_SOURCE;
+  } else {
+    record->frame_num = worker->dsosdcoord->frame_num;
+    record->pts = worker->pts;
+    record->source_id = 0;
+    record->batch_id = 0;
+    record->flags = 0;
+  }
+  record->object_id = object_meta->object_id;
+  record->event = DSOSDCOORD_TRACK_EVENT_NONE;
+  record->left = object_meta->rect_params.left;
+  record->top = object_meta->rect_params.top;
+  record->width = object_meta->rect_params.width;
+  record->height = object_meta->rect_params.height;
+  record->class_id = object_meta->class_id;
+  record->label_hash = gst_ds_osdcoord_label_copy (record->label,
+      object_meta->text_params.display_text, sizeof (record->label));
+  record->fields = worker->dsosdcoord->export_fields;
+  if (record->fields)
+    gst_ds_osdcoord_extract_fields (worker, record, object_meta);
+}
+
+/**
+ * Build the export record of an object if it passes the export filter,
+ * counting it as filtered otherwise.
+ */
+static void
+gst_ds_osdcoord_export_object (GstDsOsdCoordWorker * worker,
+    NvDsObjectMeta * object_meta, NvDsFrameMeta * frame_meta)
+{
+  if (gst_ds_osdcoord_filter_accept (worker->dsosdcoord->active_filter,
+          object_meta, frame_meta ? frame_meta->source_id : 0))
+    gst_ds_osdcoord_extract_object (worker, object_meta, frame_meta);
+  else
+    worker->stats->filtered++;
+}
 
-  for (l = full_obj_meta_list; l != NULL; l = l->next) {
-    object_meta = (NvDsObjectMeta *) (l->data);
-    if (dsosdcoord->draw_bbox) {
-      dsosdcoord->rect_params[rect_cnt] = object_meta->rect_params;
+/**
+ * Add the box, label and mask of an object to the draw lists of the worker
+ * and build its export record. frame_meta is NULL when walking the object
+ * pool of the whole batch.
+ */
+static void
+gst_ds_osdcoord_process_object (GstDsOsdCoordWorker * worker,
+    NvDsObjectMeta * object_meta, NvDsFrameMeta * frame_meta)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+
+  if (dsosdcoord->draw_bbox) {
+    NvOSD_RectParams *rect = (NvOSD_RectParams *)
+        gst_ds_osdcoord_draw_list_append (worker, &worker->rects);
+
+    *rect = object_meta->rect_params;
 #ifdef PLATFORM_TEGRA
-      /* In case of hardware blending, values set in hw-blend-color-attr
-         should be considered as rect bg color values*/
-      if (dsosdcoord->dsosdcoord_mode == MODE_HW && dsosdcoord->hw_blend) {
-        for (idx = 0; idx < dsosdcoord->num_class_entries; idx++) {
-          if (dsosdcoord->color_info[idx].id == object_meta->class_id) {
-            dsosdcoord->rect_params[rect_cnt].color_id = idx;
-            dsosdcoord->rect_params[rect_cnt].has_bg_color = TRUE;
-            dsosdcoord->rect_params[rect_cnt].bg_color.red =
-              dsosdcoord->color_info[idx].color.red;
-            dsosdcoord->rect_params[rect_cnt].bg_color.blue =
-              dsosdcoord->color_info[idx].color.blue;
-            dsosdcoord->rect_params[rect_cnt].bg_color.green =
-              dsosdcoord->color_info[idx].color.green;
-            dsosdcoord->rect_params[rect_cnt].bg_color.alpha =
-              dsosdcoord->color_info[idx].color.alpha;
-            break;
-          }
-        }
+    /* In case of hardware blending, values set in hw-blend-color-attr
+       should be considered as rect bg color values*/
+    if (dsosdcoord->dsosdcoord_mode == MODE_HW && dsosdcoord->hw_blend) {
+      gint idx = gst_ds_osdcoord_color_table_lookup (dsosdcoord->active_colors,
+          object_meta->class_id);
+      if (idx >= 0) {
+        rect->color_id = idx;
+        rect->has_bg_color = TRUE;
+        rect->bg_color = dsosdcoord->active_colors->entries[idx].color;
       }
+    }
 #endif
-      rect_cnt++;
+  }
+  /* Record the label and coordinates of the drawn bboxs that pass the
+     export filter. They are formatted and written by the exporter thread. */
+  if (worker->export_frame)
+    gst_ds_osdcoord_export_object (worker, object_meta, frame_meta);
+
+  if (dsosdcoord->draw_mask && object_meta->mask_params.data &&
+      object_meta->mask_params.size > 0) {
+    *(NvOSD_RectParams *) gst_ds_osdcoord_draw_list_append (worker,
+        &worker->mask_rects) = object_meta->rect_params;
+    *(NvOSD_MaskParams *) gst_ds_osdcoord_draw_list_append (worker,
+        &worker->masks) = object_meta->mask_params;
+  }
+
+  if (object_meta->text_params.display_text)
+    *(NvOSD_TextParams *) gst_ds_osdcoord_draw_list_append (worker,
+        &worker->texts) = object_meta->text_params;
+}
+
+/**
+ * Add the elements of a display meta to the draw lists of the worker.
+ */
+static void
+gst_ds_osdcoord_process_display_meta (GstDsOsdCoordWorker * worker,
+    NvDsDisplayMeta * display_meta)
+{
+  unsigned int cnt = 0;
+
+  for (cnt = 0; cnt < display_meta->num_rects; cnt++)
+    *(NvOSD_RectParams *) gst_ds_osdcoord_draw_list_append (worker,
+        &worker->rects) = display_meta->rect_params[cnt];
+
+  for (cnt = 0; cnt < display_meta->num_labels; cnt++) {
+    if (display_meta->text_params[cnt].display_text)
+      *(NvOSD_TextParams *) gst_ds_osdcoord_draw_list_append (worker,
+          &worker->texts) = display_meta->text_params[cnt];
+  }
+
+  for (cnt = 0; cnt < display_meta->num_lines; cnt++)
+    *(NvOSD_LineParams *) gst_ds_osdcoord_draw_list_append (worker,
+        &worker->lines) = display_meta->line_params[cnt];
+
+  for (cnt = 0; cnt < display_meta->num_arrows; cnt++)
+    *(NvOSD_ArrowParams *) gst_ds_osdcoord_draw_list_append (worker,
+        &worker->arrows) = display_meta->arrow_params[cnt];
+
+  for (cnt = 0; cnt < display_meta->num_circles; cnt++)
+    *(NvOSD_CircleParams *) gst_ds_osdcoord_draw_list_append (worker,
+        &worker->circles) = display_meta->circle_params[cnt];
+}
+
+/**
+ * Draw the draw lists of the worker onto dst, one call per element type.
+ */
+static gboolean
+gst_ds_osdcoord_flush (GstDsOsdCoordWorker * worker, NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+
+  if (worker->rects.len != 0 && dsosdcoord->draw_bbox &&
+      !gst_ds_osdcoord_draw_rects (worker, dst))
+    return FALSE;
+
+  if (worker->masks.len != 0 && dsosdcoord->draw_mask &&
+      !gst_ds_osdcoord_draw_segment_masks (worker, dst))
+    return FALSE;
+
+  if ((dsosdcoord->show_clock || worker->texts.len) &&
+      dsosdcoord->draw_text && !gst_ds_osdcoord_draw_text (worker, dst))
+    return FALSE;
+
+  if (worker->lines.len != 0 && !gst_ds_osdcoord_draw_lines (worker, dst))
+    return FALSE;
+
+  if (worker->arrows.len != 0 && !gst_ds_osdcoord_draw_arrows (worker, dst))
+    return FALSE;
+
+  if (worker->circles.len != 0 && !gst_ds_osdcoord_draw_circles (worker, dst))
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+gst_ds_osdcoord_worker_reset (GstDsOsdCoordWorker * worker)
+{
+  worker->rects.len = 0;
+  worker->mask_rects.len = 0;
+  worker->masks.len = 0;
+  worker->texts.len = 0;
+  worker->lines.len = 0;
+  worker->arrows.len = 0;
+  worker->circles.len = 0;
+  worker->num_records = 0;
+  worker->num_frames = 0;
+  worker->records = (GstDsOsdCoordExportRecord *)
+      gst_ds_osdcoord_arena_alloc (&worker->arena,
+      (gsize) worker->max_records * sizeof (GstDsOsdCoordExportRecord));
+}
+
+/**
+ * Map the boxes of the records from first on, all of one frame, from muxer
+ * pixels to coord-space. frame_meta is NULL when walking the object pool,
+ * in which case source space keeps muxer pixels.
+ */
+static void
+gst_ds_osdcoord_map_records (GstDsOsdCoordWorker * worker, guint first,
+    NvDsFrameMeta * frame_meta)
+{
+  GstDsOsdCoord *dsosdcoord = worker->dsosdcoord;
+  GstDsOsdCoordTransform transform;
+
+  if (worker->num_records == first)
+    return;
+  if (!gst_ds_osdcoord_transform_init (&transform, dsosdcoord->coord_space,
+          dsosdcoord->width, dsosdcoord->height,
+          frame_meta ? frame_meta->source_frame_width : 0,
+          frame_meta ? frame_meta->source_frame_height : 0,
+          dsosdcoord->coord_clamp,
+          dsosdcoord->coord_format == DSOSDCOORD_COORD_FORMAT_INT))
+    return;
+  gst_ds_osdcoord_transform_records (&worker->arena,
+      worker->records + first, worker->num_records - first, &transform);
+}
+
+/**
+ * Walk the object and display meta pools of the whole batch and draw
+ * everything onto the first surface of the batch.
+ */
+static gboolean
+gst_ds_osdcoord_process_batch_pool (GstDsOsdCoordWorker * worker,
+    NvDsBatchMeta * batch_meta, NvBufSurface * surface)
+{
+  NvBufSurfaceParams *dst;
+  NvDsMetaList *l = NULL;
+  GstClockTime start;
+
+  if (batch_meta)
+    worker->stats->frames += batch_meta->num_frames_in_batch;
+
+  if (worker->dsosdcoord->operation == DSOSDCOORD_OPERATION_EXTRACT_ONLY) {
+    if (batch_meta && worker->export_frame) {
+      start = gst_util_get_timestamp ();
+      for (l = batch_meta->obj_meta_pool->full_list; l != NULL; l = l->next) {
+        gst_ds_osdcoord_export_object (worker,
+            (NvDsObjectMeta *) (l->data), NULL);
+        worker->stats->objects++;
+      }
+      gst_ds_osdcoord_map_records (worker, 0, NULL);
+      gst_ds_osdcoord_stats_record (worker->stats, DSOSDCOORD_STAGE_OBJECTS,
+          start);
     }
-    /* Display the label and coordinates of the drawn bboxs*/
-    if (dsosdcoord->display_coord) {
-      COORD top_left, bottom_right;
-      top_left.x = object_meta->rect_params.left;
-      top_left.y = object_meta->rect_params.top;
-      bottom_right.x = object_meta->rect_params.left + object_meta->rect_params.width;
-      bottom_right.y = object_meta->rect_params.top + object_meta->rect_params.height;
-      g_print("%u: %s, ", dsosdcoord->frame_num, object_meta->text_params.display_text);
-      g_print ("Top Left: (%f, %f), Bottom Right: (%f, %f)\n", top_left.x, top_left.y, bottom_right.x, bottom_right.y);
+    return TRUE;
+  }
+
+  dst = &surface->surfaceList[0];
+  if (batch_meta) {
+    start = gst_util_get_timestamp ();
+    for (l = batch_meta->obj_meta_pool->full_list; l != NULL; l = l->next) {
+      gst_ds_osdcoord_process_object (worker, (NvDsObjectMeta *) (l->data),
+          NULL);
+      worker->stats->objects++;
     }
+    gst_ds_osdcoord_map_records (worker, 0, NULL);
+    gst_ds_osdcoord_stats_record (worker->stats, DSOSDCOORD_STAGE_OBJECTS,
+        start);
+
+    start = gst_util_get_timestamp ();
+    for (l = batch_meta->display_meta_pool->full_list; l != NULL; l = l->next)
+      gst_ds_osdcoord_process_display_meta (worker,
+          (NvDsDisplayMeta *) (l->data));
+    gst_ds_osdcoord_stats_record (worker->stats,
+        DSOSDCOORD_STAGE_DISPLAY_META, start);
+  }
+
+  return gst_ds_osdcoord_flush (worker, dst);
+}
 
-    if (rect_cnt == MAX_OSD_ELEMS) {
-      dsosdcoord->frame_rect_params->num_rects = rect_cnt;
-      dsosdcoord->frame_rect_params->rect_params_list = dsosdcoord->rect_params;
-      dsosdcoord->frame_rect_params->buf_ptr = &surface->surfaceList[0];
-      dsosdcoord->frame_rect_params->mode = dsosdcoord->dsosdcoord_mode;
-      if (nvll_osd_draw_rectangles (dsosdcoord->dsosdcoord_context,
-              dsosdcoord->frame_rect_params) == -1) {
-        GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-            ("Unable to draw rectangles"), NULL);
-        return GST_FLOW_ERROR;
+/**
+ * Walk the object and display meta of the frames assigned to the worker and
+ * draw them onto the surface each frame belongs to.
+ */
+static gboolean
+gst_ds_osdcoord_worker_process_frames (GstDsOsdCoordWorker * worker)
+{
+  NvBufSurface *surface = worker->surface;
+  NvDsMetaList *l = NULL;
+  GstClockTime start;
+  guint i;
+
+  worker->stats->frames += worker->num_frames;
+
+  for (i = 0; i < worker->num_frames; i++) {
+    NvDsFrameMeta *frame_meta = worker->frames[i];
+    NvBufSurfaceParams *dst;
+    guint first = worker->num_records;
+
+    worker->export_frame = worker->exports[i];
+    if (worker->dsosdcoord->operation == DSOSDCOORD_OPERATION_EXTRACT_ONLY) {
+      if (!worker->export_frame)
+        continue;
+      start = gst_util_get_timestamp ();
+      for (l = frame_meta->obj_meta_list; l != NULL; l = l->next) {
+        gst_ds_osdcoord_export_object (worker,
+            (NvDsObjectMeta *) (l->data), frame_meta);
+        worker->stats->objects++;
       }
-      rect_cnt = 0;
+      gst_ds_osdcoord_map_records (worker, first, frame_meta);
+      gst_ds_osdcoord_stats_record (worker->stats, DSOSDCOORD_STAGE_OBJECTS,
+          start);
+      continue;
     }
-    if (dsosdcoord->draw_mask && object_meta->mask_params.data &&
-                              object_meta->mask_params.size > 0) {
-      dsosdcoord->mask_rect_params[segment_cnt] = object_meta->rect_params;
-      dsosdcoord->mask_params[segment_cnt++] = object_meta->mask_params;
-      if (segment_cnt == MAX_OSD_ELEMS) {
-        dsosdcoord->frame_mask_params->num_segments = segment_cnt;
-        dsosdcoord->frame_mask_params->rect_params_list = dsosdcoord->mask_rect_params;
-        dsosdcoord->frame_mask_params->mask_params_list = dsosdcoord->mask_params;
-        dsosdcoord->frame_mask_params->buf_ptr = &surface->surfaceList[0];
-        dsosdcoord->frame_mask_params->mode = dsosdcoord->dsosdcoord_mode;
-        if (nvll_osd_draw_segment_masks (dsosdcoord->dsosdcoord_context,
-                dsosdcoord->frame_mask_params) == -1) {
-          GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-              ("Unable to draw rectangles"), NULL);
-          return GST_FLOW_ERROR;
-        }
-        segment_cnt = 0;
-      }
+
+    if (frame_meta->batch_id >= surface->batchSize) {
+      GST_WARNING_OBJECT (worker->dsosdcoord,
+          "batch_id %u of source %u exceeds batch size %u, skipping frame",
+          frame_meta->batch_id, frame_meta->source_id, surface->batchSize);
+      continue;
+    }
+    dst = &surface->surfaceList[frame_meta->batch_id];
+
+    start = gst_util_get_timestamp ();
+    for (l = frame_meta->obj_meta_list; l != NULL; l = l->next) {
+      gst_ds_osdcoord_process_object (worker, (NvDsObjectMeta *) (l->data),
+          frame_meta);
+      worker->stats->objects++;
     }
-    if (object_meta->text_params.display_text)
-      dsosdcoord->text_params[text_cnt++] = object_meta->text_params;
-    if (text_cnt == MAX_OSD_ELEMS) {
-      dsosdcoord->frame_text_params->num_strings = text_cnt;
-      dsosdcoord->frame_text_params->text_params_list = dsosdcoord->text_params;
-      dsosdcoord->frame_text_params->buf_ptr = &surface->surfaceList[0];
-      dsosdcoord->frame_text_params->mode = dsosdcoord->dsosdcoord_mode;
-      if (nvll_osd_put_text (dsosdcoord->dsosdcoord_context,
-              dsosdcoord->frame_text_params) == -1) {
-        GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-            ("Unable to draw text"), NULL);
-        return GST_FLOW_ERROR;
+    gst_ds_osdcoord_map_records (worker, first, frame_meta);
+    gst_ds_osdcoord_stats_record (worker->stats, DSOSDCOORD_STAGE_OBJECTS,
+        start);
+
+    start = gst_util_get_timestamp ();
+    for (l = frame_meta->display_meta_list; l != NULL; l = l->next)
+      gst_ds_osdcoord_process_display_meta (worker,
+          (NvDsDisplayMeta *) (l->data));
+    gst_ds_osdcoord_stats_record (worker->stats,
+        DSOSDCOORD_STAGE_DISPLAY_META, start);
+
+    if (!gst_ds_osdcoord_flush (worker, dst))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * Thread pool function running workers[1..num_started_workers-1].
+ */
+static void
+gst_ds_osdcoord_worker_func (gpointer data, gpointer user_data)
+{
+  GstDsOsdCoordWorker *worker = (GstDsOsdCoordWorker *) data;
+  GstDsOsdCoord *dsosdcoord = (GstDsOsdCoord *) user_data;
+
+  /* The CUDA device is per thread. */
+  if (dsosdcoord->operation == DSOSDCOORD_OPERATION_OSD &&
+      dsosdcoord->backend->set_device &&
+      !dsosdcoord->backend->set_device (dsosdcoord->gpu_id)) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to set device"), NULL);
+    worker->ok = FALSE;
+  } else {
+    worker->ok = gst_ds_osdcoord_worker_process_frames (worker);
+  }
+
+  g_mutex_lock (&dsosdcoord->workers_lock);
+  if (--dsosdcoord->workers_pending == 0)
+    g_cond_signal (&dsosdcoord->workers_cond);
+  g_mutex_unlock (&dsosdcoord->workers_lock);
+}
+
+/**
+ * Split the frames of the batch into contiguous ranges, one per worker, and
+ * process them in parallel. workers[0] runs on the calling thread.
+ */
+static gboolean
+gst_ds_osdcoord_process_frames (GstDsOsdCoord * dsosdcoord,
+    NvDsBatchMeta * batch_meta, NvBufSurface * surface)
+{
+  NvDsMetaList *l_frame = NULL;
+  NvDsFrameMeta **frames;
+  gboolean *exports;
+  guint num_frames, num_active, start, i;
+  gboolean ok = TRUE;
+
+  g_ptr_array_set_size (dsosdcoord->batch_frames, 0);
+  if (!batch_meta)
+    return TRUE;
+
+  for (l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next)
+    g_ptr_array_add (dsosdcoord->batch_frames, l_frame->data);
+
+  frames = (NvDsFrameMeta **) dsosdcoord->batch_frames->pdata;
+  num_frames = dsosdcoord->batch_frames->len;
+
+  /* Decide which frames are exported before any object is walked. */
+  g_array_set_size (dsosdcoord->batch_exports, num_frames);
+  exports = (gboolean *) dsosdcoord->batch_exports->data;
+  g_mutex_lock (&dsosdcoord->stats_lock);
+  for (i = 0; i < num_frames; i++)
+    exports[i] = dsosdcoord->display_coord &&
+        gst_ds_osdcoord_rate_limiter_check (dsosdcoord->rate_limiter,
+        frames[i]->source_id, frames[i]->buf_pts);
+  g_mutex_unlock (&dsosdcoord->stats_lock);
+
+  num_active = MIN (dsosdcoord->num_started_workers, num_frames);
+
+  for (i = 0, start = 0; i < num_active; i++) {
+    GstDsOsdCoordWorker *worker = &dsosdcoord->workers[i];
+
+    worker->frames = frames + start;
+    worker->exports = exports + start;
+    worker->num_frames = num_frames / num_active +
+        (i < num_frames % num_active ? 1 : 0);
+    worker->surface = surface;
+    worker->ok = TRUE;
+    start += worker->num_frames;
+  }
+
+  if (num_active > 1) {
+    dsosdcoord->workers_pending = num_active - 1;
+    for (i = 1; i < num_active; i++)
+      g_thread_pool_push (dsosdcoord->worker_pool, &dsosdcoord->workers[i],
+          NULL);
+  }
+
+  if (num_active > 0)
+    dsosdcoord->workers[0].ok =
+        gst_ds_osdcoord_worker_process_frames (&dsosdcoord->workers[0]);
+
+  if (num_active > 1) {
+    g_mutex_lock (&dsosdcoord->workers_lock);
+    while (dsosdcoord->workers_pending > 0)
+      g_cond_wait (&dsosdcoord->workers_cond, &dsosdcoord->workers_lock);
+    g_mutex_unlock (&dsosdcoord->workers_lock);
+  }
+
+  for (i = 0; i < num_active; i++)
+    ok &= dsosdcoord->workers[i].ok;
+
+  return ok;
+}
+
+/**
+ * Copy a record into the export queue.
+ */
+static void
+gst_ds_osdcoord_export_record (GstDsOsdCoordExportRecord * src,
+    gpointer user_data)
+{
+  GstDsOsdCoord *dsosdcoord = user_data;
+  GstDsOsdCoordExportRecord *record =
+      gst_ds_osdcoord_exporter_reserve (dsosdcoord->exporter);
+
+  if (record) {
+    memcpy (record, src, gst_ds_osdcoord_export_record_size (src));
+    if (record->fields & DSOSDCOORD_EXPORT_FIELD_MASK)
+      gst_ds_osdcoord_exporter_push_mask (dsosdcoord->exporter, record);
+    gst_ds_osdcoord_exporter_commit (dsosdcoord->exporter);
+    DSOSDCOORD_TRACE_EXPORT_OBJECT (record->frame_num, record->source_id,
+        record->label);
+  }
+}
+
+/**
+ * Copy the records built by the workers into the export queue, in frame
+ * order, and wake the exporter thread. With export-mode=changes only the
+ * records of changed tracks are copied, followed by those of the tracks
+ * that disappeared in the frames of the batch. The workers have mapped the
+ * boxes to coord-space already, so the tracker compares them, and the
+ * move threshold applies, in that space. Returns TRUE if tracks were added
+ * or removed.
+ */
+static gboolean
+gst_ds_osdcoord_export_records (GstDsOsdCoord * dsosdcoord)
+{
+  GstDsOsdCoordTracker *tracker = dsosdcoord->tracker;
+  guint64 tracks_size = 0;
+  guint i, j;
+
+  if (tracker)
+    tracks_size = gst_ds_osdcoord_tracker_get_memory_usage (tracker);
+
+  for (i = 0; i < dsosdcoord->num_started_workers; i++) {
+    GstDsOsdCoordWorker *worker = &dsosdcoord->workers[i];
+
+    for (j = 0; j < worker->num_records; j++) {
+      if (tracker &&
+          !gst_ds_osdcoord_tracker_update (tracker, &worker->records[j])) {
+        dsosdcoord->workers[0].stats->suppressed++;
+        continue;
       }
-      text_cnt = 0;
+      gst_ds_osdcoord_export_record (&worker->records[j], dsosdcoord);
     }
   }
 
-  NvDsMetaList *display_meta_list = NULL;
-  if (batch_meta)
-    display_meta_list = batch_meta->display_meta_pool->full_list;
-  NvDsDisplayMeta *display_meta = NULL;
-
-  /* Get objects to be drawn from display meta.
-   * Draw objects if count equals MAX_OSD_ELEMS.
-   */
-  for (l = display_meta_list; l != NULL; l = l->next) {
-    display_meta = (NvDsDisplayMeta *) (l->data);
-
-    unsigned int cnt = 0;
-    for (cnt = 0; cnt < display_meta->num_rects; cnt++) {
-      dsosdcoord->rect_params[rect_cnt++] = display_meta->rect_params[cnt];
-      if (rect_cnt == MAX_OSD_ELEMS) {
-        dsosdcoord->frame_rect_params->num_rects = rect_cnt;
-        dsosdcoord->frame_rect_params->rect_params_list = dsosdcoord->rect_params;
-        dsosdcoord->frame_rect_params->buf_ptr = &surface->surfaceList[0];
-        dsosdcoord->frame_rect_params->mode = dsosdcoord->dsosdcoord_mode;
-        if (nvll_osd_draw_rectangles (dsosdcoord->dsosdcoord_context,
-                dsosdcoord->frame_rect_params) == -1) {
-          GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-              ("Unable to draw rectangles"), NULL);
-          return GST_FLOW_ERROR;
-        }
-        rect_cnt = 0;
+  /* Only exported frames count as seeing the tracks of their source. */
+  if (tracker) {
+    if (dsosdcoord->meta_traversal == DSOSDCOORD_TRAVERSAL_FRAME) {
+      for (i = 0; i < dsosdcoord->batch_frames->len; i++) {
+        NvDsFrameMeta *frame_meta =
+            g_ptr_array_index (dsosdcoord->batch_frames, i);
+
+        if (!g_array_index (dsosdcoord->batch_exports, gboolean, i))
+          continue;
+        gst_ds_osdcoord_tracker_expire (tracker, frame_meta->source_id,
+            (guint) frame_meta->frame_num, frame_meta->buf_pts,
+            gst_ds_osdcoord_export_record, dsosdcoord);
       }
+    } else if (dsosdcoord->workers[0].export_frame) {
+      gst_ds_osdcoord_tracker_expire (tracker, 0, dsosdcoord->frame_num,
+          dsosdcoord->workers[0].pts, gst_ds_osdcoord_export_record,
+          dsosdcoord);
+    }
+  }
+
+  gst_ds_osdcoord_exporter_kick (dsosdcoord->exporter);
+
+  return tracker &&
+      gst_ds_osdcoord_tracker_get_memory_usage (tracker) != tracks_size;
+}
+
+/**
+ * Return the batch metadata attached to the buffer, or NULL.
+ */
+static NvDsBatchMeta *
+gst_ds_osdcoord_find_batch_meta (GstBuffer * buf)
+{
+  gpointer state = NULL;
+  GstMeta *gst_meta;
+  NvDsMeta *dsmeta;
+
+  while ((gst_meta = gst_buffer_iterate_meta (buf, &state))) {
+    if (gst_meta_api_type_has_tag (gst_meta->info->api, _dsmeta_quark)) {
+      dsmeta = (NvDsMeta *) gst_meta;
+      if (dsmeta->meta_type == NVDS_BATCH_GST_META)
+        return (NvDsBatchMeta *) dsmeta->meta_data;
     }
+  }
+  return NULL;
+}
+
+/**
+ * Switch to the last filter compiled from the filter properties, if it
+ * changed since the previous buffer. Returns TRUE if it did.
+ */
+static gboolean
+gst_ds_osdcoord_update_filter (GstDsOsdCoord * dsosdcoord)
+{
+  GstDsOsdCoordFilter *old = dsosdcoord->active_filter;
+
+  GST_OBJECT_LOCK (dsosdcoord);
+  if (dsosdcoord->filter == old) {
+    GST_OBJECT_UNLOCK (dsosdcoord);
+    return FALSE;
+  }
+  dsosdcoord->active_filter = gst_ds_osdcoord_filter_ref (dsosdcoord->filter);
+  GST_OBJECT_UNLOCK (dsosdcoord);
+
+  gst_ds_osdcoord_filter_unref (old);
+  return TRUE;
+}
+
+/**
+ * Walk the batch metadata with the configured traversal. surface is NULL in
+ * extract-only mode. pts is the PTS of the buffer, used for the export
+ * rate of the batch pool, which counts as source 0.
+ */
+static gboolean
+gst_ds_osdcoord_process_batch (GstDsOsdCoord * dsosdcoord,
+    NvDsBatchMeta * batch_meta, NvBufSurface * surface, GstClockTime pts)
+{
+  gboolean ok, resized;
+  guint i;
+
+  resized = gst_ds_osdcoord_update_filter (dsosdcoord);
+  for (i = 0; i < dsosdcoord->num_started_workers; i++)
+    gst_ds_osdcoord_worker_reset (&dsosdcoord->workers[i]);
+
+  if (dsosdcoord->meta_traversal == DSOSDCOORD_TRAVERSAL_FRAME) {
+    ok = gst_ds_osdcoord_process_frames (dsosdcoord, batch_meta, surface);
+  } else {
+    GstDsOsdCoordWorker *worker = &dsosdcoord->workers[0];
+
+    worker->pts = pts;
+    if (batch_meta && dsosdcoord->display_coord) {
+      g_mutex_lock (&dsosdcoord->stats_lock);
+      worker->export_frame =
+          gst_ds_osdcoord_rate_limiter_check (dsosdcoord->rate_limiter, 0,
+          pts);
+      g_mutex_unlock (&dsosdcoord->stats_lock);
+    } else {
+      worker->export_frame = FALSE;
+    }
+    ok = gst_ds_osdcoord_process_batch_pool (worker, batch_meta, surface);
+  }
+
+  if (dsosdcoord->display_coord) {
+    GstClockTime start = gst_util_get_timestamp ();
+
+    resized |= gst_ds_osdcoord_export_records (dsosdcoord);
+    gst_ds_osdcoord_stats_record (dsosdcoord->workers[0].stats,
+        DSOSDCOORD_STAGE_EXPORT, start);
+  }
+
+  /* The records are in the export queue now, all scratch data goes. */
+  for (i = 0; i < dsosdcoord->num_started_workers; i++) {
+    guint allocations =
+        gst_ds_osdcoord_arena_reset (&dsosdcoord->workers[i].arena);
+
+    dsosdcoord->workers[0].stats->scratch_allocations += allocations;
+    resized |= allocations > 0;
+  }
+
+  resized |= gst_ds_osdcoord_shrink_draw_lists (dsosdcoord);
+  for (i = 0; i < dsosdcoord->num_started_workers; i++)
+    resized |= dsosdcoord->workers[i].resized;
+  if (resized)
+    gst_ds_osdcoord_update_memory_usage (dsosdcoord);
+
+  return ok;
+}
+
+/**
+ * Sum the statistics of the current workers and of the workers of the
+ * previous run into stats. Pool workers may be recording meanwhile, so the
+ * counts of a running batch can be partially included.
+ */
+static void
+gst_ds_osdcoord_stats_snapshot (GstDsOsdCoord * dsosdcoord,
+    GstDsOsdCoordStats * stats)
+{
+  guint i;
+
+  g_mutex_lock (&dsosdcoord->stats_lock);
+  *stats = *dsosdcoord->stats_total;
+  if (dsosdcoord->worker_stats) {
+    for (i = 0; i < dsosdcoord->num_started_workers; i++)
+      gst_ds_osdcoord_stats_add (stats, &dsosdcoord->worker_stats[i]);
+  }
+  g_mutex_unlock (&dsosdcoord->stats_lock);
+}
+
+/**
+ * Add the effective export rate of each source and the exporter counters of
+ * the current run to s.
+ */
+static void
+gst_ds_osdcoord_add_export_stats (GstDsOsdCoord * dsosdcoord,
+    GstStructure * s)
+{
+  g_mutex_lock (&dsosdcoord->stats_lock);
+  if (dsosdcoord->rate_limiter)
+    gst_ds_osdcoord_rate_limiter_add_to_structure (dsosdcoord->rate_limiter,
+        s);
+  if (dsosdcoord->exporter)
+    gst_ds_osdcoord_exporter_add_to_structure (dsosdcoord->exporter, s);
+  g_mutex_unlock (&dsosdcoord->stats_lock);
+}
+
+/**
+ * Post a dsosdcoord-stats element message with the statistics of the
+ * buffers since the previous one, once per stats-interval.
+ */
+static void
+gst_ds_osdcoord_post_stats (GstDsOsdCoord * dsosdcoord, GstClockTime now)
+{
+  GstDsOsdCoordStats *window = dsosdcoord->stats_window;
+  guint interval = dsosdcoord->stats_interval;
+  GstStructure *s;
+
+  if (interval == 0)
+    return;
+  if (!GST_CLOCK_TIME_IS_VALID (dsosdcoord->stats_last_post)) {
+    dsosdcoord->stats_last_post = now;
+    return;
+  }
+  if (now - dsosdcoord->stats_last_post < interval * GST_MSECOND)
+    return;
+
+  /* window = now - posted, then posted = now. */
+  gst_ds_osdcoord_stats_snapshot (dsosdcoord, window);
+  gst_ds_osdcoord_stats_subtract (window, dsosdcoord->stats_posted);
+  gst_ds_osdcoord_stats_add (dsosdcoord->stats_posted, window);
+
+  s = gst_ds_osdcoord_stats_to_structure (window, "dsosdcoord-stats");
+  gst_ds_osdcoord_add_export_stats (dsosdcoord, s);
+  gst_structure_set (s, "interval", G_TYPE_UINT64,
+      now - dsosdcoord->stats_last_post, NULL);
+  dsosdcoord->stats_last_post = now;
+
+  gst_element_post_message (GST_ELEMENT (dsosdcoord),
+      gst_message_new_element (GST_OBJECT (dsosdcoord), s));
+}
+
+/**
+ * Account a finished buffer that started at start and advance frame_num.
+ */
+static void
+gst_ds_osdcoord_buffer_done (GstDsOsdCoord * dsosdcoord, GstClockTime start)
+{
+  GstDsOsdCoordStats *stats = dsosdcoord->workers[0].stats;
+
+  stats->buffers++;
+  gst_ds_osdcoord_stats_record (stats, DSOSDCOORD_STAGE_BUFFER, start);
+  DSOSDCOORD_TRACE_BUFFER_EXIT (dsosdcoord->frame_num,
+      gst_util_get_timestamp () - start);
+  dsosdcoord->frame_num++;
+  gst_ds_osdcoord_post_stats (dsosdcoord, gst_util_get_timestamp ());
+}
+
+/**
+ * Return the batch metadata attached to the buffer, timing the lookup.
+ */
+static NvDsBatchMeta *
+gst_ds_osdcoord_lookup_batch_meta (GstDsOsdCoord * dsosdcoord,
+    GstBuffer * buf)
+{
+  GstClockTime start = gst_util_get_timestamp ();
+  NvDsBatchMeta *batch_meta = gst_ds_osdcoord_find_batch_meta (buf);
+
+  gst_ds_osdcoord_stats_record (dsosdcoord->workers[0].stats,
+      DSOSDCOORD_STAGE_META_LOOKUP, start);
+  return batch_meta;
+}
+
+/**
+ * transform_ip of mode=extract-only: export the coordinates found in the
+ * batch metadata without touching the buffer memory or CUDA.
+ */
+static GstFlowReturn
+gst_ds_osdcoord_extract_ip (GstDsOsdCoord * dsosdcoord, GstBuffer * buf)
+{
+  GstClockTime start = gst_util_get_timestamp ();
+  gboolean ok = TRUE;
+
+  nvds_set_input_system_timestamp (buf, GST_ELEMENT_NAME (dsosdcoord));
+
+  if (dsosdcoord->display_coord)
+    ok = gst_ds_osdcoord_process_batch (dsosdcoord,
+        gst_ds_osdcoord_lookup_batch_meta (dsosdcoord, buf), NULL,
+        GST_BUFFER_PTS (buf));
+
+  gst_ds_osdcoord_buffer_done (dsosdcoord, start);
+
+  if (!ok)
+    return GST_FLOW_ERROR;
+  nvds_set_output_system_timestamp (buf, GST_ELEMENT_NAME (dsosdcoord));
+  return GST_FLOW_OK;
+}
+
+/**
+ * Switch to the table of the last hw-blend-color-attr set, if it changed
+ * since the previous buffer, and hand its colors to the dsosdcoord context.
+ */
+static void
+gst_ds_osdcoord_update_colors (GstDsOsdCoord * dsosdcoord)
+{
+  GstDsOsdCoordColorTable *old = dsosdcoord->active_colors;
+
+  GST_OBJECT_LOCK (dsosdcoord);
+  if (dsosdcoord->colors == old) {
+    GST_OBJECT_UNLOCK (dsosdcoord);
+    return;
+  }
+  dsosdcoord->active_colors =
+      gst_ds_osdcoord_color_table_ref (dsosdcoord->colors);
+  GST_OBJECT_UNLOCK (dsosdcoord);
+
+  gst_ds_osdcoord_color_table_unref (old);
+  dsosdcoord->backend->init_colors_for_hw_blend (dsosdcoord->dsosdcoord_context,
+      dsosdcoord->active_colors->entries,
+      dsosdcoord->active_colors->num_entries);
+}
 
-    for (cnt = 0; cnt < display_meta->num_labels; cnt++) {
-      if (display_meta->text_params[cnt].display_text) {
-        dsosdcoord->text_params[text_cnt++] = display_meta->text_params[cnt];
-        if (text_cnt == MAX_OSD_ELEMS) {
-          dsosdcoord->frame_text_params->num_strings = text_cnt;
-          dsosdcoord->frame_text_params->text_params_list = dsosdcoord->text_params;
-          dsosdcoord->frame_text_params->buf_ptr = &surface->surfaceList[0];
-          dsosdcoord->frame_text_params->mode = dsosdcoord->dsosdcoord_mode;
-          if (nvll_osd_put_text (dsosdcoord->dsosdcoord_context,
-                  dsosdcoord->frame_text_params) == -1) {
-            GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-                ("Unable to draw text"), NULL);
-            return GST_FLOW_ERROR;
-          }
-          text_cnt = 0;
-        }
-      }
-    }
+/**
+ * Called when element recieves an input buffer from upstream element.
+ */
+static GstFlowReturn
+gst_ds_osdcoord_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+{
+  GstDsOsdCoord *dsosdcoord = GST_DSOSDCOORD (trans);
+  const GstDsOsdCoordBackend *backend = dsosdcoord->backend;
+  GstMapInfo inmap = GST_MAP_INFO_INIT;
+  NvBufSurface *surface = NULL;
+  NvDsBatchMeta *batch_meta = NULL;
+  GstClockTime start;
+  gboolean ok;
 
-    for (cnt = 0; cnt < display_meta->num_lines; cnt++) {
-      dsosdcoord->line_params[line_cnt++] = display_meta->line_params[cnt];
-      if (line_cnt == MAX_OSD_ELEMS) {
-        dsosdcoord->frame_line_params->num_lines = line_cnt;
-        dsosdcoord->frame_line_params->line_params_list = dsosdcoord->line_params;
-        dsosdcoord->frame_line_params->buf_ptr = &surface->surfaceList[0];
-        dsosdcoord->frame_line_params->mode = dsosdcoord->dsosdcoord_mode;
-        if (nvll_osd_draw_lines (dsosdcoord->dsosdcoord_context,
-                dsosdcoord->frame_line_params) == -1) {
-          GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-              ("Unable to draw lines"), NULL);
-          return GST_FLOW_ERROR;
-        }
-        line_cnt = 0;
-      }
-    }
+  DSOSDCOORD_TRACE_BUFFER_ENTER (dsosdcoord->frame_num, buf);
 
-    for (cnt = 0; cnt < display_meta->num_arrows; cnt++) {
-      dsosdcoord->arrow_params[arrow_cnt++] = display_meta->arrow_params[cnt];
-      if (arrow_cnt == MAX_OSD_ELEMS) {
-        dsosdcoord->frame_arrow_params->num_arrows = arrow_cnt;
-        dsosdcoord->frame_arrow_params->arrow_params_list = dsosdcoord->arrow_params;
-        dsosdcoord->frame_arrow_params->buf_ptr = &surface->surfaceList[0];
-        dsosdcoord->frame_arrow_params->mode = dsosdcoord->dsosdcoord_mode;
-        if (nvll_osd_draw_arrows (dsosdcoord->dsosdcoord_context,
-                dsosdcoord->frame_arrow_params) == -1) {
-          GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-              ("Unable to draw arrows"), NULL);
-          return GST_FLOW_ERROR;
-        }
-        arrow_cnt = 0;
-      }
-    }
+  if (dsosdcoord->operation == DSOSDCOORD_OPERATION_EXTRACT_ONLY)
+    return gst_ds_osdcoord_extract_ip (dsosdcoord, buf);
 
-    for (cnt = 0; cnt < display_meta->num_circles; cnt++) {
-      dsosdcoord->circle_params[circle_cnt++] = display_meta->circle_params[cnt];
-      if (circle_cnt == MAX_OSD_ELEMS) {
-        dsosdcoord->frame_circle_params->num_circles = circle_cnt;
-        dsosdcoord->frame_circle_params->circle_params_list =
-            dsosdcoord->circle_params;
-        dsosdcoord->frame_circle_params->buf_ptr = &surface->surfaceList[0];
-        dsosdcoord->frame_circle_params->mode = dsosdcoord->dsosdcoord_mode;
-        if (nvll_osd_draw_circles (dsosdcoord->dsosdcoord_context,
-                dsosdcoord->frame_circle_params) == -1) {
-          GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-              ("Unable to draw circles"), NULL);
-          return GST_FLOW_ERROR;
-        }
-        circle_cnt = 0;
-      }
-    }
-    i++;
-  }
-
-  dsosdcoord->num_rect = rect_cnt;
-  dsosdcoord->num_segments = segment_cnt;
-  dsosdcoord->num_strings = text_cnt;
-  dsosdcoord->num_lines = line_cnt;
-  dsosdcoord->num_arrows = arrow_cnt;
-  dsosdcoord->num_circles = circle_cnt;
-  if (rect_cnt != 0 && dsosdcoord->draw_bbox) {
-    dsosdcoord->frame_rect_params->num_rects = dsosdcoord->num_rect;
-    dsosdcoord->frame_rect_params->rect_params_list = dsosdcoord->rect_params;
-    dsosdcoord->frame_rect_params->buf_ptr = &surface->surfaceList[0];
-    dsosdcoord->frame_rect_params->mode = dsosdcoord->dsosdcoord_mode;
-    if (nvll_osd_draw_rectangles (dsosdcoord->dsosdcoord_context,
-            dsosdcoord->frame_rect_params) == -1) {
-      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-          ("Unable to draw rectangles"), NULL);
-      return GST_FLOW_ERROR;
-    }
-  }
+  start = gst_util_get_timestamp ();
 
-  if (segment_cnt != 0 && dsosdcoord->draw_mask) {
-    dsosdcoord->frame_mask_params->num_segments = dsosdcoord->num_segments;
-    dsosdcoord->frame_mask_params->rect_params_list = dsosdcoord->mask_rect_params;
-    dsosdcoord->frame_mask_params->mask_params_list = dsosdcoord->mask_params;
-    dsosdcoord->frame_mask_params->buf_ptr = &surface->surfaceList[0];
-    dsosdcoord->frame_mask_params->mode = dsosdcoord->dsosdcoord_mode;
-    if (nvll_osd_draw_segment_masks (dsosdcoord->dsosdcoord_context,
-            dsosdcoord->frame_mask_params) == -1) {
-      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-          ("Unable to draw segment masks"), NULL);
-      return GST_FLOW_ERROR;
-    }
+  if (!gst_buffer_map (buf, &inmap,
+          dsosdcoord->sysmem ? GST_MAP_READWRITE : GST_MAP_READ)) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to map info from buffer"), NULL);
+    return GST_FLOW_ERROR;
   }
 
-  if ((dsosdcoord->show_clock || text_cnt) && dsosdcoord->draw_text) {
-    dsosdcoord->frame_text_params->num_strings = dsosdcoord->num_strings;
-    dsosdcoord->frame_text_params->text_params_list = dsosdcoord->text_params;
-    dsosdcoord->frame_text_params->buf_ptr = &surface->surfaceList[0];
-    dsosdcoord->frame_text_params->mode = dsosdcoord->dsosdcoord_mode;
-    if (nvll_osd_put_text (dsosdcoord->dsosdcoord_context,
-            dsosdcoord->frame_text_params) == -1) {
-      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED, ("Unable to draw text"),
-          NULL);
-      return GST_FLOW_ERROR;
-    }
-  }
+  nvds_set_input_system_timestamp (buf, GST_ELEMENT_NAME (dsosdcoord));
 
-  if (line_cnt != 0) {
-    dsosdcoord->frame_line_params->num_lines = dsosdcoord->num_lines;
-    dsosdcoord->frame_line_params->line_params_list = dsosdcoord->line_params;
-    dsosdcoord->frame_line_params->buf_ptr = &surface->surfaceList[0];
-    dsosdcoord->frame_line_params->mode = dsosdcoord->dsosdcoord_mode;
-    if (nvll_osd_draw_lines (dsosdcoord->dsosdcoord_context,
-            dsosdcoord->frame_line_params) == -1) {
-      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED, ("Unable to draw lines"),
-          NULL);
-      return GST_FLOW_ERROR;
-    }
+  if (backend->set_device && !backend->set_device (dsosdcoord->gpu_id)) {
+    GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
+        ("Unable to set device"), NULL);
+    gst_buffer_unmap (buf, &inmap);
+    return GST_FLOW_ERROR;
   }
 
-  if (arrow_cnt != 0) {
-    dsosdcoord->frame_arrow_params->num_arrows = dsosdcoord->num_arrows;
-    dsosdcoord->frame_arrow_params->arrow_params_list = dsosdcoord->arrow_params;
-    dsosdcoord->frame_arrow_params->buf_ptr = &surface->surfaceList[0];
-    dsosdcoord->frame_arrow_params->mode = dsosdcoord->dsosdcoord_mode;
-    if (nvll_osd_draw_arrows (dsosdcoord->dsosdcoord_context,
-            dsosdcoord->frame_arrow_params) == -1) {
-      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-          ("Unable to draw arrows"), NULL);
-      return GST_FLOW_ERROR;
-    }
+  if (dsosdcoord->sysmem) {
+    /* Describe the mapped RGBA frame as a single surface so the backends
+     * see the same layout as with NVMM. */
+    NvBufSurfaceParams *params = &dsosdcoord->sys_params;
+
+    memset (params, 0, sizeof (*params));
+    params->width = dsosdcoord->width;
+    params->height = dsosdcoord->height;
+    params->pitch = GST_VIDEO_INFO_PLANE_STRIDE (&dsosdcoord->video_info, 0);
+    params->colorFormat = NVBUF_COLOR_FORMAT_RGBA;
+    params->layout = NVBUF_LAYOUT_PITCH;
+    params->dataSize = inmap.size;
+    params->mappedAddr.addr[0] = inmap.data;
+
+    memset (&dsosdcoord->sys_surface, 0, sizeof (dsosdcoord->sys_surface));
+    dsosdcoord->sys_surface.gpuId = dsosdcoord->gpu_id;
+    dsosdcoord->sys_surface.batchSize = 1;
+    dsosdcoord->sys_surface.numFilled = 1;
+    dsosdcoord->sys_surface.memType = NVBUF_MEM_SYSTEM;
+    dsosdcoord->sys_surface.surfaceList = params;
+    surface = &dsosdcoord->sys_surface;
+  } else {
+    surface = (NvBufSurface *) inmap.data;
   }
 
-  if (circle_cnt != 0) {
-    dsosdcoord->frame_circle_params->num_circles = dsosdcoord->num_circles;
-    dsosdcoord->frame_circle_params->circle_params_list = dsosdcoord->circle_params;
-    dsosdcoord->frame_circle_params->buf_ptr = &surface->surfaceList[0];
-    dsosdcoord->frame_circle_params->mode = dsosdcoord->dsosdcoord_mode;
-    if (nvll_osd_draw_circles (dsosdcoord->dsosdcoord_context,
-            dsosdcoord->frame_circle_params) == -1) {
-      GST_ELEMENT_ERROR (dsosdcoord, RESOURCE, FAILED,
-          ("Unable to draw circles"), NULL);
-      return GST_FLOW_ERROR;
-    }
-  }
+  gst_ds_osdcoord_update_colors (dsosdcoord);
+
+  /* Get metadata. Update rectangle and text params */
+  char context_name[100];
+  snprintf (context_name, sizeof (context_name), "%s_(Frame=%u)",
+      GST_ELEMENT_NAME (dsosdcoord), dsosdcoord->frame_num);
+  nvtxRangePushA (context_name);
+  batch_meta = gst_ds_osdcoord_lookup_batch_meta (dsosdcoord, buf);
+
+  ok = gst_ds_osdcoord_process_batch (dsosdcoord, batch_meta, surface,
+      GST_BUFFER_PTS (buf));
 
+  /* A failed batch has posted its error; the range, the buffer accounting
+   * and the mapping are closed either way. */
   nvtxRangePop ();
-  dsosdcoord->frame_num++;
+  gst_ds_osdcoord_buffer_done (dsosdcoord, start);
 
-  nvds_set_output_system_timestamp (buf, GST_ELEMENT_NAME (dsosdcoord));
+  if (ok)
+    nvds_set_output_system_timestamp (buf, GST_ELEMENT_NAME (dsosdcoord));
 
   gst_buffer_unmap (buf, &inmap);
-  return GST_FLOW_OK;
+  return ok ? GST_FLOW_OK : GST_FLOW_ERROR;
 }
 
 /* Called when the plugin is destroyed.
@@ -623,20 +2213,23 @@ gst_ds_osdcoord_finalize (GObject * object)
   if (dsosdcoord->clock_text_params.font_params.font_name) {
     g_free ((char *) dsosdcoord->clock_text_params.font_params.font_name);
   }
-  g_free (dsosdcoord->rect_params);
-  g_free (dsosdcoord->mask_rect_params);
-  g_free (dsosdcoord->mask_params);
-  g_free (dsosdcoord->text_params);
-  g_free (dsosdcoord->line_params);
-  g_free (dsosdcoord->arrow_params);
-  g_free (dsosdcoord->circle_params);
-
-  g_free (dsosdcoord->frame_rect_params);
-  g_free (dsosdcoord->frame_mask_params);
-  g_free (dsosdcoord->frame_text_params);
-  g_free (dsosdcoord->frame_line_params);
-  g_free (dsosdcoord->frame_arrow_params);
-  g_free (dsosdcoord->frame_circle_params);
+  g_ptr_array_free (dsosdcoord->batch_frames, TRUE);
+  g_array_free (dsosdcoord->batch_exports, TRUE);
+  if (dsosdcoord->rate_limiter)
+    gst_ds_osdcoord_rate_limiter_free (dsosdcoord->rate_limiter);
+  gst_ds_osdcoord_color_table_unref (dsosdcoord->colors);
+  gst_ds_osdcoord_filter_unref (dsosdcoord->filter);
+  gst_ds_osdcoord_filter_config_clear (&dsosdcoord->filter_config);
+  g_free (dsosdcoord->shm_name);
+  g_free (dsosdcoord->uds_path);
+  g_free (dsosdcoord->file_location);
+  g_mutex_clear (&dsosdcoord->draw_lock);
+  g_mutex_clear (&dsosdcoord->stats_lock);
+  g_free (dsosdcoord->stats_total);
+  g_free (dsosdcoord->stats_posted);
+  g_free (dsosdcoord->stats_window);
+  g_mutex_clear (&dsosdcoord->workers_lock);
+  g_cond_clear (&dsosdcoord->workers_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -661,6 +2254,8 @@ gst_ds_osdcoord_class_init (GstDsOsdCoordClass * klass)
   base_transform_class->start = GST_DEBUG_FUNCPTR (gst_ds_osdcoord_start);
   base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_ds_osdcoord_stop);
   base_transform_class->set_caps = GST_DEBUG_FUNCPTR (gst_ds_osdcoord_set_caps);
+  base_transform_class->transform_caps =
+      GST_DEBUG_FUNCPTR (gst_ds_osdcoord_transform_caps);
 
   gobject_class->set_property = gst_ds_osdcoord_set_property;
   gobject_class->get_property = gst_ds_osdcoord_get_property;
@@ -688,6 +2283,330 @@ gst_ds_osdcoord_class_init (GstDsOsdCoordClass * klass)
       g_param_spec_boolean ("display-coord", "text", "Whether to display coordinate",
 	  TRUE, G_PARAM_READWRITE));
 
+  g_object_class_install_property (gobject_class, PROP_EXPORT_QUEUE_SIZE,
+      g_param_spec_uint ("export-queue-size", "Export Queue Size",
+          "Number of coordinate records that can be queued for the exporter "
+          "thread",
+          1, G_MAXINT, DEFAULT_EXPORT_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_OVERFLOW_POLICY,
+      g_param_spec_enum ("export-overflow-policy", "Export Overflow Policy",
+          "What to do with coordinate records when the export queue is full",
+          GST_TYPE_DS_OSDCOORD_OVERFLOW_POLICY,
+          DEFAULT_EXPORT_OVERFLOW_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_DROPPED,
+      g_param_spec_uint64 ("export-dropped", "Export Dropped",
+          "Number of coordinate records dropped because the export queue "
+          "was full, the uds receiver was slow or absent or no segment "
+          "file could be opened. With export-shared the sink drops of all "
+          "instances sharing the sink are included",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_META_TRAVERSAL,
+      g_param_spec_enum ("meta-traversal", "Meta Traversal",
+          "How the batch metadata is walked. \"frame\" draws each frame of a\n"
+          "\t\t\t batch onto its own surface and exports source_id and\n"
+          "\t\t\t batch_id with the coordinates",
+          GST_TYPE_DS_OSDCOORD_META_TRAVERSAL,
+          DEFAULT_META_TRAVERSAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_WORKERS,
+      g_param_spec_uint ("num-workers", "Number of workers",
+          "Number of threads the frames of a batch are spread across.\n"
+          "\t\t\t Only used with meta-traversal=frame. In CPU mode each\n"
+          "\t\t\t worker also rasterizes its frames with its own context",
+          1, MAX_NUM_WORKERS, DEFAULT_NUM_WORKERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_SINK,
+      g_param_spec_enum ("export-sink", "Export Sink",
+          "Where coordinate records are written to",
+          GST_TYPE_DS_OSDCOORD_EXPORT_SINK,
+          DEFAULT_EXPORT_SINK,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_FORMAT,
+      g_param_spec_enum ("export-format", "Export Format",
+          "How records are serialized for export-sink=stdout and uds.\n"
+          "\t\t\t \"binary\" writes frames with a string table, see\n"
+          "\t\t\t dsosdcoord_bin.h. export-sink=file is always binary",
+          GST_TYPE_DS_OSDCOORD_EXPORT_FORMAT,
+          DEFAULT_EXPORT_FORMAT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_FIELDS,
+      g_param_spec_flags ("export-fields", "Export Fields",
+          "Object meta exported besides the box, label and class id,\n"
+          "\t\t\t collected in the same walk of the object list. Not\n"
+          "\t\t\t written to export-sink=shm",
+          GST_TYPE_DS_OSDCOORD_EXPORT_FIELDS,
+          DEFAULT_EXPORT_FIELDS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_UDS_PATH,
+      g_param_spec_string ("uds-path", "UDS Path",
+          "Unix domain datagram socket the uds export sink sends to",
+          DEFAULT_UDS_PATH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_UDS_FLUSH_US,
+      g_param_spec_uint ("uds-flush-us", "UDS Flush Microseconds",
+          "Microseconds datagrams of the uds export sink are held back\n"
+          "\t\t\t to be sent with one sendmmsg, 0 for once per buffer",
+          0, G_MAXUINT, DEFAULT_UDS_FLUSH_US,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_FILE_LOCATION,
+      g_param_spec_string ("file-location", "File Location",
+          "Directory the file export sink writes its segment files to",
+          DEFAULT_FILE_LOCATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_FILE_SEGMENT_SIZE,
+      g_param_spec_uint ("file-segment-size", "File Segment Size",
+          "Bytes preallocated and mapped per segment file, which is\n"
+          "\t\t\t rotated when full",
+          DSOSDCOORD_LOG_MIN_SEGMENT_SIZE, DSOSDCOORD_LOG_MAX_SEGMENT_SIZE,
+          DEFAULT_FILE_SEGMENT_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_FILE_SEGMENT_SECONDS,
+      g_param_spec_uint ("file-segment-seconds", "File Segment Seconds",
+          "Seconds after which a segment file is rotated, 0 to rotate\n"
+          "\t\t\t only when it is full",
+          0, G_MAXUINT, DEFAULT_FILE_SEGMENT_SECONDS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_FILE_SYNC_INTERVAL,
+      g_param_spec_uint ("file-sync-interval", "File Sync Interval",
+          "Milliseconds between msyncs of the current segment file on a\n"
+          "\t\t\t background thread, 0 to sync segments only when closed",
+          0, G_MAXUINT, DEFAULT_FILE_SYNC_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_SHARED,
+      g_param_spec_boolean ("export-shared", "Export Shared",
+          "Share the export sink and its thread with the other instances\n"
+          "\t\t\t of the process writing to the same stdout, shm-name,\n"
+          "\t\t\t uds-path or file-location, which must use the same\n"
+          "\t\t\t sink settings and, for binary output, export-fields.\n"
+          "\t\t\t Each instance keeps its own queue",
+          DEFAULT_EXPORT_SHARED,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SHM_NAME,
+      g_param_spec_string ("shm-name", "Shared Memory Name",
+          "Name of the shared memory object for export-sink=shm",
+          DEFAULT_SHM_NAME,
+          (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+              GST_PARAM_MUTABLE_READY)));
+
+  g_object_class_install_property (gobject_class, PROP_SHM_SLOTS,
+      g_param_spec_uint ("shm-slots", "Shared Memory Slots",
+          "Number of records the shared memory ring holds",
+          1, G_MAXINT, DEFAULT_SHM_SLOTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_OPERATION,
+      g_param_spec_enum ("mode", "Mode",
+          "What is done with each buffer. \"extract-only\" exports the\n"
+          "\t\t\t coordinates without mapping the buffer, using CUDA or\n"
+          "\t\t\t drawing, and also accepts system memory caps",
+          GST_TYPE_DS_OSDCOORD_OPERATION,
+          DEFAULT_OPERATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_DRAW_SHRINK_INTERVAL,
+      g_param_spec_uint ("draw-shrink-interval", "Draw Shrink Interval",
+          "Number of buffers after which draw lists are shrunk to the\n"
+          "\t\t\t largest size needed meanwhile. 0 never shrinks them",
+          0, G_MAXUINT, DEFAULT_DRAW_SHRINK_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_MEMORY_USAGE,
+      g_param_spec_uint64 ("memory-usage", "Memory Usage",
+          "Bytes allocated by the element for draw lists, export records\n"
+          "\t\t\t and the export queue and sink",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_OSD_BACKEND,
+      g_param_spec_enum ("osd-backend", "OSD Backend",
+          "Implementation of the draw calls. \"null\" only counts them and\n"
+          "\t\t\t \"cpu\" draws on system memory RGBA frames without CUDA",
+          GST_TYPE_DS_OSDCOORD_OSD_BACKEND,
+          DEFAULT_OSD_BACKEND,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Buffer, frame and object counts and, per stage, the count and\n"
+          "\t\t\t p50, p99 and max duration in nanoseconds since start,\n"
+          "\t\t\t with the export rates and exporter counters",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_STATS_INTERVAL,
+      g_param_spec_uint ("stats-interval", "Statistics Interval",
+          "Interval in milliseconds at which a dsosdcoord-stats element\n"
+          "\t\t\t message with the statistics of the interval is posted,\n"
+          "\t\t\t 0 to post none",
+          0, G_MAXUINT, DEFAULT_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_CLASS_IDS,
+      g_param_spec_string ("class-ids", "Class IDs",
+          "Class ids of the objects to export, separated by ';',\n"
+          "\t\t\t empty to export all classes. e.g. 0;2",
+          NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_EXCLUDE_CLASS_IDS,
+      g_param_spec_string ("exclude-class-ids", "Exclude Class IDs",
+          "Class ids of the objects never to export, separated by ';'",
+          NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_MIN_CONFIDENCE,
+      g_param_spec_float ("min-confidence", "Minimum Confidence",
+          "Objects with a lower confidence are not exported,\n"
+          "\t\t\t -1 to export all",
+          -1.0, 1.0, DEFAULT_MIN_CONFIDENCE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_MIN_AREA,
+      g_param_spec_uint ("min-area", "Minimum Area",
+          "Objects whose box is smaller, in pixels, are not exported",
+          0, G_MAXUINT, DEFAULT_MIN_AREA,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_AREA,
+      g_param_spec_uint ("max-area", "Maximum Area",
+          "Objects whose box is larger, in pixels, are not exported,\n"
+          "\t\t\t 0 for no limit",
+          0, G_MAXUINT, DEFAULT_MAX_AREA,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_ROI,
+      g_param_spec_string ("roi", "Regions of Interest",
+          "Polygons per source, separated by ';'. Objects of a source\n"
+          "\t\t\t with polygons are exported only if the center of their\n"
+          "\t\t\t box is in one of them.\n"
+          "\t\t\t e.g. 0:0,0,640,0,640,360,0,360;1:100,100,500,120,300,400",
+          NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_MODE,
+      g_param_spec_enum ("export-mode", "Export Mode",
+          "Which records are exported. \"changes\" exports tracked objects\n"
+          "\t\t\t only when they appear, move or disappear",
+          GST_TYPE_DS_OSDCOORD_EXPORT_MODE,
+          DEFAULT_EXPORT_MODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_TRACK_GRACE_FRAMES,
+      g_param_spec_uint ("track-grace-frames", "Track Grace Frames",
+          "Frames a track may be missing before it is exported as\n"
+          "\t\t\t disappeared, with export-mode=changes",
+          0, G_MAXUINT, DEFAULT_TRACK_GRACE_FRAMES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_TRACK_MOVE_THRESHOLD,
+      g_param_spec_float ("track-move-threshold", "Track Move Threshold",
+          "Distance in coord-space units an edge of the box must move by\n"
+          "\t\t\t for a track to be exported again, 0 to ignore.\n"
+          "\t\t\t With coord-space=normalized, a fraction of the frame",
+          0, G_MAXFLOAT, DEFAULT_TRACK_MOVE_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_TRACK_IOU_THRESHOLD,
+      g_param_spec_float ("track-iou-threshold", "Track IoU Threshold",
+          "A track is exported again when the IoU of its box with the\n"
+          "\t\t\t last exported one is below this, 0 to ignore",
+          0, 1, DEFAULT_TRACK_IOU_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class,
+      PROP_TRACK_KEYFRAME_INTERVAL,
+      g_param_spec_uint ("track-keyframe-interval", "Track Keyframe Interval",
+          "Export all tracks of frames whose frame number is a multiple\n"
+          "\t\t\t of this, 0 for no keyframes",
+          0, G_MAXUINT, DEFAULT_TRACK_KEYFRAME_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class,
+      PROP_EXPORT_INTERVAL_FRAMES,
+      g_param_spec_uint ("export-interval-frames", "Export Interval Frames",
+          "Export the objects of one frame out of this many of each\n"
+          "\t\t\t source. Drawing is not affected",
+          1, G_MAXUINT, DEFAULT_EXPORT_INTERVAL_FRAMES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_EXPORT_MAX_HZ,
+      g_param_spec_double ("export-max-hz", "Export Max Hz",
+          "Largest number of frames per second of each source whose\n"
+          "\t\t\t objects are exported, by buffer PTS, 0 for no limit",
+          0, G_MAXDOUBLE, DEFAULT_EXPORT_MAX_HZ,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_COORD_SPACE,
+      g_param_spec_enum ("coord-space", "Coordinate Space",
+          "Space exported coordinates are expressed in. \"source\" maps\n"
+          "\t\t\t boxes to source_frame_width/height of the frame meta",
+          GST_TYPE_DS_OSDCOORD_COORD_SPACE,
+          DEFAULT_COORD_SPACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_COORD_FORMAT,
+      g_param_spec_enum ("coord-format", "Coordinate Format",
+          "Number format of exported coordinates",
+          GST_TYPE_DS_OSDCOORD_COORD_FORMAT,
+          DEFAULT_COORD_FORMAT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_COORD_CLAMP,
+      g_param_spec_boolean ("coord-clamp", "Coordinate Clamp",
+          "Clamp exported boxes to the bounds of the frame",
+          DEFAULT_COORD_CLAMP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   g_object_class_install_property (gobject_class, PROP_CLOCK_FONT,
       g_param_spec_string ("clock-font", "clock-font",
           "Clock Font to be set",
@@ -735,7 +2654,7 @@ gst_ds_osdcoord_class_init (GstDsOsdCoordClass * klass)
           "color attributes for all classes,\n"
           "\t\t\t Use string with values of color class atrributes \n"
           "\t\t\t in ClassID (int), r(float), g(float), b(float), a(float)\n"
-          "\t\t\t in order to set the property.\n"
+          "\t\t\t in order to set the property. a defaults to 1.0.\n"
           "\t\t\t Applicable only for HW mode on Jetson.\n"
           "\t\t\t e.g. 0,0.0,1.0,0.0,0.3:1,1.0,0.0,0.3,0.3",
           DEFAULT_CLR,
@@ -763,6 +2682,64 @@ gst_ds_osdcoord_class_init (GstDsOsdCoordClass * klass)
   _dsmeta_quark = g_quark_from_static_string (NVDS_META_STRING);
 }
 
+/**
+ * Apply a filter property to a copy of the filter settings and compile it.
+ * The property is ignored with a warning if the copy does not compile. The
+ * object lock is held from the copy to the swap so that concurrent sets of
+ * two filter properties do not drop one of the changes.
+ */
+static void
+gst_ds_osdcoord_set_filter_property (GstDsOsdCoord * dsosdcoord,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstDsOsdCoordFilterConfig config;
+  GstDsOsdCoordFilter *filter, *old;
+  GError *error = NULL;
+
+  GST_OBJECT_LOCK (dsosdcoord);
+  gst_ds_osdcoord_filter_config_copy (&config, &dsosdcoord->filter_config);
+
+  switch (prop_id) {
+    case PROP_CLASS_IDS:
+      g_free (config.class_ids);
+      config.class_ids = g_value_dup_string (value);
+      break;
+    case PROP_EXCLUDE_CLASS_IDS:
+      g_free (config.exclude_class_ids);
+      config.exclude_class_ids = g_value_dup_string (value);
+      break;
+    case PROP_MIN_CONFIDENCE:
+      config.min_confidence = g_value_get_float (value);
+      break;
+    case PROP_MIN_AREA:
+      config.min_area = g_value_get_uint (value);
+      break;
+    case PROP_MAX_AREA:
+      config.max_area = g_value_get_uint (value);
+      break;
+    case PROP_ROI:
+      g_free (config.roi);
+      config.roi = g_value_dup_string (value);
+      break;
+  }
+
+  filter = gst_ds_osdcoord_filter_new (&config, &error);
+  if (!filter) {
+    GST_OBJECT_UNLOCK (dsosdcoord);
+    g_warning ("dsosdcoord: ignoring %s: %s", pspec->name, error->message);
+    g_error_free (error);
+    gst_ds_osdcoord_filter_config_clear (&config);
+    return;
+  }
+
+  gst_ds_osdcoord_filter_config_clear (&dsosdcoord->filter_config);
+  dsosdcoord->filter_config = config;
+  old = dsosdcoord->filter;
+  dsosdcoord->filter = filter;
+  GST_OBJECT_UNLOCK (dsosdcoord);
+  gst_ds_osdcoord_filter_unref (old);
+}
+
 /* Function called when a property of the element is set. Standard boilerplate.
  */
 static void
@@ -811,13 +2788,137 @@ gst_ds_osdcoord_set_property (GObject * object, guint prop_id,
       dsosdcoord->dsosdcoord_mode = (NvOSD_Mode) g_value_get_enum (value);
       break;
     case PROP_HW_BLEND_COLOR_ATTRS:
+    {
+      GstDsOsdCoordColorTable *colors, *old;
+      GError *error = NULL;
+
+      colors = gst_ds_osdcoord_color_table_parse (g_value_get_string (value),
+          &error);
+      if (!colors) {
+        g_warning ("dsosdcoord: ignoring hw-blend-color-attr: %s",
+            error->message);
+        g_error_free (error);
+        break;
+      }
+      GST_OBJECT_LOCK (dsosdcoord);
+      old = dsosdcoord->colors;
+      dsosdcoord->colors = colors;
       dsosdcoord->hw_blend = TRUE;
-      gst_ds_osdcoord_parse_hw_blend_color_attrs (dsosdcoord,
-          g_value_get_string (value));
+      GST_OBJECT_UNLOCK (dsosdcoord);
+      gst_ds_osdcoord_color_table_unref (old);
       break;
+    }
     case PROP_GPU_DEVICE_ID:
       dsosdcoord->gpu_id = g_value_get_uint (value);
       break;
+    case PROP_EXPORT_QUEUE_SIZE:
+      dsosdcoord->export_queue_size = g_value_get_uint (value);
+      break;
+    case PROP_EXPORT_OVERFLOW_POLICY:
+      dsosdcoord->export_overflow_policy =
+          (GstDsOsdCoordOverflowPolicy) g_value_get_enum (value);
+      break;
+    case PROP_META_TRAVERSAL:
+      dsosdcoord->meta_traversal =
+          (GstDsOsdCoordMetaTraversal) g_value_get_enum (value);
+      break;
+    case PROP_NUM_WORKERS:
+      dsosdcoord->num_workers = g_value_get_uint (value);
+      break;
+    case PROP_EXPORT_SINK:
+      dsosdcoord->export_sink = (GstDsOsdCoordExportSink) g_value_get_enum (value);
+      break;
+    case PROP_EXPORT_FORMAT:
+      dsosdcoord->export_format = (GstDsOsdCoordExportFormat)
+          g_value_get_enum (value);
+      break;
+    case PROP_EXPORT_FIELDS:
+      dsosdcoord->export_fields = g_value_get_flags (value);
+      break;
+    case PROP_SHM_NAME:
+      g_free (dsosdcoord->shm_name);
+      dsosdcoord->shm_name = g_value_dup_string (value);
+      break;
+    case PROP_SHM_SLOTS:
+      dsosdcoord->shm_slots = g_value_get_uint (value);
+      break;
+    case PROP_UDS_PATH:
+      g_free (dsosdcoord->uds_path);
+      dsosdcoord->uds_path = g_value_dup_string (value);
+      break;
+    case PROP_UDS_FLUSH_US:
+      dsosdcoord->uds_flush_us = g_value_get_uint (value);
+      break;
+    case PROP_FILE_LOCATION:
+      g_free (dsosdcoord->file_location);
+      dsosdcoord->file_location = g_value_dup_string (value);
+      break;
+    case PROP_FILE_SEGMENT_SIZE:
+      dsosdcoord->file_segment_size = g_value_get_uint (value);
+      break;
+    case PROP_FILE_SEGMENT_SECONDS:
+      dsosdcoord->file_segment_seconds = g_value_get_uint (value);
+      break;
+    case PROP_FILE_SYNC_INTERVAL:
+      dsosdcoord->file_sync_interval = g_value_get_uint (value);
+      break;
+    case PROP_EXPORT_SHARED:
+      dsosdcoord->export_shared = g_value_get_boolean (value);
+      break;
+    case PROP_OPERATION:
+      dsosdcoord->operation = (GstDsOsdCoordOperation) g_value_get_enum (value);
+      break;
+    case PROP_DRAW_SHRINK_INTERVAL:
+      dsosdcoord->draw_shrink_interval = g_value_get_uint (value);
+      break;
+    case PROP_OSD_BACKEND:
+      dsosdcoord->backend_type =
+          (GstDsOsdCoordBackendType) g_value_get_enum (value);
+      break;
+    case PROP_STATS_INTERVAL:
+      dsosdcoord->stats_interval = g_value_get_uint (value);
+      break;
+    case PROP_CLASS_IDS:
+    case PROP_EXCLUDE_CLASS_IDS:
+    case PROP_MIN_CONFIDENCE:
+    case PROP_MIN_AREA:
+    case PROP_MAX_AREA:
+    case PROP_ROI:
+      gst_ds_osdcoord_set_filter_property (dsosdcoord, prop_id, value, pspec);
+      break;
+    case PROP_EXPORT_MODE:
+      dsosdcoord->export_mode = (GstDsOsdCoordExportMode)
+          g_value_get_enum (value);
+      break;
+    case PROP_TRACK_GRACE_FRAMES:
+      dsosdcoord->track_config.grace_frames = g_value_get_uint (value);
+      break;
+    case PROP_TRACK_MOVE_THRESHOLD:
+      dsosdcoord->track_config.move_threshold = g_value_get_float (value);
+      break;
+    case PROP_TRACK_IOU_THRESHOLD:
+      dsosdcoord->track_config.iou_threshold = g_value_get_float (value);
+      break;
+    case PROP_TRACK_KEYFRAME_INTERVAL:
+      dsosdcoord->track_config.keyframe_interval = g_value_get_uint (value);
+      break;
+    case PROP_EXPORT_INTERVAL_FRAMES:
+      dsosdcoord->rate_config.interval_frames = g_value_get_uint (value);
+      break;
+    case PROP_EXPORT_MAX_HZ:
+      dsosdcoord->rate_config.max_hz = g_value_get_double (value);
+      break;
+    case PROP_COORD_SPACE:
+      dsosdcoord->coord_space = (GstDsOsdCoordCoordSpace)
+          g_value_get_enum (value);
+      break;
+    case PROP_COORD_FORMAT:
+      dsosdcoord->coord_format = (GstDsOsdCoordCoordFormat)
+          g_value_get_enum (value);
+      break;
+    case PROP_COORD_CLAMP:
+      dsosdcoord->coord_clamp = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -868,11 +2969,151 @@ gst_ds_osdcoord_get_property (GObject * object, guint prop_id,
       g_value_set_enum (value, dsosdcoord->dsosdcoord_mode);
       break;
     case PROP_HW_BLEND_COLOR_ATTRS:
-      gst_ds_osdcoord_get_hw_blend_color_attrs (value, dsosdcoord);
+      GST_OBJECT_LOCK (dsosdcoord);
+      g_value_take_string (value,
+          gst_ds_osdcoord_color_table_to_string (dsosdcoord->colors));
+      GST_OBJECT_UNLOCK (dsosdcoord);
       break;
     case PROP_GPU_DEVICE_ID:
       g_value_set_uint (value, dsosdcoord->gpu_id);
       break;
+    case PROP_EXPORT_QUEUE_SIZE:
+      g_value_set_uint (value, dsosdcoord->export_queue_size);
+      break;
+    case PROP_EXPORT_OVERFLOW_POLICY:
+      g_value_set_enum (value, dsosdcoord->export_overflow_policy);
+      break;
+    case PROP_META_TRAVERSAL:
+      g_value_set_enum (value, dsosdcoord->meta_traversal);
+      break;
+    case PROP_NUM_WORKERS:
+      g_value_set_uint (value, dsosdcoord->num_workers);
+      break;
+    case PROP_EXPORT_SINK:
+      g_value_set_enum (value, dsosdcoord->export_sink);
+      break;
+    case PROP_EXPORT_FORMAT:
+      g_value_set_enum (value, dsosdcoord->export_format);
+      break;
+    case PROP_EXPORT_FIELDS:
+      g_value_set_flags (value, dsosdcoord->export_fields);
+      break;
+    case PROP_SHM_NAME:
+      g_value_set_string (value, dsosdcoord->shm_name);
+      break;
+    case PROP_SHM_SLOTS:
+      g_value_set_uint (value, dsosdcoord->shm_slots);
+      break;
+    case PROP_UDS_PATH:
+      g_value_set_string (value, dsosdcoord->uds_path);
+      break;
+    case PROP_UDS_FLUSH_US:
+      g_value_set_uint (value, dsosdcoord->uds_flush_us);
+      break;
+    case PROP_FILE_LOCATION:
+      g_value_set_string (value, dsosdcoord->file_location);
+      break;
+    case PROP_FILE_SEGMENT_SIZE:
+      g_value_set_uint (value, dsosdcoord->file_segment_size);
+      break;
+    case PROP_FILE_SEGMENT_SECONDS:
+      g_value_set_uint (value, dsosdcoord->file_segment_seconds);
+      break;
+    case PROP_FILE_SYNC_INTERVAL:
+      g_value_set_uint (value, dsosdcoord->file_sync_interval);
+      break;
+    case PROP_EXPORT_SHARED:
+      g_value_set_boolean (value, dsosdcoord->export_shared);
+      break;
+    case PROP_OPERATION:
+      g_value_set_enum (value, dsosdcoord->operation);
+      break;
+    case PROP_DRAW_SHRINK_INTERVAL:
+      g_value_set_uint (value, dsosdcoord->draw_shrink_interval);
+      break;
+    case PROP_OSD_BACKEND:
+      g_value_set_enum (value, dsosdcoord->backend_type);
+      break;
+    case PROP_STATS:{
+      GstDsOsdCoordStats *stats = g_new (GstDsOsdCoordStats, 1);
+      GstStructure *s;
+
+      gst_ds_osdcoord_stats_snapshot (dsosdcoord, stats);
+      s = gst_ds_osdcoord_stats_to_structure (stats, "dsosdcoord-stats");
+      gst_ds_osdcoord_add_export_stats (dsosdcoord, s);
+      g_value_take_boxed (value, s);
+      g_free (stats);
+      break;
+    }
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, dsosdcoord->stats_interval);
+      break;
+    case PROP_CLASS_IDS:
+      GST_OBJECT_LOCK (dsosdcoord);
+      g_value_set_string (value, dsosdcoord->filter_config.class_ids);
+      GST_OBJECT_UNLOCK (dsosdcoord);
+      break;
+    case PROP_EXCLUDE_CLASS_IDS:
+      GST_OBJECT_LOCK (dsosdcoord);
+      g_value_set_string (value, dsosdcoord->filter_config.exclude_class_ids);
+      GST_OBJECT_UNLOCK (dsosdcoord);
+      break;
+    case PROP_MIN_CONFIDENCE:
+      g_value_set_float (value, dsosdcoord->filter_config.min_confidence);
+      break;
+    case PROP_MIN_AREA:
+      g_value_set_uint (value, dsosdcoord->filter_config.min_area);
+      break;
+    case PROP_MAX_AREA:
+      g_value_set_uint (value, dsosdcoord->filter_config.max_area);
+      break;
+    case PROP_ROI:
+      GST_OBJECT_LOCK (dsosdcoord);
+      g_value_set_string (value, dsosdcoord->filter_config.roi);
+      GST_OBJECT_UNLOCK (dsosdcoord);
+      break;
+    case PROP_EXPORT_MODE:
+      g_value_set_enum (value, dsosdcoord->export_mode);
+      break;
+    case PROP_TRACK_GRACE_FRAMES:
+      g_value_set_uint (value, dsosdcoord->track_config.grace_frames);
+      break;
+    case PROP_TRACK_MOVE_THRESHOLD:
+      g_value_set_float (value, dsosdcoord->track_config.move_threshold);
+      break;
+    case PROP_TRACK_IOU_THRESHOLD:
+      g_value_set_float (value, dsosdcoord->track_config.iou_threshold);
+      break;
+    case PROP_TRACK_KEYFRAME_INTERVAL:
+      g_value_set_uint (value, dsosdcoord->track_config.keyframe_interval);
+      break;
+    case PROP_EXPORT_INTERVAL_FRAMES:
+      g_value_set_uint (value, dsosdcoord->rate_config.interval_frames);
+      break;
+    case PROP_EXPORT_MAX_HZ:
+      g_value_set_double (value, dsosdcoord->rate_config.max_hz);
+      break;
+    case PROP_COORD_SPACE:
+      g_value_set_enum (value, dsosdcoord->coord_space);
+      break;
+    case PROP_COORD_FORMAT:
+      g_value_set_enum (value, dsosdcoord->coord_format);
+      break;
+    case PROP_COORD_CLAMP:
+      g_value_set_boolean (value, dsosdcoord->coord_clamp);
+      break;
+    case PROP_MEMORY_USAGE:
+      GST_OBJECT_LOCK (dsosdcoord);
+      g_value_set_uint64 (value, dsosdcoord->memory_usage);
+      GST_OBJECT_UNLOCK (dsosdcoord);
+      break;
+    case PROP_EXPORT_DROPPED:
+      g_mutex_lock (&dsosdcoord->stats_lock);
+      g_value_set_uint64 (value, dsosdcoord->export_dropped +
+          (dsosdcoord->exporter ?
+              gst_ds_osdcoord_exporter_get_dropped (dsosdcoord->exporter) : 0));
+      g_mutex_unlock (&dsosdcoord->stats_lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -893,29 +3134,74 @@ gst_ds_osdcoord_init (GstDsOsdCoord * dsosdcoord)
   dsosdcoord->clock_text_params.font_params.font_size = DEFAULT_FONT_SIZE;
   dsosdcoord->dsosdcoord_mode = GST_NV_OSD_DEFAULT_PROCESS_MODE;
   dsosdcoord->border_width = DEFAULT_BORDER_WIDTH;
-  dsosdcoord->num_rect = 0;
-  dsosdcoord->num_segments = 0;
-  dsosdcoord->num_strings = 0;
-  dsosdcoord->num_lines = 0;
   dsosdcoord->clock_text_params.font_params.font_color.red = 1.0;
   dsosdcoord->clock_text_params.font_params.font_color.green = 0.0;
   dsosdcoord->clock_text_params.font_params.font_color.blue = 0.0;
   dsosdcoord->clock_text_params.font_params.font_color.alpha = 1.0;
-  dsosdcoord->rect_params = g_new0 (NvOSD_RectParams, MAX_OSD_ELEMS);
-  dsosdcoord->mask_rect_params = g_new0 (NvOSD_RectParams, MAX_OSD_ELEMS);
-  dsosdcoord->mask_params = g_new0 (NvOSD_MaskParams, MAX_OSD_ELEMS);
-  dsosdcoord->text_params = g_new0 (NvOSD_TextParams, MAX_OSD_ELEMS);
-  dsosdcoord->line_params = g_new0 (NvOSD_LineParams, MAX_OSD_ELEMS);
-  dsosdcoord->arrow_params = g_new0 (NvOSD_ArrowParams, MAX_OSD_ELEMS);
-  dsosdcoord->circle_params = g_new0 (NvOSD_CircleParams, MAX_OSD_ELEMS);
-  dsosdcoord->frame_rect_params = g_new0 (NvOSD_FrameRectParams, MAX_OSD_ELEMS);
-  dsosdcoord->frame_mask_params = g_new0 (NvOSD_FrameSegmentMaskParams, MAX_OSD_ELEMS);
-  dsosdcoord->frame_text_params = g_new0 (NvOSD_FrameTextParams, MAX_OSD_ELEMS);
-  dsosdcoord->frame_line_params = g_new0 (NvOSD_FrameLineParams, MAX_OSD_ELEMS);
-  dsosdcoord->frame_arrow_params = g_new0 (NvOSD_FrameArrowParams, MAX_OSD_ELEMS);
-  dsosdcoord->frame_circle_params =
-      g_new0 (NvOSD_FrameCircleParams, MAX_OSD_ELEMS);
   dsosdcoord->hw_blend = FALSE;
+  dsosdcoord->colors = gst_ds_osdcoord_color_table_parse (DEFAULT_CLR, NULL);
+  dsosdcoord->active_colors = NULL;
+  dsosdcoord->filter_config.class_ids = NULL;
+  dsosdcoord->filter_config.exclude_class_ids = NULL;
+  dsosdcoord->filter_config.min_confidence = DEFAULT_MIN_CONFIDENCE;
+  dsosdcoord->filter_config.min_area = DEFAULT_MIN_AREA;
+  dsosdcoord->filter_config.max_area = DEFAULT_MAX_AREA;
+  dsosdcoord->filter_config.roi = NULL;
+  dsosdcoord->filter =
+      gst_ds_osdcoord_filter_new (&dsosdcoord->filter_config, NULL);
+  dsosdcoord->active_filter = NULL;
+  dsosdcoord->export_mode = DEFAULT_EXPORT_MODE;
+  dsosdcoord->track_config.grace_frames = DEFAULT_TRACK_GRACE_FRAMES;
+  dsosdcoord->track_config.move_threshold = DEFAULT_TRACK_MOVE_THRESHOLD;
+  dsosdcoord->track_config.iou_threshold = DEFAULT_TRACK_IOU_THRESHOLD;
+  dsosdcoord->track_config.keyframe_interval =
+      DEFAULT_TRACK_KEYFRAME_INTERVAL;
+  dsosdcoord->tracker = NULL;
+  dsosdcoord->exporter = NULL;
+  dsosdcoord->export_queue_size = DEFAULT_EXPORT_QUEUE_SIZE;
+  dsosdcoord->export_overflow_policy = DEFAULT_EXPORT_OVERFLOW_POLICY;
+  dsosdcoord->export_dropped = 0;
+  dsosdcoord->meta_traversal = DEFAULT_META_TRAVERSAL;
+  dsosdcoord->num_workers = DEFAULT_NUM_WORKERS;
+  dsosdcoord->workers = NULL;
+  dsosdcoord->worker_pool = NULL;
+  dsosdcoord->batch_frames = g_ptr_array_new ();
+  dsosdcoord->batch_exports = g_array_new (FALSE, FALSE, sizeof (gboolean));
+  dsosdcoord->rate_config.interval_frames = DEFAULT_EXPORT_INTERVAL_FRAMES;
+  dsosdcoord->rate_config.max_hz = DEFAULT_EXPORT_MAX_HZ;
+  dsosdcoord->coord_space = DEFAULT_COORD_SPACE;
+  dsosdcoord->coord_format = DEFAULT_COORD_FORMAT;
+  dsosdcoord->coord_clamp = DEFAULT_COORD_CLAMP;
+  dsosdcoord->rate_limiter = NULL;
+  g_mutex_init (&dsosdcoord->draw_lock);
+  g_mutex_init (&dsosdcoord->stats_lock);
+  g_mutex_init (&dsosdcoord->workers_lock);
+  g_cond_init (&dsosdcoord->workers_cond);
+  dsosdcoord->export_sink = DEFAULT_EXPORT_SINK;
+  dsosdcoord->export_format = DEFAULT_EXPORT_FORMAT;
+  dsosdcoord->shm_name = g_strdup (DEFAULT_SHM_NAME);
+  dsosdcoord->shm_slots = DEFAULT_SHM_SLOTS;
+  dsosdcoord->uds_path = g_strdup (DEFAULT_UDS_PATH);
+  dsosdcoord->uds_flush_us = DEFAULT_UDS_FLUSH_US;
+  dsosdcoord->file_location = g_strdup (DEFAULT_FILE_LOCATION);
+  dsosdcoord->file_segment_size = DEFAULT_FILE_SEGMENT_SIZE;
+  dsosdcoord->file_segment_seconds = DEFAULT_FILE_SEGMENT_SECONDS;
+  dsosdcoord->file_sync_interval = DEFAULT_FILE_SYNC_INTERVAL;
+  dsosdcoord->export_shared = DEFAULT_EXPORT_SHARED;
+  dsosdcoord->export_fields = DEFAULT_EXPORT_FIELDS;
+  dsosdcoord->operation = DEFAULT_OPERATION;
+  dsosdcoord->draw_shrink_interval = DEFAULT_DRAW_SHRINK_INTERVAL;
+  dsosdcoord->memory_usage = 0;
+  dsosdcoord->stats_interval = DEFAULT_STATS_INTERVAL;
+  dsosdcoord->stats_last_post = GST_CLOCK_TIME_NONE;
+  dsosdcoord->num_started_workers = 0;
+  dsosdcoord->worker_stats = NULL;
+  dsosdcoord->stats_total = g_new0 (GstDsOsdCoordStats, 1);
+  dsosdcoord->stats_posted = g_new0 (GstDsOsdCoordStats, 1);
+  dsosdcoord->stats_window = g_new0 (GstDsOsdCoordStats, 1);
+  dsosdcoord->backend_type = DEFAULT_OSD_BACKEND;
+  dsosdcoord->backend = NULL;
+  dsosdcoord->sysmem = FALSE;
 }
 
 /**
@@ -944,72 +3230,11 @@ dsosdcoord_init (GstPlugin * dsosdcoord)
   GST_DEBUG_CATEGORY_INIT (gst_ds_osdcoord_debug, "dsosdcoord", 0, "dsosdcoord plugin");
 
   return gst_element_register (dsosdcoord, "dsosdcoord", GST_RANK_PRIMARY,
-      GST_TYPE_DSOSDCOORD);
-}
-
-static gboolean
-gst_ds_osdcoord_parse_hw_blend_color_attrs (GstDsOsdCoord * dsosdcoord,
-    const gchar * arr)
-{
-  gchar *str = (gchar *) arr;
-  int idx = 0;
-  int class_id = 0;
-
-  while (str != NULL && str[0] != '\0') {
-    class_id = atoi (str);
-    if (class_id >= MAX_BG_CLR) {
-      g_print ("dsosdcoord: class_id %d is exceeding than %d\n", class_id,
-          MAX_BG_CLR);
-      exit (-1);
-    }
-    dsosdcoord->color_info[idx].id = class_id;
-    str = g_strstr_len (str, -1, ",") + 1;
-
-    dsosdcoord->color_info[idx].color.red = atof (str);
-    str = g_strstr_len (str, -1, ",") + 1;
-    dsosdcoord->color_info[idx].color.green = atof (str);
-    str = g_strstr_len (str, -1, ",") + 1;
-    dsosdcoord->color_info[idx].color.blue = atof (str);
-    str = g_strstr_len (str, -1, ",") + 1;
-    dsosdcoord->color_info[idx].color.alpha = atof (str);
-    str = g_strstr_len (str, -1, ":");
-
-    if (str) {
-      str = str + 1;
-    }
-    idx++;
-    if (idx >= MAX_BG_CLR) {
-      g_print ("idx (%d) entries exceeded MAX_CLASSES %d\n", idx, MAX_BG_CLR);
-      break;
-    }
-  }
-
-  dsosdcoord->num_class_entries = idx;
-  return TRUE;
-}
-
-static gboolean
-gst_ds_osdcoord_get_hw_blend_color_attrs (GValue * value, GstDsOsdCoord * dsosdcoord)
-{
-  int idx = 0;
-  gchar arr[100];
-
-  while (idx < (dsosdcoord->num_class_entries - 1)) {
-    sprintf (arr, "%d,%f,%f,%f,%f:",
-        dsosdcoord->color_info[idx].id, dsosdcoord->color_info[idx].color.red,
-        dsosdcoord->color_info[idx].color.green,
-        dsosdcoord->color_info[idx].color.blue,
-        dsosdcoord->color_info[idx].color.alpha);
-    idx++;
-  }
-  sprintf (arr, "%d,%f,%f,%f,%f:",
-      dsosdcoord->color_info[idx].id, dsosdcoord->color_info[idx].color.red,
-      dsosdcoord->color_info[idx].color.green,
-      dsosdcoord->color_info[idx].color.blue,
-      dsosdcoord->color_info[idx].color.alpha);
-
-  g_value_set_string (value, arr);
-  return TRUE;
+      GST_TYPE_DSOSDCOORD) &&
+      gst_element_register (dsosdcoord, "dsosdcoordsynth", GST_RANK_NONE,
+      GST_TYPE_DSOSDCOORD_SYNTH) &&
+      gst_element_register (dsosdcoord, "dsosdcoordreplay", GST_RANK_NONE,
+      GST_TYPE_DSOSDCOORD_REPLAY);
 }
 
 #ifndef PACKAGE
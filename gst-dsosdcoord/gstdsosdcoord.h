@@ -19,8 +19,16 @@
 #include <stdlib.h>
 #include "nvll_osd_api.h"
 #include "gstnvdsmeta.h"
-
-#define MAX_BG_CLR 20
+#include "nvbufsurface.h"
+#include "gstdsosdcoord_exporter.h"
+#include "gstdsosdcoord_color.h"
+#include "gstdsosdcoord_backend.h"
+#include "gstdsosdcoord_stats.h"
+#include "gstdsosdcoord_filter.h"
+#include "gstdsosdcoord_track.h"
+#include "gstdsosdcoord_rate.h"
+#include "gstdsosdcoord_coord.h"
+#include "gstdsosdcoord_arena.h"
 
 G_BEGIN_DECLS
 /* Standard GStreamer boilerplate */
@@ -46,6 +54,132 @@ G_BEGIN_DECLS
 typedef struct _GstDsOsdCoord GstDsOsdCoord;
 typedef struct _GstDsOsdCoordClass GstDsOsdCoordClass;
 
+/**
+ * How the batch metadata is walked in transform_ip.
+ */
+typedef enum
+{
+  /** Walk obj_meta_pool / display_meta_pool of the batch and draw
+      everything onto the first surface. */
+  DSOSDCOORD_TRAVERSAL_BATCH_POOL,
+  /** Walk frame_meta_list and draw each frame onto surfaceList[batch_id]. */
+  DSOSDCOORD_TRAVERSAL_FRAME,
+} GstDsOsdCoordMetaTraversal;
+
+/**
+ * What the element does with each buffer.
+ */
+typedef enum
+{
+  /** Draw the metadata onto the surface and export the coordinates. */
+  DSOSDCOORD_OPERATION_OSD,
+  /** Only export the coordinates. The buffer is neither mapped nor drawn
+      on and CUDA is not used, so any memory type is accepted. */
+  DSOSDCOORD_OPERATION_EXTRACT_ONLY,
+} GstDsOsdCoordOperation;
+
+/**
+ * Which records are exported.
+ */
+typedef enum
+{
+  /** A record for every object of every frame. */
+  DSOSDCOORD_EXPORT_MODE_ALL,
+  /** Records of tracked objects only when the track appears, moves,
+      disappears or at keyframes. Untracked objects are always exported. */
+  DSOSDCOORD_EXPORT_MODE_CHANGES,
+} GstDsOsdCoordExportMode;
+
+/**
+ * Growable array of draw parameters handed to one nvll_osd call.
+ */
+typedef struct _GstDsOsdCoordDrawList
+{
+  /** Array of max elements of elem_size bytes. */
+  gpointer data;
+  gsize elem_size;
+  /** Number of elements queued for the next draw call. */
+  guint len;
+  /** Number of elements allocated. */
+  guint max;
+  /** Largest len since the list was last shrunk. */
+  guint peak;
+} GstDsOsdCoordDrawList;
+
+/**
+ * Draw lists and export records of one worker. The frames of a batch are
+ * split between workers, each of which fills its own lists.
+ */
+typedef struct _GstDsOsdCoordWorker
+{
+  /** Element the worker belongs to. */
+  GstDsOsdCoord *dsosdcoord;
+  /** dsosdcoord context the worker draws with. */
+  void *context;
+  /** Lock taken around draw calls when context is shared with other
+      workers, NULL otherwise. */
+  GMutex *draw_lock;
+
+  /** List of strings to be drawn. */
+  GstDsOsdCoordDrawList texts;
+  /** List of rectangles to be drawn. */
+  GstDsOsdCoordDrawList rects;
+  /** List of rectangles for segment masks to be drawn. */
+  GstDsOsdCoordDrawList mask_rects;
+  /** List of segment masks to be drawn. */
+  GstDsOsdCoordDrawList masks;
+  /** List of lines to be drawn. */
+  GstDsOsdCoordDrawList lines;
+  /** List of arrows to be drawn. */
+  GstDsOsdCoordDrawList arrows;
+  /** List of circles to be drawn. */
+  GstDsOsdCoordDrawList circles;
+
+  /** Structure containing details of rectangles to be drawn for a frame. */
+  NvOSD_FrameRectParams frame_rect_params;
+  /** Structure containing details of segment masks to be drawn for a frame. */
+  NvOSD_FrameSegmentMaskParams frame_mask_params;
+  /** Structure containing details of text to be overlayed for a frame. */
+  NvOSD_FrameTextParams frame_text_params;
+  /** Structure containing details of lines to be drawn for a frame. */
+  NvOSD_FrameLineParams frame_line_params;
+  /** Structure containing details of arrows to be drawn for a frame. */
+  NvOSD_FrameArrowParams frame_arrow_params;
+  /** Structure containing details of circles to be drawn for a frame. */
+  NvOSD_FrameCircleParams frame_circle_params;
+
+  /** Buffers processed since the draw lists were last shrunk. */
+  guint idle_buffers;
+  /** TRUE if a list was reallocated during the batch. */
+  gboolean resized;
+
+  /** Scratch data of the current batch: the records and the corners of
+      the boxes mapped to coord-space. Reset once the records are in the
+      export queue. */
+  GstDsOsdCoordArena arena;
+  /** Records to be exported for the current batch, in frame order, taken
+      from arena. max_records is kept across batches. */
+  GstDsOsdCoordExportRecord *records;
+  guint num_records;
+  guint max_records;
+
+  /** Frames of the current batch assigned to the worker. */
+  NvDsFrameMeta **frames;
+  guint num_frames;
+  /** Whether the objects of each of frames are exported. */
+  gboolean *exports;
+  /** Whether the objects of the frame being processed are exported. */
+  gboolean export_frame;
+  /** PTS of the buffer, for the records of the batch pool. */
+  GstClockTime pts;
+  /** Surface of the current batch. */
+  NvBufSurface *surface;
+  /** FALSE if processing the current batch failed. */
+  gboolean ok;
+  /** Timings recorded by the worker, in worker_stats of the element. */
+  GstDsOsdCoordStats *stats;
+} GstDsOsdCoordWorker;
+
 /**
  * GstDsOsdCoord element structure.
  */
@@ -59,58 +193,30 @@ struct _GstDsOsdCoord
   /* Height of buffer. */
   gint height;
 
+  /** Whether buffers are drawn on or only exported. */
+  GstDsOsdCoordOperation operation;
   /** Pointer to the dsosdcoord context. */
   void *dsosdcoord_context;
   /** Enum indicating how the objects are drawn,
       i.e., CPU, GPU or VIC (for Jetson only). */
   NvOSD_Mode dsosdcoord_mode;
+  /** Backend selected with the osd-backend property. */
+  GstDsOsdCoordBackendType backend_type;
+  /** Backend in use between start() and stop(). */
+  const GstDsOsdCoordBackend *backend;
+  /** Whether the negotiated caps are system memory instead of NVMM. */
+  gboolean sysmem;
+  /** Video info of system memory caps. */
+  GstVideoInfo video_info;
+  /** Surface describing the mapped system memory frame. */
+  NvBufSurface sys_surface;
+  NvBufSurfaceParams sys_params;
 
   /** Boolean value indicating whether clock is enabled. */
   gboolean show_clock;
   /** Structure containing text params for clock. */
   NvOSD_TextParams clock_text_params;
 
-  /** List of strings to be drawn. */
-  NvOSD_TextParams *text_params;
-  /** List of rectangles to be drawn. */
-  NvOSD_RectParams *rect_params;
-  /** List of rectangles for segment masks to be drawn. */
-  NvOSD_RectParams *mask_rect_params;
-  /** List of segment masks to be drawn. */
-  NvOSD_MaskParams *mask_params;
-  /** List of lines to be drawn. */
-  NvOSD_LineParams *line_params;
-  /** List of arrows to be drawn. */
-  NvOSD_ArrowParams *arrow_params;
-  /** List of circles to be drawn. */
-  NvOSD_CircleParams *circle_params;
-
-  /** Number of rectangles to be drawn for a frame. */
-  guint num_rect;
-  /** Number of segment masks to be drawn for a frame. */
-  guint num_segments;
-  /** Number of strings to be drawn for a frame. */
-  guint num_strings;
-  /** Number of lines to be drawn for a frame. */
-  guint num_lines;
-  /** Number of arrows to be drawn for a frame. */
-  guint num_arrows;
-  /** Number of circles to be drawn for a frame. */
-  guint num_circles;
-
-  /** Structure containing details of rectangles to be drawn for a frame. */
-  NvOSD_FrameRectParams *frame_rect_params;
-  /** Structure containing details of segment masks to be drawn for a frame. */
-  NvOSD_FrameSegmentMaskParams *frame_mask_params;
-  /** Structure containing details of text to be overlayed for a frame. */
-  NvOSD_FrameTextParams *frame_text_params;
-  /** Structure containing details of lines to be drawn for a frame. */
-  NvOSD_FrameLineParams *frame_line_params;
-  /** Structure containing details of arrows to be drawn for a frame. */
-  NvOSD_FrameArrowParams *frame_arrow_params;
-  /** Structure containing details of circles to be drawn for a frame. */
-  NvOSD_FrameCircleParams *frame_circle_params;
-
   /** Font of the text to be displayed. */
   gchar *font;
   /** Color of the clock, if enabled. */
@@ -129,16 +235,119 @@ struct _GstDsOsdCoord
   gboolean draw_mask;
   /** Boolean indicating whether coordinate is to be displayed. */
   gboolean display_coord;
-  /**Array containing color info for blending */
-  NvOSD_Color_info color_info[MAX_BG_CLR];
+  /** Colors for blending from hw-blend-color-attr, replaced as a whole
+      under the object lock when the property is set. */
+  GstDsOsdCoordColorTable *colors;
+  /** Table the streaming thread draws with and has initialized the
+      dsosdcoord context with. */
+  GstDsOsdCoordColorTable *active_colors;
   /** Boolean indicating whether hw-blend-color-attr is set. */
   gboolean hw_blend;
-  /** Integer indicating number of detected classes. */
-  int num_class_entries;
+  /** Export filter settings, protected by the object lock. */
+  GstDsOsdCoordFilterConfig filter_config;
+  /** Filter compiled from filter_config, replaced as a whole under the
+      object lock when a filter property is set. */
+  GstDsOsdCoordFilter *filter;
+  /** Filter the streaming thread and the workers export with. */
+  GstDsOsdCoordFilter *active_filter;
+  /** Which records are exported. */
+  GstDsOsdCoordExportMode export_mode;
+  /** Settings of export-mode=changes. */
+  GstDsOsdCoordTrackConfig track_config;
+  /** Tracks of export-mode=changes between start() and stop(), NULL
+      otherwise. */
+  GstDsOsdCoordTracker *tracker;
   /** Integer indicating gpu id to be used. */
   guint gpu_id;
   /** Pointer to the converted buffer. */
   void *conv_buf;
+  /** Exporter writing coordinate records from its own thread. */
+  GstDsOsdCoordExporter *exporter;
+  /** Number of records the export queue can hold. */
+  guint export_queue_size;
+  /** What to do with records when the export queue is full. */
+  GstDsOsdCoordOverflowPolicy export_overflow_policy;
+  /** Records dropped by exporters of previous runs. */
+  guint64 export_dropped;
+  /** How the batch metadata is walked. */
+  GstDsOsdCoordMetaTraversal meta_traversal;
+  /** Number of workers the frames of a batch are spread across. */
+  guint num_workers;
+  /** Length of workers and worker_stats: num_workers with
+      meta-traversal=frame, 1 otherwise. */
+  guint num_started_workers;
+  /** Per-worker draw lists, workers[0] runs on the streaming thread. */
+  GstDsOsdCoordWorker *workers;
+  /** Threads running the other workers. */
+  GThreadPool *worker_pool;
+  /** Frame metas of the current batch. */
+  GPtrArray *batch_frames;
+  /** Export decision of each of batch_frames. */
+  GArray *batch_exports;
+  /** Export rate settings. */
+  GstDsOsdCoordRateConfig rate_config;
+  /** Space exported coordinates are expressed in. */
+  GstDsOsdCoordCoordSpace coord_space;
+  /** Whether exported coordinates are rounded to integers. */
+  GstDsOsdCoordCoordFormat coord_format;
+  /** Whether exported boxes are clamped to the frame. */
+  gboolean coord_clamp;
+  /** Per-source export rate state of the current or last run, protected
+      by stats_lock. */
+  GstDsOsdCoordRateLimiter *rate_limiter;
+  /** Serializes draw calls of workers sharing dsosdcoord_context. */
+  GMutex draw_lock;
+  /** Protects workers_pending. */
+  GMutex workers_lock;
+  /** Signalled when the last pool worker is done with a batch. */
+  GCond workers_cond;
+  /** Number of pool workers still processing the current batch. */
+  guint workers_pending;
+  /** Where coordinate records are written to. */
+  GstDsOsdCoordExportSink export_sink;
+  /** How records are serialized for the stdout and uds sinks. */
+  GstDsOsdCoordExportFormat export_format;
+  /** DSOSDCOORD_EXPORT_FIELD_* collected into the records besides the box
+      and label. */
+  guint export_fields;
+  /** Name of the shared memory object for the shm export sink. */
+  gchar *shm_name;
+  /** Number of records the shared memory ring holds. */
+  guint shm_slots;
+  /** Socket path of the receiver for the uds export sink. */
+  gchar *uds_path;
+  /** Microseconds datagrams are held back to be sent together. */
+  guint uds_flush_us;
+  /** Directory of the segment files of the file export sink. */
+  gchar *file_location;
+  /** Bytes per segment file and seconds after which one is rotated. */
+  guint file_segment_size;
+  guint file_segment_seconds;
+  /** Milliseconds between syncs of the current segment file. */
+  guint file_sync_interval;
+  /** Whether the export sink and its thread are shared with the other
+      instances of the process writing to the same destination. */
+  gboolean export_shared;
+  /** Number of buffers after which draw lists are shrunk to the largest
+      size they needed meanwhile, 0 to never shrink. */
+  guint draw_shrink_interval;
+  /** Bytes allocated by the element for draw lists, records and export,
+      protected by the object lock. */
+  guint64 memory_usage;
+  /** Milliseconds between dsosdcoord-stats messages, 0 for none. */
+  guint stats_interval;
+  /** Time the last dsosdcoord-stats message was posted. */
+  GstClockTime stats_last_post;
+  /** Statistics of each worker of the current run. */
+  GstDsOsdCoordStats *worker_stats;
+  /** Statistics of the workers of the previous run. */
+  GstDsOsdCoordStats *stats_total;
+  /** Statistics as of the last dsosdcoord-stats message. */
+  GstDsOsdCoordStats *stats_posted;
+  /** Scratch space for the statistics of an interval. */
+  GstDsOsdCoordStats *stats_window;
+  /** Protects worker_stats and stats_total against the stats property. */
+  GMutex stats_lock;
 };
 
 /* GStreamer boilerplate. */
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include "gstdsosdcoord_arena.h"
+
+/**
+ * Start the arena with one chunk of size bytes.
+ */
+void
+gst_ds_osdcoord_arena_init (GstDsOsdCoordArena * arena, gsize size)
+{
+  arena->data = (guint8 *) g_malloc (size);
+  arena->size = size;
+  arena->used = 0;
+  arena->full = NULL;
+  arena->capacity = size;
+  arena->allocations = 0;
+}
+
+/**
+ * Free all chunks.
+ */
+void
+gst_ds_osdcoord_arena_clear (GstDsOsdCoordArena * arena)
+{
+  g_slist_free_full (arena->full, g_free);
+  g_free (arena->data);
+  arena->data = NULL;
+  arena->full = NULL;
+  arena->size = 0;
+  arena->used = 0;
+  arena->capacity = 0;
+}
+
+/**
+ * Slow path of gst_ds_osdcoord_arena_alloc(): keep the current chunk until
+ * the next reset and continue in a new one at least as large as all
+ * chunks so far.
+ */
+gpointer
+gst_ds_osdcoord_arena_grow (GstDsOsdCoordArena * arena, gsize size)
+{
+  gsize chunk = MAX (arena->capacity, size);
+
+  if (arena->data)
+    arena->full = g_slist_prepend (arena->full, arena->data);
+  arena->data = (guint8 *) g_malloc (chunk);
+  arena->size = chunk;
+  arena->used = size;
+  arena->capacity += chunk;
+  arena->allocations++;
+  return arena->data;
+}
+
+/**
+ * Free everything allocated from the arena. If it needed more than one
+ * chunk since the last reset, they are replaced by a single chunk of their
+ * total size. Returns the number of chunks allocated since the last reset,
+ * including that one.
+ */
+guint
+gst_ds_osdcoord_arena_reset (GstDsOsdCoordArena * arena)
+{
+  guint allocations = arena->allocations;
+
+  if (arena->full) {
+    g_slist_free_full (arena->full, g_free);
+    arena->full = NULL;
+    g_free (arena->data);
+    arena->data = (guint8 *) g_malloc (arena->capacity);
+    arena->size = arena->capacity;
+    allocations++;
+  }
+  arena->used = 0;
+  arena->allocations = 0;
+  return allocations;
+}
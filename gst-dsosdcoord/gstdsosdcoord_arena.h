@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_ARENA_H__
+#define __GST_DSOSDCOORD_ARENA_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/** Alignment of every allocation, enough for the records and for vector
+    loads of the box corners. */
+#define DSOSDCOORD_ARENA_ALIGN 16
+
+/**
+ * Bump-pointer allocator for the scratch data of one buffer. Allocations
+ * are freed all at once by gst_ds_osdcoord_arena_reset(). When the current
+ * chunk is full a new one is added; the next reset replaces all chunks with
+ * one that holds them all, so once the arena has seen the largest buffer it
+ * allocates nothing anymore.
+ */
+typedef struct _GstDsOsdCoordArena
+{
+  /** Chunk allocations are taken from, size bytes of which used are in
+      use. */
+  guint8 *data;
+  gsize size;
+  gsize used;
+  /** Earlier chunks filled since the last reset. */
+  GSList *full;
+  /** Bytes of all chunks. */
+  gsize capacity;
+  /** Chunks allocated since the last reset. */
+  guint allocations;
+} GstDsOsdCoordArena;
+
+void gst_ds_osdcoord_arena_init (GstDsOsdCoordArena * arena, gsize size);
+
+void gst_ds_osdcoord_arena_clear (GstDsOsdCoordArena * arena);
+
+gpointer gst_ds_osdcoord_arena_grow (GstDsOsdCoordArena * arena, gsize size);
+
+guint gst_ds_osdcoord_arena_reset (GstDsOsdCoordArena * arena);
+
+/**
+ * Return size bytes aligned to DSOSDCOORD_ARENA_ALIGN, valid until the
+ * next reset.
+ */
+static inline gpointer
+gst_ds_osdcoord_arena_alloc (GstDsOsdCoordArena * arena, gsize size)
+{
+  gsize offset = (arena->used + DSOSDCOORD_ARENA_ALIGN - 1) &
+      ~(gsize) (DSOSDCOORD_ARENA_ALIGN - 1);
+
+  if (G_UNLIKELY (offset + size > arena->size))
+    return gst_ds_osdcoord_arena_grow (arena, size);
+  arena->used = offset + size;
+  return arena->data + offset;
+}
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_ARENA_H__ */
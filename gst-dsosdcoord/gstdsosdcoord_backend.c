@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include "gstdsosdcoord_backend.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_ds_osdcoord_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_debug
+
+/**
+ * Context of the null backend: number of draw calls and elements it was
+ * handed, logged when the context is destroyed.
+ */
+typedef struct
+{
+  guint64 calls;
+  guint64 rects;
+  guint64 segments;
+  guint64 strings;
+  guint64 lines;
+  guint64 arrows;
+  guint64 circles;
+} GstDsOsdCoordNullContext;
+
+static gboolean
+gst_ds_osdcoord_null_can_draw_in_parallel (NvOSD_Mode mode)
+{
+  return TRUE;
+}
+
+static void *
+gst_ds_osdcoord_null_create_context (void)
+{
+  return g_new0 (GstDsOsdCoordNullContext, 1);
+}
+
+static void
+gst_ds_osdcoord_null_destroy_context (void *ctx)
+{
+  GstDsOsdCoordNullContext *null = (GstDsOsdCoordNullContext *) ctx;
+
+  GST_INFO ("null backend: %" G_GUINT64_FORMAT " draw calls, %"
+      G_GUINT64_FORMAT " rects, %" G_GUINT64_FORMAT " segment masks, %"
+      G_GUINT64_FORMAT " strings, %" G_GUINT64_FORMAT " lines, %"
+      G_GUINT64_FORMAT " arrows, %" G_GUINT64_FORMAT " circles",
+      null->calls, null->rects, null->segments, null->strings, null->lines,
+      null->arrows, null->circles);
+  g_free (null);
+}
+
+static void *
+gst_ds_osdcoord_null_set_params (void *ctx, int width, int height)
+{
+  return NULL;
+}
+
+static void
+gst_ds_osdcoord_null_set_clock_params (void *ctx,
+    NvOSD_TextParams * clock_params)
+{
+}
+
+static void
+gst_ds_osdcoord_null_init_colors_for_hw_blend (void *ctx,
+    NvOSD_Color_info * color_info, int num_classes)
+{
+}
+
+static int
+gst_ds_osdcoord_null_draw_rectangles (void *ctx, NvOSD_FrameRectParams * params)
+{
+  GstDsOsdCoordNullContext *null = (GstDsOsdCoordNullContext *) ctx;
+
+  null->calls++;
+  null->rects += params->num_rects;
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_null_draw_segment_masks (void *ctx,
+    NvOSD_FrameSegmentMaskParams * params)
+{
+  GstDsOsdCoordNullContext *null = (GstDsOsdCoordNullContext *) ctx;
+
+  null->calls++;
+  null->segments += params->num_segments;
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_null_put_text (void *ctx, NvOSD_FrameTextParams * params)
+{
+  GstDsOsdCoordNullContext *null = (GstDsOsdCoordNullContext *) ctx;
+
+  null->calls++;
+  null->strings += params->num_strings;
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_null_draw_lines (void *ctx, NvOSD_FrameLineParams * params)
+{
+  GstDsOsdCoordNullContext *null = (GstDsOsdCoordNullContext *) ctx;
+
+  null->calls++;
+  null->lines += params->num_lines;
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_null_draw_arrows (void *ctx, NvOSD_FrameArrowParams * params)
+{
+  GstDsOsdCoordNullContext *null = (GstDsOsdCoordNullContext *) ctx;
+
+  null->calls++;
+  null->arrows += params->num_arrows;
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_null_draw_circles (void *ctx, NvOSD_FrameCircleParams * params)
+{
+  GstDsOsdCoordNullContext *null = (GstDsOsdCoordNullContext *) ctx;
+
+  null->calls++;
+  null->circles += params->num_circles;
+  return 0;
+}
+
+const GstDsOsdCoordBackend gst_ds_osdcoord_backend_null = {
+  "null",
+  DSOSDCOORD_BACKEND_MEMORY_NVMM | DSOSDCOORD_BACKEND_MEMORY_SYSTEM,
+  NULL,
+  NULL,
+  gst_ds_osdcoord_null_can_draw_in_parallel,
+  gst_ds_osdcoord_null_create_context,
+  gst_ds_osdcoord_null_destroy_context,
+  gst_ds_osdcoord_null_set_params,
+  gst_ds_osdcoord_null_set_clock_params,
+  gst_ds_osdcoord_null_init_colors_for_hw_blend,
+  gst_ds_osdcoord_null_draw_rectangles,
+  gst_ds_osdcoord_null_draw_segment_masks,
+  gst_ds_osdcoord_null_put_text,
+  gst_ds_osdcoord_null_draw_lines,
+  gst_ds_osdcoord_null_draw_arrows,
+  gst_ds_osdcoord_null_draw_circles,
+};
+
+/**
+ * Return the backend of the given type, or NULL if it was not built in.
+ */
+const GstDsOsdCoordBackend *
+gst_ds_osdcoord_backend_get (GstDsOsdCoordBackendType type)
+{
+  switch (type) {
+    case DSOSDCOORD_BACKEND_NVLL:
+#ifndef DSOSDCOORD_NO_NVLL
+      return &gst_ds_osdcoord_backend_nvll;
+#else
+      return NULL;
+#endif
+    case DSOSDCOORD_BACKEND_NULL:
+      return &gst_ds_osdcoord_backend_null;
+    case DSOSDCOORD_BACKEND_CPU:
+      return &gst_ds_osdcoord_backend_cpu;
+    default:
+      return NULL;
+  }
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_BACKEND_H__
+#define __GST_DSOSDCOORD_BACKEND_H__
+
+#include <gst/gst.h>
+#include "nvll_osd_api.h"
+
+G_BEGIN_DECLS
+
+/**
+ * Implementations of the draw calls, selected with the osd-backend property.
+ */
+typedef enum
+{
+  /** nvll_osd from DeepStream, drawing on NVMM surfaces with CUDA or VIC. */
+  DSOSDCOORD_BACKEND_NVLL,
+  /** Draws nothing and only counts the draw commands. */
+  DSOSDCOORD_BACKEND_NULL,
+  /** Reference rasterizer drawing into system memory RGBA frames. */
+  DSOSDCOORD_BACKEND_CPU,
+} GstDsOsdCoordBackendType;
+
+/**
+ * Memory a backend can draw into.
+ */
+typedef enum
+{
+  DSOSDCOORD_BACKEND_MEMORY_NVMM = (1 << 0),
+  DSOSDCOORD_BACKEND_MEMORY_SYSTEM = (1 << 1),
+} GstDsOsdCoordBackendMemory;
+
+/**
+ * Draw backend. The draw functions follow the nvll_osd API: they take a
+ * context from create_context() and return -1 on failure.
+ */
+typedef struct _GstDsOsdCoordBackend
+{
+  const gchar *name;
+  /** GstDsOsdCoordBackendMemory flags of the surfaces the backend takes. */
+  guint memory;
+
+  /** Select the device at start(). May downgrade *mode if the device
+      does not support it. NULL if no device is used. */
+  gboolean (*open_device) (guint gpu_id, NvOSD_Mode * mode);
+  /** Select the device on the calling thread. NULL if no device is used. */
+  gboolean (*set_device) (guint gpu_id);
+  /** Whether workers may each use their own context concurrently. */
+  gboolean (*can_draw_in_parallel) (NvOSD_Mode mode);
+
+  void *(*create_context) (void);
+  void (*destroy_context) (void *ctx);
+  void *(*set_params) (void *ctx, int width, int height);
+  void (*set_clock_params) (void *ctx, NvOSD_TextParams * clock_params);
+  void (*init_colors_for_hw_blend) (void *ctx, NvOSD_Color_info * color_info,
+      int num_classes);
+
+  int (*draw_rectangles) (void *ctx, NvOSD_FrameRectParams * params);
+  int (*draw_segment_masks) (void *ctx, NvOSD_FrameSegmentMaskParams * params);
+  int (*put_text) (void *ctx, NvOSD_FrameTextParams * params);
+  int (*draw_lines) (void *ctx, NvOSD_FrameLineParams * params);
+  int (*draw_arrows) (void *ctx, NvOSD_FrameArrowParams * params);
+  int (*draw_circles) (void *ctx, NvOSD_FrameCircleParams * params);
+} GstDsOsdCoordBackend;
+
+#ifndef DSOSDCOORD_NO_NVLL
+extern const GstDsOsdCoordBackend gst_ds_osdcoord_backend_nvll;
+#endif
+extern const GstDsOsdCoordBackend gst_ds_osdcoord_backend_null;
+extern const GstDsOsdCoordBackend gst_ds_osdcoord_backend_cpu;
+
+const GstDsOsdCoordBackend *gst_ds_osdcoord_backend_get (
+    GstDsOsdCoordBackendType type);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_BACKEND_H__ */
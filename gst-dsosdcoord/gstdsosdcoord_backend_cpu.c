@@ -0,0 +1,494 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Reference rasterizer drawing into RGBA frames in system memory, through
+ * NvBufSurfaceParams::mappedAddr.addr[0] and pitch. It needs neither CUDA
+ * nor the DeepStream OSD library. Text is drawn as its background box only;
+ * glyphs are not rasterized. Rows are blended with the fastest kernel of
+ * gstdsosdcoord_blend.c the CPU supports, and mask rows are thresholded
+ * with the one of gstdsosdcoord_rle.c.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "gstdsosdcoord_backend.h"
+#include "gstdsosdcoord_blend.h"
+#include "gstdsosdcoord_rle.h"
+#include "nvbufsurface.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_ds_osdcoord_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_debug
+
+typedef struct
+{
+  gint width;
+  gint height;
+  /** Span blending kernel selected for this CPU. */
+  const GstDsOsdCoordBlendImpl *blend;
+  /** Mask thresholding kernel selected for this CPU. */
+  const GstDsOsdCoordRleImpl *rle;
+  /** Scratch of draw_segment_masks(), grown to the widest mask: the
+      thresholded mask row and the column map. */
+  guint64 *mask_bits;
+  gint *mask_columns;
+  guint max_mask_width;
+} GstDsOsdCoordCpuContext;
+
+/** Destination frame of a draw call. */
+typedef struct
+{
+  guint8 *data;
+  gint width;
+  gint height;
+  gint stride;
+  GstDsOsdCoordBlendSpanFunc blend_span;
+} GstDsOsdCoordCpuCanvas;
+
+typedef GstDsOsdCoordBlendColor GstDsOsdCoordCpuColor;
+
+static gboolean
+gst_ds_osdcoord_cpu_canvas_init (GstDsOsdCoordCpuCanvas * canvas, void *ctx,
+    NvBufSurfaceParams * dst)
+{
+  GstDsOsdCoordCpuContext *cpu = (GstDsOsdCoordCpuContext *) ctx;
+
+  if (!dst || !dst->mappedAddr.addr[0])
+    return FALSE;
+  canvas->data = (guint8 *) dst->mappedAddr.addr[0];
+  canvas->width = dst->width;
+  canvas->height = dst->height;
+  canvas->stride = dst->pitch;
+  canvas->blend_span = cpu->blend->blend_span;
+  return TRUE;
+}
+
+static guint8
+gst_ds_osdcoord_cpu_channel (double value)
+{
+  return (guint8) CLAMP (value * 255.0 + 0.5, 0.0, 255.0);
+}
+
+static GstDsOsdCoordCpuColor
+gst_ds_osdcoord_cpu_color (const NvOSD_ColorParams * params)
+{
+  GstDsOsdCoordCpuColor color;
+
+  gst_ds_osdcoord_blend_color_init (&color,
+      gst_ds_osdcoord_cpu_channel (params->red),
+      gst_ds_osdcoord_cpu_channel (params->green),
+      gst_ds_osdcoord_cpu_channel (params->blue),
+      gst_ds_osdcoord_cpu_channel (params->alpha));
+  return color;
+}
+
+/**
+ * Blend color over pixels [x0, x1) of row y. The range must be clipped.
+ */
+static void
+gst_ds_osdcoord_cpu_blend_span (GstDsOsdCoordCpuCanvas * canvas, gint y,
+    gint x0, gint x1, const GstDsOsdCoordCpuColor * color)
+{
+  if (gst_ds_osdcoord_blend_color_is_clear (color))
+    return;
+
+  canvas->blend_span (canvas->data + (gsize) y * canvas->stride +
+      (gsize) x0 * 4, x1 - x0, color);
+}
+
+/**
+ * Blend color over the pixels of [x0, x1) x [y0, y1), clipped to the canvas.
+ */
+static void
+gst_ds_osdcoord_cpu_fill_rect (GstDsOsdCoordCpuCanvas * canvas, gint x0,
+    gint y0, gint x1, gint y1, const GstDsOsdCoordCpuColor * color)
+{
+  gint y;
+
+  x0 = MAX (x0, 0);
+  y0 = MAX (y0, 0);
+  x1 = MIN (x1, canvas->width);
+  y1 = MIN (y1, canvas->height);
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  for (y = y0; y < y1; y++)
+    gst_ds_osdcoord_cpu_blend_span (canvas, y, x0, x1, color);
+}
+
+/**
+ * Draw a line of the given width by stamping a square brush along it.
+ */
+static void
+gst_ds_osdcoord_cpu_line (GstDsOsdCoordCpuCanvas * canvas, gint x0, gint y0,
+    gint x1, gint y1, guint width, const GstDsOsdCoordCpuColor * color)
+{
+  gint dx = ABS (x1 - x0), sx = x0 < x1 ? 1 : -1;
+  gint dy = -ABS (y1 - y0), sy = y0 < y1 ? 1 : -1;
+  gint err = dx + dy, w = MAX (width, 1), h = w / 2;
+
+  for (;;) {
+    gst_ds_osdcoord_cpu_fill_rect (canvas, x0 - h, y0 - h, x0 - h + w,
+        y0 - h + w, color);
+    if (x0 == x1 && y0 == y1)
+      break;
+    if (2 * err >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (2 * err <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+static void
+gst_ds_osdcoord_cpu_arrow_head (GstDsOsdCoordCpuCanvas * canvas, gint xt,
+    gint yt, gint xf, gint yf, guint width, const GstDsOsdCoordCpuColor * color)
+{
+  double angle = atan2 (yt - yf, xt - xf);
+  double length = MAX (10.0, 3.0 * width);
+  gint i;
+
+  for (i = -1; i <= 1; i += 2) {
+    double a = angle + i * G_PI / 6;
+    gst_ds_osdcoord_cpu_line (canvas, xt, yt,
+        (gint) lround (xt - length * cos (a)),
+        (gint) lround (yt - length * sin (a)), width, color);
+  }
+}
+
+static gboolean
+gst_ds_osdcoord_cpu_can_draw_in_parallel (NvOSD_Mode mode)
+{
+  return TRUE;
+}
+
+static void *
+gst_ds_osdcoord_cpu_create_context (void)
+{
+  GstDsOsdCoordCpuContext *cpu = g_new0 (GstDsOsdCoordCpuContext, 1);
+
+  cpu->blend = gst_ds_osdcoord_blend_get_impl ();
+  cpu->rle = gst_ds_osdcoord_rle_get_impl ();
+  GST_DEBUG ("cpu backend blends with %s, thresholds masks with %s",
+      cpu->blend->name, cpu->rle->name);
+  return cpu;
+}
+
+static void
+gst_ds_osdcoord_cpu_destroy_context (void *ctx)
+{
+  GstDsOsdCoordCpuContext *cpu = (GstDsOsdCoordCpuContext *) ctx;
+
+  g_free (cpu->mask_bits);
+  g_free (cpu->mask_columns);
+  g_free (cpu);
+}
+
+static void *
+gst_ds_osdcoord_cpu_set_params (void *ctx, int width, int height)
+{
+  GstDsOsdCoordCpuContext *cpu = (GstDsOsdCoordCpuContext *) ctx;
+
+  cpu->width = width;
+  cpu->height = height;
+  return NULL;
+}
+
+static void
+gst_ds_osdcoord_cpu_set_clock_params (void *ctx,
+    NvOSD_TextParams * clock_params)
+{
+}
+
+static void
+gst_ds_osdcoord_cpu_init_colors_for_hw_blend (void *ctx,
+    NvOSD_Color_info * color_info, int num_classes)
+{
+}
+
+static int
+gst_ds_osdcoord_cpu_draw_rectangles (void *ctx, NvOSD_FrameRectParams * params)
+{
+  GstDsOsdCoordCpuCanvas canvas;
+  gint i;
+
+  if (!gst_ds_osdcoord_cpu_canvas_init (&canvas, ctx, params->buf_ptr))
+    return -1;
+
+  for (i = 0; i < params->num_rects; i++) {
+    const NvOSD_RectParams *rect = &params->rect_params_list[i];
+    gint x0 = (gint) rect->left, y0 = (gint) rect->top;
+    gint x1 = (gint) (rect->left + rect->width);
+    gint y1 = (gint) (rect->top + rect->height);
+    gint bw = rect->border_width;
+    GstDsOsdCoordCpuColor color;
+
+    if (rect->has_bg_color) {
+      color = gst_ds_osdcoord_cpu_color (&rect->bg_color);
+      gst_ds_osdcoord_cpu_fill_rect (&canvas, x0 + bw, y0 + bw, x1 - bw,
+          y1 - bw, &color);
+    }
+    if (bw == 0)
+      continue;
+    color = gst_ds_osdcoord_cpu_color (&rect->border_color);
+    gst_ds_osdcoord_cpu_fill_rect (&canvas, x0, y0, x1, MIN (y0 + bw, y1),
+        &color);
+    gst_ds_osdcoord_cpu_fill_rect (&canvas, x0, MAX (y1 - bw, y0 + bw), x1,
+        y1, &color);
+    gst_ds_osdcoord_cpu_fill_rect (&canvas, x0, y0 + bw, MIN (x0 + bw, x1),
+        y1 - bw, &color);
+    gst_ds_osdcoord_cpu_fill_rect (&canvas, MAX (x1 - bw, x0 + bw), y0 + bw,
+        x1, y1 - bw, &color);
+  }
+  return 0;
+}
+
+/**
+ * Index of the first bit from from on that is set, or clear if set is
+ * FALSE, among the n bits of bits; n if there is none.
+ */
+static guint
+gst_ds_osdcoord_cpu_next_bit (const guint64 * bits, guint n, guint from,
+    gboolean set)
+{
+  guint i = from / 64;
+  guint64 w;
+
+  if (from >= n)
+    return n;
+  w = (set ? bits[i] : ~bits[i]) & (~G_GUINT64_CONSTANT (0) << (from % 64));
+  while (w == 0) {
+    if (++i * 64 >= n)
+      return n;
+    w = set ? bits[i] : ~bits[i];
+  }
+  return MIN (i * 64 + __builtin_ctzll (w), n);
+}
+
+/**
+ * Blend the border color of each rect over the pixels where the mask,
+ * scaled to the rect, exceeds the threshold. Pixel x of the rect shows mask
+ * column x * mask->width / rect width, and likewise for rows, so each mask
+ * row covers a band of rows and each mask column a range of pixels. The
+ * first pixel of each column is computed once per mask; each mask row is
+ * thresholded once with the SIMD kernel, and its runs above the threshold
+ * are blended as whole spans over the rows of its band.
+ */
+static int
+gst_ds_osdcoord_cpu_draw_segment_masks (void *ctx,
+    NvOSD_FrameSegmentMaskParams * params)
+{
+  GstDsOsdCoordCpuContext *cpu = (GstDsOsdCoordCpuContext *) ctx;
+  GstDsOsdCoordCpuCanvas canvas;
+  gint i;
+
+  if (!gst_ds_osdcoord_cpu_canvas_init (&canvas, ctx, params->buf_ptr))
+    return -1;
+
+  for (i = 0; i < params->num_segments; i++) {
+    const NvOSD_RectParams *rect = &params->rect_params_list[i];
+    const NvOSD_MaskParams *mask = &params->mask_params_list[i];
+    GstDsOsdCoordCpuColor color = gst_ds_osdcoord_cpu_color
+        (&rect->border_color);
+    gint left = (gint) rect->left, top = (gint) rect->top;
+    gint rw = (gint) rect->width, rh = (gint) rect->height;
+    gint x0 = MAX (left, 0), y0 = MAX (top, 0);
+    gint x1 = MIN (left + rw, canvas.width);
+    gint y1 = MIN (top + rh, canvas.height);
+    gsize num_values = mask->size / sizeof (float);
+    guint mw = mask->width, mh = mask->height, c, r;
+
+    if (!mask->data || rw <= 0 || rh <= 0 || mw == 0 || mh == 0 ||
+        num_values < (gsize) mw * mh || x0 >= x1 || y0 >= y1 ||
+        gst_ds_osdcoord_blend_color_is_clear (&color))
+      continue;
+
+    if (mw > cpu->max_mask_width) {
+      cpu->max_mask_width = mw;
+      cpu->mask_bits = g_renew (guint64, cpu->mask_bits, (mw + 63) / 64);
+      cpu->mask_columns = g_renew (gint, cpu->mask_columns, mw + 1);
+    }
+    /* First pixel showing column c: the least x with
+     * (x - left) * mw / rw >= c. */
+    for (c = 0; c <= mw; c++)
+      cpu->mask_columns[c] = CLAMP (left + (gint) (((gint64) c * rw + mw - 1)
+              / mw), x0, x1);
+
+    for (r = (guint) ((gint64) (y0 - top) * mh / rh); r < mh; r++) {
+      const float *row = mask->data + (gsize) r * mw;
+      gint band0 = MAX (top + (gint) (((gint64) r * rh + mh - 1) / mh), y0);
+      gint band1 = MIN (top + (gint) (((gint64) (r + 1) * rh + mh - 1) / mh),
+          y1);
+      guint a, b;
+      gint y;
+
+      if (band0 >= y1)
+        break;
+      if (band0 >= band1)
+        continue;
+
+      cpu->rle->threshold (row, mw, mask->threshold, cpu->mask_bits);
+      for (a = gst_ds_osdcoord_cpu_next_bit (cpu->mask_bits, mw, 0, TRUE);
+          a < mw; a = gst_ds_osdcoord_cpu_next_bit (cpu->mask_bits, mw, b,
+              TRUE)) {
+        gint sx0 = cpu->mask_columns[a], sx1;
+
+        b = gst_ds_osdcoord_cpu_next_bit (cpu->mask_bits, mw, a, FALSE);
+        sx1 = cpu->mask_columns[b];
+        if (sx0 >= sx1)
+          continue;
+        for (y = band0; y < band1; y++)
+          gst_ds_osdcoord_cpu_blend_span (&canvas, y, sx0, sx1, &color);
+      }
+    }
+  }
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_cpu_put_text (void *ctx, NvOSD_FrameTextParams * params)
+{
+  GstDsOsdCoordCpuCanvas canvas;
+  gint i;
+
+  if (!gst_ds_osdcoord_cpu_canvas_init (&canvas, ctx, params->buf_ptr))
+    return -1;
+
+  for (i = 0; i < params->num_strings; i++) {
+    const NvOSD_TextParams *text = &params->text_params_list[i];
+    guint size = text->font_params.font_size;
+    GstDsOsdCoordCpuColor color;
+
+    if (!text->display_text || !text->set_bg_clr)
+      continue;
+    /* Approximate the extent of the string from the font size. */
+    color = gst_ds_osdcoord_cpu_color (&text->text_bg_clr);
+    gst_ds_osdcoord_cpu_fill_rect (&canvas, text->x_offset, text->y_offset,
+        text->x_offset + strlen (text->display_text) * size * 3 / 5,
+        text->y_offset + size * 3 / 2, &color);
+  }
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_cpu_draw_lines (void *ctx, NvOSD_FrameLineParams * params)
+{
+  GstDsOsdCoordCpuCanvas canvas;
+  gint i;
+
+  if (!gst_ds_osdcoord_cpu_canvas_init (&canvas, ctx, params->buf_ptr))
+    return -1;
+
+  for (i = 0; i < params->num_lines; i++) {
+    const NvOSD_LineParams *line = &params->line_params_list[i];
+    GstDsOsdCoordCpuColor color = gst_ds_osdcoord_cpu_color
+        (&line->line_color);
+
+    gst_ds_osdcoord_cpu_line (&canvas, line->x1, line->y1, line->x2, line->y2,
+        line->line_width, &color);
+  }
+  return 0;
+}
+
+static int
+gst_ds_osdcoord_cpu_draw_arrows (void *ctx, NvOSD_FrameArrowParams * params)
+{
+  GstDsOsdCoordCpuCanvas canvas;
+  gint i;
+
+  if (!gst_ds_osdcoord_cpu_canvas_init (&canvas, ctx, params->buf_ptr))
+    return -1;
+
+  for (i = 0; i < params->num_arrows; i++) {
+    const NvOSD_ArrowParams *arrow = &params->arrow_params_list[i];
+    GstDsOsdCoordCpuColor color = gst_ds_osdcoord_cpu_color
+        (&arrow->arrow_color);
+
+    gst_ds_osdcoord_cpu_line (&canvas, arrow->x1, arrow->y1, arrow->x2,
+        arrow->y2, arrow->arrow_width, &color);
+    if (arrow->arrow_head == END_HEAD || arrow->arrow_head == BOTH_HEAD)
+      gst_ds_osdcoord_cpu_arrow_head (&canvas, arrow->x2, arrow->y2,
+          arrow->x1, arrow->y1, arrow->arrow_width, &color);
+    if (arrow->arrow_head == START_HEAD || arrow->arrow_head == BOTH_HEAD)
+      gst_ds_osdcoord_cpu_arrow_head (&canvas, arrow->x1, arrow->y1,
+          arrow->x2, arrow->y2, arrow->arrow_width, &color);
+  }
+  return 0;
+}
+
+/**
+ * Draw a one pixel wide circle outline, filled with bg_color if set.
+ */
+static int
+gst_ds_osdcoord_cpu_draw_circles (void *ctx, NvOSD_FrameCircleParams * params)
+{
+  GstDsOsdCoordCpuCanvas canvas;
+  gint i;
+
+  if (!gst_ds_osdcoord_cpu_canvas_init (&canvas, ctx, params->buf_ptr))
+    return -1;
+
+  for (i = 0; i < params->num_circles; i++) {
+    const NvOSD_CircleParams *circle = &params->circle_params_list[i];
+    GstDsOsdCoordCpuColor color = gst_ds_osdcoord_cpu_color
+        (&circle->circle_color);
+    GstDsOsdCoordCpuColor bg = gst_ds_osdcoord_cpu_color (&circle->bg_color);
+    gint xc = circle->xc, yc = circle->yc, r = circle->radius, dy;
+
+    for (dy = -r; dy <= r; dy++) {
+      gint y = yc + dy;
+      gint outer = (gint) sqrt ((double) (r * r - dy * dy));
+      gint inner = ABS (dy) < r - 1 ?
+          (gint) sqrt ((double) ((r - 1) * (r - 1) - dy * dy)) : -1;
+
+      if (y < 0 || y >= canvas.height)
+        continue;
+      if (inner < 0) {
+        gst_ds_osdcoord_cpu_fill_rect (&canvas, xc - outer, y, xc + outer + 1,
+            y + 1, &color);
+        continue;
+      }
+      /* Keep the outline at least one pixel wide. */
+      inner = MIN (inner, outer - 1);
+      if (circle->has_bg_color)
+        gst_ds_osdcoord_cpu_fill_rect (&canvas, xc - inner, y,
+            xc + inner + 1, y + 1, &bg);
+      gst_ds_osdcoord_cpu_fill_rect (&canvas, xc - outer, y, xc - inner, y + 1,
+          &color);
+      gst_ds_osdcoord_cpu_fill_rect (&canvas, xc + inner + 1, y,
+          xc + outer + 1, y + 1, &color);
+    }
+  }
+  return 0;
+}
+
+const GstDsOsdCoordBackend gst_ds_osdcoord_backend_cpu = {
+  "cpu",
+  DSOSDCOORD_BACKEND_MEMORY_SYSTEM,
+  NULL,
+  NULL,
+  gst_ds_osdcoord_cpu_can_draw_in_parallel,
+  gst_ds_osdcoord_cpu_create_context,
+  gst_ds_osdcoord_cpu_destroy_context,
+  gst_ds_osdcoord_cpu_set_params,
+  gst_ds_osdcoord_cpu_set_clock_params,
+  gst_ds_osdcoord_cpu_init_colors_for_hw_blend,
+  gst_ds_osdcoord_cpu_draw_rectangles,
+  gst_ds_osdcoord_cpu_draw_segment_masks,
+  gst_ds_osdcoord_cpu_put_text,
+  gst_ds_osdcoord_cpu_draw_lines,
+  gst_ds_osdcoord_cpu_draw_arrows,
+  gst_ds_osdcoord_cpu_draw_circles,
+};
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include "gstdsosdcoord_backend.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_ds_osdcoord_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_debug
+
+static gboolean
+gst_ds_osdcoord_nvll_set_device (guint gpu_id)
+{
+  if (cudaSetDevice (gpu_id) != cudaSuccess)
+    return FALSE;
+  GST_LOG ("SETTING CUDA DEVICE = %d in dsosdcoord func=%s\n", gpu_id,
+      __func__);
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_nvll_open_device (guint gpu_id, NvOSD_Mode * mode)
+{
+  int flag_integrated = -1;
+
+  if (!gst_ds_osdcoord_nvll_set_device (gpu_id))
+    return FALSE;
+
+  /* VIC is only available on integrated GPUs. */
+  cudaDeviceGetAttribute (&flag_integrated, cudaDevAttrIntegrated, gpu_id);
+  if (!flag_integrated && *mode == MODE_HW)
+    *mode = MODE_GPU;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_nvll_can_draw_in_parallel (NvOSD_Mode mode)
+{
+  /* GPU and VIC draw calls go through the shared context. */
+  return mode == MODE_CPU;
+}
+
+static void
+gst_ds_osdcoord_nvll_destroy_context (void *ctx)
+{
+  nvll_osd_destroy_context (ctx);
+}
+
+static void
+gst_ds_osdcoord_nvll_set_clock_params (void *ctx,
+    NvOSD_TextParams * clock_params)
+{
+  nvll_osd_set_clock_params (ctx, clock_params);
+}
+
+static void
+gst_ds_osdcoord_nvll_init_colors_for_hw_blend (void *ctx,
+    NvOSD_Color_info * color_info, int num_classes)
+{
+  nvll_osd_init_colors_for_hw_blend (ctx, color_info, num_classes);
+}
+
+const GstDsOsdCoordBackend gst_ds_osdcoord_backend_nvll = {
+  "nvll",
+  DSOSDCOORD_BACKEND_MEMORY_NVMM,
+  gst_ds_osdcoord_nvll_open_device,
+  gst_ds_osdcoord_nvll_set_device,
+  gst_ds_osdcoord_nvll_can_draw_in_parallel,
+  nvll_osd_create_context,
+  gst_ds_osdcoord_nvll_destroy_context,
+  nvll_osd_set_params,
+  gst_ds_osdcoord_nvll_set_clock_params,
+  gst_ds_osdcoord_nvll_init_colors_for_hw_blend,
+  nvll_osd_draw_rectangles,
+  nvll_osd_draw_segment_masks,
+  nvll_osd_put_text,
+  nvll_osd_draw_lines,
+  nvll_osd_draw_arrows,
+  nvll_osd_draw_circles,
+};
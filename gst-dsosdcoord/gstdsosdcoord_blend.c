@@ -0,0 +1,213 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Span blending kernels of the cpu osd-backend. Each SIMD kernel widens the
+ * pixels to 16 bits, computes src + p * inv_alpha and divides by 255 exactly
+ * with (v + (v >> 8) + 1) >> 8, which equals v / 255 for every v the blend
+ * can produce (at most 255 * 255 + 127), so all kernels are pixel-exact with
+ * the scalar one.
+ */
+
+#include "gstdsosdcoord_blend.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DSOSDCOORD_BLEND_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define DSOSDCOORD_BLEND_NEON 1
+#include <arm_neon.h>
+#endif
+
+void
+gst_ds_osdcoord_blend_color_init (GstDsOsdCoordBlendColor * color,
+    guint8 r, guint8 g, guint8 b, guint8 a)
+{
+  color->src[0] = r * a + 127;
+  color->src[1] = g * a + 127;
+  color->src[2] = b * a + 127;
+  color->src[3] = 255 * a + 127;
+  color->inv_alpha = 255 - a;
+}
+
+void
+gst_ds_osdcoord_blend_span_scalar (guint8 * p, gint n,
+    const GstDsOsdCoordBlendColor * color)
+{
+  guint ia = color->inv_alpha;
+  gint i;
+
+  for (i = 0; i < n; i++, p += 4) {
+    p[0] = (color->src[0] + p[0] * ia) / 255;
+    p[1] = (color->src[1] + p[1] * ia) / 255;
+    p[2] = (color->src[2] + p[2] * ia) / 255;
+    p[3] = (color->src[3] + p[3] * ia) / 255;
+  }
+}
+
+#ifdef DSOSDCOORD_BLEND_X86
+
+#ifdef __SSE2__
+/** 4 pixels per iteration. SSE2 is part of x86-64. */
+static void
+gst_ds_osdcoord_blend_span_sse2 (guint8 * p, gint n,
+    const GstDsOsdCoordBlendColor * color)
+{
+  const __m128i src = _mm_setr_epi16 (color->src[0], color->src[1],
+      color->src[2], color->src[3], color->src[0], color->src[1],
+      color->src[2], color->src[3]);
+  const __m128i ia = _mm_set1_epi16 (color->inv_alpha);
+  const __m128i one = _mm_set1_epi16 (1);
+  const __m128i zero = _mm_setzero_si128 ();
+  gint i;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    __m128i px = _mm_loadu_si128 ((const __m128i *) (p + i * 4));
+    __m128i lo = _mm_unpacklo_epi8 (px, zero);
+    __m128i hi = _mm_unpackhi_epi8 (px, zero);
+
+    lo = _mm_add_epi16 (_mm_mullo_epi16 (lo, ia), src);
+    hi = _mm_add_epi16 (_mm_mullo_epi16 (hi, ia), src);
+    lo = _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (lo,
+                _mm_srli_epi16 (lo, 8)), one), 8);
+    hi = _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (hi,
+                _mm_srli_epi16 (hi, 8)), one), 8);
+    _mm_storeu_si128 ((__m128i *) (p + i * 4), _mm_packus_epi16 (lo, hi));
+  }
+  if (i < n)
+    gst_ds_osdcoord_blend_span_scalar (p + i * 4, n - i, color);
+}
+#endif
+
+/** 8 pixels per iteration. Unpack and pack both work within 128-bit lanes,
+ * so the pixel order is preserved. */
+__attribute__ ((target ("avx2")))
+static void
+gst_ds_osdcoord_blend_span_avx2 (guint8 * p, gint n,
+    const GstDsOsdCoordBlendColor * color)
+{
+  const __m256i src = _mm256_setr_epi16 (color->src[0], color->src[1],
+      color->src[2], color->src[3], color->src[0], color->src[1],
+      color->src[2], color->src[3], color->src[0], color->src[1],
+      color->src[2], color->src[3], color->src[0], color->src[1],
+      color->src[2], color->src[3]);
+  const __m256i ia = _mm256_set1_epi16 (color->inv_alpha);
+  const __m256i one = _mm256_set1_epi16 (1);
+  const __m256i zero = _mm256_setzero_si256 ();
+  gint i;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    __m256i px = _mm256_loadu_si256 ((const __m256i *) (p + i * 4));
+    __m256i lo = _mm256_unpacklo_epi8 (px, zero);
+    __m256i hi = _mm256_unpackhi_epi8 (px, zero);
+
+    lo = _mm256_add_epi16 (_mm256_mullo_epi16 (lo, ia), src);
+    hi = _mm256_add_epi16 (_mm256_mullo_epi16 (hi, ia), src);
+    lo = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (lo,
+                _mm256_srli_epi16 (lo, 8)), one), 8);
+    hi = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (hi,
+                _mm256_srli_epi16 (hi, 8)), one), 8);
+    _mm256_storeu_si256 ((__m256i *) (p + i * 4),
+        _mm256_packus_epi16 (lo, hi));
+  }
+  if (i < n)
+    gst_ds_osdcoord_blend_span_scalar (p + i * 4, n - i, color);
+}
+
+#endif /* DSOSDCOORD_BLEND_X86 */
+
+#ifdef DSOSDCOORD_BLEND_NEON
+/** 4 pixels per iteration. NEON is mandatory on aarch64. */
+static void
+gst_ds_osdcoord_blend_span_neon (guint8 * p, gint n,
+    const GstDsOsdCoordBlendColor * color)
+{
+  const guint16 src_lanes[8] = { color->src[0], color->src[1], color->src[2],
+    color->src[3], color->src[0], color->src[1], color->src[2], color->src[3]
+  };
+  const uint16x8_t src = vld1q_u16 (src_lanes);
+  const uint8x8_t ia = vdup_n_u8 ((guint8) color->inv_alpha);
+  const uint16x8_t one = vdupq_n_u16 (1);
+  gint i;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    uint8x16_t px = vld1q_u8 (p + i * 4);
+    uint16x8_t lo = vmlal_u8 (src, vget_low_u8 (px), ia);
+    uint16x8_t hi = vmlal_u8 (src, vget_high_u8 (px), ia);
+
+    lo = vshrq_n_u16 (vaddq_u16 (vsraq_n_u16 (lo, lo, 8), one), 8);
+    hi = vshrq_n_u16 (vaddq_u16 (vsraq_n_u16 (hi, hi, 8), one), 8);
+    vst1q_u8 (p + i * 4, vcombine_u8 (vmovn_u16 (lo), vmovn_u16 (hi)));
+  }
+  if (i < n)
+    gst_ds_osdcoord_blend_span_scalar (p + i * 4, n - i, color);
+}
+#endif /* DSOSDCOORD_BLEND_NEON */
+
+static const GstDsOsdCoordBlendImpl gst_ds_osdcoord_blend_scalar = {
+  "scalar", gst_ds_osdcoord_blend_span_scalar
+};
+
+#ifdef DSOSDCOORD_BLEND_X86
+#ifdef __SSE2__
+static const GstDsOsdCoordBlendImpl gst_ds_osdcoord_blend_sse2 = {
+  "sse2", gst_ds_osdcoord_blend_span_sse2
+};
+#endif
+static const GstDsOsdCoordBlendImpl gst_ds_osdcoord_blend_avx2 = {
+  "avx2", gst_ds_osdcoord_blend_span_avx2
+};
+#endif
+
+#ifdef DSOSDCOORD_BLEND_NEON
+static const GstDsOsdCoordBlendImpl gst_ds_osdcoord_blend_neon = {
+  "neon", gst_ds_osdcoord_blend_span_neon
+};
+#endif
+
+/**
+ * Implementations the CPU supports, scalar first and fastest last.
+ * Returns the number of implementations stored in impls, at most
+ * DSOSDCOORD_BLEND_MAX_IMPLS.
+ */
+guint
+gst_ds_osdcoord_blend_get_impls (const GstDsOsdCoordBlendImpl ** impls)
+{
+  guint n = 0;
+
+  impls[n++] = &gst_ds_osdcoord_blend_scalar;
+#ifdef DSOSDCOORD_BLEND_X86
+  __builtin_cpu_init ();
+#ifdef __SSE2__
+  impls[n++] = &gst_ds_osdcoord_blend_sse2;
+#endif
+  if (__builtin_cpu_supports ("avx2"))
+    impls[n++] = &gst_ds_osdcoord_blend_avx2;
+#elif defined(DSOSDCOORD_BLEND_NEON)
+  impls[n++] = &gst_ds_osdcoord_blend_neon;
+#endif
+  return n;
+}
+
+const GstDsOsdCoordBlendImpl *
+gst_ds_osdcoord_blend_get_impl (void)
+{
+  static gsize impl = 0;
+
+  if (g_once_init_enter (&impl)) {
+    const GstDsOsdCoordBlendImpl *impls[DSOSDCOORD_BLEND_MAX_IMPLS];
+    guint n = gst_ds_osdcoord_blend_get_impls (impls);
+
+    g_once_init_leave (&impl, (gsize) impls[n - 1]);
+  }
+  return (const GstDsOsdCoordBlendImpl *) impl;
+}
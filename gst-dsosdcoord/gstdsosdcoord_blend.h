@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_BLEND_H__
+#define __GST_DSOSDCOORD_BLEND_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Color prepared for blending over RGBA pixels. Every channel, alpha
+ * included, is computed as (src + p * inv_alpha) / 255 with integer
+ * division, which gives the same result as blending c with alpha a:
+ * (c * a + p * (255 - a) + 127) / 255.
+ */
+typedef struct
+{
+  /** c * a + 127 for r, g, b and 255 * a + 127 for alpha. */
+  guint16 src[4];
+  /** 255 - a. */
+  guint16 inv_alpha;
+} GstDsOsdCoordBlendColor;
+
+/**
+ * Blend color over n RGBA pixels starting at p.
+ */
+typedef void (*GstDsOsdCoordBlendSpanFunc) (guint8 * p, gint n,
+    const GstDsOsdCoordBlendColor * color);
+
+typedef struct
+{
+  const gchar *name;
+  GstDsOsdCoordBlendSpanFunc blend_span;
+} GstDsOsdCoordBlendImpl;
+
+void gst_ds_osdcoord_blend_color_init (GstDsOsdCoordBlendColor * color,
+    guint8 r, guint8 g, guint8 b, guint8 a);
+
+/** Whether blending the color leaves the pixels unchanged. */
+static inline gboolean
+gst_ds_osdcoord_blend_color_is_clear (const GstDsOsdCoordBlendColor * color)
+{
+  return color->inv_alpha == 255;
+}
+
+/** Portable implementation all others must match pixel for pixel. */
+void gst_ds_osdcoord_blend_span_scalar (guint8 * p, gint n,
+    const GstDsOsdCoordBlendColor * color);
+
+#define DSOSDCOORD_BLEND_MAX_IMPLS 4
+
+guint gst_ds_osdcoord_blend_get_impls (const GstDsOsdCoordBlendImpl ** impls);
+
+/**
+ * Fastest implementation the CPU supports, detected on the first call.
+ */
+const GstDsOsdCoordBlendImpl *gst_ds_osdcoord_blend_get_impl (void);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_BLEND_H__ */
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include "gstdsosdcoord_color.h"
+
+static gboolean
+gst_ds_osdcoord_color_parse_double (const gchar * str, gdouble * value)
+{
+  gchar *end = NULL;
+  gdouble d = g_ascii_strtod (str, &end);
+
+  if (end == str)
+    return FALSE;
+  while (g_ascii_isspace (*end))
+    end++;
+  if (*end != '\0')
+    return FALSE;
+  *value = d;
+  return TRUE;
+}
+
+/**
+ * Parse "class_id,r,g,b,a:class_id,r,g,b,a:..." into a new table. a may be
+ * left out and defaults to DSOSDCOORD_DEFAULT_ALPHA. If a class id is listed
+ * more than once the last entry wins.
+ * Returns NULL and sets error if the string is malformed.
+ */
+GstDsOsdCoordColorTable *
+gst_ds_osdcoord_color_table_parse (const gchar * str, GError ** error)
+{
+  GstDsOsdCoordColorTable *table;
+  gchar **classes;
+  guint i, n = 0, max_id = 0;
+
+  classes = g_strsplit (str ? str : "", ":", -1);
+
+  table = g_new0 (GstDsOsdCoordColorTable, 1);
+  table->ref_count = 1;
+  table->entries = g_new0 (NvOSD_Color_info, g_strv_length (classes));
+
+  for (i = 0; classes[i]; i++) {
+    NvOSD_Color_info *entry = &table->entries[n];
+    gchar **fields;
+    gchar *end = NULL;
+    gint64 class_id;
+    guint num_fields;
+    gboolean ok;
+
+    /* Allow a trailing ':' as written by older versions. */
+    if (g_strstrip (classes[i])[0] == '\0')
+      continue;
+
+    fields = g_strsplit (classes[i], ",", -1);
+    num_fields = g_strv_length (fields);
+    class_id = g_ascii_strtoll (fields[0], &end, 10);
+    while (g_ascii_isspace (*end))
+      end++;
+    entry->color.alpha = DSOSDCOORD_DEFAULT_ALPHA;
+    ok = (num_fields == 4 || num_fields == 5) && end != fields[0] &&
+        *end == '\0' && class_id >= 0 &&
+        class_id <= DSOSDCOORD_MAX_CLASS_ID &&
+        gst_ds_osdcoord_color_parse_double (fields[1], &entry->color.red) &&
+        gst_ds_osdcoord_color_parse_double (fields[2], &entry->color.green) &&
+        gst_ds_osdcoord_color_parse_double (fields[3], &entry->color.blue) &&
+        (num_fields == 4 ||
+        gst_ds_osdcoord_color_parse_double (fields[4], &entry->color.alpha));
+    g_strfreev (fields);
+
+    if (!ok) {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+          "invalid color \"%s\", expected class_id,r,g,b[,a] with class_id "
+          "between 0 and %d", classes[i], DSOSDCOORD_MAX_CLASS_ID);
+      g_strfreev (classes);
+      gst_ds_osdcoord_color_table_unref (table);
+      return NULL;
+    }
+
+    entry->id = (int) class_id;
+    max_id = MAX (max_id, (guint) class_id);
+    n++;
+  }
+  g_strfreev (classes);
+
+  table->num_entries = n;
+  table->lut_size = n > 0 ? max_id + 1 : 0;
+  table->lut = g_new (gint, MAX (table->lut_size, 1));
+  for (i = 0; i < table->lut_size; i++)
+    table->lut[i] = -1;
+  for (i = 0; i < n; i++)
+    table->lut[table->entries[i].id] = (gint) i;
+
+  return table;
+}
+
+GstDsOsdCoordColorTable *
+gst_ds_osdcoord_color_table_ref (GstDsOsdCoordColorTable * table)
+{
+  g_atomic_int_inc (&table->ref_count);
+  return table;
+}
+
+void
+gst_ds_osdcoord_color_table_unref (GstDsOsdCoordColorTable * table)
+{
+  if (!table || !g_atomic_int_dec_and_test (&table->ref_count))
+    return;
+
+  g_free (table->entries);
+  g_free (table->lut);
+  g_free (table);
+}
+
+/**
+ * Serialize the table back into hw-blend-color-attr syntax.
+ */
+gchar *
+gst_ds_osdcoord_color_table_to_string (const GstDsOsdCoordColorTable * table)
+{
+  GString *str = g_string_new (NULL);
+  guint i;
+
+  for (i = 0; i < table->num_entries; i++) {
+    const NvOSD_Color_info *entry = &table->entries[i];
+
+    g_string_append_printf (str, "%s%d,%f,%f,%f,%f", i > 0 ? ":" : "",
+        entry->id, entry->color.red, entry->color.green, entry->color.blue,
+        entry->color.alpha);
+  }
+  return g_string_free (str, FALSE);
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_COLOR_H__
+#define __GST_DSOSDCOORD_COLOR_H__
+
+#include <gst/gst.h>
+#include "nvll_osd_api.h"
+
+G_BEGIN_DECLS
+
+/** Largest class id accepted in hw-blend-color-attr. */
+#define DSOSDCOORD_MAX_CLASS_ID 65535
+/** Alpha of hw-blend-color-attr entries that leave it out: opaque. */
+#define DSOSDCOORD_DEFAULT_ALPHA 1.0
+
+/**
+ * Immutable, reference counted table of hw blend colors parsed from
+ * hw-blend-color-attr. A new table is built whenever the property is set;
+ * the streaming thread keeps using the table it holds a reference to until
+ * it picks up the new one.
+ */
+typedef struct _GstDsOsdCoordColorTable
+{
+  gint ref_count;
+  /** Entries in the order they were configured, as handed to
+      nvll_osd_init_colors_for_hw_blend(). */
+  NvOSD_Color_info *entries;
+  guint num_entries;
+  /** Index into entries by class id, -1 for classes without a color.
+      Has one element more than the largest configured class id. */
+  gint *lut;
+  guint lut_size;
+} GstDsOsdCoordColorTable;
+
+GstDsOsdCoordColorTable *gst_ds_osdcoord_color_table_parse (
+    const gchar * str, GError ** error);
+
+GstDsOsdCoordColorTable *gst_ds_osdcoord_color_table_ref (
+    GstDsOsdCoordColorTable * table);
+
+void gst_ds_osdcoord_color_table_unref (GstDsOsdCoordColorTable * table);
+
+gchar *gst_ds_osdcoord_color_table_to_string (
+    const GstDsOsdCoordColorTable * table);
+
+/**
+ * Index of the entry of class_id in table->entries, or -1 if the class has
+ * no color.
+ */
+static inline gint
+gst_ds_osdcoord_color_table_lookup (const GstDsOsdCoordColorTable * table,
+    gint class_id)
+{
+  if (class_id < 0 || (guint) class_id >= table->lut_size)
+    return -1;
+  return table->lut[class_id];
+}
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_COLOR_H__ */
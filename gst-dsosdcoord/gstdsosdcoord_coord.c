@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <math.h>
+#include "gstdsosdcoord_coord.h"
+
+/**
+ * Set up the mapping from muxer pixels of a width x height frame into space.
+ * source_width and source_height are those of the frame meta, 0 if
+ * unknown, in which case DSOSDCOORD_COORD_SPACE_SOURCE keeps muxer pixels.
+ * Returns FALSE if the mapping does nothing.
+ */
+gboolean
+gst_ds_osdcoord_transform_init (GstDsOsdCoordTransform * transform,
+    GstDsOsdCoordCoordSpace space, gint width, gint height,
+    guint source_width, guint source_height, gboolean clamp, gboolean round)
+{
+  transform->scale_x = 1;
+  transform->scale_y = 1;
+  transform->max_x = width;
+  transform->max_y = height;
+  transform->clamp = clamp;
+  transform->round = round;
+
+  if (width <= 0 || height <= 0)
+    return round;
+
+  switch (space) {
+    case DSOSDCOORD_COORD_SPACE_MUXER:
+      break;
+    case DSOSDCOORD_COORD_SPACE_NORMALIZED:
+      transform->scale_x = 1.0f / width;
+      transform->scale_y = 1.0f / height;
+      transform->max_x = 1;
+      transform->max_y = 1;
+      break;
+    case DSOSDCOORD_COORD_SPACE_SOURCE:
+      if (source_width == 0 || source_height == 0)
+        break;
+      transform->scale_x = (gfloat) source_width / width;
+      transform->scale_y = (gfloat) source_height / height;
+      transform->max_x = source_width;
+      transform->max_y = source_height;
+      break;
+  }
+
+  return transform->scale_x != 1 || transform->scale_y != 1 || clamp || round;
+}
+
+/**
+ * Map the corners of n boxes in place. Each step is a separate loop over
+ * plain arrays so the compiler can vectorize it.
+ */
+static void
+gst_ds_osdcoord_boxes_transform (GstDsOsdCoordBoxes * boxes, guint n,
+    const GstDsOsdCoordTransform * transform)
+{
+  gfloat *__restrict x0 = boxes->x0;
+  gfloat *__restrict y0 = boxes->y0;
+  gfloat *__restrict x1 = boxes->x1;
+  gfloat *__restrict y1 = boxes->y1;
+  const gfloat sx = transform->scale_x, sy = transform->scale_y;
+  const gfloat mx = transform->max_x, my = transform->max_y;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    x0[i] *= sx;
+    x1[i] *= sx;
+    y0[i] *= sy;
+    y1[i] *= sy;
+  }
+
+  if (transform->clamp) {
+    for (i = 0; i < n; i++) {
+      x0[i] = MIN (MAX (x0[i], 0.0f), mx);
+      x1[i] = MIN (MAX (x1[i], 0.0f), mx);
+      y0[i] = MIN (MAX (y0[i], 0.0f), my);
+      y1[i] = MIN (MAX (y1[i], 0.0f), my);
+    }
+  }
+
+  if (transform->round) {
+    for (i = 0; i < n; i++) {
+      x0[i] = rintf (x0[i]);
+      x1[i] = rintf (x1[i]);
+      y0[i] = rintf (y0[i]);
+      y1[i] = rintf (y1[i]);
+    }
+  }
+}
+
+/**
+ * Map the boxes of n records of one frame: gather their corners into
+ * scratch arrays taken from arena, transform them and write them back.
+ */
+void
+gst_ds_osdcoord_transform_records (GstDsOsdCoordArena * arena,
+    GstDsOsdCoordExportRecord * records, guint n,
+    const GstDsOsdCoordTransform * transform)
+{
+  GstDsOsdCoordBoxes boxes;
+  guint i;
+
+  boxes.x0 = (gfloat *) gst_ds_osdcoord_arena_alloc (arena,
+      n * sizeof (gfloat));
+  boxes.y0 = (gfloat *) gst_ds_osdcoord_arena_alloc (arena,
+      n * sizeof (gfloat));
+  boxes.x1 = (gfloat *) gst_ds_osdcoord_arena_alloc (arena,
+      n * sizeof (gfloat));
+  boxes.y1 = (gfloat *) gst_ds_osdcoord_arena_alloc (arena,
+      n * sizeof (gfloat));
+
+  for (i = 0; i < n; i++) {
+    boxes.x0[i] = records[i].left;
+    boxes.y0[i] = records[i].top;
+    boxes.x1[i] = records[i].left + records[i].width;
+    boxes.y1[i] = records[i].top + records[i].height;
+  }
+
+  gst_ds_osdcoord_boxes_transform (&boxes, n, transform);
+
+  for (i = 0; i < n; i++) {
+    records[i].left = boxes.x0[i];
+    records[i].top = boxes.y0[i];
+    records[i].width = boxes.x1[i] - boxes.x0[i];
+    records[i].height = boxes.y1[i] - boxes.y0[i];
+  }
+}
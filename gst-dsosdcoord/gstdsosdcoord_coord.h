@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_COORD_H__
+#define __GST_DSOSDCOORD_COORD_H__
+
+#include <gst/gst.h>
+#include "gstdsosdcoord_exporter.h"
+#include "gstdsosdcoord_arena.h"
+
+G_BEGIN_DECLS
+
+/**
+ * Space the exported coordinates are expressed in.
+ */
+typedef enum
+{
+  /** Pixels of the nvstreammux output, as in the metadata. */
+  DSOSDCOORD_COORD_SPACE_MUXER,
+  /** Fractions of the frame width and height, 0 to 1. */
+  DSOSDCOORD_COORD_SPACE_NORMALIZED,
+  /** Pixels of the original source, source_frame_width/height of the
+      frame meta. */
+  DSOSDCOORD_COORD_SPACE_SOURCE,
+} GstDsOsdCoordCoordSpace;
+
+/**
+ * Number format of the exported coordinates.
+ */
+typedef enum
+{
+  DSOSDCOORD_COORD_FORMAT_FLOAT,
+  /** Rounded to the nearest integer. */
+  DSOSDCOORD_COORD_FORMAT_INT,
+} GstDsOsdCoordCoordFormat;
+
+/**
+ * Mapping of the boxes of one frame: scale, then optionally clamp to
+ * [0, max] and round to whole numbers.
+ */
+typedef struct _GstDsOsdCoordTransform
+{
+  gfloat scale_x;
+  gfloat scale_y;
+  gfloat max_x;
+  gfloat max_y;
+  gboolean clamp;
+  gboolean round;
+} GstDsOsdCoordTransform;
+
+/**
+ * Scratch box corners in structure-of-arrays layout.
+ */
+typedef struct _GstDsOsdCoordBoxes
+{
+  gfloat *x0;
+  gfloat *y0;
+  gfloat *x1;
+  gfloat *y1;
+} GstDsOsdCoordBoxes;
+
+gboolean gst_ds_osdcoord_transform_init (GstDsOsdCoordTransform * transform,
+    GstDsOsdCoordCoordSpace space, gint width, gint height,
+    guint source_width, guint source_height, gboolean clamp, gboolean round);
+
+void gst_ds_osdcoord_transform_records (GstDsOsdCoordArena * arena,
+    GstDsOsdCoordExportRecord * records, guint n,
+    const GstDsOsdCoordTransform * transform);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_COORD_H__ */
@@ -0,0 +1,1499 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "gstdsosdcoord_exporter.h"
+#include "gstdsosdcoord_shm.h"
+#include "gstdsosdcoord_uds.h"
+#include "gstdsosdcoord_log.h"
+#include "gstdsosdcoord_labels.h"
+#include "dsosdcoord_bin.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_ds_osdcoord_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_debug
+
+/* How long the exporter thread sleeps when it has not been kicked. */
+#define EXPORT_IDLE_WAIT_US (100 * 1000)
+/* Size of the serialized output after which it is written out mid-drain. */
+#define EXPORT_WRITE_CHUNK (64 * 1024)
+/* Records taken from one queue before the engine moves on to the next. */
+#define EXPORT_DRAIN_QUANTUM 256
+#define CACHE_LINE_SIZE 64
+/* Objects after which a binary frame chunk is ended, to keep chunks well
+ * within a datagram. */
+#define EXPORT_MAX_FRAME_OBJECTS 512
+/* Bytes of objects and masks after which a binary frame chunk is ended,
+ * for the same reason. */
+#define EXPORT_MAX_FRAME_BYTES (16 * 1024)
+/* Run lengths the mask ring of a queue holds per record slot. */
+#define EXPORT_MASK_COUNTS_PER_RECORD 64
+#define EXPORT_MAX_MASK_SIZE \
+    (sizeof (DsOsdCoordBinMask) + DSOSDCOORD_MAX_MASK_COUNTS * sizeof (guint32))
+/* Largest output of one frame chunk and the labels it introduces, which
+ * the file sink keeps within one segment. */
+#define EXPORT_STRING_SIZE(length) \
+    (sizeof (DsOsdCoordBinChunk) + sizeof (DsOsdCoordBinString) + (length))
+#define EXPORT_MAX_UNIT_SIZE \
+    (EXPORT_MAX_FRAME_OBJECTS * (sizeof (DsOsdCoordBinObject) + \
+        sizeof (DsOsdCoordBinObjectFields) + \
+        EXPORT_STRING_SIZE (MAX_LABEL_SIZE) + \
+        DSOSDCOORD_MAX_CLASSIFIER_RESULTS * \
+        EXPORT_STRING_SIZE (DSOSDCOORD_CLASSIFIER_LABEL_SIZE)) + \
+    EXPORT_MAX_FRAME_BYTES + EXPORT_MAX_MASK_SIZE + \
+    2 * sizeof (DsOsdCoordBinChunk) + sizeof (DsOsdCoordBinFrame) + \
+    sizeof (DsOsdCoordBinMasks))
+
+G_STATIC_ASSERT (EXPORT_MAX_UNIT_SIZE < DSOSDCOORD_LOG_MIN_SEGMENT_SIZE / 2);
+
+G_STATIC_ASSERT (sizeof (DsOsdCoordBinFrame) == 32);
+G_STATIC_ASSERT (sizeof (DsOsdCoordBinObject) == 40);
+G_STATIC_ASSERT (sizeof (DsOsdCoordBinObjectFields) == 96);
+G_STATIC_ASSERT (DSOSDCOORD_MAX_CLASSIFIER_RESULTS ==
+    DSOSDCOORD_BIN_MAX_CLASSIFIER_RESULTS);
+G_STATIC_ASSERT (DSOSDCOORD_MAX_USER_META == DSOSDCOORD_BIN_MAX_USER_META);
+G_STATIC_ASSERT (DSOSDCOORD_MAX_MASK_COUNTS == DSOSDCOORD_BIN_MAX_MASK_COUNTS);
+
+typedef struct _GstDsOsdCoordExportEngine GstDsOsdCoordExportEngine;
+
+/**
+ * Bounded single-producer ring of export records, one per element instance.
+ *
+ * The streaming thread owns head; the engine thread consumes by advancing
+ * tail with a compare-and-exchange after copying the slot out. With the
+ * drop-oldest policy the streaming thread advances tail itself, in which case
+ * the engine's exchange fails and the (possibly overwritten) copy is
+ * discarded.
+ *
+ * The run lengths of masks, which do not fit a slot, go to a ring of their
+ * own that follows the slots: each slot remembers where the data of its
+ * record starts, so the data of the oldest queued record bounds the free
+ * space. A mask that does not fit is dropped rather than waited for.
+ */
+struct _GstDsOsdCoordExporter
+{
+  GstDsOsdCoordExportRecord *slots;
+  guint mask;
+  GstDsOsdCoordOverflowPolicy policy;
+  GstDsOsdCoordExportEngine *engine;
+  /** Run lengths of masks, NULL without DSOSDCOORD_EXPORT_FIELD_MASK, and
+      for every slot the position of mask_head when it was reserved. */
+  guint32 *mask_ring;
+  guint64 mask_ring_size;
+  guint64 *mask_starts;
+
+  gchar pad0[CACHE_LINE_SIZE];
+  /** Next slot to be written. Only written by the streaming thread. */
+  volatile gint head;
+  /** Number of records dropped. Only written by the streaming thread. */
+  guint64 dropped;
+  /** Total run lengths written to mask_ring and masks dropped. Only
+      written by the streaming thread. */
+  guint64 mask_head;
+  guint64 masks_dropped;
+
+  gchar pad1[CACHE_LINE_SIZE];
+  /** Next slot to be read. */
+  volatile gint tail;
+
+  gchar pad2[CACHE_LINE_SIZE];
+  volatile gint running;
+  volatile gint producer_waiting;
+  /** Records taken by the engine and records of this queue the sink
+      dropped, protected by engine->lock. */
+  guint64 exported;
+  guint64 sink_dropped;
+  /** engine->exported when the queue was registered. */
+  guint64 exported_base;
+};
+
+/**
+ * Records of one queue, in the order they were written, that the sink has
+ * neither sent nor dropped yet.
+ */
+typedef struct
+{
+  GstDsOsdCoordExporter *exporter;
+  guint records;
+} GstDsOsdCoordExportSpan;
+
+/**
+ * Sink and thread that drain the queues of one or, with export-shared, all
+ * element instances of the process writing to the same destination. The
+ * queues are drained round-robin, EXPORT_DRAIN_QUANTUM records at a time,
+ * into one output so writes are coalesced across instances.
+ *
+ * Lock order is engines_lock, queues_lock, lock.
+ */
+struct _GstDsOsdCoordExportEngine
+{
+  /** Key in the table of shared engines, NULL for a private engine. */
+  gchar *key;
+  /** Number of registered queues, protected by engines_lock. */
+  guint ref_count;
+  /** Settings the engine was created with; strings are left out as they
+      are part of the key. */
+  GstDsOsdCoordExportConfig config;
+
+  /** Registered queues, protected by queues_lock. The engine thread holds
+      it while draining, so a queue is never unregistered mid-pass. */
+  GMutex queues_lock;
+  GPtrArray *queues;
+  /** Queue the next round starts at. */
+  guint next_queue;
+  /** Queue of the binary frame chunk being built. */
+  GstDsOsdCoordExporter *current;
+
+  volatile gint running;
+  volatile gint consumer_waiting;
+  GMutex lock;
+  /** Signalled when records are available. */
+  GCond data_cond;
+  /** Signalled when slots are freed. */
+  GCond space_cond;
+  /** Signalled when a drain pass ends. */
+  GCond pass_cond;
+  /** Drain passes started and ended, protected by lock. */
+  guint64 passes_started;
+  guint64 passes_ended;
+  /** Whether the next pass sends held back datagrams, protected by lock. */
+  gboolean flush_requested;
+  /** Records taken from all queues, number of registered queues and bytes
+      allocated by the engine as of the last pass, protected by lock. */
+  guint64 exported;
+  guint num_queues;
+  gsize memory_usage;
+  GThread *thread;
+
+  GstDsOsdCoordExportSink sink;
+  GstDsOsdCoordExportFormat format;
+  /** Whether coordinates are printed as integers. */
+  gboolean integer_coords;
+  /** Serialized output, only touched by the exporter thread. */
+  GString *out;
+  /** Number of records in out. */
+  guint out_records;
+  /** Labels sent in the current binary stream. */
+  GstDsOsdCoordLabels *labels;
+  /** Header and objects of the binary frame chunk being built, and the
+      DsOsdCoordBinMask of its objects with masks. */
+  DsOsdCoordBinFrame frame;
+  GString *objects;
+  GString *masks;
+  guint frame_masks;
+  /** Run lengths of the mask of the last record taken from a queue. */
+  GArray *mask_counts;
+  /** Shared memory ring for DSOSDCOORD_EXPORT_SINK_SHM. */
+  GstDsOsdCoordShmWriter *shm;
+  /** Socket for DSOSDCOORD_EXPORT_SINK_UDS. */
+  GstDsOsdCoordUdsWriter *uds;
+  guint uds_flush_us;
+  /** Monotonic time the pending datagrams are due, 0 if none. */
+  gint64 uds_deadline;
+  /** Segment files for DSOSDCOORD_EXPORT_SINK_FILE. */
+  GstDsOsdCoordLogWriter *log;
+  /** GstDsOsdCoordExportSpan of the records in datagrams, out and the frame
+      being built, oldest first, so drops are counted for the instance whose
+      records were lost. Only touched by the engine thread. */
+  GArray *pending;
+};
+
+/**
+ * Copy the mask of record, just copied out of its slot, out of the mask
+ * ring before the slot is released. Returns FALSE if the slot was being
+ * overwritten, in which case the pop is retried.
+ */
+static gboolean
+gst_ds_osdcoord_exporter_copy_mask (GstDsOsdCoordExporter * exporter,
+    GstDsOsdCoordExportRecord * record)
+{
+  GArray *counts = exporter->engine->mask_counts;
+  const guint32 *ring = exporter->mask_ring;
+
+  if (!ring || record->num_mask_counts > DSOSDCOORD_MAX_MASK_COUNTS ||
+      record->mask_counts < ring ||
+      record->mask_counts + record->num_mask_counts >
+      ring + exporter->mask_ring_size)
+    return FALSE;
+
+  g_array_set_size (counts, record->num_mask_counts);
+  memcpy (counts->data, record->mask_counts,
+      record->num_mask_counts * sizeof (guint32));
+  record->mask_counts = (guint32 *) counts->data;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_exporter_pop (GstDsOsdCoordExporter * exporter,
+    GstDsOsdCoordExportRecord * record)
+{
+  for (;;) {
+    guint tail = (guint) g_atomic_int_get (&exporter->tail);
+    guint head = (guint) g_atomic_int_get (&exporter->head);
+
+    if (tail == head)
+      return FALSE;
+
+    const GstDsOsdCoordExportRecord *slot =
+        &exporter->slots[tail & exporter->mask];
+
+    memcpy (record, slot, gst_ds_osdcoord_export_record_size (slot));
+    if ((record->fields & DSOSDCOORD_EXPORT_FIELD_MASK) &&
+        !gst_ds_osdcoord_exporter_copy_mask (exporter, record))
+      continue;
+    if (g_atomic_int_compare_and_exchange (&exporter->tail, (gint) tail,
+            (gint) (tail + 1)))
+      return TRUE;
+  }
+}
+
+static const gchar *event_names[] = {
+  "none",
+  "appear",
+  "move",
+  "keyframe",
+  "disappear",
+};
+
+/**
+ * Append the export-fields of record to its text line.
+ */
+static void
+gst_ds_osdcoord_export_engine_format_fields (GstDsOsdCoordExportEngine *
+    engine, const GstDsOsdCoordExportRecord * record)
+{
+  guint i;
+
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_CONFIDENCE)
+    g_string_append_printf (engine->out, ", Confidence: %f",
+        record->confidence);
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_TRACKER_CONFIDENCE)
+    g_string_append_printf (engine->out, ", Tracker Confidence: %f",
+        record->tracker_confidence);
+  for (i = 0; i < record->num_classifier_results; i++) {
+    const GstDsOsdCoordClassifierResult *result =
+        &record->classifier_results[i];
+
+    g_string_append_printf (engine->out, ", Classifier %d: %s (%u, %f)",
+        result->component_id, result->label, result->class_id, result->prob);
+  }
+  if (record->num_user_meta > 0) {
+    g_string_append (engine->out, ", User Meta:");
+    for (i = 0; i < record->num_user_meta; i++)
+      g_string_append_printf (engine->out, " %u", record->user_meta_types[i]);
+  }
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_MASK) {
+    g_string_append_printf (engine->out, ", Mask: %ux%u:",
+        record->mask_width, record->mask_height);
+    for (i = 0; i < record->num_mask_counts; i++)
+      g_string_append_printf (engine->out, " %u", record->mask_counts[i]);
+  }
+}
+
+static void
+gst_ds_osdcoord_export_engine_format (GstDsOsdCoordExportEngine * engine,
+    const GstDsOsdCoordExportRecord * record)
+{
+  if (engine->integer_coords)
+    g_string_append_printf (engine->out,
+        "%u: %s, Top Left: (%d, %d), Bottom Right: (%d, %d)",
+        record->frame_num, record->label, (gint) record->left,
+        (gint) record->top, (gint) (record->left + record->width),
+        (gint) (record->top + record->height));
+  else
+    g_string_append_printf (engine->out,
+        "%u: %s, Top Left: (%f, %f), Bottom Right: (%f, %f)",
+        record->frame_num, record->label, record->left, record->top,
+        record->left + record->width, record->top + record->height);
+  if (record->flags & DSOSDCOORD_RECORD_FLAG_HAS_SOURCE)
+    g_string_append_printf (engine->out, ", Source: %u, Batch: %u",
+        record->source_id, record->batch_id);
+  if (record->flags & DSOSDCOORD_RECORD_FLAG_HAS_TRACK)
+    g_string_append_printf (engine->out, ", Track: %" G_GUINT64_FORMAT
+        ", Event: %s", record->object_id, event_names[record->event]);
+  if (record->fields)
+    gst_ds_osdcoord_export_engine_format_fields (engine, record);
+  g_string_append_c (engine->out, '\n');
+  engine->out_records++;
+}
+
+/**
+ * Append the header of a chunk with size bytes of payload, which the caller
+ * appends next.
+ */
+static void
+gst_ds_osdcoord_export_engine_begin_chunk (GstDsOsdCoordExportEngine * engine,
+    guint32 type, gsize size)
+{
+  DsOsdCoordBinChunk chunk;
+
+  chunk.type = type;
+  chunk.size = (guint32) size;
+  g_string_append_len (engine->out, (const gchar *) &chunk, sizeof (chunk));
+}
+
+/**
+ * Start a binary stream, or restart it with an empty string table.
+ */
+static void
+gst_ds_osdcoord_export_engine_begin_stream (GstDsOsdCoordExportEngine * engine)
+{
+  DsOsdCoordBinStream stream;
+
+  stream.magic = DSOSDCOORD_BIN_MAGIC;
+  stream.version = DSOSDCOORD_BIN_VERSION;
+  stream.object_size = sizeof (DsOsdCoordBinObject);
+  if (engine->config.fields)
+    stream.object_size += sizeof (DsOsdCoordBinObjectFields);
+  stream.reserved = 0;
+  gst_ds_osdcoord_export_engine_begin_chunk (engine,
+      DSOSDCOORD_BIN_CHUNK_STREAM, sizeof (stream));
+  g_string_append_len (engine->out, (const gchar *) &stream,
+      sizeof (stream));
+  gst_ds_osdcoord_labels_reset (engine->labels);
+}
+
+/**
+ * Append the frame chunk being built to the output, if it has objects,
+ * preceded by the mask chunk of its objects with masks.
+ */
+static void
+gst_ds_osdcoord_export_engine_end_frame (GstDsOsdCoordExportEngine * engine)
+{
+  if (engine->frame.num_objects == 0)
+    return;
+
+  if (engine->frame_masks > 0) {
+    DsOsdCoordBinMasks masks;
+
+    masks.num_masks = engine->frame_masks;
+    masks.reserved = 0;
+    gst_ds_osdcoord_export_engine_begin_chunk (engine,
+        DSOSDCOORD_BIN_CHUNK_MASK, sizeof (masks) + engine->masks->len);
+    g_string_append_len (engine->out, (const gchar *) &masks,
+        sizeof (masks));
+    g_string_append_len (engine->out, engine->masks->str,
+        engine->masks->len);
+    g_string_truncate (engine->masks, 0);
+    engine->frame_masks = 0;
+  }
+
+  gst_ds_osdcoord_export_engine_begin_chunk (engine, DSOSDCOORD_BIN_CHUNK_FRAME,
+      sizeof (engine->frame) + engine->objects->len);
+  g_string_append_len (engine->out, (const gchar *) &engine->frame,
+      sizeof (engine->frame));
+  g_string_append_len (engine->out, engine->objects->str,
+      engine->objects->len);
+  g_string_truncate (engine->objects, 0);
+  engine->out_records += engine->frame.num_objects;
+  engine->frame.num_objects = 0;
+}
+
+/**
+ * Return the string table id of label, sending it first if it is new, or
+ * DSOSDCOORD_LABEL_ID_NONE if the table is full.
+ */
+static guint32
+gst_ds_osdcoord_export_engine_intern (GstDsOsdCoordExportEngine * engine,
+    const gchar * label, guint32 hash)
+{
+  DsOsdCoordBinString string;
+  gboolean added;
+  guint32 id;
+
+  id = gst_ds_osdcoord_labels_intern (engine->labels, label, hash, &added);
+  if (!added)
+    return id;
+
+  string.id = id;
+  string.length = strlen (label);
+  gst_ds_osdcoord_export_engine_begin_chunk (engine,
+      DSOSDCOORD_BIN_CHUNK_STRING, sizeof (string) + string.length);
+  g_string_append_len (engine->out, (const gchar *) &string,
+      sizeof (string));
+  g_string_append_len (engine->out, label, string.length);
+  return id;
+}
+
+/**
+ * Set the label ids of object and its classifier results in fields.
+ * Returns FALSE if the string table is full.
+ */
+static gboolean
+gst_ds_osdcoord_export_engine_intern_labels (GstDsOsdCoordExportEngine *
+    engine, const GstDsOsdCoordExportRecord * record,
+    DsOsdCoordBinObject * object, DsOsdCoordBinObjectFields * fields)
+{
+  guint i;
+
+  object->label_id = gst_ds_osdcoord_export_engine_intern (engine,
+      record->label, record->label_hash);
+  if (object->label_id == DSOSDCOORD_LABEL_ID_NONE)
+    return FALSE;
+  if (!(record->fields & DSOSDCOORD_EXPORT_FIELD_CLASSIFIER))
+    return TRUE;
+
+  for (i = 0; i < record->num_classifier_results; i++) {
+    const GstDsOsdCoordClassifierResult *result =
+        &record->classifier_results[i];
+    DsOsdCoordBinClassifierResult *out = &fields->classifier_results[i];
+
+    out->label_id = gst_ds_osdcoord_export_engine_intern (engine,
+        result->label, result->label_hash);
+    if (out->label_id == DSOSDCOORD_LABEL_ID_NONE)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * Fill in the export-fields part of the binary object of record.
+ */
+static guint32
+gst_ds_osdcoord_export_engine_encode_fields (const GstDsOsdCoordExportRecord *
+    record, DsOsdCoordBinObjectFields * fields)
+{
+  guint32 flags = 0;
+  guint i;
+
+  memset (fields, 0, sizeof (*fields));
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_CONFIDENCE) {
+    fields->confidence = record->confidence;
+    flags |= DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CONFIDENCE;
+  }
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_TRACKER_CONFIDENCE) {
+    fields->tracker_confidence = record->tracker_confidence;
+    flags |= DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACKER_CONFIDENCE;
+  }
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_CLASSIFIER) {
+    fields->num_classifier_results = record->num_classifier_results;
+    for (i = 0; i < record->num_classifier_results; i++) {
+      fields->classifier_results[i].component_id =
+          record->classifier_results[i].component_id;
+      fields->classifier_results[i].class_id =
+          record->classifier_results[i].class_id;
+      fields->classifier_results[i].prob = record->classifier_results[i].prob;
+    }
+    flags |= DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASSIFIER;
+  }
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_USER_META) {
+    fields->num_user_meta = record->num_user_meta;
+    memcpy (fields->user_meta_types, record->user_meta_types,
+        record->num_user_meta * sizeof (guint32));
+    flags |= DSOSDCOORD_BIN_OBJECT_FLAG_HAS_USER_META;
+  }
+  if (record->fields & DSOSDCOORD_EXPORT_FIELD_MASK)
+    flags |= DSOSDCOORD_BIN_OBJECT_FLAG_HAS_MASK;
+  return flags;
+}
+
+/**
+ * Add the mask of record, the next object of the frame chunk being built,
+ * to its mask chunk.
+ */
+static void
+gst_ds_osdcoord_export_engine_encode_mask (GstDsOsdCoordExportEngine * engine,
+    const GstDsOsdCoordExportRecord * record)
+{
+  DsOsdCoordBinMask mask;
+
+  mask.object_index = engine->frame.num_objects;
+  mask.width = record->mask_width;
+  mask.height = record->mask_height;
+  mask.num_counts = record->num_mask_counts;
+  g_string_append_len (engine->masks, (const gchar *) &mask, sizeof (mask));
+  g_string_append_len (engine->masks, (const gchar *) record->mask_counts,
+      record->num_mask_counts * sizeof (guint32));
+  engine->frame_masks++;
+}
+
+/**
+ * Whether the record goes into the binary frame chunk being built.
+ */
+static gboolean
+gst_ds_osdcoord_export_engine_same_frame (GstDsOsdCoordExportEngine * engine,
+    const GstDsOsdCoordExportRecord * record)
+{
+  const DsOsdCoordBinFrame *frame = &engine->frame;
+  guint32 flags = (record->flags & DSOSDCOORD_RECORD_FLAG_HAS_SOURCE) ?
+      DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE : 0;
+
+  return frame->num_objects > 0 && frame->frame_num == record->frame_num &&
+      frame->source_id == record->source_id &&
+      frame->batch_id == record->batch_id && frame->flags == flags &&
+      frame->pts == record->pts;
+}
+
+/**
+ * Add a record to the binary frame chunk being built, ending the chunk
+ * first if the record belongs to another frame.
+ */
+static void
+gst_ds_osdcoord_export_engine_encode (GstDsOsdCoordExportEngine * engine,
+    const GstDsOsdCoordExportRecord * record)
+{
+  DsOsdCoordBinFrame *frame = &engine->frame;
+  DsOsdCoordBinObject object;
+  DsOsdCoordBinObjectFields fields;
+  guint32 flags = (record->flags & DSOSDCOORD_RECORD_FLAG_HAS_SOURCE) ?
+      DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE : 0;
+
+  if (!gst_ds_osdcoord_export_engine_same_frame (engine, record))
+    gst_ds_osdcoord_export_engine_end_frame (engine);
+
+  object.flags = DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASS |
+      ((record->flags & DSOSDCOORD_RECORD_FLAG_HAS_TRACK) ?
+      DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK : 0);
+  if (engine->config.fields)
+    object.flags |=
+        gst_ds_osdcoord_export_engine_encode_fields (record, &fields);
+
+  /* Interning may end the frame too, so the header is filled in after. */
+  if (!gst_ds_osdcoord_export_engine_intern_labels (engine, record, &object,
+          &fields)) {
+    /* Objects already built refer to the old table. */
+    gst_ds_osdcoord_export_engine_end_frame (engine);
+    gst_ds_osdcoord_export_engine_begin_stream (engine);
+    gst_ds_osdcoord_export_engine_intern_labels (engine, record, &object,
+        &fields);
+  }
+  object.event = record->event;
+  object.class_id = record->class_id;
+  object.left = record->left;
+  object.top = record->top;
+  object.width = record->width;
+  object.height = record->height;
+  object.object_id = record->object_id;
+
+  if (frame->num_objects == 0) {
+    frame->source_id = record->source_id;
+    frame->batch_id = record->batch_id;
+    frame->frame_num = record->frame_num;
+    frame->flags = flags;
+    frame->pts = record->pts;
+    frame->reserved = 0;
+  }
+  g_string_append_len (engine->objects, (const gchar *) &object,
+      sizeof (object));
+  if (engine->config.fields)
+    g_string_append_len (engine->objects, (const gchar *) &fields,
+        sizeof (fields));
+  if (object.flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_MASK)
+    gst_ds_osdcoord_export_engine_encode_mask (engine, record);
+  if (++frame->num_objects == EXPORT_MAX_FRAME_OBJECTS ||
+      engine->objects->len + engine->masks->len >= EXPORT_MAX_FRAME_BYTES)
+    gst_ds_osdcoord_export_engine_end_frame (engine);
+}
+
+/**
+ * Note that a record taken from exporter was written to the output.
+ */
+static void
+gst_ds_osdcoord_export_engine_add_pending (GstDsOsdCoordExportEngine * engine,
+    GstDsOsdCoordExporter * exporter)
+{
+  GArray *pending = engine->pending;
+  GstDsOsdCoordExportSpan span;
+
+  if (pending->len > 0) {
+    GstDsOsdCoordExportSpan *last = &g_array_index (pending,
+        GstDsOsdCoordExportSpan, pending->len - 1);
+
+    if (last->exporter == exporter) {
+      last->records++;
+      return;
+    }
+  }
+  span.exporter = exporter;
+  span.records = 1;
+  g_array_append_val (pending, span);
+}
+
+/**
+ * Take the oldest records pending in the sink off the list, counting them
+ * for their instances if they were dropped.
+ */
+static void
+gst_ds_osdcoord_export_engine_settle (GstDsOsdCoordExportEngine * engine,
+    guint records, gboolean dropped)
+{
+  GArray *pending = engine->pending;
+  guint i = 0;
+
+  if (records == 0)
+    return;
+
+  if (dropped)
+    g_mutex_lock (&engine->lock);
+  while (records > 0 && i < pending->len) {
+    GstDsOsdCoordExportSpan *span =
+        &g_array_index (pending, GstDsOsdCoordExportSpan, i);
+    guint n = MIN (records, span->records);
+
+    if (dropped)
+      span->exporter->sink_dropped += n;
+    span->records -= n;
+    records -= n;
+    if (span->records == 0)
+      i++;
+  }
+  if (dropped)
+    g_mutex_unlock (&engine->lock);
+  g_array_remove_range (pending, 0, i);
+}
+
+/**
+ * Restart a binary stream after the sink dropped records, dropping the
+ * output and frame being built with it, as the receiver may have missed
+ * labels.
+ */
+static void
+gst_ds_osdcoord_export_engine_sink_dropped (GstDsOsdCoordExportEngine * engine)
+{
+  if (!engine->labels)
+    return;
+
+  gst_ds_osdcoord_export_engine_settle (engine,
+      engine->out_records + engine->frame.num_objects, TRUE);
+  g_string_truncate (engine->out, 0);
+  g_string_truncate (engine->objects, 0);
+  g_string_truncate (engine->masks, 0);
+  engine->out_records = 0;
+  engine->frame.num_objects = 0;
+  engine->frame_masks = 0;
+  gst_ds_osdcoord_export_engine_begin_stream (engine);
+}
+
+static void
+gst_ds_osdcoord_export_engine_datagram_done (guint records, gboolean dropped,
+    gpointer user_data)
+{
+  gst_ds_osdcoord_export_engine_settle ((GstDsOsdCoordExportEngine *)
+      user_data, records, dropped);
+}
+
+/**
+ * Send the pending datagrams of the uds sink.
+ */
+static void
+gst_ds_osdcoord_export_engine_flush (GstDsOsdCoordExportEngine * engine)
+{
+  engine->uds_deadline = 0;
+  if (gst_ds_osdcoord_uds_writer_flush (engine->uds,
+          gst_ds_osdcoord_export_engine_datagram_done, engine) > 0)
+    gst_ds_osdcoord_export_engine_sink_dropped (engine);
+}
+
+/**
+ * Move the serialized output, whole records, into the datagrams of the uds
+ * sink.
+ */
+static void
+gst_ds_osdcoord_export_engine_queue_datagram (GstDsOsdCoordExportEngine *
+    engine)
+{
+  GstDsOsdCoordUdsWriter *uds = engine->uds;
+
+  if (engine->out->len == 0)
+    return;
+
+  if (gst_ds_osdcoord_uds_writer_is_empty (uds))
+    engine->uds_deadline = g_get_monotonic_time () + engine->uds_flush_us;
+  if (!gst_ds_osdcoord_uds_writer_append (uds, engine->out->str,
+          engine->out->len, engine->out_records)) {
+    /* On a drop a binary stream replaces out with its restart. */
+    gst_ds_osdcoord_export_engine_flush (engine);
+    engine->uds_deadline = g_get_monotonic_time () + engine->uds_flush_us;
+    gst_ds_osdcoord_uds_writer_append (uds, engine->out->str,
+        engine->out->len, engine->out_records);
+  }
+  g_string_truncate (engine->out, 0);
+  engine->out_records = 0;
+}
+
+/**
+ * Copy the serialized output into the current segment of the file sink.
+ */
+static void
+gst_ds_osdcoord_export_engine_log_write (GstDsOsdCoordExportEngine * engine)
+{
+  guint records = engine->out_records;
+
+  if (engine->out->len == 0)
+    return;
+
+  /* A failed write leaves no segment, and the next one restarts the binary
+     stream, so lost labels need no further care. */
+  if (!gst_ds_osdcoord_log_writer_write (engine->log, engine->out->str,
+          engine->out->len)) {
+    gst_ds_osdcoord_export_engine_sink_dropped (engine);
+    return;
+  }
+  g_string_truncate (engine->out, 0);
+  engine->out_records = 0;
+  gst_ds_osdcoord_export_engine_settle (engine, records, FALSE);
+}
+
+/**
+ * Encode a record for the file sink. Segments are rotated between frame
+ * chunks, each new segment starting its own binary stream so it can be
+ * read on its own.
+ */
+static void
+gst_ds_osdcoord_export_engine_log_record (GstDsOsdCoordExportEngine * engine,
+    const GstDsOsdCoordExportRecord * record)
+{
+  if (!gst_ds_osdcoord_export_engine_same_frame (engine, record)) {
+    gst_ds_osdcoord_export_engine_end_frame (engine);
+    gst_ds_osdcoord_export_engine_log_write (engine);
+    if (gst_ds_osdcoord_log_writer_should_rotate (engine->log,
+            EXPORT_MAX_UNIT_SIZE) &&
+        gst_ds_osdcoord_log_writer_rotate (engine->log)) {
+      g_string_truncate (engine->out, 0);
+      gst_ds_osdcoord_export_engine_begin_stream (engine);
+    }
+  }
+  gst_ds_osdcoord_export_engine_encode (engine, record);
+  gst_ds_osdcoord_export_engine_log_write (engine);
+}
+
+static void
+gst_ds_osdcoord_export_engine_write (GstDsOsdCoordExportEngine * engine)
+{
+  if (engine->out->len == 0)
+    return;
+
+  fwrite (engine->out->str, 1, engine->out->len, stdout);
+  fflush (stdout);
+  g_string_truncate (engine->out, 0);
+  gst_ds_osdcoord_export_engine_settle (engine, engine->out_records, FALSE);
+  engine->out_records = 0;
+}
+
+/**
+ * Serialize a record taken from exporter into the sink.
+ */
+static void
+gst_ds_osdcoord_export_engine_write_record (GstDsOsdCoordExportEngine * engine,
+    GstDsOsdCoordExporter * exporter, const GstDsOsdCoordExportRecord * record)
+{
+  /* Frame chunks never mix the records of two instances. */
+  if (engine->current != exporter) {
+    if (engine->labels)
+      gst_ds_osdcoord_export_engine_end_frame (engine);
+    engine->current = exporter;
+  }
+  if (engine->sink != DSOSDCOORD_EXPORT_SINK_SHM)
+    gst_ds_osdcoord_export_engine_add_pending (engine, exporter);
+
+  switch (engine->sink) {
+    case DSOSDCOORD_EXPORT_SINK_SHM:
+      gst_ds_osdcoord_shm_writer_write (engine->shm, record);
+      break;
+    case DSOSDCOORD_EXPORT_SINK_UDS:
+      if (engine->format == DSOSDCOORD_EXPORT_FORMAT_BINARY)
+        gst_ds_osdcoord_export_engine_encode (engine, record);
+      else
+        gst_ds_osdcoord_export_engine_format (engine, record);
+      gst_ds_osdcoord_export_engine_queue_datagram (engine);
+      break;
+    case DSOSDCOORD_EXPORT_SINK_FILE:
+      gst_ds_osdcoord_export_engine_log_record (engine, record);
+      break;
+    case DSOSDCOORD_EXPORT_SINK_STDOUT:
+    default:
+      if (engine->format == DSOSDCOORD_EXPORT_FORMAT_BINARY)
+        gst_ds_osdcoord_export_engine_encode (engine, record);
+      else
+        gst_ds_osdcoord_export_engine_format (engine, record);
+      if (engine->out->len >= EXPORT_WRITE_CHUNK)
+        gst_ds_osdcoord_export_engine_write (engine);
+      break;
+  }
+}
+
+/**
+ * Whether all registered queues are empty. Must be called with
+ * queues_lock held.
+ */
+static gboolean
+gst_ds_osdcoord_export_engine_is_idle (GstDsOsdCoordExportEngine * engine)
+{
+  guint i;
+
+  for (i = 0; i < engine->queues->len; i++) {
+    GstDsOsdCoordExporter *exporter =
+        (GstDsOsdCoordExporter *) g_ptr_array_index (engine->queues, i);
+
+    if (g_atomic_int_get (&exporter->tail) !=
+        g_atomic_int_get (&exporter->head))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * Bytes allocated by the engine. Only called from the engine thread.
+ */
+static gsize
+gst_ds_osdcoord_export_engine_get_memory_usage (GstDsOsdCoordExportEngine *
+    engine)
+{
+  gsize total = sizeof (*engine);
+
+  total += engine->out->allocated_len;
+  total += engine->mask_counts->len * sizeof (guint32);
+  total += engine->pending->len * sizeof (GstDsOsdCoordExportSpan);
+  if (engine->labels) {
+    total += engine->objects->allocated_len + engine->masks->allocated_len;
+    total += gst_ds_osdcoord_labels_get_memory_usage (engine->labels);
+  }
+  if (engine->shm)
+    total += gst_ds_osdcoord_shm_writer_get_size (engine->shm);
+  if (engine->uds)
+    total += gst_ds_osdcoord_uds_writer_get_size (engine->uds);
+  if (engine->log)
+    total += gst_ds_osdcoord_log_writer_get_size (engine->log);
+  return total;
+}
+
+/**
+ * Take up to EXPORT_DRAIN_QUANTUM records from each queue and write out the
+ * output. Each pass starts at the next queue so that no instance is always
+ * served first, and takes a bounded number of records so that a busy
+ * producer cannot hold back the uds deadline or a stop.
+ */
+static void
+gst_ds_osdcoord_export_engine_drain (GstDsOsdCoordExportEngine * engine)
+{
+  GstDsOsdCoordExportRecord record;
+  gboolean flush;
+  guint i, n, len;
+  gsize memory_usage;
+
+  g_mutex_lock (&engine->lock);
+  engine->passes_started++;
+  flush = engine->flush_requested;
+  engine->flush_requested = FALSE;
+  g_mutex_unlock (&engine->lock);
+
+  g_mutex_lock (&engine->queues_lock);
+  len = engine->queues->len;
+  for (i = 0; i < len; i++) {
+    GstDsOsdCoordExporter *exporter = (GstDsOsdCoordExporter *)
+        g_ptr_array_index (engine->queues, (engine->next_queue + i) % len);
+
+    for (n = 0; n < EXPORT_DRAIN_QUANTUM &&
+        gst_ds_osdcoord_exporter_pop (exporter, &record); n++)
+      gst_ds_osdcoord_export_engine_write_record (engine, exporter, &record);
+    if (n == 0)
+      continue;
+
+    g_mutex_lock (&engine->lock);
+    exporter->exported += n;
+    engine->exported += n;
+    if (g_atomic_int_get (&exporter->producer_waiting))
+      g_cond_broadcast (&engine->space_cond);
+    g_mutex_unlock (&engine->lock);
+  }
+  engine->next_queue++;
+  g_mutex_unlock (&engine->queues_lock);
+
+  if (engine->labels)
+    gst_ds_osdcoord_export_engine_end_frame (engine);
+  if (engine->uds) {
+    gst_ds_osdcoord_export_engine_queue_datagram (engine);
+    if (!gst_ds_osdcoord_uds_writer_is_empty (engine->uds) &&
+        (engine->uds_flush_us == 0 || flush ||
+            !g_atomic_int_get (&engine->running) ||
+            g_get_monotonic_time () >= engine->uds_deadline))
+      gst_ds_osdcoord_export_engine_flush (engine);
+  } else if (engine->log) {
+    gst_ds_osdcoord_export_engine_log_write (engine);
+  } else {
+    gst_ds_osdcoord_export_engine_write (engine);
+  }
+
+  memory_usage = gst_ds_osdcoord_export_engine_get_memory_usage (engine);
+  g_mutex_lock (&engine->lock);
+  engine->memory_usage = memory_usage;
+  engine->passes_ended++;
+  g_cond_broadcast (&engine->pass_cond);
+  g_mutex_unlock (&engine->lock);
+}
+
+static gpointer
+gst_ds_osdcoord_export_engine_thread (gpointer data)
+{
+  GstDsOsdCoordExportEngine *engine = (GstDsOsdCoordExportEngine *) data;
+  gboolean idle;
+
+  while (g_atomic_int_get (&engine->running)) {
+    gst_ds_osdcoord_export_engine_drain (engine);
+
+    g_mutex_lock (&engine->queues_lock);
+    g_mutex_lock (&engine->lock);
+    g_atomic_int_set (&engine->consumer_waiting, 1);
+    idle = g_atomic_int_get (&engine->running) && !engine->flush_requested &&
+        gst_ds_osdcoord_export_engine_is_idle (engine);
+    g_mutex_unlock (&engine->queues_lock);
+    if (idle) {
+      gint64 end_time = g_get_monotonic_time () + EXPORT_IDLE_WAIT_US;
+
+      /* Wake up in time to send held back datagrams. */
+      if (engine->uds_deadline)
+        end_time = MIN (end_time, engine->uds_deadline);
+      g_cond_wait_until (&engine->data_cond, &engine->lock, end_time);
+    }
+    g_atomic_int_set (&engine->consumer_waiting, 0);
+    g_mutex_unlock (&engine->lock);
+  }
+
+  /* Flush whatever was queued before stop. */
+  gst_ds_osdcoord_export_engine_drain (engine);
+  return NULL;
+}
+
+/**
+ * Key of the engines a shared exporter can join: the destination of the
+ * sink.
+ */
+static gchar *
+gst_ds_osdcoord_export_engine_key (const GstDsOsdCoordExportConfig * config)
+{
+  switch (config->sink) {
+    case DSOSDCOORD_EXPORT_SINK_SHM:
+      return g_strconcat ("shm:", config->shm_name, NULL);
+    case DSOSDCOORD_EXPORT_SINK_UDS:
+      return g_strconcat ("uds:", config->uds_path, NULL);
+    case DSOSDCOORD_EXPORT_SINK_FILE:
+      return g_strconcat ("file:", config->file_location, NULL);
+    case DSOSDCOORD_EXPORT_SINK_STDOUT:
+    default:
+      return g_strdup ("stdout");
+  }
+}
+
+/**
+ * Whether config writes to the engine's destination the way the engine
+ * does. Binary streams have one object size, so their export-fields must
+ * match too.
+ */
+static gboolean
+gst_ds_osdcoord_export_engine_matches (GstDsOsdCoordExportEngine * engine,
+    const GstDsOsdCoordExportConfig * config)
+{
+  const GstDsOsdCoordExportConfig *own = &engine->config;
+  gboolean text = config->format == DSOSDCOORD_EXPORT_FORMAT_TEXT;
+
+  switch (config->sink) {
+    case DSOSDCOORD_EXPORT_SINK_SHM:
+      return config->shm_slots == own->shm_slots;
+    case DSOSDCOORD_EXPORT_SINK_UDS:
+      return config->format == own->format &&
+          config->uds_flush_us == own->uds_flush_us &&
+          (text ? config->integer_coords == own->integer_coords :
+          config->fields == own->fields);
+    case DSOSDCOORD_EXPORT_SINK_FILE:
+      return config->fields == own->fields &&
+          config->file_segment_size == own->file_segment_size &&
+          config->file_segment_seconds == own->file_segment_seconds &&
+          config->file_sync_interval == own->file_sync_interval;
+    case DSOSDCOORD_EXPORT_SINK_STDOUT:
+    default:
+      return config->format == own->format &&
+          (text ? config->integer_coords == own->integer_coords :
+          config->fields == own->fields);
+  }
+}
+
+/**
+ * Open the sink of config and start the engine thread.
+ */
+static GstDsOsdCoordExportEngine *
+gst_ds_osdcoord_export_engine_new (const GstDsOsdCoordExportConfig * config,
+    GError ** error)
+{
+  GstDsOsdCoordExportEngine *engine;
+  GstDsOsdCoordShmWriter *shm = NULL;
+  GstDsOsdCoordUdsWriter *uds = NULL;
+  GstDsOsdCoordLogWriter *log = NULL;
+
+  if (config->sink == DSOSDCOORD_EXPORT_SINK_SHM) {
+    shm = gst_ds_osdcoord_shm_writer_new (config->shm_name,
+        config->shm_slots, error);
+    if (!shm)
+      return NULL;
+  } else if (config->sink == DSOSDCOORD_EXPORT_SINK_UDS) {
+    uds = gst_ds_osdcoord_uds_writer_new (config->uds_path, error);
+    if (!uds)
+      return NULL;
+  } else if (config->sink == DSOSDCOORD_EXPORT_SINK_FILE) {
+    log = gst_ds_osdcoord_log_writer_new (config->file_location,
+        config->file_segment_size, config->file_segment_seconds,
+        config->file_sync_interval, error);
+    if (!log)
+      return NULL;
+  }
+
+  engine = g_new0 (GstDsOsdCoordExportEngine, 1);
+  engine->config = *config;
+  engine->config.shm_name = NULL;
+  engine->config.uds_path = NULL;
+  engine->config.file_location = NULL;
+  engine->queues = g_ptr_array_new ();
+  engine->sink = config->sink;
+  engine->format = config->format;
+  engine->integer_coords = config->integer_coords;
+  engine->shm = shm;
+  engine->uds = uds;
+  engine->log = log;
+  engine->uds_flush_us = config->uds_flush_us;
+  engine->running = 1;
+  engine->out = g_string_sized_new (EXPORT_WRITE_CHUNK);
+  engine->pending = g_array_new (FALSE, FALSE,
+      sizeof (GstDsOsdCoordExportSpan));
+  engine->mask_counts = g_array_sized_new (FALSE, FALSE, sizeof (guint32),
+      DSOSDCOORD_MAX_MASK_COUNTS);
+  if (engine->sink == DSOSDCOORD_EXPORT_SINK_FILE ||
+      (engine->sink != DSOSDCOORD_EXPORT_SINK_SHM &&
+          engine->format == DSOSDCOORD_EXPORT_FORMAT_BINARY)) {
+    engine->labels = gst_ds_osdcoord_labels_new (DSOSDCOORD_BIN_MAX_STRINGS);
+    engine->objects = g_string_new (NULL);
+    engine->masks = g_string_new (NULL);
+    gst_ds_osdcoord_export_engine_begin_stream (engine);
+  }
+  engine->memory_usage =
+      gst_ds_osdcoord_export_engine_get_memory_usage (engine);
+  g_mutex_init (&engine->queues_lock);
+  g_mutex_init (&engine->lock);
+  g_cond_init (&engine->data_cond);
+  g_cond_init (&engine->space_cond);
+  g_cond_init (&engine->pass_cond);
+
+  engine->thread = g_thread_new ("dsosdcoord-export",
+      gst_ds_osdcoord_export_engine_thread, engine);
+
+  return engine;
+}
+
+/**
+ * Stop the engine thread after it has written all queued records and free
+ * the engine. No queue may be registered anymore.
+ */
+static void
+gst_ds_osdcoord_export_engine_free (GstDsOsdCoordExportEngine * engine)
+{
+  g_mutex_lock (&engine->lock);
+  g_atomic_int_set (&engine->running, 0);
+  g_cond_broadcast (&engine->data_cond);
+  g_mutex_unlock (&engine->lock);
+  g_thread_join (engine->thread);
+
+  g_mutex_clear (&engine->queues_lock);
+  g_mutex_clear (&engine->lock);
+  g_cond_clear (&engine->data_cond);
+  g_cond_clear (&engine->space_cond);
+  g_cond_clear (&engine->pass_cond);
+  g_ptr_array_free (engine->queues, TRUE);
+  g_string_free (engine->out, TRUE);
+  g_array_free (engine->pending, TRUE);
+  g_array_free (engine->mask_counts, TRUE);
+  if (engine->labels) {
+    gst_ds_osdcoord_labels_free (engine->labels);
+    g_string_free (engine->objects, TRUE);
+    g_string_free (engine->masks, TRUE);
+  }
+  gst_ds_osdcoord_shm_writer_free (engine->shm);
+  gst_ds_osdcoord_uds_writer_free (engine->uds);
+  gst_ds_osdcoord_log_writer_free (engine->log);
+  g_free (engine->key);
+  g_free (engine);
+}
+
+/* Engines of shared exporters by gst_ds_osdcoord_export_engine_key(). */
+static GMutex engines_lock;
+static GHashTable *engines;
+
+/**
+ * Return the engine an exporter for config is to register with: a new
+ * private one, or with config->shared the one of the process writing to
+ * the same destination, created on first use.
+ */
+static GstDsOsdCoordExportEngine *
+gst_ds_osdcoord_export_engine_acquire (const GstDsOsdCoordExportConfig *
+    config, GError ** error)
+{
+  GstDsOsdCoordExportEngine *engine;
+  gchar *key;
+
+  if (!config->shared) {
+    engine = gst_ds_osdcoord_export_engine_new (config, error);
+    if (engine)
+      engine->ref_count = 1;
+    return engine;
+  }
+
+  key = gst_ds_osdcoord_export_engine_key (config);
+  g_mutex_lock (&engines_lock);
+  if (!engines)
+    engines = g_hash_table_new (g_str_hash, g_str_equal);
+  engine = (GstDsOsdCoordExportEngine *) g_hash_table_lookup (engines, key);
+  if (engine && !gst_ds_osdcoord_export_engine_matches (engine, config)) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_EXIST,
+        "the shared export sink %s is in use with other settings", key);
+    engine = NULL;
+  } else if (!engine) {
+    engine = gst_ds_osdcoord_export_engine_new (config, error);
+    if (engine) {
+      engine->key = key;
+      key = NULL;
+      g_hash_table_insert (engines, engine->key, engine);
+    }
+  }
+  if (engine)
+    engine->ref_count++;
+  g_mutex_unlock (&engines_lock);
+
+  g_free (key);
+  return engine;
+}
+
+/**
+ * Drop a reference taken by gst_ds_osdcoord_export_engine_acquire(),
+ * freeing the engine with the last one.
+ */
+static void
+gst_ds_osdcoord_export_engine_release (GstDsOsdCoordExportEngine * engine)
+{
+  gboolean last;
+
+  g_mutex_lock (&engines_lock);
+  last = --engine->ref_count == 0;
+  if (last && engine->key)
+    g_hash_table_remove (engines, engine->key);
+  g_mutex_unlock (&engines_lock);
+
+  if (last)
+    gst_ds_osdcoord_export_engine_free (engine);
+}
+
+/**
+ * Create an exporter with room for at least config->queue_size records and
+ * register it with its engine, which is started if new.
+ */
+GstDsOsdCoordExporter *
+gst_ds_osdcoord_exporter_new (const GstDsOsdCoordExportConfig * config,
+    GError ** error)
+{
+  GstDsOsdCoordExportEngine *engine;
+  GstDsOsdCoordExporter *exporter;
+  guint capacity = 1;
+
+  engine = gst_ds_osdcoord_export_engine_acquire (config, error);
+  if (!engine)
+    return NULL;
+
+  while (capacity < config->queue_size && capacity < (1u << 30))
+    capacity <<= 1;
+
+  exporter = g_new0 (GstDsOsdCoordExporter, 1);
+  exporter->slots = g_new0 (GstDsOsdCoordExportRecord, capacity);
+  exporter->mask = capacity - 1;
+  exporter->policy = config->overflow_policy;
+  exporter->engine = engine;
+  exporter->running = 1;
+  if (config->fields & DSOSDCOORD_EXPORT_FIELD_MASK) {
+    exporter->mask_ring_size = (guint64) capacity *
+        EXPORT_MASK_COUNTS_PER_RECORD;
+    exporter->mask_ring = g_new (guint32, exporter->mask_ring_size);
+    exporter->mask_starts = g_new0 (guint64, capacity);
+  }
+
+  g_mutex_lock (&engine->queues_lock);
+  g_mutex_lock (&engine->lock);
+  exporter->exported_base = engine->exported;
+  engine->num_queues++;
+  g_mutex_unlock (&engine->lock);
+  g_ptr_array_add (engine->queues, exporter);
+  g_mutex_unlock (&engine->queues_lock);
+
+  return exporter;
+}
+
+/**
+ * Wait until the engine has written all records queued by exporter, then
+ * refuse further ones. The dropped count is final afterwards, and no
+ * record of exporter is pending in the sink.
+ */
+void
+gst_ds_osdcoord_exporter_stop (GstDsOsdCoordExporter * exporter)
+{
+  GstDsOsdCoordExportEngine *engine = exporter->engine;
+  guint64 pass;
+
+  g_mutex_lock (&engine->lock);
+  if (!g_atomic_int_get (&exporter->running)) {
+    g_mutex_unlock (&engine->lock);
+    return;
+  }
+  g_atomic_int_set (&exporter->running, 0);
+  g_cond_broadcast (&engine->space_cond);
+
+  /* The next pass to start sends held back datagrams; as each pass takes a
+     bounded number of records, wait for more until the queue is empty. */
+  do {
+    engine->flush_requested = TRUE;
+    pass = engine->passes_started + 1;
+    g_cond_signal (&engine->data_cond);
+    while (engine->passes_ended < pass)
+      g_cond_wait (&engine->pass_cond, &engine->lock);
+  } while (g_atomic_int_get (&exporter->tail) !=
+      g_atomic_int_get (&exporter->head));
+  g_mutex_unlock (&engine->lock);
+}
+
+/**
+ * Stop the exporter if still running, unregister it from its engine and
+ * free it.
+ */
+void
+gst_ds_osdcoord_exporter_free (GstDsOsdCoordExporter * exporter)
+{
+  GstDsOsdCoordExportEngine *engine;
+
+  if (!exporter)
+    return;
+
+  gst_ds_osdcoord_exporter_stop (exporter);
+
+  engine = exporter->engine;
+  g_mutex_lock (&engine->queues_lock);
+  g_ptr_array_remove (engine->queues, exporter);
+  if (engine->current == exporter)
+    engine->current = NULL;
+  g_mutex_lock (&engine->lock);
+  engine->num_queues--;
+  g_mutex_unlock (&engine->lock);
+  g_mutex_unlock (&engine->queues_lock);
+  gst_ds_osdcoord_export_engine_release (engine);
+
+  g_free (exporter->slots);
+  g_free (exporter->mask_ring);
+  g_free (exporter->mask_starts);
+  g_free (exporter);
+}
+
+/**
+ * Return the next free record slot, applying the overflow policy if the
+ * queue is full. Returns NULL if the record is to be dropped. The slot must
+ * be published with gst_ds_osdcoord_exporter_commit() before the next call.
+ * Must only be called from the streaming thread.
+ */
+GstDsOsdCoordExportRecord *
+gst_ds_osdcoord_exporter_reserve (GstDsOsdCoordExporter * exporter)
+{
+  GstDsOsdCoordExportEngine *engine = exporter->engine;
+  guint head = (guint) exporter->head;
+  guint tail = (guint) g_atomic_int_get (&exporter->tail);
+
+  if (head - tail > exporter->mask) {
+    switch (exporter->policy) {
+      case DSOSDCOORD_OVERFLOW_DROP_NEWEST:
+        exporter->dropped++;
+        return NULL;
+      case DSOSDCOORD_OVERFLOW_DROP_OLDEST:
+        /* If the engine thread took the oldest record in the meantime
+         * there is room anyway. */
+        if (g_atomic_int_compare_and_exchange (&exporter->tail, (gint) tail,
+                (gint) (tail + 1)))
+          exporter->dropped++;
+        break;
+      case DSOSDCOORD_OVERFLOW_BLOCK:
+      default:
+        g_mutex_lock (&engine->lock);
+        g_atomic_int_set (&exporter->producer_waiting, 1);
+        while (head - (guint) g_atomic_int_get (&exporter->tail) >
+            exporter->mask && g_atomic_int_get (&exporter->running)) {
+          g_cond_signal (&engine->data_cond);
+          g_cond_wait (&engine->space_cond, &engine->lock);
+        }
+        g_atomic_int_set (&exporter->producer_waiting, 0);
+        g_mutex_unlock (&engine->lock);
+        if (!g_atomic_int_get (&exporter->running)) {
+          exporter->dropped++;
+          return NULL;
+        }
+        break;
+    }
+  }
+
+  if (exporter->mask_starts)
+    exporter->mask_starts[head & exporter->mask] = exporter->mask_head;
+  return &exporter->slots[head & exporter->mask];
+}
+
+/**
+ * Copy the mask of record, the slot returned by the last
+ * gst_ds_osdcoord_exporter_reserve(), from the scratch memory of the
+ * streaming thread into the mask ring. If the ring has no room for it, or
+ * the mask has more than DSOSDCOORD_MAX_MASK_COUNTS runs, the mask is
+ * dropped and FALSE returned; the record is exported without it.
+ */
+gboolean
+gst_ds_osdcoord_exporter_push_mask (GstDsOsdCoordExporter * exporter,
+    GstDsOsdCoordExportRecord * record)
+{
+  guint head = (guint) exporter->head;
+  guint tail = (guint) g_atomic_int_get (&exporter->tail);
+  guint64 size = exporter->mask_ring_size;
+  guint64 start = exporter->mask_head, oldest, offset;
+  guint n = record->num_mask_counts;
+
+  if (!exporter->mask_ring || !record->mask_counts ||
+      n > DSOSDCOORD_MAX_MASK_COUNTS)
+    goto drop;
+
+  /* The data of the oldest queued record, or none if the queue is empty,
+     must not be overwritten. A stale tail only makes this stricter. */
+  oldest = tail == head ? start : exporter->mask_starts[tail & exporter->mask];
+  offset = start % size;
+  /* The counts are kept contiguous, skipping the end of the ring. */
+  if (offset + n > size) {
+    start += size - offset;
+    offset = 0;
+  }
+  if (start + n - oldest > size)
+    goto drop;
+
+  memcpy (exporter->mask_ring + offset, record->mask_counts,
+      n * sizeof (guint32));
+  record->mask_counts = exporter->mask_ring + offset;
+  exporter->mask_head = start + n;
+  return TRUE;
+
+drop:
+  record->fields &= ~DSOSDCOORD_EXPORT_FIELD_MASK;
+  record->num_mask_counts = 0;
+  record->mask_counts = NULL;
+  exporter->masks_dropped++;
+  return FALSE;
+}
+
+/**
+ * Publish the slot returned by the last gst_ds_osdcoord_exporter_reserve().
+ */
+void
+gst_ds_osdcoord_exporter_commit (GstDsOsdCoordExporter * exporter)
+{
+  g_atomic_int_set (&exporter->head, exporter->head + 1);
+}
+
+/**
+ * Wake the engine thread if it is idle. Called once per buffer rather than
+ * per record so the streaming thread only takes the lock when needed.
+ */
+void
+gst_ds_osdcoord_exporter_kick (GstDsOsdCoordExporter * exporter)
+{
+  GstDsOsdCoordExportEngine *engine = exporter->engine;
+
+  if (g_atomic_int_get (&engine->consumer_waiting)) {
+    g_mutex_lock (&engine->lock);
+    g_cond_signal (&engine->data_cond);
+    g_mutex_unlock (&engine->lock);
+  }
+}
+
+/**
+ * Records of exporter the sink dropped.
+ */
+static guint64
+gst_ds_osdcoord_exporter_get_sink_dropped (GstDsOsdCoordExporter * exporter)
+{
+  GstDsOsdCoordExportEngine *engine = exporter->engine;
+  guint64 sink_dropped;
+
+  g_mutex_lock (&engine->lock);
+  sink_dropped = exporter->sink_dropped;
+  g_mutex_unlock (&engine->lock);
+  return sink_dropped;
+}
+
+/**
+ * Records dropped because the queue was full or the sink could not take
+ * them.
+ */
+guint64
+gst_ds_osdcoord_exporter_get_dropped (GstDsOsdCoordExporter * exporter)
+{
+  return exporter->dropped +
+      gst_ds_osdcoord_exporter_get_sink_dropped (exporter);
+}
+
+/**
+ * Add the counters of exporter to s: the records taken from its queue,
+ * still queued and dropped there, the records the sink dropped, the number
+ * of instances sharing the sink and the share of the records the sink took
+ * from this instance since it joined.
+ */
+void
+gst_ds_osdcoord_exporter_add_to_structure (GstDsOsdCoordExporter * exporter,
+    GstStructure * s)
+{
+  GstDsOsdCoordExportEngine *engine = exporter->engine;
+  guint64 exported, total, sink_dropped;
+  guint queued, instances;
+
+  /* Only the short-held lock, never queues_lock, which the engine thread
+     holds while writing to the sink. */
+  g_mutex_lock (&engine->lock);
+  exported = exporter->exported;
+  total = engine->exported - exporter->exported_base;
+  sink_dropped = exporter->sink_dropped;
+  instances = engine->num_queues;
+  g_mutex_unlock (&engine->lock);
+  queued = (guint) g_atomic_int_get (&exporter->head) -
+      (guint) g_atomic_int_get (&exporter->tail);
+
+  gst_structure_set (s,
+      "export-records", G_TYPE_UINT64, exported,
+      "export-queued", G_TYPE_UINT, queued,
+      "export-queue-dropped", G_TYPE_UINT64, exporter->dropped,
+      "export-masks-dropped", G_TYPE_UINT64, exporter->masks_dropped,
+      "export-sink-dropped", G_TYPE_UINT64, sink_dropped,
+      "export-instances", G_TYPE_UINT, instances,
+      "export-share", G_TYPE_DOUBLE,
+      total > 0 ? (gdouble) exported / total : 0.0, NULL);
+}
+
+/**
+ * Bytes allocated for the queue of exporter and by its engine for the
+ * output buffer and sink, which a shared engine reports for every instance.
+ * The engine's part is as of its last pass, as its buffers are only
+ * touched by the engine thread.
+ */
+gsize
+gst_ds_osdcoord_exporter_get_memory_usage (GstDsOsdCoordExporter * exporter)
+{
+  GstDsOsdCoordExportEngine *engine = exporter->engine;
+  gsize total = sizeof (*exporter);
+
+  total += (gsize) (exporter->mask + 1) * sizeof (GstDsOsdCoordExportRecord);
+  if (exporter->mask_ring)
+    total += exporter->mask_ring_size * sizeof (guint32) +
+        (exporter->mask + 1) * sizeof (guint64);
+  g_mutex_lock (&engine->lock);
+  total += engine->memory_usage;
+  g_mutex_unlock (&engine->lock);
+  return total;
+}
@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_EXPORTER_H__
+#define __GST_DSOSDCOORD_EXPORTER_H__
+
+#include <gst/gst.h>
+#include "nvdsmeta.h"
+
+G_BEGIN_DECLS
+
+/**
+ * What the streaming thread does when the export queue is full.
+ */
+typedef enum
+{
+  /** Wait until the exporter thread frees a slot. */
+  DSOSDCOORD_OVERFLOW_BLOCK,
+  /** Discard the oldest queued record to make room. */
+  DSOSDCOORD_OVERFLOW_DROP_OLDEST,
+  /** Discard the record being pushed. */
+  DSOSDCOORD_OVERFLOW_DROP_NEWEST,
+} GstDsOsdCoordOverflowPolicy;
+
+/**
+ * Where the exporter thread writes records to.
+ */
+typedef enum
+{
+  /** Records on stdout, serialized as GstDsOsdCoordExportFormat. */
+  DSOSDCOORD_EXPORT_SINK_STDOUT,
+  /** Fixed-layout records in a shared memory ring, see dsosdcoord_shm.h. */
+  DSOSDCOORD_EXPORT_SINK_SHM,
+  /** Datagrams of whole records on a Unix domain socket. */
+  DSOSDCOORD_EXPORT_SINK_UDS,
+  /** Rotating, indexed segment files, see dsosdcoord_log.h. */
+  DSOSDCOORD_EXPORT_SINK_FILE,
+} GstDsOsdCoordExportSink;
+
+/**
+ * How records are serialized for the stdout and uds sinks. The file sink
+ * always writes the binary format.
+ */
+typedef enum
+{
+  /** One text line per record. */
+  DSOSDCOORD_EXPORT_FORMAT_TEXT,
+  /** Frame chunks with a string table, see dsosdcoord_bin.h. */
+  DSOSDCOORD_EXPORT_FORMAT_BINARY,
+} GstDsOsdCoordExportFormat;
+
+/**
+ * Object meta exported besides the box, label and class_id, collected in
+ * the same walk of the object list when selected with export-fields.
+ */
+typedef enum
+{
+  /** NvDsObjectMeta::confidence */
+  DSOSDCOORD_EXPORT_FIELD_CONFIDENCE = (1 << 0),
+  /** NvDsObjectMeta::tracker_confidence */
+  DSOSDCOORD_EXPORT_FIELD_TRACKER_CONFIDENCE = (1 << 1),
+  /** Labels of classifier_meta_list, DSOSDCOORD_MAX_CLASSIFIER_RESULTS at
+      most. */
+  DSOSDCOORD_EXPORT_FIELD_CLASSIFIER = (1 << 2),
+  /** meta_type of the obj_user_meta_list entries, DSOSDCOORD_MAX_USER_META
+      at most; their data is opaque to dsosdcoord. */
+  DSOSDCOORD_EXPORT_FIELD_USER_META = (1 << 3),
+  /** mask_params thresholded at its threshold and run-length encoded,
+      DSOSDCOORD_MAX_MASK_COUNTS runs at most. */
+  DSOSDCOORD_EXPORT_FIELD_MASK = (1 << 4),
+} GstDsOsdCoordExportField;
+
+#define DSOSDCOORD_MAX_CLASSIFIER_RESULTS 4
+#define DSOSDCOORD_MAX_USER_META 4
+/** Bytes of a classifier label in a record, longer ones are truncated. */
+#define DSOSDCOORD_CLASSIFIER_LABEL_SIZE 32
+/** Most runs of an exported mask; masks with more are dropped. */
+#define DSOSDCOORD_MAX_MASK_COUNTS 4096
+
+/**
+ * Exporter settings, taken from the element properties at start().
+ */
+typedef struct _GstDsOsdCoordExportConfig
+{
+  /** Number of records the export queue can hold. */
+  guint queue_size;
+  /** What to do with records when the export queue is full. */
+  GstDsOsdCoordOverflowPolicy overflow_policy;
+  /** Where records are written to. */
+  GstDsOsdCoordExportSink sink;
+  /** Serialization of the stdout and uds sinks. */
+  GstDsOsdCoordExportFormat format;
+  /** Name of the shared memory object for DSOSDCOORD_EXPORT_SINK_SHM. */
+  const gchar *shm_name;
+  /** Number of record slots in the shared memory ring. */
+  guint shm_slots;
+  /** Socket path of the receiver for DSOSDCOORD_EXPORT_SINK_UDS. */
+  const gchar *uds_path;
+  /** Microseconds datagrams are held back to be sent together, 0 to send
+      them once per buffer. */
+  guint uds_flush_us;
+  /** Directory of the segment files for DSOSDCOORD_EXPORT_SINK_FILE. */
+  const gchar *file_location;
+  /** Bytes preallocated per segment, after which it is rotated. */
+  guint file_segment_size;
+  /** Seconds after which a segment is rotated, 0 for no limit. */
+  guint file_segment_seconds;
+  /** Milliseconds between syncs of the current segment, 0 to sync
+      segments only when they are closed. */
+  guint file_sync_interval;
+  /** Whether text output prints coordinates as integers. */
+  gboolean integer_coords;
+  /** Whether the sink and its thread are shared with the other exporters
+      of the process writing to the same destination. */
+  gboolean shared;
+  /** DSOSDCOORD_EXPORT_FIELD_* the records carry, which decides the
+      object size of a binary stream. */
+  guint fields;
+} GstDsOsdCoordExportConfig;
+
+/** The record carries source_id and batch_id of its frame. */
+#define DSOSDCOORD_RECORD_FLAG_HAS_SOURCE (1 << 0)
+/** The record carries the object_id and event of a track. */
+#define DSOSDCOORD_RECORD_FLAG_HAS_TRACK (1 << 1)
+
+/**
+ * Why the record of a track is exported with export-mode=changes.
+ */
+typedef enum
+{
+  /** The object is not tracked, or export-mode=all. */
+  DSOSDCOORD_TRACK_EVENT_NONE,
+  /** First record of the track. */
+  DSOSDCOORD_TRACK_EVENT_APPEAR,
+  /** The box moved or was resized beyond the thresholds. */
+  DSOSDCOORD_TRACK_EVENT_MOVE,
+  /** Periodic snapshot of an unchanged track. */
+  DSOSDCOORD_TRACK_EVENT_KEYFRAME,
+  /** The track was not seen for the grace period; the box is the last
+      exported one. */
+  DSOSDCOORD_TRACK_EVENT_DISAPPEAR,
+} GstDsOsdCoordTrackEvent;
+
+/**
+ * One label of a secondary classifier.
+ */
+typedef struct _GstDsOsdCoordClassifierResult
+{
+  /** unique_component_id of the classifier. */
+  gint component_id;
+  guint class_id;
+  gfloat prob;
+  /** Hash of label from gst_ds_osdcoord_label_copy(). */
+  guint32 label_hash;
+  gchar label[DSOSDCOORD_CLASSIFIER_LABEL_SIZE];
+} GstDsOsdCoordClassifierResult;
+
+/**
+ * Fixed-size record of one detected object, copied by the streaming thread
+ * and serialized by the exporter thread. The export-fields part comes last
+ * and is only copied when fields is not 0, see
+ * gst_ds_osdcoord_export_record_size().
+ */
+typedef struct _GstDsOsdCoordExportRecord
+{
+  /** Frame number the object belongs to. */
+  guint frame_num;
+  /** Buffer PTS of the frame. */
+  GstClockTime pts;
+  /** Source and position in the batch of the frame. */
+  guint source_id;
+  guint batch_id;
+  /** DSOSDCOORD_RECORD_FLAG_* */
+  guint flags;
+  /** Tracker id of the object, UNTRACKED_OBJECT_ID if not tracked. */
+  guint64 object_id;
+  GstDsOsdCoordTrackEvent event;
+  /** Bounding box of the object. */
+  gfloat left;
+  gfloat top;
+  gfloat width;
+  gfloat height;
+  /** class_id of the object meta. */
+  gint class_id;
+  /** Hash of label from gst_ds_osdcoord_label_copy(), computed by the
+      streaming thread so the exporter thread looks the label up in the
+      string table of a binary stream without hashing it. */
+  guint32 label_hash;
+  /** Label of the object, truncated to MAX_LABEL_SIZE. */
+  gchar label[MAX_LABEL_SIZE];
+
+  /** DSOSDCOORD_EXPORT_FIELD_* filled in below, 0 if none. */
+  guint fields;
+  gfloat confidence;
+  gfloat tracker_confidence;
+  guint num_classifier_results;
+  GstDsOsdCoordClassifierResult
+      classifier_results[DSOSDCOORD_MAX_CLASSIFIER_RESULTS];
+  guint num_user_meta;
+  guint user_meta_types[DSOSDCOORD_MAX_USER_META];
+  /** Size of the mask and its runs from gst_ds_osdcoord_rle_encode().
+      mask_counts points into the scratch arena of the worker until the
+      record is committed, then into the mask ring of the exporter. */
+  guint mask_width;
+  guint mask_height;
+  guint num_mask_counts;
+  guint32 *mask_counts;
+} GstDsOsdCoordExportRecord;
+
+/**
+ * Bytes of record in use: records without export-fields end at fields.
+ */
+static inline gsize
+gst_ds_osdcoord_export_record_size (const GstDsOsdCoordExportRecord * record)
+{
+  return record->fields ? sizeof (GstDsOsdCoordExportRecord) :
+      G_STRUCT_OFFSET (GstDsOsdCoordExportRecord, confidence);
+}
+
+typedef struct _GstDsOsdCoordExporter GstDsOsdCoordExporter;
+
+GstDsOsdCoordExporter *gst_ds_osdcoord_exporter_new (
+    const GstDsOsdCoordExportConfig * config, GError ** error);
+
+void gst_ds_osdcoord_exporter_stop (GstDsOsdCoordExporter * exporter);
+
+void gst_ds_osdcoord_exporter_free (GstDsOsdCoordExporter * exporter);
+
+GstDsOsdCoordExportRecord *gst_ds_osdcoord_exporter_reserve (
+    GstDsOsdCoordExporter * exporter);
+
+gboolean gst_ds_osdcoord_exporter_push_mask (GstDsOsdCoordExporter * exporter,
+    GstDsOsdCoordExportRecord * record);
+
+void gst_ds_osdcoord_exporter_commit (GstDsOsdCoordExporter * exporter);
+
+void gst_ds_osdcoord_exporter_kick (GstDsOsdCoordExporter * exporter);
+
+guint64 gst_ds_osdcoord_exporter_get_dropped (GstDsOsdCoordExporter * exporter);
+
+void gst_ds_osdcoord_exporter_add_to_structure (
+    GstDsOsdCoordExporter * exporter, GstStructure * s);
+
+gsize gst_ds_osdcoord_exporter_get_memory_usage (
+    GstDsOsdCoordExporter * exporter);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_EXPORTER_H__ */
@@ -0,0 +1,343 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <math.h>
+#include <string.h>
+#include "gstdsosdcoord_filter.h"
+#include "gstdsosdcoord_color.h"
+
+#define BITSET_WORDS(n) (((n) + 31) / 32)
+
+void
+gst_ds_osdcoord_filter_config_clear (GstDsOsdCoordFilterConfig * config)
+{
+  g_free (config->class_ids);
+  g_free (config->exclude_class_ids);
+  g_free (config->roi);
+  config->class_ids = NULL;
+  config->exclude_class_ids = NULL;
+  config->roi = NULL;
+}
+
+void
+gst_ds_osdcoord_filter_config_copy (GstDsOsdCoordFilterConfig * dst,
+    const GstDsOsdCoordFilterConfig * src)
+{
+  *dst = *src;
+  dst->class_ids = g_strdup (src->class_ids);
+  dst->exclude_class_ids = g_strdup (src->exclude_class_ids);
+  dst->roi = g_strdup (src->roi);
+}
+
+/**
+ * Parse "id;id;..." into a bitset covering ids up to the largest one.
+ * Returns FALSE and sets error if an id is malformed. *bits is NULL if the
+ * string lists no id.
+ */
+static gboolean
+gst_ds_osdcoord_filter_parse_classes (const gchar * str, const gchar * name,
+    guint32 ** bits, guint * size, GError ** error)
+{
+  gchar **ids = g_strsplit_set (str ? str : "", ";,", -1);
+  GArray *values = g_array_new (FALSE, FALSE, sizeof (guint));
+  guint i, max_id = 0;
+
+  for (i = 0; ids[i]; i++) {
+    gchar *end = NULL;
+    gint64 id;
+    guint value;
+
+    if (g_strstrip (ids[i])[0] == '\0')
+      continue;
+    id = g_ascii_strtoll (ids[i], &end, 10);
+    if (end == ids[i] || *end != '\0' || id < 0 ||
+        id > DSOSDCOORD_MAX_CLASS_ID) {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+          "invalid class id \"%s\" in %s, expected an integer between 0 "
+          "and %d", ids[i], name, DSOSDCOORD_MAX_CLASS_ID);
+      g_array_free (values, TRUE);
+      g_strfreev (ids);
+      return FALSE;
+    }
+    value = (guint) id;
+    g_array_append_val (values, value);
+    max_id = MAX (max_id, value);
+  }
+  g_strfreev (ids);
+
+  *bits = NULL;
+  *size = 0;
+  if (values->len > 0) {
+    *size = max_id + 1;
+    *bits = g_new0 (guint32, BITSET_WORDS (*size));
+    for (i = 0; i < values->len; i++) {
+      guint id = g_array_index (values, guint, i);
+      (*bits)[id >> 5] |= 1u << (id & 31);
+    }
+  }
+  g_array_free (values, TRUE);
+  return TRUE;
+}
+
+static void
+gst_ds_osdcoord_roi_grid_free (GstDsOsdCoordRoiGrid * grid)
+{
+  if (!grid)
+    return;
+  g_free (grid->bits);
+  g_free (grid);
+}
+
+static gint
+gst_ds_osdcoord_compare_double (gconstpointer a, gconstpointer b)
+{
+  gdouble da = *(const gdouble *) a, db = *(const gdouble *) b;
+
+  return da < db ? -1 : da > db;
+}
+
+/**
+ * Rasterize the union of polygons, each a GArray of x,y gfloat pairs. A
+ * cell is inside a polygon if its center is, by the even-odd rule. The
+ * coordinates are within DSOSDCOORD_MAX_ROI_COORD, which bounds the grid.
+ */
+static GstDsOsdCoordRoiGrid *
+gst_ds_osdcoord_roi_grid_new (GPtrArray * polygons)
+{
+  GstDsOsdCoordRoiGrid *grid = g_new0 (GstDsOsdCoordRoiGrid, 1);
+  GArray *crossings = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  gfloat min_x = G_MAXFLOAT, min_y = G_MAXFLOAT;
+  gfloat max_x = -G_MAXFLOAT, max_y = -G_MAXFLOAT;
+  guint i, j, k, row;
+
+  for (i = 0; i < polygons->len; i++) {
+    GArray *points = g_ptr_array_index (polygons, i);
+
+    for (j = 0; j < points->len; j += 2) {
+      gfloat x = g_array_index (points, gfloat, j);
+      gfloat y = g_array_index (points, gfloat, j + 1);
+
+      min_x = MIN (min_x, x);
+      max_x = MAX (max_x, x);
+      min_y = MIN (min_y, y);
+      max_y = MAX (max_y, y);
+    }
+  }
+
+  grid->x = min_x;
+  grid->y = min_y;
+  grid->cols = MAX ((guint) ceil ((max_x - min_x) / DSOSDCOORD_ROI_CELL_SIZE),
+      1);
+  grid->rows = MAX ((guint) ceil ((max_y - min_y) / DSOSDCOORD_ROI_CELL_SIZE),
+      1);
+  grid->stride = BITSET_WORDS (grid->cols);
+  grid->bits = g_new0 (guint32, (gsize) grid->stride * grid->rows);
+
+  for (row = 0; row < grid->rows; row++) {
+    gdouble yc = grid->y + (row + 0.5) * DSOSDCOORD_ROI_CELL_SIZE;
+    guint32 *bits = grid->bits + (gsize) row * grid->stride;
+
+    for (i = 0; i < polygons->len; i++) {
+      GArray *points = g_ptr_array_index (polygons, i);
+      guint n = points->len / 2;
+
+      g_array_set_size (crossings, 0);
+      for (j = 0, k = n - 1; j < n; k = j++) {
+        gdouble x0 = g_array_index (points, gfloat, 2 * k);
+        gdouble y0 = g_array_index (points, gfloat, 2 * k + 1);
+        gdouble x1 = g_array_index (points, gfloat, 2 * j);
+        gdouble y1 = g_array_index (points, gfloat, 2 * j + 1);
+        gdouble x;
+
+        if ((y0 <= yc) == (y1 <= yc))
+          continue;
+        x = x0 + (yc - y0) * (x1 - x0) / (y1 - y0);
+        g_array_append_val (crossings, x);
+      }
+      g_array_sort (crossings, gst_ds_osdcoord_compare_double);
+
+      /* Fill the cells whose center lies between each pair of crossings. */
+      for (j = 0; j + 1 < crossings->len; j += 2) {
+        gdouble a = (g_array_index (crossings, gdouble, j) - grid->x) /
+            DSOSDCOORD_ROI_CELL_SIZE - 0.5;
+        gdouble b = (g_array_index (crossings, gdouble, j + 1) - grid->x) /
+            DSOSDCOORD_ROI_CELL_SIZE - 0.5;
+        gint first = MAX ((gint) ceil (a), 0);
+        gint last = MIN ((gint) ceil (b), (gint) grid->cols);
+        gint col;
+
+        for (col = first; col < last; col++)
+          bits[col >> 5] |= 1u << (col & 31);
+      }
+    }
+  }
+
+  g_array_free (crossings, TRUE);
+  return grid;
+}
+
+/**
+ * Parse "source_id:x,y,x,y,x,y,...;..." and rasterize the polygons of each
+ * source. A source may be listed more than once; its polygons are merged.
+ */
+static gboolean
+gst_ds_osdcoord_filter_parse_roi (GstDsOsdCoordFilter * filter,
+    const gchar * str, GError ** error)
+{
+  gchar **entries = g_strsplit (str ? str : "", ";", -1);
+  GPtrArray **sources = g_new0 (GPtrArray *, DSOSDCOORD_MAX_SOURCE_ID + 1);
+  guint i, num_sources = 0;
+  gboolean ok = TRUE;
+
+  for (i = 0; entries[i] && ok; i++) {
+    gchar **parts, **coords = NULL;
+    gchar *end = NULL;
+    gint64 source_id = -1;
+    GArray *points = NULL;
+    guint j, n = 0;
+
+    if (g_strstrip (entries[i])[0] == '\0')
+      continue;
+
+    parts = g_strsplit (entries[i], ":", 2);
+    if (g_strv_length (parts) == 2) {
+      source_id = g_ascii_strtoll (parts[0], &end, 10);
+      coords = g_strsplit (parts[1], ",", -1);
+      n = g_strv_length (coords);
+    }
+    ok = end != parts[0] && source_id >= 0 &&
+        source_id <= DSOSDCOORD_MAX_SOURCE_ID && n >= 6 && n % 2 == 0;
+
+    if (ok) {
+      points = g_array_sized_new (FALSE, FALSE, sizeof (gfloat), n);
+      for (j = 0; j < n && ok; j++) {
+        gchar *coord_end = NULL;
+        gfloat v = (gfloat) g_ascii_strtod (coords[j], &coord_end);
+
+        while (g_ascii_isspace (*coord_end))
+          coord_end++;
+        /* Also rejects NaN, which would make the grid size undefined. */
+        ok = coord_end != coords[j] && *coord_end == '\0' && v >= 0 &&
+            v <= DSOSDCOORD_MAX_ROI_COORD;
+        g_array_append_val (points, v);
+      }
+    }
+    g_strfreev (coords);
+    g_strfreev (parts);
+
+    if (!ok) {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+          "invalid roi \"%s\", expected source_id:x,y,x,y,x,y,... with at "
+          "least three points, source_id between 0 and %d and coordinates "
+          "between 0 and %d", entries[i], DSOSDCOORD_MAX_SOURCE_ID,
+          DSOSDCOORD_MAX_ROI_COORD);
+      if (points)
+        g_array_free (points, TRUE);
+      break;
+    }
+
+    if (!sources[source_id])
+      sources[source_id] =
+          g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+    g_ptr_array_add (sources[source_id], points);
+    num_sources = MAX (num_sources, (guint) source_id + 1);
+  }
+  g_strfreev (entries);
+
+  if (ok && num_sources > 0) {
+    filter->num_rois = num_sources;
+    filter->rois = g_new0 (GstDsOsdCoordRoiGrid *, num_sources);
+    for (i = 0; i < num_sources; i++) {
+      if (sources[i])
+        filter->rois[i] = gst_ds_osdcoord_roi_grid_new (sources[i]);
+    }
+  }
+  for (i = 0; i <= DSOSDCOORD_MAX_SOURCE_ID; i++) {
+    if (sources[i])
+      g_ptr_array_unref (sources[i]);
+  }
+  g_free (sources);
+  return ok;
+}
+
+/**
+ * Compile config into a new filter.
+ * Returns NULL and sets error if one of the strings is malformed.
+ */
+GstDsOsdCoordFilter *
+gst_ds_osdcoord_filter_new (const GstDsOsdCoordFilterConfig * config,
+    GError ** error)
+{
+  GstDsOsdCoordFilter *filter = g_new0 (GstDsOsdCoordFilter, 1);
+
+  filter->ref_count = 1;
+  if (!gst_ds_osdcoord_filter_parse_classes (config->class_ids, "class-ids",
+          &filter->allow, &filter->allow_size, error) ||
+      !gst_ds_osdcoord_filter_parse_classes (config->exclude_class_ids,
+          "exclude-class-ids", &filter->deny, &filter->deny_size, error) ||
+      !gst_ds_osdcoord_filter_parse_roi (filter, config->roi, error)) {
+    gst_ds_osdcoord_filter_unref (filter);
+    return NULL;
+  }
+
+  filter->min_confidence = config->min_confidence;
+  filter->min_area = config->min_area;
+  filter->max_area = config->max_area > 0 ? config->max_area : G_MAXFLOAT;
+  filter->pass_all = !filter->allow && !filter->deny && !filter->rois &&
+      config->min_confidence <= -1.0f && config->min_area == 0 &&
+      config->max_area == 0;
+
+  return filter;
+}
+
+GstDsOsdCoordFilter *
+gst_ds_osdcoord_filter_ref (GstDsOsdCoordFilter * filter)
+{
+  g_atomic_int_inc (&filter->ref_count);
+  return filter;
+}
+
+void
+gst_ds_osdcoord_filter_unref (GstDsOsdCoordFilter * filter)
+{
+  guint i;
+
+  if (!filter || !g_atomic_int_dec_and_test (&filter->ref_count))
+    return;
+
+  for (i = 0; i < filter->num_rois; i++)
+    gst_ds_osdcoord_roi_grid_free (filter->rois[i]);
+  g_free (filter->rois);
+  g_free (filter->allow);
+  g_free (filter->deny);
+  g_free (filter);
+}
+
+/**
+ * Bytes allocated for the filter.
+ */
+gsize
+gst_ds_osdcoord_filter_get_size (const GstDsOsdCoordFilter * filter)
+{
+  gsize size = sizeof (*filter);
+  guint i;
+
+  size += BITSET_WORDS (filter->allow_size) * sizeof (guint32);
+  size += BITSET_WORDS (filter->deny_size) * sizeof (guint32);
+  size += filter->num_rois * sizeof (GstDsOsdCoordRoiGrid *);
+  for (i = 0; i < filter->num_rois; i++) {
+    if (filter->rois[i])
+      size += sizeof (GstDsOsdCoordRoiGrid) + (gsize) filter->rois[i]->stride *
+          filter->rois[i]->rows * sizeof (guint32);
+  }
+  return size;
+}
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_FILTER_H__
+#define __GST_DSOSDCOORD_FILTER_H__
+
+#include <gst/gst.h>
+#include "gstnvdsmeta.h"
+
+G_BEGIN_DECLS
+
+/** Largest source id accepted in roi. */
+#define DSOSDCOORD_MAX_SOURCE_ID 1023
+/** Width and height in pixels of the cells ROI polygons are rasterized to. */
+#define DSOSDCOORD_ROI_CELL_SIZE 4
+/** Largest ROI coordinate in pixels, which bounds a grid to
+    (DSOSDCOORD_MAX_ROI_COORD / DSOSDCOORD_ROI_CELL_SIZE)^2 cells. */
+#define DSOSDCOORD_MAX_ROI_COORD 16384
+
+/**
+ * Export filter settings as set through the element properties.
+ */
+typedef struct _GstDsOsdCoordFilterConfig
+{
+  /** "id;id;..." of the classes to export, NULL or empty for all. */
+  gchar *class_ids;
+  /** "id;id;..." of the classes never to export. */
+  gchar *exclude_class_ids;
+  /** Objects with a lower confidence are not exported. */
+  gfloat min_confidence;
+  /** Bounds of the box area in pixels, 0 for no bound. */
+  guint min_area;
+  guint max_area;
+  /** "source_id:x,y,x,y,x,y,...;..." polygons objects of a source must
+      have their center in, NULL or empty for none. */
+  gchar *roi;
+} GstDsOsdCoordFilterConfig;
+
+/**
+ * Union of the ROI polygons of one source, rasterized to cells of
+ * DSOSDCOORD_ROI_CELL_SIZE pixels over their bounding box.
+ */
+typedef struct _GstDsOsdCoordRoiGrid
+{
+  /** Top left corner of the grid in pixels. */
+  gfloat x;
+  gfloat y;
+  guint cols;
+  guint rows;
+  /** One bit per cell, row after row, each row stride words long. */
+  guint32 *bits;
+  guint stride;
+} GstDsOsdCoordRoiGrid;
+
+/**
+ * Immutable, reference counted filter compiled from a
+ * GstDsOsdCoordFilterConfig. Like GstDsOsdCoordColorTable it is replaced as
+ * a whole when a property changes and picked up by the streaming thread at
+ * the next buffer.
+ */
+typedef struct _GstDsOsdCoordFilter
+{
+  gint ref_count;
+  /** TRUE if no setting filters anything out. */
+  gboolean pass_all;
+  /** Bitset of the classes to export, NULL for all classes. Covers ids
+      below allow_size; larger ids are not exported. */
+  guint32 *allow;
+  guint allow_size;
+  /** Bitset of the classes never to export. Covers ids below deny_size;
+      larger ids are not denied. */
+  guint32 *deny;
+  guint deny_size;
+  gfloat min_confidence;
+  gfloat min_area;
+  gfloat max_area;
+  /** Grid of each source id below num_rois, NULL for sources without
+      ROI. */
+  GstDsOsdCoordRoiGrid **rois;
+  guint num_rois;
+} GstDsOsdCoordFilter;
+
+void gst_ds_osdcoord_filter_config_clear (GstDsOsdCoordFilterConfig * config);
+
+void gst_ds_osdcoord_filter_config_copy (GstDsOsdCoordFilterConfig * dst,
+    const GstDsOsdCoordFilterConfig * src);
+
+GstDsOsdCoordFilter *gst_ds_osdcoord_filter_new (
+    const GstDsOsdCoordFilterConfig * config, GError ** error);
+
+GstDsOsdCoordFilter *gst_ds_osdcoord_filter_ref (GstDsOsdCoordFilter * filter);
+
+void gst_ds_osdcoord_filter_unref (GstDsOsdCoordFilter * filter);
+
+gsize gst_ds_osdcoord_filter_get_size (const GstDsOsdCoordFilter * filter);
+
+static inline gboolean
+gst_ds_osdcoord_bitset_get (const guint32 * bits, guint i)
+{
+  return (bits[i >> 5] >> (i & 31)) & 1;
+}
+
+/**
+ * Whether the center (x, y) lies in the ROI of source_id. Sources without
+ * ROI accept every point.
+ */
+static inline gboolean
+gst_ds_osdcoord_filter_in_roi (const GstDsOsdCoordFilter * filter,
+    guint source_id, gfloat x, gfloat y)
+{
+  const GstDsOsdCoordRoiGrid *grid;
+  gint col, row;
+
+  if (source_id >= filter->num_rois || !filter->rois[source_id])
+    return TRUE;
+  grid = filter->rois[source_id];
+  col = (gint) ((x - grid->x) * (1.0f / DSOSDCOORD_ROI_CELL_SIZE));
+  row = (gint) ((y - grid->y) * (1.0f / DSOSDCOORD_ROI_CELL_SIZE));
+  if (x < grid->x || y < grid->y || (guint) col >= grid->cols ||
+      (guint) row >= grid->rows)
+    return FALSE;
+  return gst_ds_osdcoord_bitset_get (grid->bits + row * grid->stride, col);
+}
+
+/**
+ * Whether the object of a frame of source_id passes the filter. Each check
+ * is a table lookup or a comparison, combined without short-circuiting.
+ */
+static inline gboolean
+gst_ds_osdcoord_filter_accept (const GstDsOsdCoordFilter * filter,
+    const NvDsObjectMeta * object_meta, guint source_id)
+{
+  const NvOSD_RectParams *rect = &object_meta->rect_params;
+  guint class_id = (guint) object_meta->class_id;
+  gfloat area = rect->width * rect->height;
+  gboolean ok;
+
+  if (filter->pass_all)
+    return TRUE;
+
+  ok = (filter->allow == NULL) | (class_id < filter->allow_size &&
+      gst_ds_osdcoord_bitset_get (filter->allow, class_id));
+  ok &= !(class_id < filter->deny_size &&
+      gst_ds_osdcoord_bitset_get (filter->deny, class_id));
+  ok &= object_meta->confidence >= filter->min_confidence;
+  ok &= (area >= filter->min_area) & (area <= filter->max_area);
+  return ok && gst_ds_osdcoord_filter_in_roi (filter, source_id,
+      rect->left + rect->width / 2, rect->top + rect->height / 2);
+}
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_FILTER_H__ */
@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <string.h>
+#include "gstdsosdcoord_labels.h"
+
+/* Slots of a new table; it is grown to keep at most half of them used. */
+#define LABELS_MIN_SLOTS 64
+
+/* FNV-1a */
+#define LABEL_HASH_SEED 2166136261u
+#define LABEL_HASH_PRIME 16777619u
+
+typedef struct
+{
+  guint32 hash;
+  /** Id of the label plus one, 0 for an empty slot. */
+  guint32 id;
+} GstDsOsdCoordLabelSlot;
+
+struct _GstDsOsdCoordLabels
+{
+  GstDsOsdCoordLabelSlot *slots;
+  guint mask;
+  guint max_labels;
+  /** Offset of each label in strings by id. */
+  GArray *offsets;
+  /** The labels, each followed by a NUL. */
+  GString *strings;
+};
+
+/**
+ * Copy label into dest of size bytes, truncated like g_strlcpy(), and
+ * return the hash of the copy. label may be NULL for an empty label.
+ */
+guint32
+gst_ds_osdcoord_label_copy (gchar * dest, const gchar * label, gsize size)
+{
+  guint32 hash = LABEL_HASH_SEED;
+  gsize i = 0;
+
+  if (label) {
+    for (; i + 1 < size && label[i]; i++) {
+      dest[i] = label[i];
+      hash = (hash ^ (guint8) label[i]) * LABEL_HASH_PRIME;
+    }
+  }
+  dest[i] = '\0';
+  return hash;
+}
+
+GstDsOsdCoordLabels *
+gst_ds_osdcoord_labels_new (guint max_labels)
+{
+  GstDsOsdCoordLabels *labels = g_new0 (GstDsOsdCoordLabels, 1);
+
+  labels->slots = g_new0 (GstDsOsdCoordLabelSlot, LABELS_MIN_SLOTS);
+  labels->mask = LABELS_MIN_SLOTS - 1;
+  labels->max_labels = max_labels;
+  labels->offsets = g_array_new (FALSE, FALSE, sizeof (guint32));
+  labels->strings = g_string_new (NULL);
+  return labels;
+}
+
+void
+gst_ds_osdcoord_labels_free (GstDsOsdCoordLabels * labels)
+{
+  g_free (labels->slots);
+  g_array_free (labels->offsets, TRUE);
+  g_string_free (labels->strings, TRUE);
+  g_free (labels);
+}
+
+/**
+ * Forget all labels, the next one added gets id 0 again. The memory of the
+ * table is kept.
+ */
+void
+gst_ds_osdcoord_labels_reset (GstDsOsdCoordLabels * labels)
+{
+  memset (labels->slots, 0,
+      (labels->mask + 1) * sizeof (GstDsOsdCoordLabelSlot));
+  g_array_set_size (labels->offsets, 0);
+  g_string_truncate (labels->strings, 0);
+}
+
+/**
+ * Double the slots, placing the labels again by their stored hashes.
+ */
+static void
+gst_ds_osdcoord_labels_grow (GstDsOsdCoordLabels * labels)
+{
+  GstDsOsdCoordLabelSlot *old = labels->slots;
+  guint old_size = labels->mask + 1;
+  guint i;
+
+  labels->mask = old_size * 2 - 1;
+  labels->slots = g_new0 (GstDsOsdCoordLabelSlot, old_size * 2);
+  for (i = 0; i < old_size; i++) {
+    guint j;
+
+    if (old[i].id == 0)
+      continue;
+    for (j = old[i].hash & labels->mask; labels->slots[j].id != 0;
+        j = (j + 1) & labels->mask);
+    labels->slots[j] = old[i];
+  }
+  g_free (old);
+}
+
+/**
+ * Return the id of label, whose hash was returned by
+ * gst_ds_osdcoord_label_copy(). A new label is added and *added set to TRUE,
+ * unless the table already holds max_labels labels, in which case
+ * DSOSDCOORD_LABEL_ID_NONE is returned.
+ */
+guint32
+gst_ds_osdcoord_labels_intern (GstDsOsdCoordLabels * labels,
+    const gchar * label, guint32 hash, gboolean * added)
+{
+  guint32 id, offset;
+  guint i;
+
+  *added = FALSE;
+  for (i = hash & labels->mask; labels->slots[i].id != 0;
+      i = (i + 1) & labels->mask) {
+    const GstDsOsdCoordLabelSlot *slot = &labels->slots[i];
+
+    if (slot->hash == hash &&
+        strcmp (labels->strings->str + g_array_index (labels->offsets,
+                guint32, slot->id - 1), label) == 0)
+      return slot->id - 1;
+  }
+
+  if (labels->offsets->len >= labels->max_labels)
+    return DSOSDCOORD_LABEL_ID_NONE;
+
+  id = labels->offsets->len;
+  offset = (guint32) labels->strings->len;
+  g_array_append_val (labels->offsets, offset);
+  g_string_append_len (labels->strings, label, strlen (label) + 1);
+  labels->slots[i].hash = hash;
+  labels->slots[i].id = id + 1;
+  *added = TRUE;
+
+  if (labels->offsets->len * 2 > labels->mask + 1)
+    gst_ds_osdcoord_labels_grow (labels);
+  return id;
+}
+
+/**
+ * Bytes allocated by the table.
+ */
+gsize
+gst_ds_osdcoord_labels_get_memory_usage (GstDsOsdCoordLabels * labels)
+{
+  return sizeof (*labels) +
+      (labels->mask + 1) * sizeof (GstDsOsdCoordLabelSlot) +
+      labels->offsets->len * sizeof (guint32) +
+      labels->strings->allocated_len;
+}
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_LABELS_H__
+#define __GST_DSOSDCOORD_LABELS_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/** Returned by gst_ds_osdcoord_labels_intern() when the table is full. */
+#define DSOSDCOORD_LABEL_ID_NONE G_MAXUINT32
+
+/**
+ * String table of the labels sent in a binary stream. Labels get ids in the
+ * order they are added. The table is an open-addressing hash over the
+ * hashes computed with gst_ds_osdcoord_label_copy(), so neither a lookup
+ * nor growing the table hashes a label again, and the labels are kept in
+ * one buffer reused after a reset.
+ */
+typedef struct _GstDsOsdCoordLabels GstDsOsdCoordLabels;
+
+guint32 gst_ds_osdcoord_label_copy (gchar * dest, const gchar * label,
+    gsize size);
+
+GstDsOsdCoordLabels *gst_ds_osdcoord_labels_new (guint max_labels);
+
+void gst_ds_osdcoord_labels_free (GstDsOsdCoordLabels * labels);
+
+void gst_ds_osdcoord_labels_reset (GstDsOsdCoordLabels * labels);
+
+guint32 gst_ds_osdcoord_labels_intern (GstDsOsdCoordLabels * labels,
+    const gchar * label, guint32 hash, gboolean * added);
+
+gsize gst_ds_osdcoord_labels_get_memory_usage (GstDsOsdCoordLabels * labels);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_LABELS_H__ */
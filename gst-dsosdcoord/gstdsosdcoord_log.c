@@ -0,0 +1,517 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "gstdsosdcoord_log.h"
+#include "dsosdcoord_log.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_ds_osdcoord_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_debug
+
+/* How long to wait before trying to open a segment again after a failure. */
+#define LOG_RETRY_US G_USEC_PER_SEC
+
+G_STATIC_ASSERT (sizeof (DsOsdCoordLogHeader) == 128);
+G_STATIC_ASSERT (sizeof (DsOsdCoordLogIndexEntry) == 24);
+
+/**
+ * One segment file, preallocated to its full size and mapped. The exporter
+ * thread copies data into the mapping and builds the index and string
+ * table; once the segment is closed they belong to the sync thread.
+ */
+typedef struct _GstDsOsdCoordLogSegment
+{
+  gchar *path;
+  int fd;
+  guint8 *map;
+  gsize size;
+  /** End of the data written, set by the exporter thread. */
+  volatile gint data_end;
+  /** End of the data synced, only used by the sync thread. */
+  gsize synced;
+  /** Monotonic time the segment was opened. */
+  gint64 opened;
+  /** DsOsdCoordLogIndexEntry of the segment. */
+  GArray *index;
+  /** Offset of the last index entry of each source. */
+  GHashTable *indexed;
+  /** The STREAM chunk and STRING chunks written since. */
+  GString *strings;
+} GstDsOsdCoordLogSegment;
+
+/**
+ * Writer of rotating segment files, see dsosdcoord_log.h. The exporter thread
+ * writes into the current segment, a sync thread msyncs it every
+ * sync_interval_ms and finalizes closed segments, so no disk flush happens
+ * on the exporter or streaming thread.
+ */
+struct _GstDsOsdCoordLogWriter
+{
+  gchar *location;
+  gsize segment_size;
+  gint64 segment_us;
+  guint sync_interval_ms;
+  guint sequence;
+  /** Monotonic time before which no segment is opened after a failure. */
+  gint64 retry_time;
+  /** Bytes of index and string table of the current segment. */
+  volatile gint footer_size;
+
+  GMutex lock;
+  GCond cond;
+  /** Segment being written, NULL after a failure. Protected by lock. */
+  GstDsOsdCoordLogSegment *current;
+  /** Segments waiting to be finalized. Protected by lock. */
+  GQueue closed;
+  gboolean running;
+  GThread *thread;
+};
+
+static void
+gst_ds_osdcoord_log_segment_free (GstDsOsdCoordLogSegment * segment)
+{
+  g_free (segment->path);
+  g_array_free (segment->index, TRUE);
+  g_hash_table_destroy (segment->indexed);
+  g_string_free (segment->strings, TRUE);
+  g_free (segment);
+}
+
+static GstDsOsdCoordLogSegment *
+gst_ds_osdcoord_log_segment_open (GstDsOsdCoordLogWriter * writer,
+    GError ** error)
+{
+  GstDsOsdCoordLogSegment *segment;
+  DsOsdCoordLogHeader *header;
+  gint64 now = g_get_real_time ();
+  gchar *name, *path;
+  void *addr;
+  int fd, ret;
+
+  name = g_strdup_printf ("dsosdcoord-%" G_GINT64_FORMAT "-%06u.dsl",
+      now / G_USEC_PER_SEC, writer->sequence++);
+  path = g_build_filename (writer->location, name, NULL);
+  g_free (name);
+
+  fd = open (path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "open %s failed: %s", path, g_strerror (errno));
+    g_free (path);
+    return NULL;
+  }
+  /* Allocate the blocks up front: writing to a hole of a mapping on a full
+     disk raises SIGBUS rather than an error. */
+  ret = posix_fallocate (fd, 0, writer->segment_size);
+  if (ret == EOPNOTSUPP || ret == EINVAL)
+    ret = ftruncate (fd, writer->segment_size) < 0 ? errno : 0;
+  if (ret != 0) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (ret),
+        "allocating %s failed: %s", path, g_strerror (ret));
+    goto error;
+  }
+  addr = mmap (NULL, writer->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      fd, 0);
+  if (addr == MAP_FAILED) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "mmap %s failed: %s", path, g_strerror (errno));
+    goto error;
+  }
+
+  segment = g_new0 (GstDsOsdCoordLogSegment, 1);
+  segment->path = path;
+  segment->fd = fd;
+  segment->map = (guint8 *) addr;
+  segment->size = writer->segment_size;
+  segment->data_end = sizeof (DsOsdCoordLogHeader);
+  segment->synced = sizeof (DsOsdCoordLogHeader);
+  segment->opened = g_get_monotonic_time ();
+  segment->index = g_array_new (FALSE, FALSE,
+      sizeof (DsOsdCoordLogIndexEntry));
+  segment->indexed = g_hash_table_new (g_direct_hash, g_direct_equal);
+  segment->strings = g_string_new (NULL);
+
+  header = (DsOsdCoordLogHeader *) segment->map;
+  memset (header, 0, sizeof (*header));
+  header->magic = DSOSDCOORD_LOG_MAGIC;
+  header->version = DSOSDCOORD_LOG_VERSION;
+  header->data_end = sizeof (*header);
+  header->start_time = now;
+
+  GST_DEBUG ("opened log segment %s", path);
+  g_atomic_int_set (&writer->footer_size, 0);
+  return segment;
+
+error:
+  close (fd);
+  unlink (path);
+  g_free (path);
+  return NULL;
+}
+
+/**
+ * Sync the data written since the last call and then the header pointing
+ * past it, so a reader never sees a data_end beyond synced data.
+ */
+static void
+gst_ds_osdcoord_log_segment_sync (GstDsOsdCoordLogSegment * segment)
+{
+  DsOsdCoordLogHeader *header = (DsOsdCoordLogHeader *) segment->map;
+  gsize end = (gsize) g_atomic_int_get (&segment->data_end);
+  gsize start;
+
+  if (end == segment->synced)
+    return;
+
+  start = segment->synced & ~((gsize) sysconf (_SC_PAGESIZE) - 1);
+  if (msync (segment->map + start, end - start, MS_SYNC) < 0)
+    GST_WARNING ("msync %s failed: %s", segment->path, g_strerror (errno));
+  segment->synced = end;
+
+  header->data_end = end;
+  if (msync (segment->map, sizeof (*header), MS_SYNC) < 0)
+    GST_WARNING ("msync %s failed: %s", segment->path, g_strerror (errno));
+}
+
+static gboolean
+gst_ds_osdcoord_log_pwrite (int fd, const gchar * data, gsize len,
+    off_t offset)
+{
+  while (len > 0) {
+    ssize_t n = pwrite (fd, data, len, offset);
+
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return FALSE;
+    }
+    data += n;
+    len -= n;
+    offset += n;
+  }
+  return TRUE;
+}
+
+/**
+ * Sync a closed segment, append its footer, mark it closed and trim the
+ * preallocated space after it. Runs on the sync thread.
+ */
+static void
+gst_ds_osdcoord_log_segment_finalize (GstDsOsdCoordLogSegment * segment)
+{
+  DsOsdCoordLogHeader *header = (DsOsdCoordLogHeader *) segment->map;
+  gsize end = (gsize) g_atomic_int_get (&segment->data_end);
+  /* Readers use the index in the mapping, so its entries are aligned. */
+  gsize index_offset = GST_ROUND_UP_8 (end);
+  gsize index_size = segment->index->len * sizeof (DsOsdCoordLogIndexEntry);
+  gsize footer_end = index_offset + index_size + segment->strings->len;
+
+  gst_ds_osdcoord_log_segment_sync (segment);
+
+  if (gst_ds_osdcoord_log_pwrite (segment->fd, segment->index->data,
+          index_size, index_offset) &&
+      gst_ds_osdcoord_log_pwrite (segment->fd, segment->strings->str,
+          segment->strings->len, index_offset + index_size) &&
+      fdatasync (segment->fd) == 0) {
+    header->index_offset = index_offset;
+    header->index_count = segment->index->len;
+    header->strings_offset = index_offset + index_size;
+    header->strings_size = segment->strings->len;
+    header->end_time = g_get_real_time ();
+    header->flags |= DSOSDCOORD_LOG_FLAG_CLOSED;
+  } else {
+    /* Left without footer, the data can still be read from the start. */
+    GST_WARNING ("writing the index of %s failed: %s", segment->path,
+        g_strerror (errno));
+    footer_end = end;
+  }
+  msync (segment->map, sizeof (*header), MS_SYNC);
+  munmap (segment->map, segment->size);
+
+  if (ftruncate (segment->fd, footer_end) < 0 || fdatasync (segment->fd) < 0)
+    GST_WARNING ("truncating %s failed: %s", segment->path,
+        g_strerror (errno));
+  close (segment->fd);
+  GST_DEBUG ("closed log segment %s, %" G_GSIZE_FORMAT " bytes, %u index "
+      "entries", segment->path, footer_end, segment->index->len);
+  gst_ds_osdcoord_log_segment_free (segment);
+}
+
+static gpointer
+gst_ds_osdcoord_log_writer_thread (gpointer data)
+{
+  GstDsOsdCoordLogWriter *writer = (GstDsOsdCoordLogWriter *) data;
+
+  g_mutex_lock (&writer->lock);
+  for (;;) {
+    GstDsOsdCoordLogSegment *segment, *current;
+
+    if (g_queue_is_empty (&writer->closed)) {
+      if (!writer->running)
+        break;
+      if (writer->sync_interval_ms)
+        g_cond_wait_until (&writer->cond, &writer->lock,
+            g_get_monotonic_time () + writer->sync_interval_ms * 1000);
+      else
+        g_cond_wait (&writer->cond, &writer->lock);
+    }
+
+    segment = (GstDsOsdCoordLogSegment *) g_queue_pop_head (&writer->closed);
+    current = writer->current;
+    g_mutex_unlock (&writer->lock);
+
+    /* Only this thread unmaps segments, so current stays mapped even if
+       the exporter thread closes it meanwhile. */
+    if (segment)
+      gst_ds_osdcoord_log_segment_finalize (segment);
+    else if (current && writer->sync_interval_ms)
+      gst_ds_osdcoord_log_segment_sync (current);
+
+    g_mutex_lock (&writer->lock);
+  }
+  g_mutex_unlock (&writer->lock);
+  return NULL;
+}
+
+/**
+ * Create the directory location if needed, open the first segment and start
+ * the sync thread. Segments are rotated when segment_size bytes are used or,
+ * if segment_seconds is not 0, after that many seconds. sync_interval_ms of 0
+ * syncs a segment only when it is closed.
+ */
+GstDsOsdCoordLogWriter *
+gst_ds_osdcoord_log_writer_new (const gchar * location, guint segment_size,
+    guint segment_seconds, guint sync_interval_ms, GError ** error)
+{
+  GstDsOsdCoordLogWriter *writer;
+  GstDsOsdCoordLogSegment *segment;
+
+  if (!location || !*location) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "No log file location");
+    return NULL;
+  }
+  if (g_mkdir_with_parents (location, 0755) < 0) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "Creating %s failed: %s", location, g_strerror (errno));
+    return NULL;
+  }
+
+  writer = g_new0 (GstDsOsdCoordLogWriter, 1);
+  writer->location = g_strdup (location);
+  writer->segment_size = CLAMP (segment_size, DSOSDCOORD_LOG_MIN_SEGMENT_SIZE,
+      DSOSDCOORD_LOG_MAX_SEGMENT_SIZE);
+  writer->segment_us = (gint64) segment_seconds * G_USEC_PER_SEC;
+  writer->sync_interval_ms = sync_interval_ms;
+
+  segment = gst_ds_osdcoord_log_segment_open (writer, error);
+  if (!segment) {
+    g_free (writer->location);
+    g_free (writer);
+    return NULL;
+  }
+
+  writer->current = segment;
+  writer->running = TRUE;
+  g_queue_init (&writer->closed);
+  g_mutex_init (&writer->lock);
+  g_cond_init (&writer->cond);
+  writer->thread = g_thread_new ("dsosdcoord-sync",
+      gst_ds_osdcoord_log_writer_thread, writer);
+  return writer;
+}
+
+/**
+ * Hand the current segment to the sync thread to be finalized.
+ */
+static void
+gst_ds_osdcoord_log_writer_close (GstDsOsdCoordLogWriter * writer)
+{
+  g_mutex_lock (&writer->lock);
+  if (writer->current)
+    g_queue_push_tail (&writer->closed, writer->current);
+  writer->current = NULL;
+  g_cond_signal (&writer->cond);
+  g_mutex_unlock (&writer->lock);
+}
+
+/**
+ * Close the current segment and wait for the sync thread to finalize it.
+ */
+void
+gst_ds_osdcoord_log_writer_free (GstDsOsdCoordLogWriter * writer)
+{
+  if (!writer)
+    return;
+
+  gst_ds_osdcoord_log_writer_close (writer);
+  g_mutex_lock (&writer->lock);
+  writer->running = FALSE;
+  g_cond_signal (&writer->cond);
+  g_mutex_unlock (&writer->lock);
+  g_thread_join (writer->thread);
+
+  g_mutex_clear (&writer->lock);
+  g_cond_clear (&writer->cond);
+  g_free (writer->location);
+  g_free (writer);
+}
+
+/**
+ * Whether the current segment is to be replaced before writing up to
+ * reserve more bytes: it is full, old enough, or there is none after a
+ * failure. Only called from the exporter thread, like the functions below.
+ */
+gboolean
+gst_ds_osdcoord_log_writer_should_rotate (GstDsOsdCoordLogWriter * writer,
+    gsize reserve)
+{
+  GstDsOsdCoordLogSegment *segment = writer->current;
+
+  if (!segment)
+    return TRUE;
+  if ((gsize) segment->data_end + reserve > segment->size)
+    return TRUE;
+  return writer->segment_us > 0 &&
+      g_get_monotonic_time () - segment->opened >= writer->segment_us;
+}
+
+/**
+ * Close the current segment and open the next one. Returns FALSE if it
+ * cannot be opened, in which case writes fail until a later rotation
+ * succeeds. The data of the new segment must start with a STREAM chunk.
+ */
+gboolean
+gst_ds_osdcoord_log_writer_rotate (GstDsOsdCoordLogWriter * writer)
+{
+  GstDsOsdCoordLogSegment *segment;
+  GError *error = NULL;
+  gint64 now = g_get_monotonic_time ();
+
+  if (writer->current)
+    gst_ds_osdcoord_log_writer_close (writer);
+  if (now < writer->retry_time)
+    return FALSE;
+
+  segment = gst_ds_osdcoord_log_segment_open (writer, &error);
+  if (!segment) {
+    GST_WARNING ("%s", error->message);
+    g_error_free (error);
+    writer->retry_time = now + LOG_RETRY_US;
+    return FALSE;
+  }
+
+  g_mutex_lock (&writer->lock);
+  writer->current = segment;
+  g_mutex_unlock (&writer->lock);
+  return TRUE;
+}
+
+/**
+ * Add the frame chunk at offset to the index if it is the first of its
+ * source in the segment or the source's last entry is far enough behind.
+ */
+static void
+gst_ds_osdcoord_log_segment_index (GstDsOsdCoordLogSegment * segment,
+    const DsOsdCoordBinFrame * frame, gsize offset)
+{
+  DsOsdCoordLogIndexEntry entry;
+  guint32 source_id = (frame->flags & DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE) ?
+      frame->source_id : 0;
+  gsize last = GPOINTER_TO_SIZE (g_hash_table_lookup (segment->indexed,
+          GUINT_TO_POINTER (source_id)));
+
+  /* Offsets start after the header, so 0 means none. */
+  if (last != 0 && offset - last < DSOSDCOORD_LOG_INDEX_INTERVAL)
+    return;
+
+  entry.source_id = source_id;
+  entry.frame_num = frame->frame_num;
+  entry.pts = frame->pts;
+  entry.offset = offset;
+  g_array_append_val (segment->index, entry);
+  g_hash_table_insert (segment->indexed, GUINT_TO_POINTER (source_id),
+      GSIZE_TO_POINTER (offset));
+}
+
+/**
+ * Copy len bytes of whole chunks into the current segment, indexing its
+ * frame chunks and keeping a copy of its string table for the footer.
+ * Returns FALSE if there is no segment, or if the data does not fit, in
+ * which case the segment is closed.
+ */
+gboolean
+gst_ds_osdcoord_log_writer_write (GstDsOsdCoordLogWriter * writer,
+    const gchar * data, gsize len)
+{
+  GstDsOsdCoordLogSegment *segment = writer->current;
+  gsize end, pos = 0;
+
+  if (!segment)
+    return FALSE;
+
+  end = (gsize) segment->data_end;
+  if (end + len > segment->size) {
+    GST_WARNING ("%" G_GSIZE_FORMAT " bytes do not fit into %s", len,
+        segment->path);
+    gst_ds_osdcoord_log_writer_close (writer);
+    return FALSE;
+  }
+
+  while (pos + sizeof (DsOsdCoordBinChunk) <= len) {
+    DsOsdCoordBinChunk chunk;
+    DsOsdCoordBinFrame frame;
+
+    memcpy (&chunk, data + pos, sizeof (chunk));
+    switch (chunk.type) {
+      case DSOSDCOORD_BIN_CHUNK_STREAM:
+        /* Entries before a restart would resolve labels in the new table. */
+        if (end + pos > sizeof (DsOsdCoordLogHeader)) {
+          g_array_set_size (segment->index, 0);
+          g_hash_table_remove_all (segment->indexed);
+        }
+        g_string_truncate (segment->strings, 0);
+        /* fall through */
+      case DSOSDCOORD_BIN_CHUNK_STRING:
+        g_string_append_len (segment->strings, data + pos,
+            sizeof (chunk) + chunk.size);
+        break;
+      case DSOSDCOORD_BIN_CHUNK_FRAME:
+        memcpy (&frame, data + pos + sizeof (chunk), sizeof (frame));
+        gst_ds_osdcoord_log_segment_index (segment, &frame, end + pos);
+        break;
+      default:
+        break;
+    }
+    pos += sizeof (chunk) + chunk.size;
+  }
+
+  memcpy (segment->map + end, data, len);
+  g_atomic_int_set (&segment->data_end, (gint) (end + len));
+  g_atomic_int_set (&writer->footer_size,
+      (gint) (segment->index->len * sizeof (DsOsdCoordLogIndexEntry) +
+          segment->strings->len));
+  return TRUE;
+}
+
+/**
+ * Bytes allocated by the writer, without the mapped segment.
+ */
+gsize
+gst_ds_osdcoord_log_writer_get_size (GstDsOsdCoordLogWriter * writer)
+{
+  return sizeof (*writer) + (gsize) g_atomic_int_get (&writer->footer_size);
+}
@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_LOG_H__
+#define __GST_DSOSDCOORD_LOG_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/** Smallest segment size, well above the largest unit written at once. */
+#define DSOSDCOORD_LOG_MIN_SEGMENT_SIZE (1024 * 1024)
+/** Largest segment size. */
+#define DSOSDCOORD_LOG_MAX_SEGMENT_SIZE (1024 * 1024 * 1024)
+
+typedef struct _GstDsOsdCoordLogWriter GstDsOsdCoordLogWriter;
+
+GstDsOsdCoordLogWriter *gst_ds_osdcoord_log_writer_new (
+    const gchar * location, guint segment_size, guint segment_seconds,
+    guint sync_interval_ms, GError ** error);
+
+void gst_ds_osdcoord_log_writer_free (GstDsOsdCoordLogWriter * writer);
+
+gboolean gst_ds_osdcoord_log_writer_should_rotate (
+    GstDsOsdCoordLogWriter * writer, gsize reserve);
+
+gboolean gst_ds_osdcoord_log_writer_rotate (GstDsOsdCoordLogWriter * writer);
+
+gboolean gst_ds_osdcoord_log_writer_write (GstDsOsdCoordLogWriter * writer,
+    const gchar * data, gsize len);
+
+gsize gst_ds_osdcoord_log_writer_get_size (GstDsOsdCoordLogWriter * writer);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_LOG_H__ */
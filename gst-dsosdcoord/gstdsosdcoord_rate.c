@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include "gstdsosdcoord_rate.h"
+
+/**
+ * Export state of one source.
+ */
+typedef struct
+{
+  /** FALSE until the first frame of the source. */
+  gboolean seen;
+  /** Frames since the last exported one. */
+  guint skipped;
+  /** Earliest PTS at which the next frame may be exported with max_hz. */
+  GstClockTime next_pts;
+  /** Number and PTS range of the exported frames with a valid PTS, for
+      the effective rate. */
+  guint64 exported;
+  GstClockTime first_pts;
+  GstClockTime last_pts;
+} GstDsOsdCoordRateSource;
+
+struct _GstDsOsdCoordRateLimiter
+{
+  GstDsOsdCoordRateConfig config;
+  /** Minimum PTS distance of exported frames, 0 for no limit. */
+  GstClockTime period;
+  /** GstDsOsdCoordRateSource by source id. */
+  GArray *sources;
+};
+
+GstDsOsdCoordRateLimiter *
+gst_ds_osdcoord_rate_limiter_new (const GstDsOsdCoordRateConfig * config)
+{
+  GstDsOsdCoordRateLimiter *limiter = g_new0 (GstDsOsdCoordRateLimiter, 1);
+
+  limiter->config = *config;
+  limiter->config.interval_frames = MAX (config->interval_frames, 1);
+  if (config->max_hz > 0)
+    limiter->period = (GstClockTime) (GST_SECOND / config->max_hz);
+  limiter->sources = g_array_new (FALSE, TRUE,
+      sizeof (GstDsOsdCoordRateSource));
+  return limiter;
+}
+
+void
+gst_ds_osdcoord_rate_limiter_free (GstDsOsdCoordRateLimiter * limiter)
+{
+  g_array_free (limiter->sources, TRUE);
+  g_free (limiter);
+}
+
+/**
+ * Whether the frame of source_id with the given PTS is to be exported.
+ * Must be called once per frame of each source. Frames without PTS are
+ * only subject to interval_frames. A PTS before the slot of the last
+ * exported frame, as when a source restarts, is exported and starts over
+ * from there, as does one after a gap.
+ */
+gboolean
+gst_ds_osdcoord_rate_limiter_check (GstDsOsdCoordRateLimiter * limiter,
+    guint source_id, GstClockTime pts)
+{
+  GstDsOsdCoordRateSource *source;
+  gboolean valid = GST_CLOCK_TIME_IS_VALID (pts);
+
+  if (source_id >= limiter->sources->len)
+    g_array_set_size (limiter->sources, source_id + 1);
+  source = &g_array_index (limiter->sources, GstDsOsdCoordRateSource,
+      source_id);
+
+  if (!source->seen) {
+    source->seen = TRUE;
+    source->skipped = limiter->config.interval_frames - 1;
+    source->next_pts = GST_CLOCK_TIME_NONE;
+  }
+
+  if (++source->skipped < limiter->config.interval_frames)
+    return FALSE;
+  if (limiter->period > 0 && valid &&
+      GST_CLOCK_TIME_IS_VALID (source->next_pts) && pts < source->next_pts &&
+      pts + limiter->period >= source->next_pts)
+    return FALSE;
+
+  source->skipped = 0;
+  if (valid) {
+    /* Advance from the previous deadline rather than from pts, so frames
+       arriving slightly early do not halve the rate; resync after gaps
+       and when the PTS goes back. */
+    if (limiter->period > 0) {
+      if (!GST_CLOCK_TIME_IS_VALID (source->next_pts) ||
+          pts >= source->next_pts + limiter->period ||
+          pts + limiter->period < source->next_pts)
+        source->next_pts = pts;
+      source->next_pts += limiter->period;
+    }
+    /* The effective rate is measured from the last time the PTS went
+       back. */
+    if (source->exported > 0 && pts < source->last_pts)
+      source->exported = 0;
+    if (source->exported == 0)
+      source->first_pts = pts;
+    source->last_pts = pts;
+    source->exported++;
+  }
+  return TRUE;
+}
+
+/**
+ * Set export-rate-source-<id> to the effective export rate in Hz of each
+ * source that exported at least two frames with PTS.
+ */
+void
+gst_ds_osdcoord_rate_limiter_add_to_structure (GstDsOsdCoordRateLimiter *
+    limiter, GstStructure * s)
+{
+  guint i;
+
+  for (i = 0; i < limiter->sources->len; i++) {
+    GstDsOsdCoordRateSource *source =
+        &g_array_index (limiter->sources, GstDsOsdCoordRateSource, i);
+    gchar *field;
+
+    if (source->exported < 2 || source->last_pts <= source->first_pts)
+      continue;
+    field = g_strdup_printf ("export-rate-source-%u", i);
+    gst_structure_set (s, field, G_TYPE_DOUBLE,
+        (gdouble) (source->exported - 1) * GST_SECOND /
+        (source->last_pts - source->first_pts), NULL);
+    g_free (field);
+  }
+}
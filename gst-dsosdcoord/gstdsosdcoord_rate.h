@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_RATE_H__
+#define __GST_DSOSDCOORD_RATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Export rate settings, taken from the element properties at start().
+ */
+typedef struct _GstDsOsdCoordRateConfig
+{
+  /** Export one frame out of this many of each source, at least 1. */
+  guint interval_frames;
+  /** Largest number of frames per second exported of each source, 0 for
+      no limit. */
+  gdouble max_hz;
+} GstDsOsdCoordRateConfig;
+
+typedef struct _GstDsOsdCoordRateLimiter GstDsOsdCoordRateLimiter;
+
+GstDsOsdCoordRateLimiter *gst_ds_osdcoord_rate_limiter_new (
+    const GstDsOsdCoordRateConfig * config);
+
+void gst_ds_osdcoord_rate_limiter_free (GstDsOsdCoordRateLimiter * limiter);
+
+gboolean gst_ds_osdcoord_rate_limiter_check (
+    GstDsOsdCoordRateLimiter * limiter, guint source_id, GstClockTime pts);
+
+void gst_ds_osdcoord_rate_limiter_add_to_structure (
+    GstDsOsdCoordRateLimiter * limiter, GstStructure * s);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_RATE_H__ */
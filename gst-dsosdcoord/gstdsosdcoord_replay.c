@@ -0,0 +1,560 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "gstdsosdcoord_replay.h"
+#include "dsosdcoord_log.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_ds_osdcoord_replay_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_replay_debug
+
+/* Enum to identify properties */
+enum
+{
+  PROP_0,
+  PROP_LOCATION,
+  PROP_RATE,
+  PROP_LOOP,
+};
+
+/* Default values for properties */
+#define DEFAULT_RATE DSOSDCOORD_REPLAY_RATE_FAST
+#define DEFAULT_LOOP FALSE
+
+static GstStaticPadTemplate dsosdcoord_replay_sink_factory =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate dsosdcoord_replay_src_factory =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#define gst_ds_osdcoord_replay_parent_class parent_class
+G_DEFINE_TYPE (GstDsOsdCoordReplay, gst_ds_osdcoord_replay,
+    GST_TYPE_BASE_TRANSFORM);
+
+static void gst_ds_osdcoord_replay_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec);
+static void gst_ds_osdcoord_replay_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec);
+static void gst_ds_osdcoord_replay_finalize (GObject * object);
+
+#define GST_TYPE_DS_OSDCOORD_REPLAY_RATE \
+    (gst_ds_osdcoord_replay_rate_get_type ())
+
+static GType
+gst_ds_osdcoord_replay_rate_get_type (void)
+{
+  static GType qtype = 0;
+
+  if (qtype == 0) {
+    static const GEnumValue values[] = {
+      {DSOSDCOORD_REPLAY_RATE_FAST, "The next batch on every buffer", "fast"},
+      {DSOSDCOORD_REPLAY_RATE_RECORDED,
+          "Restamp buffers with the recorded PTS", "recorded"},
+      {0, NULL, NULL}
+    };
+
+    qtype = g_enum_register_static ("GstDsOsdCoordReplayRate", values);
+  }
+  return qtype;
+}
+
+static void
+gst_ds_osdcoord_replay_clear (GstDsOsdCoordReplay * replay)
+{
+  if (replay->frames) {
+    g_array_free (replay->frames, TRUE);
+    g_array_free (replay->objects, TRUE);
+    g_array_free (replay->batches, TRUE);
+    g_ptr_array_free (replay->labels, TRUE);
+  }
+  replay->frames = NULL;
+  replay->objects = NULL;
+  replay->batches = NULL;
+  replay->labels = NULL;
+  replay->max_batch_frames = 0;
+}
+
+/**
+ * Whether frame continues the last recorded frame, which the writer split
+ * into several chunks.
+ */
+static gboolean
+gst_ds_osdcoord_replay_same_frame (const GstDsOsdCoordReplayFrame * last,
+    const DsOsdCoordBinFrame * frame)
+{
+  return last->source_id == frame->source_id &&
+      last->batch_id == frame->batch_id &&
+      last->frame_num == frame->frame_num && last->flags == frame->flags &&
+      last->pts == frame->pts;
+}
+
+/**
+ * Whether a frame with batch_id and flags can join batch, which holds
+ * frames of the given PTS.
+ */
+static gboolean
+gst_ds_osdcoord_replay_batch_has_room (GstDsOsdCoordReplay * replay,
+    const GstDsOsdCoordReplayBatch * batch, const DsOsdCoordBinFrame * frame)
+{
+  guint i;
+
+  for (i = 0; i < batch->num_frames; i++) {
+    const GstDsOsdCoordReplayFrame *other =
+        &g_array_index (replay->frames, GstDsOsdCoordReplayFrame,
+        batch->first_frame + i);
+
+    if (other->pts != frame->pts)
+      return FALSE;
+    if (other->batch_id == frame->batch_id && other->flags == frame->flags)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * Read all frame chunks of reader into the recording, merging chunks of the
+ * same frame and grouping frames into batches. Labels are interned into
+ * replay->labels so the string tables of restarted streams do not matter.
+ */
+static int
+gst_ds_osdcoord_replay_read (GstDsOsdCoordReplay * replay,
+    DsOsdCoordBinReader * reader)
+{
+  GHashTable *ids = g_hash_table_new (g_str_hash, g_str_equal);
+  int ret;
+
+  while ((ret = dsosdcoord_bin_reader_next (reader)) > 0) {
+    const DsOsdCoordBinFrame *bin = &reader->frame;
+    GstDsOsdCoordReplayFrame *last = replay->frames->len > 0 ?
+        &g_array_index (replay->frames, GstDsOsdCoordReplayFrame,
+        replay->frames->len - 1) : NULL;
+    GstDsOsdCoordReplayBatch *batch = replay->batches->len > 0 ?
+        &g_array_index (replay->batches, GstDsOsdCoordReplayBatch,
+        replay->batches->len - 1) : NULL;
+    guint i;
+
+    for (i = 0; i < bin->num_objects; i++) {
+      DsOsdCoordBinObject object = reader->objects[i];
+      const gchar *label = dsosdcoord_bin_reader_label (reader,
+          object.label_id);
+      gpointer value;
+
+      if (!g_hash_table_lookup_extended (ids, label, NULL, &value)) {
+        gchar *copy = g_strdup (label);
+
+        value = GUINT_TO_POINTER (replay->labels->len);
+        g_ptr_array_add (replay->labels, copy);
+        g_hash_table_insert (ids, copy, value);
+      }
+      object.label_id = GPOINTER_TO_UINT (value);
+      g_array_append_val (replay->objects, object);
+    }
+
+    if (last && gst_ds_osdcoord_replay_same_frame (last, bin)) {
+      last->num_objects += bin->num_objects;
+      continue;
+    }
+
+    if (!batch || !gst_ds_osdcoord_replay_batch_has_room (replay, batch, bin)) {
+      GstDsOsdCoordReplayBatch next;
+
+      next.first_frame = replay->frames->len;
+      next.num_frames = 0;
+      g_array_append_val (replay->batches, next);
+      batch = &g_array_index (replay->batches, GstDsOsdCoordReplayBatch,
+          replay->batches->len - 1);
+    }
+    batch->num_frames++;
+    replay->max_batch_frames = MAX (replay->max_batch_frames,
+        batch->num_frames);
+
+    {
+      GstDsOsdCoordReplayFrame frame;
+
+      frame.source_id = bin->source_id;
+      frame.batch_id = bin->batch_id;
+      frame.frame_num = bin->frame_num;
+      frame.flags = bin->flags;
+      frame.pts = bin->pts;
+      frame.first_object = replay->objects->len - bin->num_objects;
+      frame.num_objects = bin->num_objects;
+      g_array_append_val (replay->frames, frame);
+    }
+  }
+
+  g_hash_table_destroy (ids);
+  return ret;
+}
+
+/**
+ * Load the recording at location, a binary stream or a segment file.
+ */
+static gboolean
+gst_ds_osdcoord_replay_load (GstDsOsdCoordReplay * replay, GError ** error)
+{
+  DsOsdCoordLogReader log;
+  DsOsdCoordBinReader reader;
+  const GstDsOsdCoordReplayFrame *first, *last;
+  guint num_batches;
+  FILE *file;
+  int ret;
+
+  replay->frames = g_array_new (FALSE, FALSE,
+      sizeof (GstDsOsdCoordReplayFrame));
+  replay->objects = g_array_new (FALSE, FALSE, sizeof (DsOsdCoordBinObject));
+  replay->batches = g_array_new (FALSE, FALSE,
+      sizeof (GstDsOsdCoordReplayBatch));
+  replay->labels = g_ptr_array_new_with_free_func (g_free);
+
+  if (dsosdcoord_log_reader_open (&log, replay->location) == 0) {
+    ret = gst_ds_osdcoord_replay_read (replay, &log.bin);
+    dsosdcoord_log_reader_close (&log);
+  } else {
+    file = fopen (replay->location, "rb");
+    if (!file) {
+      g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+          "open %s failed: %s", replay->location, g_strerror (errno));
+      return FALSE;
+    }
+    dsosdcoord_bin_reader_init (&reader, file);
+    ret = gst_ds_osdcoord_replay_read (replay, &reader);
+    dsosdcoord_bin_reader_clear (&reader);
+    fclose (file);
+  }
+
+  if (ret < 0) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "%s is truncated or not a dsosdcoord recording", replay->location);
+    return FALSE;
+  }
+  num_batches = replay->batches->len;
+  if (num_batches == 0) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "%s holds no frames", replay->location);
+    return FALSE;
+  }
+
+  /* A loop lasts as long as the recording plus one average batch interval. */
+  first = &g_array_index (replay->frames, GstDsOsdCoordReplayFrame, 0);
+  last = &g_array_index (replay->frames, GstDsOsdCoordReplayFrame,
+      g_array_index (replay->batches, GstDsOsdCoordReplayBatch,
+          num_batches - 1).first_frame);
+  replay->first_pts = first->pts;
+  replay->loop_duration = 0;
+  if (num_batches > 1 && GST_CLOCK_TIME_IS_VALID (first->pts) &&
+      GST_CLOCK_TIME_IS_VALID (last->pts) && last->pts > first->pts)
+    replay->loop_duration = (last->pts - first->pts) +
+        (last->pts - first->pts) / (num_batches - 1);
+
+  GST_INFO_OBJECT (replay, "loaded %u batches, %u frames, %u objects and %u "
+      "labels from %s", num_batches, replay->frames->len,
+      replay->objects->len, replay->labels->len, replay->location);
+  return TRUE;
+}
+
+static void
+gst_ds_osdcoord_replay_add_object (GstDsOsdCoordReplay * replay,
+    NvDsBatchMeta * batch_meta, NvDsFrameMeta * frame_meta,
+    const DsOsdCoordBinObject * object)
+{
+  NvDsObjectMeta *obj_meta = nvds_acquire_obj_meta_from_pool (batch_meta);
+  NvOSD_RectParams *rect = &obj_meta->rect_params;
+  NvOSD_TextParams *text = &obj_meta->text_params;
+  const gchar *label = replay->pool->label_texts[object->label_id];
+
+  /* Recordings without class ids give labels class ids in the order they
+     first appear. */
+  obj_meta->unique_component_id = 1;
+  obj_meta->class_id = (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASS) ?
+      object->class_id : (gint) object->label_id;
+  obj_meta->object_id = (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK) ?
+      object->object_id : UNTRACKED_OBJECT_ID;
+  obj_meta->confidence = 1.0f;
+  g_strlcpy (obj_meta->obj_label, label, MAX_LABEL_SIZE);
+
+  rect->left = object->left;
+  rect->top = object->top;
+  rect->width = object->width;
+  rect->height = object->height;
+  rect->border_width = 3;
+  gst_ds_osdcoord_synth_color (&rect->border_color, object->label_id);
+  rect->has_bg_color = 0;
+
+  /* The pool's copy of the label, not freed with the object. */
+  text->display_text = (gchar *) label;
+  text->x_offset = (guint) MAX (rect->left, 0);
+  text->y_offset = (guint) MAX (rect->top - 20, 0);
+  text->font_params.font_name = (gchar *) "Serif";
+  text->font_params.font_size = 12;
+  text->font_params.font_color.red = 1.0;
+  text->font_params.font_color.green = 1.0;
+  text->font_params.font_color.blue = 1.0;
+  text->font_params.font_color.alpha = 1.0;
+  text->set_bg_clr = 1;
+  text->text_bg_clr.alpha = 1.0;
+
+  nvds_add_obj_meta_to_frame (frame_meta, obj_meta, NULL);
+}
+
+static gboolean
+gst_ds_osdcoord_replay_start (GstBaseTransform * trans)
+{
+  GstDsOsdCoordReplay *replay = GST_DSOSDCOORD_REPLAY (trans);
+  GError *error = NULL;
+
+  if (!replay->location) {
+    GST_ELEMENT_ERROR (replay, RESOURCE, NOT_FOUND,
+        ("No recording to replay"), ("location is not set"));
+    return FALSE;
+  }
+  if (!gst_ds_osdcoord_replay_load (replay, &error)) {
+    GST_ELEMENT_ERROR (replay, RESOURCE, OPEN_READ,
+        ("Unable to load the recording"), ("%s", error->message));
+    g_error_free (error);
+    gst_ds_osdcoord_replay_clear (replay);
+    return FALSE;
+  }
+
+  replay->pool = gst_ds_osdcoord_synth_pool_new (replay->max_batch_frames, 0);
+  gst_ds_osdcoord_synth_pool_set_labels (replay->pool, replay->labels);
+  replay->next_batch = 0;
+  replay->loops = 0;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_replay_stop (GstBaseTransform * trans)
+{
+  GstDsOsdCoordReplay *replay = GST_DSOSDCOORD_REPLAY (trans);
+
+  /* Buffers still in flight hold their own reference. */
+  gst_ds_osdcoord_synth_pool_unref (replay->pool);
+  replay->pool = NULL;
+  gst_ds_osdcoord_replay_clear (replay);
+  return TRUE;
+}
+
+/**
+ * Attach the next recorded batch to the buffer.
+ */
+static GstFlowReturn
+gst_ds_osdcoord_replay_transform_ip (GstBaseTransform * trans,
+    GstBuffer * buf)
+{
+  GstDsOsdCoordReplay *replay = GST_DSOSDCOORD_REPLAY (trans);
+  const GstDsOsdCoordReplayBatch *batch;
+  const GstDsOsdCoordReplayFrame *frame;
+  NvDsBatchMeta *batch_meta;
+  GstClockTime pts;
+  guint i, j;
+
+  if (replay->next_batch == replay->batches->len) {
+    if (!replay->loop) {
+      GST_DEBUG_OBJECT (replay, "end of the recording");
+      return GST_FLOW_EOS;
+    }
+    replay->next_batch = 0;
+    replay->loops++;
+  }
+  batch = &g_array_index (replay->batches, GstDsOsdCoordReplayBatch,
+      replay->next_batch++);
+
+  batch_meta = gst_ds_osdcoord_synth_pool_acquire (replay->pool);
+  if (!batch_meta) {
+    GST_ELEMENT_ERROR (replay, RESOURCE, FAILED,
+        ("Unable to create batch meta"), NULL);
+    return GST_FLOW_ERROR;
+  }
+
+  for (i = 0; i < batch->num_frames; i++) {
+    NvDsFrameMeta *frame_meta = nvds_acquire_frame_meta_from_pool (batch_meta);
+    gboolean has_source;
+
+    frame = &g_array_index (replay->frames, GstDsOsdCoordReplayFrame,
+        batch->first_frame + i);
+    has_source = (frame->flags & DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE) != 0;
+    frame_meta->source_id = has_source ? frame->source_id : 0;
+    frame_meta->pad_index = frame_meta->source_id;
+    frame_meta->batch_id = has_source ? frame->batch_id : i;
+    frame_meta->frame_num = (gint) frame->frame_num;
+    frame_meta->buf_pts = frame->pts;
+    frame_meta->num_surfaces_per_frame = 1;
+    frame_meta->bInferDone = TRUE;
+    nvds_add_frame_meta_to_batch (batch_meta, frame_meta);
+
+    for (j = 0; j < frame->num_objects; j++)
+      gst_ds_osdcoord_replay_add_object (replay, batch_meta, frame_meta,
+          &g_array_index (replay->objects, DsOsdCoordBinObject,
+              frame->first_object + j));
+  }
+  gst_ds_osdcoord_synth_pool_attach (replay->pool, buf, batch_meta);
+
+  frame = &g_array_index (replay->frames, GstDsOsdCoordReplayFrame,
+      batch->first_frame);
+  pts = frame->pts;
+  if (replay->rate == DSOSDCOORD_REPLAY_RATE_RECORDED &&
+      GST_CLOCK_TIME_IS_VALID (pts) &&
+      GST_CLOCK_TIME_IS_VALID (replay->first_pts) &&
+      pts >= replay->first_pts) {
+    GST_BUFFER_PTS (buf) = pts - replay->first_pts +
+        replay->loops * replay->loop_duration;
+    GST_BUFFER_DTS (buf) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DURATION (buf) = GST_CLOCK_TIME_NONE;
+    if (replay->next_batch < replay->batches->len) {
+      const GstDsOsdCoordReplayFrame *next =
+          &g_array_index (replay->frames, GstDsOsdCoordReplayFrame,
+          g_array_index (replay->batches, GstDsOsdCoordReplayBatch,
+              replay->next_batch).first_frame);
+
+      if (GST_CLOCK_TIME_IS_VALID (next->pts) && next->pts > pts)
+        GST_BUFFER_DURATION (buf) = next->pts - pts;
+    }
+  }
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_ds_osdcoord_replay_finalize (GObject * object)
+{
+  GstDsOsdCoordReplay *replay = GST_DSOSDCOORD_REPLAY (object);
+
+  g_free (replay->location);
+  gst_ds_osdcoord_replay_clear (replay);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_ds_osdcoord_replay_class_init (GstDsOsdCoordReplayClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstBaseTransformClass *base_transform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
+
+  base_transform_class->transform_ip =
+      GST_DEBUG_FUNCPTR (gst_ds_osdcoord_replay_transform_ip);
+  base_transform_class->start =
+      GST_DEBUG_FUNCPTR (gst_ds_osdcoord_replay_start);
+  base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_ds_osdcoord_replay_stop);
+
+  gobject_class->set_property = gst_ds_osdcoord_replay_set_property;
+  gobject_class->get_property = gst_ds_osdcoord_replay_get_property;
+  gobject_class->finalize = gst_ds_osdcoord_replay_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_LOCATION,
+      g_param_spec_string ("location", "Location",
+          "Recording to replay: dsosdcoord output with export-format=binary\n"
+          "\t\t\t or a segment file of export-sink=file",
+          NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_RATE,
+      g_param_spec_enum ("replay-rate", "Replay Rate",
+          "\"fast\" attaches the next recorded batch to every buffer.\n"
+          "\t\t\t \"recorded\" also restamps the buffers with the recorded\n"
+          "\t\t\t PTS, so a sink with sync=true plays them at that rate",
+          GST_TYPE_DS_OSDCOORD_REPLAY_RATE, DEFAULT_RATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_LOOP,
+      g_param_spec_boolean ("loop", "Loop",
+          "Start over at the end of the recording instead of ending the\n"
+          "\t\t\t stream",
+          DEFAULT_LOOP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  gst_element_class_set_details_simple (gstelement_class,
+      "DsOsdCoord metadata replay",
+      "Filter/Metadata",
+      "Attaches NvDsBatchMeta recorded by dsosdcoord to buffers",
+      "NVIDIA Corporation. Post on Deepstream for Tesla forum for any queries "
+      "@ https://devtalk.nvidia.com/default/board/209/");
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&dsosdcoord_replay_src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&dsosdcoord_replay_sink_factory));
+
+  GST_DEBUG_CATEGORY_INIT (gst_ds_osdcoord_replay_debug, "dsosdcoordreplay",
+      0, "dsosdcoord metadata replay");
+}
+
+static void
+gst_ds_osdcoord_replay_init (GstDsOsdCoordReplay * replay)
+{
+  GstBaseTransform *btrans = GST_BASE_TRANSFORM (replay);
+
+  gst_base_transform_set_in_place (btrans, TRUE);
+  gst_base_transform_set_passthrough (btrans, FALSE);
+
+  replay->location = NULL;
+  replay->rate = DEFAULT_RATE;
+  replay->loop = DEFAULT_LOOP;
+  replay->pool = NULL;
+}
+
+static void
+gst_ds_osdcoord_replay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstDsOsdCoordReplay *replay = GST_DSOSDCOORD_REPLAY (object);
+
+  switch (prop_id) {
+    case PROP_LOCATION:
+      g_free (replay->location);
+      replay->location = g_value_dup_string (value);
+      break;
+    case PROP_RATE:
+      replay->rate = (GstDsOsdCoordReplayRate) g_value_get_enum (value);
+      break;
+    case PROP_LOOP:
+      replay->loop = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_ds_osdcoord_replay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstDsOsdCoordReplay *replay = GST_DSOSDCOORD_REPLAY (object);
+
+  switch (prop_id) {
+    case PROP_LOCATION:
+      g_value_set_string (value, replay->location);
+      break;
+    case PROP_RATE:
+      g_value_set_enum (value, replay->rate);
+      break;
+    case PROP_LOOP:
+      g_value_set_boolean (value, replay->loop);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_REPLAY_H__
+#define __GST_DSOSDCOORD_REPLAY_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstbasetransform.h>
+#include "gstnvdsmeta.h"
+#include "gstdsosdcoord_synth.h"
+
+G_BEGIN_DECLS
+/* Standard GStreamer boilerplate */
+#define GST_TYPE_DSOSDCOORD_REPLAY \
+  (gst_ds_osdcoord_replay_get_type())
+#define GST_DSOSDCOORD_REPLAY(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_DSOSDCOORD_REPLAY,GstDsOsdCoordReplay))
+#define GST_DSOSDCOORD_REPLAY_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_DSOSDCOORD_REPLAY,GstDsOsdCoordReplayClass))
+#define GST_IS_DSOSDCOORD_REPLAY(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_DSOSDCOORD_REPLAY))
+typedef struct _GstDsOsdCoordReplay GstDsOsdCoordReplay;
+typedef struct _GstDsOsdCoordReplayClass GstDsOsdCoordReplayClass;
+
+/**
+ * How fast the recorded batches are replayed.
+ */
+typedef enum
+{
+  /** The next batch on every buffer, buffer timestamps are kept. */
+  DSOSDCOORD_REPLAY_RATE_FAST,
+  /** The next batch on every buffer, which is restamped with the recorded
+      PTS so a synchronizing sink plays it at the recorded rate. */
+  DSOSDCOORD_REPLAY_RATE_RECORDED,
+} GstDsOsdCoordReplayRate;
+
+/**
+ * One recorded frame, its objects at first_object in the objects array.
+ */
+typedef struct _GstDsOsdCoordReplayFrame
+{
+  guint source_id;
+  guint batch_id;
+  guint frame_num;
+  /** DSOSDCOORD_BIN_FRAME_FLAG_* */
+  guint flags;
+  GstClockTime pts;
+  guint first_object;
+  guint num_objects;
+} GstDsOsdCoordReplayFrame;
+
+/**
+ * Frames of one recorded batch: consecutive frames with the same PTS and
+ * distinct batch_id.
+ */
+typedef struct _GstDsOsdCoordReplayBatch
+{
+  guint first_frame;
+  guint num_frames;
+} GstDsOsdCoordReplayBatch;
+
+/**
+ * GstDsOsdCoordReplay element structure. Attaches the NvDsBatchMeta of a
+ * recording made with export-format=binary or export-sink=file to every
+ * buffer, so dsosdcoord can be run on real detections without a GPU or the
+ * DeepStream inference elements.
+ */
+struct _GstDsOsdCoordReplay
+{
+  /** Should be the first member when extending from GstBaseTransform. */
+  GstBaseTransform parent_instance;
+
+  /** Binary stream or segment file to replay. */
+  gchar *location;
+  GstDsOsdCoordReplayRate rate;
+  /** Whether to start over at the end of the recording instead of ending
+      the stream. */
+  gboolean loop;
+
+  /** The recording, loaded at start(). The label_id of the objects index
+      labels. */
+  GArray *frames;
+  GArray *objects;
+  GArray *batches;
+  GPtrArray *labels;
+  /** Largest number of frames in a batch. */
+  guint max_batch_frames;
+  /** PTS of the first batch and the time from it to the start of the next
+      loop. */
+  GstClockTime first_pts;
+  GstClockTime loop_duration;
+
+  /** Pool of the current run, shared with dsosdcoordsynth. */
+  GstDsOsdCoordSynthPool *pool;
+  /** Next batch to attach and number of times the recording wrapped. */
+  guint next_batch;
+  guint64 loops;
+};
+
+/* GStreamer boilerplate. */
+struct _GstDsOsdCoordReplayClass
+{
+  GstBaseTransformClass parent_class;
+};
+
+GType gst_ds_osdcoord_replay_get_type (void);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_REPLAY_H__ */
@@ -0,0 +1,252 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Run-length encoding of instance masks. A mask is first thresholded into
+ * a bitmap, 64 pixels per word, by a SIMD kernel that compares a vector of
+ * floats and packs the comparison into bits with a movemask. The runs are
+ * then found a word at a time: w ^ (w << 1) has a bit set wherever a pixel
+ * differs from the one before it, so the number of runs is a popcount and
+ * their ends are found with count-trailing-zeros, without a branch per
+ * pixel.
+ */
+
+#include <string.h>
+#include "gstdsosdcoord_rle.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DSOSDCOORD_RLE_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define DSOSDCOORD_RLE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define RLE_WORD_BITS 64
+
+void
+gst_ds_osdcoord_rle_threshold_scalar (const gfloat * data, guint n,
+    gfloat threshold, guint64 * bits)
+{
+  guint i;
+
+  memset (bits, 0, (n + RLE_WORD_BITS - 1) / RLE_WORD_BITS * sizeof (guint64));
+  for (i = 0; i < n; i++)
+    bits[i / RLE_WORD_BITS] |=
+        (guint64) (data[i] > threshold) << (i % RLE_WORD_BITS);
+}
+
+#ifdef DSOSDCOORD_RLE_X86
+
+#ifdef __SSE2__
+/** 4 pixels per compare. SSE2 is part of x86-64. */
+static void
+gst_ds_osdcoord_rle_threshold_sse2 (const gfloat * data, guint n,
+    gfloat threshold, guint64 * bits)
+{
+  const __m128 t = _mm_set1_ps (threshold);
+  guint i;
+
+  for (i = 0; i + RLE_WORD_BITS <= n; i += RLE_WORD_BITS) {
+    guint64 w = 0;
+    guint j;
+
+    for (j = 0; j < RLE_WORD_BITS; j += 4)
+      w |= (guint64) _mm_movemask_ps (_mm_cmpgt_ps (_mm_loadu_ps (data + i +
+                  j), t)) << j;
+    bits[i / RLE_WORD_BITS] = w;
+  }
+  if (i < n)
+    gst_ds_osdcoord_rle_threshold_scalar (data + i, n - i, threshold,
+        bits + i / RLE_WORD_BITS);
+}
+#endif
+
+/** 8 pixels per compare, used when the CPU reports AVX2 at run time like
+    the blend kernels. */
+__attribute__ ((target ("avx2")))
+static void
+gst_ds_osdcoord_rle_threshold_avx2 (const gfloat * data, guint n,
+    gfloat threshold, guint64 * bits)
+{
+  const __m256 t = _mm256_set1_ps (threshold);
+  guint i;
+
+  for (i = 0; i + RLE_WORD_BITS <= n; i += RLE_WORD_BITS) {
+    guint64 w = 0;
+    guint j;
+
+    for (j = 0; j < RLE_WORD_BITS; j += 8)
+      w |= (guint64) _mm256_movemask_ps (_mm256_cmp_ps (_mm256_loadu_ps (data +
+                  i + j), t, _CMP_GT_OQ)) << j;
+    bits[i / RLE_WORD_BITS] = w;
+  }
+  if (i < n)
+    gst_ds_osdcoord_rle_threshold_scalar (data + i, n - i, threshold,
+        bits + i / RLE_WORD_BITS);
+}
+
+#endif /* DSOSDCOORD_RLE_X86 */
+
+#ifdef DSOSDCOORD_RLE_NEON
+/** 4 pixels per compare; NEON has no movemask, so the compare result is
+    masked with the bit of each lane and the lanes are added up. */
+static void
+gst_ds_osdcoord_rle_threshold_neon (const gfloat * data, guint n,
+    gfloat threshold, guint64 * bits)
+{
+  const guint32 lane_bits[4] = { 1, 2, 4, 8 };
+  const uint32x4_t lanes = vld1q_u32 (lane_bits);
+  const float32x4_t t = vdupq_n_f32 (threshold);
+  guint i;
+
+  for (i = 0; i + RLE_WORD_BITS <= n; i += RLE_WORD_BITS) {
+    guint64 w = 0;
+    guint j;
+
+    for (j = 0; j < RLE_WORD_BITS; j += 4) {
+      uint32x4_t m = vandq_u32 (vcgtq_f32 (vld1q_f32 (data + i + j), t), lanes);
+      uint32x2_t s = vadd_u32 (vget_low_u32 (m), vget_high_u32 (m));
+
+      w |= (guint64) vget_lane_u32 (vpadd_u32 (s, s), 0) << j;
+    }
+    bits[i / RLE_WORD_BITS] = w;
+  }
+  if (i < n)
+    gst_ds_osdcoord_rle_threshold_scalar (data + i, n - i, threshold,
+        bits + i / RLE_WORD_BITS);
+}
+#endif /* DSOSDCOORD_RLE_NEON */
+
+static const GstDsOsdCoordRleImpl gst_ds_osdcoord_rle_scalar = {
+  "scalar", gst_ds_osdcoord_rle_threshold_scalar
+};
+
+#ifdef DSOSDCOORD_RLE_X86
+#ifdef __SSE2__
+static const GstDsOsdCoordRleImpl gst_ds_osdcoord_rle_sse2 = {
+  "sse2", gst_ds_osdcoord_rle_threshold_sse2
+};
+#endif
+static const GstDsOsdCoordRleImpl gst_ds_osdcoord_rle_avx2 = {
+  "avx2", gst_ds_osdcoord_rle_threshold_avx2
+};
+#endif
+
+#ifdef DSOSDCOORD_RLE_NEON
+static const GstDsOsdCoordRleImpl gst_ds_osdcoord_rle_neon = {
+  "neon", gst_ds_osdcoord_rle_threshold_neon
+};
+#endif
+
+/**
+ * Implementations the CPU supports, scalar first and fastest last.
+ * Returns the number of implementations stored in impls, at most
+ * DSOSDCOORD_RLE_MAX_IMPLS.
+ */
+guint
+gst_ds_osdcoord_rle_get_impls (const GstDsOsdCoordRleImpl ** impls)
+{
+  guint n = 0;
+
+  impls[n++] = &gst_ds_osdcoord_rle_scalar;
+#ifdef DSOSDCOORD_RLE_X86
+  __builtin_cpu_init ();
+#ifdef __SSE2__
+  impls[n++] = &gst_ds_osdcoord_rle_sse2;
+#endif
+  if (__builtin_cpu_supports ("avx2"))
+    impls[n++] = &gst_ds_osdcoord_rle_avx2;
+#elif defined(DSOSDCOORD_RLE_NEON)
+  impls[n++] = &gst_ds_osdcoord_rle_neon;
+#endif
+  return n;
+}
+
+const GstDsOsdCoordRleImpl *
+gst_ds_osdcoord_rle_get_impl (void)
+{
+  static gsize impl = 0;
+
+  if (g_once_init_enter (&impl)) {
+    const GstDsOsdCoordRleImpl *impls[DSOSDCOORD_RLE_MAX_IMPLS];
+    guint n = gst_ds_osdcoord_rle_get_impls (impls);
+
+    g_once_init_leave (&impl, (gsize) impls[n - 1]);
+  }
+  return (const GstDsOsdCoordRleImpl *) impl;
+}
+
+/**
+ * Bits of word i of bits set where a pixel differs from the one before it,
+ * the pixel before the first one counting as not set. carry holds the last
+ * bit of the previous word.
+ */
+static inline guint64
+gst_ds_osdcoord_rle_edges (const guint64 * bits, guint i, guint n,
+    guint64 carry)
+{
+  guint64 edges = bits[i] ^ ((bits[i] << 1) | carry);
+  guint valid = n - i * RLE_WORD_BITS;
+
+  if (valid < RLE_WORD_BITS)
+    edges &= (G_GUINT64_CONSTANT (1) << valid) - 1;
+  return edges;
+}
+
+/**
+ * Threshold the n values of data and return the lengths of their runs in
+ * order, alternately of values at or below threshold and above it,
+ * starting with the former, so the first run is empty if data[0] is above
+ * threshold. The number of runs is stored in *num_counts; if it exceeds
+ * max_counts NULL is returned. The bitmap and the runs are allocated from
+ * arena, so nothing is allocated once it has grown to the largest buffer.
+ */
+guint32 *
+gst_ds_osdcoord_rle_encode (const GstDsOsdCoordRleImpl * impl,
+    GstDsOsdCoordArena * arena, const gfloat * data, guint n,
+    gfloat threshold, guint max_counts, guint * num_counts)
+{
+  guint words = (n + RLE_WORD_BITS - 1) / RLE_WORD_BITS;
+  guint64 *bits = gst_ds_osdcoord_arena_alloc (arena, words *
+      sizeof (guint64));
+  guint32 *counts;
+  guint64 carry = 0;
+  guint count = 1, start = 0, i, k = 0;
+
+  impl->threshold (data, n, threshold, bits);
+
+  for (i = 0; i < words; i++) {
+    count += __builtin_popcountll (gst_ds_osdcoord_rle_edges (bits, i, n,
+            carry));
+    carry = bits[i] >> (RLE_WORD_BITS - 1);
+  }
+  *num_counts = count;
+  if (count > max_counts)
+    return NULL;
+
+  counts = gst_ds_osdcoord_arena_alloc (arena, count * sizeof (guint32));
+  carry = 0;
+  for (i = 0; i < words; i++) {
+    guint64 edges = gst_ds_osdcoord_rle_edges (bits, i, n, carry);
+
+    for (; edges; edges &= edges - 1) {
+      guint end = i * RLE_WORD_BITS + __builtin_ctzll (edges);
+
+      counts[k++] = end - start;
+      start = end;
+    }
+    carry = bits[i] >> (RLE_WORD_BITS - 1);
+  }
+  counts[k] = n - start;
+  return counts;
+}
@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_RLE_H__
+#define __GST_DSOSDCOORD_RLE_H__
+
+#include <glib.h>
+#include "gstdsosdcoord_arena.h"
+
+G_BEGIN_DECLS
+
+/**
+ * Set bit i % 64 of bits[i / 64] for each of the n values of data above
+ * threshold, clearing the bits past n in the last word.
+ */
+typedef void (*GstDsOsdCoordRleThresholdFunc) (const gfloat * data, guint n,
+    gfloat threshold, guint64 * bits);
+
+typedef struct
+{
+  const gchar *name;
+  GstDsOsdCoordRleThresholdFunc threshold;
+} GstDsOsdCoordRleImpl;
+
+/** Portable implementation all others must match bit for bit. */
+void gst_ds_osdcoord_rle_threshold_scalar (const gfloat * data, guint n,
+    gfloat threshold, guint64 * bits);
+
+#define DSOSDCOORD_RLE_MAX_IMPLS 4
+
+guint gst_ds_osdcoord_rle_get_impls (const GstDsOsdCoordRleImpl ** impls);
+
+/**
+ * Fastest implementation the CPU supports, detected on the first call.
+ */
+const GstDsOsdCoordRleImpl *gst_ds_osdcoord_rle_get_impl (void);
+
+guint32 *gst_ds_osdcoord_rle_encode (const GstDsOsdCoordRleImpl * impl,
+    GstDsOsdCoordArena * arena, const gfloat * data, guint n,
+    gfloat threshold, guint max_counts, guint * num_counts);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_RLE_H__ */
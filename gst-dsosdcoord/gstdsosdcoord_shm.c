@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "gstdsosdcoord_shm.h"
+
+G_STATIC_ASSERT (sizeof (DsOsdCoordShmHeader) == 64);
+G_STATIC_ASSERT (sizeof (DsOsdCoordShmRecord) % 8 == 0);
+
+/**
+ * Writer side of the shared memory ring described in dsosdcoord_shm.h.
+ * Only used from the exporter thread.
+ */
+struct _GstDsOsdCoordShmWriter
+{
+  gchar *name;
+  gsize size;
+  DsOsdCoordShmHeader *header;
+  DsOsdCoordShmRecord *records;
+  guint64 write_index;
+};
+
+/**
+ * Create (or recreate) the shared memory object `name` with room for
+ * capacity records and map it.
+ */
+GstDsOsdCoordShmWriter *
+gst_ds_osdcoord_shm_writer_new (const gchar * name, guint capacity,
+    GError ** error)
+{
+  GstDsOsdCoordShmWriter *writer;
+  gsize size = dsosdcoord_shm_size (capacity);
+  void *addr;
+  int fd;
+
+  /* Start from a fresh object so readers of a previous run, which still
+     map the old one, never see a reinitialized header. */
+  shm_unlink (name);
+  fd = shm_open (name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "shm_open %s failed: %s", name, g_strerror (errno));
+    return NULL;
+  }
+  if (ftruncate (fd, size) < 0) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "ftruncate %s failed: %s", name, g_strerror (errno));
+    close (fd);
+    shm_unlink (name);
+    return NULL;
+  }
+  addr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (addr == MAP_FAILED) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "mmap %s failed: %s", name, g_strerror (errno));
+    shm_unlink (name);
+    return NULL;
+  }
+
+  writer = g_new0 (GstDsOsdCoordShmWriter, 1);
+  writer->name = g_strdup (name);
+  writer->size = size;
+  writer->header = (DsOsdCoordShmHeader *) addr;
+  writer->records = dsosdcoord_shm_records (writer->header);
+
+  writer->header->version = DSOSDCOORD_SHM_VERSION;
+  writer->header->record_size = sizeof (DsOsdCoordShmRecord);
+  writer->header->capacity = capacity;
+  writer->header->write_index = 0;
+  /* Readers check the magic last. */
+  __atomic_store_n (&writer->header->magic, DSOSDCOORD_SHM_MAGIC,
+      __ATOMIC_RELEASE);
+
+  return writer;
+}
+
+/**
+ * Unmap and unlink the ring. Readers that still map it keep their mapping.
+ */
+void
+gst_ds_osdcoord_shm_writer_free (GstDsOsdCoordShmWriter * writer)
+{
+  if (!writer)
+    return;
+
+  munmap (writer->header, writer->size);
+  shm_unlink (writer->name);
+  g_free (writer->name);
+  g_free (writer);
+}
+
+/**
+ * Publish one record into the next slot of the ring.
+ */
+void
+gst_ds_osdcoord_shm_writer_write (GstDsOsdCoordShmWriter * writer,
+    const GstDsOsdCoordExportRecord * record)
+{
+  DsOsdCoordShmRecord *slot =
+      &writer->records[writer->write_index % writer->header->capacity];
+  guint32 seq = slot->seq;
+
+  __atomic_store_n (&slot->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+
+  slot->flags = ((record->flags & DSOSDCOORD_RECORD_FLAG_HAS_SOURCE) ?
+      DSOSDCOORD_SHM_FLAG_HAS_SOURCE : 0) |
+      ((record->flags & DSOSDCOORD_RECORD_FLAG_HAS_TRACK) ?
+      DSOSDCOORD_SHM_FLAG_HAS_TRACK : 0);
+  slot->index = writer->write_index;
+  slot->pts = record->pts;
+  slot->frame_num = record->frame_num;
+  slot->source_id = record->source_id;
+  slot->batch_id = record->batch_id;
+  slot->event = record->event;
+  slot->left = record->left;
+  slot->top = record->top;
+  slot->width = record->width;
+  slot->height = record->height;
+  slot->object_id = record->object_id;
+  slot->class_id = record->class_id;
+  slot->reserved = 0;
+  g_strlcpy (slot->label, record->label, sizeof (slot->label));
+
+  __atomic_store_n (&slot->seq, seq + 2, __ATOMIC_RELEASE);
+  writer->write_index++;
+  __atomic_store_n (&writer->header->write_index, writer->write_index,
+      __ATOMIC_RELEASE);
+}
+
+/**
+ * Size of the shared memory mapping.
+ */
+gsize
+gst_ds_osdcoord_shm_writer_get_size (GstDsOsdCoordShmWriter * writer)
+{
+  return writer->size;
+}
@@ -0,0 +1,35 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_SHM_H__
+#define __GST_DSOSDCOORD_SHM_H__
+
+#include <gst/gst.h>
+#include "dsosdcoord_shm.h"
+#include "gstdsosdcoord_exporter.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GstDsOsdCoordShmWriter GstDsOsdCoordShmWriter;
+
+GstDsOsdCoordShmWriter *gst_ds_osdcoord_shm_writer_new (const gchar * name,
+    guint capacity, GError ** error);
+
+void gst_ds_osdcoord_shm_writer_free (GstDsOsdCoordShmWriter * writer);
+
+void gst_ds_osdcoord_shm_writer_write (GstDsOsdCoordShmWriter * writer,
+    const GstDsOsdCoordExportRecord * record);
+
+gsize gst_ds_osdcoord_shm_writer_get_size (GstDsOsdCoordShmWriter * writer);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_SHM_H__ */
@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include "gstdsosdcoord_stats.h"
+
+static const gchar *stage_names[DSOSDCOORD_NUM_STAGES] = {
+  "meta-lookup",
+  "objects",
+  "display-meta",
+  "draw-rects",
+  "draw-masks",
+  "draw-text",
+  "draw-lines",
+  "draw-arrows",
+  "draw-circles",
+  "export",
+  "buffer",
+};
+
+/**
+ * Largest duration counted in bucket index.
+ */
+static guint64
+gst_ds_osdcoord_histogram_bucket_max (guint index)
+{
+  guint group = index >> DSOSDCOORD_HISTOGRAM_SUB_BITS;
+  guint64 sub = index & ((1 << DSOSDCOORD_HISTOGRAM_SUB_BITS) - 1);
+
+  if (group == 0)
+    return index;
+  return (((1 << DSOSDCOORD_HISTOGRAM_SUB_BITS) + sub + 1) << (group - 1)) - 1;
+}
+
+void
+gst_ds_osdcoord_stats_add (GstDsOsdCoordStats * dst,
+    const GstDsOsdCoordStats * src)
+{
+  guint i, j;
+
+  for (i = 0; i < DSOSDCOORD_NUM_STAGES; i++)
+    for (j = 0; j < DSOSDCOORD_HISTOGRAM_BUCKETS; j++)
+      dst->stages[i].counts[j] += src->stages[i].counts[j];
+  dst->buffers += src->buffers;
+  dst->frames += src->frames;
+  dst->objects += src->objects;
+  dst->filtered += src->filtered;
+  dst->suppressed += src->suppressed;
+  dst->scratch_allocations += src->scratch_allocations;
+}
+
+void
+gst_ds_osdcoord_stats_subtract (GstDsOsdCoordStats * dst,
+    const GstDsOsdCoordStats * src)
+{
+  guint i, j;
+
+  for (i = 0; i < DSOSDCOORD_NUM_STAGES; i++)
+    for (j = 0; j < DSOSDCOORD_HISTOGRAM_BUCKETS; j++)
+      dst->stages[i].counts[j] -= src->stages[i].counts[j];
+  dst->buffers -= src->buffers;
+  dst->frames -= src->frames;
+  dst->objects -= src->objects;
+  dst->filtered -= src->filtered;
+  dst->suppressed -= src->suppressed;
+  dst->scratch_allocations -= src->scratch_allocations;
+}
+
+/**
+ * Return the upper bound of the bucket holding the given percentile
+ * (0 to 100) of the samples, 0 if the histogram is empty.
+ */
+guint64
+gst_ds_osdcoord_histogram_percentile (const GstDsOsdCoordHistogram *
+    histogram, gdouble percentile)
+{
+  guint64 total = 0, rank, seen = 0;
+  guint i, last = 0;
+
+  for (i = 0; i < DSOSDCOORD_HISTOGRAM_BUCKETS; i++)
+    total += histogram->counts[i];
+  if (total == 0)
+    return 0;
+
+  rank = (guint64) (percentile / 100.0 * total + 0.5);
+  rank = CLAMP (rank, 1, total);
+  for (i = 0; i < DSOSDCOORD_HISTOGRAM_BUCKETS; i++) {
+    if (histogram->counts[i] == 0)
+      continue;
+    last = i;
+    seen += histogram->counts[i];
+    if (seen >= rank)
+      break;
+  }
+  return gst_ds_osdcoord_histogram_bucket_max (last);
+}
+
+/**
+ * Summarize the statistics as a structure with buffers, frames, objects,
+ * filtered, suppressed and scratch-allocations counts and, for each stage,
+ * <stage>-count and <stage>-p50, -p99 and -max in nanoseconds.
+ */
+GstStructure *
+gst_ds_osdcoord_stats_to_structure (const GstDsOsdCoordStats * stats,
+    const gchar * name)
+{
+  GstStructure *s = gst_structure_new (name,
+      "buffers", G_TYPE_UINT64, stats->buffers,
+      "frames", G_TYPE_UINT64, stats->frames,
+      "objects", G_TYPE_UINT64, stats->objects,
+      "filtered", G_TYPE_UINT64, stats->filtered,
+      "suppressed", G_TYPE_UINT64, stats->suppressed,
+      "scratch-allocations", G_TYPE_UINT64, stats->scratch_allocations,
+      NULL);
+  guint i, j;
+
+  for (i = 0; i < DSOSDCOORD_NUM_STAGES; i++) {
+    const GstDsOsdCoordHistogram *histogram = &stats->stages[i];
+    guint64 count = 0;
+    gchar *field;
+
+    for (j = 0; j < DSOSDCOORD_HISTOGRAM_BUCKETS; j++)
+      count += histogram->counts[j];
+
+    field = g_strdup_printf ("%s-count", stage_names[i]);
+    gst_structure_set (s, field, G_TYPE_UINT64, count, NULL);
+    g_free (field);
+    field = g_strdup_printf ("%s-p50", stage_names[i]);
+    gst_structure_set (s, field, G_TYPE_UINT64,
+        gst_ds_osdcoord_histogram_percentile (histogram, 50), NULL);
+    g_free (field);
+    field = g_strdup_printf ("%s-p99", stage_names[i]);
+    gst_structure_set (s, field, G_TYPE_UINT64,
+        gst_ds_osdcoord_histogram_percentile (histogram, 99), NULL);
+    g_free (field);
+    field = g_strdup_printf ("%s-max", stage_names[i]);
+    gst_structure_set (s, field, G_TYPE_UINT64,
+        gst_ds_osdcoord_histogram_percentile (histogram, 100), NULL);
+    g_free (field);
+  }
+  return s;
+}
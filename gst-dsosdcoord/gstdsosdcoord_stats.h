@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_STATS_H__
+#define __GST_DSOSDCOORD_STATS_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Timed stages of a buffer.
+ */
+typedef enum
+{
+  /** Finding the NvDsBatchMeta on the buffer. */
+  DSOSDCOORD_STAGE_META_LOOKUP,
+  /** Walking the objects of a frame, or of the batch pool. */
+  DSOSDCOORD_STAGE_OBJECTS,
+  /** Walking the display metas of a frame, or of the batch pool. */
+  DSOSDCOORD_STAGE_DISPLAY_META,
+  /** One draw call of each kind. */
+  DSOSDCOORD_STAGE_DRAW_RECTS,
+  DSOSDCOORD_STAGE_DRAW_MASKS,
+  DSOSDCOORD_STAGE_DRAW_TEXT,
+  DSOSDCOORD_STAGE_DRAW_LINES,
+  DSOSDCOORD_STAGE_DRAW_ARROWS,
+  DSOSDCOORD_STAGE_DRAW_CIRCLES,
+  /** Handing the records of the batch to the exporter. */
+  DSOSDCOORD_STAGE_EXPORT,
+  /** The whole of transform_ip. */
+  DSOSDCOORD_STAGE_BUFFER,
+  DSOSDCOORD_NUM_STAGES
+} GstDsOsdCoordStage;
+
+/** Linear sub-buckets per power of two, 1 << 4 gives 6.25% precision. */
+#define DSOSDCOORD_HISTOGRAM_SUB_BITS 4
+/** Durations of 2^36 ns (about 68 s) and more share the last bucket. */
+#define DSOSDCOORD_HISTOGRAM_MAX_BITS 36
+#define DSOSDCOORD_HISTOGRAM_BUCKETS \
+    ((DSOSDCOORD_HISTOGRAM_MAX_BITS - DSOSDCOORD_HISTOGRAM_SUB_BITS + 1) << \
+        DSOSDCOORD_HISTOGRAM_SUB_BITS)
+
+/**
+ * Log-linear histogram of durations in nanoseconds. Values below
+ * 1 << SUB_BITS are counted exactly, larger ones in SUB_BITS linear steps
+ * per power of two.
+ */
+typedef struct
+{
+  guint64 counts[DSOSDCOORD_HISTOGRAM_BUCKETS];
+} GstDsOsdCoordHistogram;
+
+/**
+ * Statistics of one worker. Only the owning thread writes to them.
+ */
+typedef struct
+{
+  GstDsOsdCoordHistogram stages[DSOSDCOORD_NUM_STAGES];
+  guint64 buffers;
+  guint64 frames;
+  guint64 objects;
+  /** Objects not exported because of the export filter. */
+  guint64 filtered;
+  /** Records of unchanged tracks not exported with export-mode=changes. */
+  guint64 suppressed;
+  /** Chunks the scratch arenas of the workers allocated, 0 per buffer once
+      they have seen the largest batch. */
+  guint64 scratch_allocations;
+} GstDsOsdCoordStats;
+
+static inline guint
+gst_ds_osdcoord_histogram_index (guint64 ns)
+{
+  guint bits;
+
+  if (ns < (1 << DSOSDCOORD_HISTOGRAM_SUB_BITS))
+    return (guint) ns;
+  bits = g_bit_storage (ns);
+  if (bits > DSOSDCOORD_HISTOGRAM_MAX_BITS)
+    return DSOSDCOORD_HISTOGRAM_BUCKETS - 1;
+  return ((bits - DSOSDCOORD_HISTOGRAM_SUB_BITS) <<
+      DSOSDCOORD_HISTOGRAM_SUB_BITS) +
+      ((ns >> (bits - DSOSDCOORD_HISTOGRAM_SUB_BITS - 1)) &
+      ((1 << DSOSDCOORD_HISTOGRAM_SUB_BITS) - 1));
+}
+
+static inline void
+gst_ds_osdcoord_stats_record (GstDsOsdCoordStats * stats,
+    GstDsOsdCoordStage stage, GstClockTime start)
+{
+  GstClockTime now = gst_util_get_timestamp ();
+
+  stats->stages[stage].counts[gst_ds_osdcoord_histogram_index (now -
+          start)]++;
+}
+
+void gst_ds_osdcoord_stats_add (GstDsOsdCoordStats * dst,
+    const GstDsOsdCoordStats * src);
+void gst_ds_osdcoord_stats_subtract (GstDsOsdCoordStats * dst,
+    const GstDsOsdCoordStats * src);
+guint64 gst_ds_osdcoord_histogram_percentile (
+    const GstDsOsdCoordHistogram * histogram, gdouble percentile);
+GstStructure *gst_ds_osdcoord_stats_to_structure (
+    const GstDsOsdCoordStats * stats, const gchar * name);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_STATS_H__ */
@@ -0,0 +1,600 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <string.h>
+#include "gstdsosdcoord_synth.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_ds_osdcoord_synth_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_synth_debug
+
+/* Enum to identify properties */
+enum
+{
+  PROP_0,
+  PROP_BATCH_SIZE,
+  PROP_OBJECTS_PER_FRAME,
+  PROP_DISPLAY_META_PER_FRAME,
+  PROP_LABEL_LENGTH,
+  PROP_MASK_SIZE,
+  PROP_NUM_CLASSES,
+  PROP_SEED,
+};
+
+/* Default values for properties */
+#define DEFAULT_BATCH_SIZE 1
+#define DEFAULT_OBJECTS_PER_FRAME 16
+#define DEFAULT_DISPLAY_META_PER_FRAME 0
+#define DEFAULT_LABEL_LENGTH 8
+#define DEFAULT_MASK_SIZE 0
+#define DEFAULT_NUM_CLASSES 4
+#define DEFAULT_SEED 0
+/* Used when the caps carry no frame size. */
+#define DEFAULT_WIDTH 1920
+#define DEFAULT_HEIGHT 1080
+#define MAX_BATCH_SIZE 1024
+#define MAX_MASK_SIZE 1024
+
+static GstStaticPadTemplate dsosdcoord_synth_sink_factory =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate dsosdcoord_synth_src_factory =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#define gst_ds_osdcoord_synth_parent_class parent_class
+G_DEFINE_TYPE (GstDsOsdCoordSynth, gst_ds_osdcoord_synth,
+    GST_TYPE_BASE_TRANSFORM);
+
+static void gst_ds_osdcoord_synth_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec);
+static void gst_ds_osdcoord_synth_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec);
+static void gst_ds_osdcoord_synth_finalize (GObject * object);
+
+/**
+ * Create a pool of batch metas for batch_size frames, with a shared mask of
+ * mask_size squared if mask_size is not 0. Also used by dsosdcoordreplay.
+ */
+GstDsOsdCoordSynthPool *
+gst_ds_osdcoord_synth_pool_new (guint batch_size, guint mask_size)
+{
+  GstDsOsdCoordSynthPool *pool = g_new0 (GstDsOsdCoordSynthPool, 1);
+  guint i;
+
+  pool->ref_count = 1;
+  g_mutex_init (&pool->lock);
+  g_queue_init (&pool->free);
+  pool->batch_size = batch_size;
+  pool->mask_size = mask_size;
+  if (mask_size > 0) {
+    /* A filled ellipse, the mask scaled onto each object. */
+    pool->mask = g_new (gfloat, mask_size * mask_size);
+    for (i = 0; i < mask_size * mask_size; i++) {
+      gfloat x = (gfloat) (i % mask_size) / mask_size * 2 - 1;
+      gfloat y = (gfloat) (i / mask_size) / mask_size * 2 - 1;
+      pool->mask[i] = 1.0f - (x * x + y * y);
+    }
+  }
+  return pool;
+}
+
+void
+gst_ds_osdcoord_synth_pool_unref (GstDsOsdCoordSynthPool * pool)
+{
+  NvDsBatchMeta *batch_meta;
+
+  if (!pool || !g_atomic_int_dec_and_test (&pool->ref_count))
+    return;
+
+  while ((batch_meta = (NvDsBatchMeta *) g_queue_pop_head (&pool->free)))
+    nvds_destroy_batch_meta (batch_meta);
+  g_mutex_clear (&pool->lock);
+  g_free (pool->mask);
+  g_free (pool->labels);
+  g_free (pool->label_texts);
+  g_free (pool);
+}
+
+/**
+ * Copy labels into the pool for objects to point their display_text at
+ * pool->label_texts[id] instead of a copy of their own. Called once,
+ * before the first batch is attached.
+ */
+void
+gst_ds_osdcoord_synth_pool_set_labels (GstDsOsdCoordSynthPool * pool,
+    const GPtrArray * labels)
+{
+  gsize offset = 0;
+  guint i;
+
+  pool->labels_size = 0;
+  for (i = 0; i < labels->len; i++)
+    pool->labels_size += strlen (g_ptr_array_index (labels, i)) + 1;
+
+  pool->labels = g_malloc (MAX (pool->labels_size, 1));
+  pool->label_texts = g_new (const gchar *, MAX (labels->len, 1));
+  for (i = 0; i < labels->len; i++) {
+    const gchar *label = g_ptr_array_index (labels, i);
+    gsize size = strlen (label) + 1;
+
+    memcpy (pool->labels + offset, label, size);
+    pool->label_texts[i] = pool->labels + offset;
+    offset += size;
+  }
+}
+
+/**
+ * Return the frame, object and display metas of a batch to its own pools.
+ * The shared mask and labels are detached first so the object release does
+ * not free them.
+ */
+static void
+gst_ds_osdcoord_synth_batch_meta_clear (GstDsOsdCoordSynthPool * pool,
+    NvDsBatchMeta * batch_meta)
+{
+  NvDsMetaList *l_frame, *l_obj;
+
+  for (l_frame = batch_meta->frame_meta_list; l_frame; l_frame = l_frame->next) {
+    NvDsFrameMeta *frame_meta = (NvDsFrameMeta *) l_frame->data;
+
+    for (l_obj = frame_meta->obj_meta_list; l_obj; l_obj = l_obj->next) {
+      NvDsObjectMeta *obj_meta = (NvDsObjectMeta *) l_obj->data;
+      gchar *text = obj_meta->text_params.display_text;
+
+      memset (&obj_meta->mask_params, 0, sizeof (obj_meta->mask_params));
+      if (pool->labels && text >= pool->labels &&
+          text < pool->labels + pool->labels_size)
+        obj_meta->text_params.display_text = NULL;
+    }
+  }
+  nvds_clear_frame_meta_list (batch_meta, batch_meta->frame_meta_list);
+  batch_meta->frame_meta_list = NULL;
+  batch_meta->num_frames_in_batch = 0;
+}
+
+/**
+ * Release function of the NvDsMeta: keep the batch meta for the next
+ * buffer instead of destroying it.
+ */
+static void
+gst_ds_osdcoord_synth_batch_meta_release (gpointer data, gpointer user_data)
+{
+  NvDsMeta *dsmeta = (NvDsMeta *) data;
+  NvDsBatchMeta *batch_meta = (NvDsBatchMeta *) dsmeta->meta_data;
+  GstDsOsdCoordSynthPool *pool = (GstDsOsdCoordSynthPool *) user_data;
+
+  gst_ds_osdcoord_synth_batch_meta_clear (pool, batch_meta);
+  if (batch_meta->max_frames_in_batch == pool->batch_size) {
+    g_mutex_lock (&pool->lock);
+    g_queue_push_head (&pool->free, batch_meta);
+    g_mutex_unlock (&pool->lock);
+  } else {
+    nvds_destroy_batch_meta (batch_meta);
+  }
+  gst_ds_osdcoord_synth_pool_unref (pool);
+}
+
+/**
+ * Copy function of the NvDsMeta. The copy is released through the pool as
+ * well, so it takes its own reference.
+ */
+static gpointer
+gst_ds_osdcoord_synth_batch_meta_copy (gpointer data, gpointer user_data)
+{
+  GstDsOsdCoordSynthPool *pool = (GstDsOsdCoordSynthPool *) user_data;
+
+  g_atomic_int_inc (&pool->ref_count);
+  return nvds_batch_meta_copy_func (data, user_data);
+}
+
+NvDsBatchMeta *
+gst_ds_osdcoord_synth_pool_acquire (GstDsOsdCoordSynthPool * pool)
+{
+  NvDsBatchMeta *batch_meta;
+
+  g_mutex_lock (&pool->lock);
+  batch_meta = (NvDsBatchMeta *) g_queue_pop_head (&pool->free);
+  g_mutex_unlock (&pool->lock);
+
+  if (!batch_meta)
+    batch_meta = nvds_create_batch_meta (pool->batch_size);
+  return batch_meta;
+}
+
+/**
+ * Attach batch_meta, taken from the pool, to buf. It returns to the pool
+ * when the buffer is freed.
+ */
+void
+gst_ds_osdcoord_synth_pool_attach (GstDsOsdCoordSynthPool * pool,
+    GstBuffer * buf, NvDsBatchMeta * batch_meta)
+{
+  NvDsMeta *meta;
+
+  g_atomic_int_inc (&pool->ref_count);
+  meta = gst_buffer_add_nvds_meta (buf, batch_meta, pool,
+      gst_ds_osdcoord_synth_batch_meta_copy,
+      gst_ds_osdcoord_synth_batch_meta_release);
+  meta->meta_type = NVDS_BATCH_GST_META;
+  batch_meta->base_meta.batch_meta = batch_meta;
+}
+
+void
+gst_ds_osdcoord_synth_color (NvOSD_ColorParams * color, guint class_id)
+{
+  color->red = (class_id & 1) ? 1.0 : 0.0;
+  color->green = (class_id & 2) ? 1.0 : 0.0;
+  color->blue = (class_id & 4) ? 1.0 : 0.5;
+  color->alpha = 1.0;
+}
+
+static void
+gst_ds_osdcoord_synth_add_object (GstDsOsdCoordSynth * synth,
+    NvDsBatchMeta * batch_meta, NvDsFrameMeta * frame_meta, guint index)
+{
+  NvDsObjectMeta *obj_meta = nvds_acquire_obj_meta_from_pool (batch_meta);
+  NvOSD_RectParams *rect = &obj_meta->rect_params;
+  NvOSD_TextParams *text = &obj_meta->text_params;
+  GstDsOsdCoordSynthPool *pool = synth->pool;
+  guint class_id = index % synth->num_classes;
+  gdouble w = g_rand_double_range (synth->rand, 0.05, 0.3) * synth->width;
+  gdouble h = g_rand_double_range (synth->rand, 0.05, 0.3) * synth->height;
+
+  obj_meta->unique_component_id = 1;
+  obj_meta->class_id = class_id;
+  obj_meta->object_id = synth->object_id++;
+  obj_meta->confidence = (gfloat) g_rand_double (synth->rand);
+  g_strlcpy (obj_meta->obj_label, synth->label, MAX_LABEL_SIZE);
+
+  rect->left = g_rand_double_range (synth->rand, 0, synth->width - w);
+  rect->top = g_rand_double_range (synth->rand, 0, synth->height - h);
+  rect->width = w;
+  rect->height = h;
+  rect->border_width = 3;
+  gst_ds_osdcoord_synth_color (&rect->border_color, class_id);
+  rect->has_bg_color = 0;
+
+  text->display_text = g_strdup (synth->label);
+  text->x_offset = (guint) rect->left;
+  text->y_offset = (guint) MAX (rect->top - 20, 0);
+  text->font_params.font_name = (gchar *) "Serif";
+  text->font_params.font_size = 12;
+  text->font_params.font_color.red = 1.0;
+  text->font_params.font_color.green = 1.0;
+  text->font_params.font_color.blue = 1.0;
+  text->font_params.font_color.alpha = 1.0;
+  text->set_bg_clr = 1;
+  text->text_bg_clr.alpha = 1.0;
+
+  if (pool->mask) {
+    obj_meta->mask_params.data = pool->mask;
+    obj_meta->mask_params.size = pool->mask_size * pool->mask_size *
+        sizeof (gfloat);
+    obj_meta->mask_params.threshold = 0.5f;
+    obj_meta->mask_params.width = pool->mask_size;
+    obj_meta->mask_params.height = pool->mask_size;
+  }
+
+  nvds_add_obj_meta_to_frame (frame_meta, obj_meta, NULL);
+}
+
+static void
+gst_ds_osdcoord_synth_add_display_meta (GstDsOsdCoordSynth * synth,
+    NvDsBatchMeta * batch_meta, NvDsFrameMeta * frame_meta, guint index)
+{
+  NvDsDisplayMeta *display_meta =
+      nvds_acquire_display_meta_from_pool (batch_meta);
+  guint y = (guint) g_rand_int_range (synth->rand, 0, MAX (synth->height, 1));
+  NvOSD_TextParams *text = &display_meta->text_params[0];
+  NvOSD_LineParams *line = &display_meta->line_params[0];
+
+  display_meta->num_labels = 1;
+  text->display_text = g_strdup (synth->label);
+  text->x_offset = 10;
+  text->y_offset = y;
+  text->font_params.font_name = (gchar *) "Serif";
+  text->font_params.font_size = 12;
+  text->font_params.font_color.green = 1.0;
+  text->font_params.font_color.alpha = 1.0;
+
+  display_meta->num_lines = 1;
+  line->x1 = 0;
+  line->y1 = y;
+  line->x2 = MAX (synth->width, 1) - 1;
+  line->y2 = y;
+  line->line_width = 2;
+  gst_ds_osdcoord_synth_color (&line->line_color, index);
+
+  nvds_add_display_meta_to_frame (frame_meta, display_meta);
+}
+
+/**
+ * Called when source / sink pad capabilities have been negotiated.
+ */
+static gboolean
+gst_ds_osdcoord_synth_set_caps (GstBaseTransform * trans, GstCaps * incaps,
+    GstCaps * outcaps)
+{
+  GstDsOsdCoordSynth *synth = GST_DSOSDCOORD_SYNTH (trans);
+  GstStructure *structure = gst_caps_get_structure (incaps, 0);
+
+  if (!gst_structure_get_int (structure, "width", &synth->width) ||
+      !gst_structure_get_int (structure, "height", &synth->height)) {
+    synth->width = DEFAULT_WIDTH;
+    synth->height = DEFAULT_HEIGHT;
+  }
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_synth_start (GstBaseTransform * trans)
+{
+  GstDsOsdCoordSynth *synth = GST_DSOSDCOORD_SYNTH (trans);
+
+  synth->pool = gst_ds_osdcoord_synth_pool_new (synth->batch_size,
+      synth->mask_size);
+  synth->rand = g_rand_new_with_seed (synth->seed);
+  g_free (synth->label);
+  synth->label = g_strnfill (synth->label_length, 'a');
+  synth->frame_num = 0;
+  synth->object_id = 0;
+  return TRUE;
+}
+
+static gboolean
+gst_ds_osdcoord_synth_stop (GstBaseTransform * trans)
+{
+  GstDsOsdCoordSynth *synth = GST_DSOSDCOORD_SYNTH (trans);
+
+  /* Buffers still in flight hold their own reference. */
+  gst_ds_osdcoord_synth_pool_unref (synth->pool);
+  synth->pool = NULL;
+  if (synth->rand) {
+    g_rand_free (synth->rand);
+    synth->rand = NULL;
+  }
+  return TRUE;
+}
+
+/**
+ * Attach a batch of batch_size frames to the buffer.
+ */
+static GstFlowReturn
+gst_ds_osdcoord_synth_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+{
+  GstDsOsdCoordSynth *synth = GST_DSOSDCOORD_SYNTH (trans);
+  NvDsBatchMeta *batch_meta;
+  guint i, j;
+
+  batch_meta = gst_ds_osdcoord_synth_pool_acquire (synth->pool);
+  if (!batch_meta) {
+    GST_ELEMENT_ERROR (synth, RESOURCE, FAILED,
+        ("Unable to create batch meta"), NULL);
+    return GST_FLOW_ERROR;
+  }
+
+  for (i = 0; i < synth->batch_size; i++) {
+    NvDsFrameMeta *frame_meta = nvds_acquire_frame_meta_from_pool (batch_meta);
+
+    frame_meta->pad_index = i;
+    frame_meta->source_id = i;
+    frame_meta->batch_id = i;
+    frame_meta->frame_num = (gint) synth->frame_num;
+    frame_meta->buf_pts = GST_BUFFER_PTS (buf);
+    frame_meta->num_surfaces_per_frame = 1;
+    frame_meta->source_frame_width = synth->width;
+    frame_meta->source_frame_height = synth->height;
+    frame_meta->bInferDone = TRUE;
+    nvds_add_frame_meta_to_batch (batch_meta, frame_meta);
+
+    for (j = 0; j < synth->objects_per_frame; j++)
+      gst_ds_osdcoord_synth_add_object (synth, batch_meta, frame_meta, j);
+    for (j = 0; j < synth->display_meta_per_frame; j++)
+      gst_ds_osdcoord_synth_add_display_meta (synth, batch_meta, frame_meta,
+          j);
+  }
+  synth->frame_num++;
+
+  gst_ds_osdcoord_synth_pool_attach (synth->pool, buf, batch_meta);
+  return GST_FLOW_OK;
+}
+
+static void
+gst_ds_osdcoord_synth_finalize (GObject * object)
+{
+  GstDsOsdCoordSynth *synth = GST_DSOSDCOORD_SYNTH (object);
+
+  g_free (synth->label);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_ds_osdcoord_synth_class_init (GstDsOsdCoordSynthClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstBaseTransformClass *base_transform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
+
+  base_transform_class->transform_ip =
+      GST_DEBUG_FUNCPTR (gst_ds_osdcoord_synth_transform_ip);
+  base_transform_class->start = GST_DEBUG_FUNCPTR (gst_ds_osdcoord_synth_start);
+  base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_ds_osdcoord_synth_stop);
+  base_transform_class->set_caps =
+      GST_DEBUG_FUNCPTR (gst_ds_osdcoord_synth_set_caps);
+
+  gobject_class->set_property = gst_ds_osdcoord_synth_set_property;
+  gobject_class->get_property = gst_ds_osdcoord_synth_get_property;
+  gobject_class->finalize = gst_ds_osdcoord_synth_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Number of frames in each batch",
+          1, MAX_BATCH_SIZE, DEFAULT_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_OBJECTS_PER_FRAME,
+      g_param_spec_uint ("objects-per-frame", "Objects Per Frame",
+          "Number of object metas in each frame",
+          0, G_MAXINT, DEFAULT_OBJECTS_PER_FRAME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_DISPLAY_META_PER_FRAME,
+      g_param_spec_uint ("display-meta-per-frame", "Display Meta Per Frame",
+          "Number of display metas, each with a label and a line, in each "
+          "frame",
+          0, G_MAXINT, DEFAULT_DISPLAY_META_PER_FRAME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_LABEL_LENGTH,
+      g_param_spec_uint ("label-length", "Label Length",
+          "Number of characters of each object label and display text",
+          0, 4096, DEFAULT_LABEL_LENGTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_MASK_SIZE,
+      g_param_spec_uint ("mask-size", "Mask Size",
+          "Width and height of the segmentation mask of each object,\n"
+          "\t\t\t 0 for no masks",
+          0, MAX_MASK_SIZE, DEFAULT_MASK_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_CLASSES,
+      g_param_spec_uint ("num-classes", "Number of Classes",
+          "Number of class ids the objects cycle through",
+          1, G_MAXINT, DEFAULT_NUM_CLASSES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_SEED,
+      g_param_spec_uint ("seed", "Seed",
+          "Seed of the random object placement",
+          0, G_MAXUINT, DEFAULT_SEED,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  gst_element_class_set_details_simple (gstelement_class,
+      "DsOsdCoord synthetic metadata",
+      "Filter/Metadata",
+      "Attaches synthetic NvDsBatchMeta to buffers to drive dsosdcoord",
+      "NVIDIA Corporation. Post on Deepstream for Tesla forum for any queries "
+      "@ https://devtalk.nvidia.com/default/board/209/");
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&dsosdcoord_synth_src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&dsosdcoord_synth_sink_factory));
+
+  GST_DEBUG_CATEGORY_INIT (gst_ds_osdcoord_synth_debug, "dsosdcoordsynth", 0,
+      "dsosdcoord synthetic metadata");
+}
+
+static void
+gst_ds_osdcoord_synth_init (GstDsOsdCoordSynth * synth)
+{
+  GstBaseTransform *btrans = GST_BASE_TRANSFORM (synth);
+
+  gst_base_transform_set_in_place (btrans, TRUE);
+  gst_base_transform_set_passthrough (btrans, FALSE);
+
+  synth->width = DEFAULT_WIDTH;
+  synth->height = DEFAULT_HEIGHT;
+  synth->batch_size = DEFAULT_BATCH_SIZE;
+  synth->objects_per_frame = DEFAULT_OBJECTS_PER_FRAME;
+  synth->display_meta_per_frame = DEFAULT_DISPLAY_META_PER_FRAME;
+  synth->label_length = DEFAULT_LABEL_LENGTH;
+  synth->mask_size = DEFAULT_MASK_SIZE;
+  synth->num_classes = DEFAULT_NUM_CLASSES;
+  synth->seed = DEFAULT_SEED;
+  synth->pool = NULL;
+  synth->rand = NULL;
+  synth->label = NULL;
+}
+
+static void
+gst_ds_osdcoord_synth_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstDsOsdCoordSynth *synth = GST_DSOSDCOORD_SYNTH (object);
+
+  switch (prop_id) {
+    case PROP_BATCH_SIZE:
+      synth->batch_size = g_value_get_uint (value);
+      break;
+    case PROP_OBJECTS_PER_FRAME:
+      synth->objects_per_frame = g_value_get_uint (value);
+      break;
+    case PROP_DISPLAY_META_PER_FRAME:
+      synth->display_meta_per_frame = g_value_get_uint (value);
+      break;
+    case PROP_LABEL_LENGTH:
+      synth->label_length = g_value_get_uint (value);
+      break;
+    case PROP_MASK_SIZE:
+      synth->mask_size = g_value_get_uint (value);
+      break;
+    case PROP_NUM_CLASSES:
+      synth->num_classes = g_value_get_uint (value);
+      break;
+    case PROP_SEED:
+      synth->seed = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_ds_osdcoord_synth_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstDsOsdCoordSynth *synth = GST_DSOSDCOORD_SYNTH (object);
+
+  switch (prop_id) {
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, synth->batch_size);
+      break;
+    case PROP_OBJECTS_PER_FRAME:
+      g_value_set_uint (value, synth->objects_per_frame);
+      break;
+    case PROP_DISPLAY_META_PER_FRAME:
+      g_value_set_uint (value, synth->display_meta_per_frame);
+      break;
+    case PROP_LABEL_LENGTH:
+      g_value_set_uint (value, synth->label_length);
+      break;
+    case PROP_MASK_SIZE:
+      g_value_set_uint (value, synth->mask_size);
+      break;
+    case PROP_NUM_CLASSES:
+      g_value_set_uint (value, synth->num_classes);
+      break;
+    case PROP_SEED:
+      g_value_set_uint (value, synth->seed);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_SYNTH_H__
+#define __GST_DSOSDCOORD_SYNTH_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstbasetransform.h>
+#include "gstnvdsmeta.h"
+
+G_BEGIN_DECLS
+/* Standard GStreamer boilerplate */
+#define GST_TYPE_DSOSDCOORD_SYNTH \
+  (gst_ds_osdcoord_synth_get_type())
+#define GST_DSOSDCOORD_SYNTH(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_DSOSDCOORD_SYNTH,GstDsOsdCoordSynth))
+#define GST_DSOSDCOORD_SYNTH_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_DSOSDCOORD_SYNTH,GstDsOsdCoordSynthClass))
+#define GST_IS_DSOSDCOORD_SYNTH(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_DSOSDCOORD_SYNTH))
+typedef struct _GstDsOsdCoordSynth GstDsOsdCoordSynth;
+typedef struct _GstDsOsdCoordSynthClass GstDsOsdCoordSynthClass;
+
+/**
+ * Batch metas kept for reuse once the buffers carrying them are freed.
+ * Reference counted so that buffers may outlive the element.
+ */
+typedef struct _GstDsOsdCoordSynthPool
+{
+  gint ref_count;
+  GMutex lock;
+  /** Idle NvDsBatchMeta created for batch_size frames. */
+  GQueue free;
+  guint batch_size;
+  /** Mask shared by all objects, NULL if masks are not generated. */
+  gfloat *mask;
+  guint mask_size;
+  /** Label texts shared by the objects, one after the other in a block of
+      labels_size bytes so the release can tell them from the texts the
+      objects own. NULL if the objects own all of them. */
+  gchar *labels;
+  gsize labels_size;
+  /** Start of each label in labels, by label id. */
+  const gchar **label_texts;
+} GstDsOsdCoordSynthPool;
+
+/**
+ * GstDsOsdCoordSynth element structure. Attaches a synthetic NvDsBatchMeta
+ * to every buffer so dsosdcoord can be run without the DeepStream
+ * inference elements.
+ */
+struct _GstDsOsdCoordSynth
+{
+  /** Should be the first member when extending from GstBaseTransform. */
+  GstBaseTransform parent_instance;
+
+  /** Frame size from the caps, used to place the objects. */
+  gint width;
+  gint height;
+
+  /** Number of frames in each batch. */
+  guint batch_size;
+  /** Number of objects in each frame. */
+  guint objects_per_frame;
+  /** Number of display metas in each frame. */
+  guint display_meta_per_frame;
+  /** Number of characters of each object label. */
+  guint label_length;
+  /** Width and height of the object masks, 0 for no masks. */
+  guint mask_size;
+  /** Number of class ids the objects cycle through. */
+  guint num_classes;
+  /** Seed of the object placement. */
+  guint seed;
+
+  /** Pool of the current run. */
+  GstDsOsdCoordSynthPool *pool;
+  GRand *rand;
+  /** Label text, label_length characters. */
+  gchar *label;
+  guint64 frame_num;
+  guint64 object_id;
+};
+
+/* GStreamer boilerplate. */
+struct _GstDsOsdCoordSynthClass
+{
+  GstBaseTransformClass parent_class;
+};
+
+GType gst_ds_osdcoord_synth_get_type (void);
+
+GstDsOsdCoordSynthPool *gst_ds_osdcoord_synth_pool_new (guint batch_size,
+    guint mask_size);
+
+void gst_ds_osdcoord_synth_pool_unref (GstDsOsdCoordSynthPool * pool);
+
+void gst_ds_osdcoord_synth_pool_set_labels (GstDsOsdCoordSynthPool * pool,
+    const GPtrArray * labels);
+
+NvDsBatchMeta *gst_ds_osdcoord_synth_pool_acquire (
+    GstDsOsdCoordSynthPool * pool);
+
+void gst_ds_osdcoord_synth_pool_attach (GstDsOsdCoordSynthPool * pool,
+    GstBuffer * buf, NvDsBatchMeta * batch_meta);
+
+void gst_ds_osdcoord_synth_color (NvOSD_ColorParams * color, guint class_id);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_SYNTH_H__ */
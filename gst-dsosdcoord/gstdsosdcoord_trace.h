@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_TRACE_H__
+#define __GST_DSOSDCOORD_TRACE_H__
+
+/**
+ * USDT probes of provider "dsosdcoord", built in when DSOSDCOORD_USDT is
+ * defined. A probe site is a single nop plus an ELF note until a tracer
+ * (bpftrace, perf, SystemTap) attaches to it; without DSOSDCOORD_USDT the
+ * macros expand to nothing.
+ *
+ *   buffer__enter (frame_num, buffer)
+ *   buffer__exit (frame_num, duration in ns)
+ *   draw (kind, element count)
+ *   export__object (frame_num, source_id, label)
+ *   draw__list__grow (element size, new capacity)
+ */
+
+#ifdef DSOSDCOORD_USDT
+#include <sys/sdt.h>
+
+#define DSOSDCOORD_TRACE_BUFFER_ENTER(frame_num, buf) \
+    DTRACE_PROBE2 (dsosdcoord, buffer__enter, frame_num, buf)
+#define DSOSDCOORD_TRACE_BUFFER_EXIT(frame_num, duration) \
+    DTRACE_PROBE2 (dsosdcoord, buffer__exit, frame_num, duration)
+#define DSOSDCOORD_TRACE_DRAW(kind, count) \
+    DTRACE_PROBE2 (dsosdcoord, draw, kind, count)
+#define DSOSDCOORD_TRACE_EXPORT_OBJECT(frame_num, source_id, label) \
+    DTRACE_PROBE3 (dsosdcoord, export__object, frame_num, source_id, label)
+#define DSOSDCOORD_TRACE_DRAW_LIST_GROW(elem_size, max) \
+    DTRACE_PROBE2 (dsosdcoord, draw__list__grow, elem_size, max)
+#else
+#define DSOSDCOORD_TRACE_BUFFER_ENTER(frame_num, buf)
+#define DSOSDCOORD_TRACE_BUFFER_EXIT(frame_num, duration)
+#define DSOSDCOORD_TRACE_DRAW(kind, count)
+#define DSOSDCOORD_TRACE_EXPORT_OBJECT(frame_num, source_id, label)
+#define DSOSDCOORD_TRACE_DRAW_LIST_GROW(elem_size, max)
+#endif
+
+#endif /* __GST_DSOSDCOORD_TRACE_H__ */
@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#include <math.h>
+#include "gstdsosdcoord_track.h"
+#include "gstnvdsmeta.h"
+
+/**
+ * State of one tracked object.
+ */
+typedef struct
+{
+  /** Last exported record of the track. Its object_id is the hash key. */
+  GstDsOsdCoordExportRecord record;
+  /** frame_num of the last frame the track was seen in. */
+  guint last_seen;
+} GstDsOsdCoordTrack;
+
+struct _GstDsOsdCoordTracker
+{
+  GstDsOsdCoordTrackConfig config;
+  /** GHashTable of GstDsOsdCoordTrack by object_id for each source id,
+      NULL for sources not seen yet. */
+  GPtrArray *sources;
+  /** Number of tracks of all sources. */
+  guint num_tracks;
+};
+
+GstDsOsdCoordTracker *
+gst_ds_osdcoord_tracker_new (const GstDsOsdCoordTrackConfig * config)
+{
+  GstDsOsdCoordTracker *tracker = g_new0 (GstDsOsdCoordTracker, 1);
+
+  tracker->config = *config;
+  tracker->sources =
+      g_ptr_array_new_with_free_func ((GDestroyNotify) g_hash_table_unref);
+  return tracker;
+}
+
+void
+gst_ds_osdcoord_tracker_free (GstDsOsdCoordTracker * tracker)
+{
+  g_ptr_array_free (tracker->sources, TRUE);
+  g_free (tracker);
+}
+
+static GHashTable *
+gst_ds_osdcoord_tracker_get_source (GstDsOsdCoordTracker * tracker,
+    guint source_id)
+{
+  GHashTable *tracks;
+
+  if (source_id >= tracker->sources->len)
+    g_ptr_array_set_size (tracker->sources, source_id + 1);
+  tracks = g_ptr_array_index (tracker->sources, source_id);
+  if (!tracks) {
+    tracks = g_hash_table_new_full (g_int64_hash, g_int64_equal, NULL,
+        g_free);
+    g_ptr_array_index (tracker->sources, source_id) = tracks;
+  }
+  return tracks;
+}
+
+/**
+ * Whether the box of b moved away from the box of a beyond the thresholds.
+ */
+static gboolean
+gst_ds_osdcoord_tracker_moved (const GstDsOsdCoordTrackConfig * config,
+    const GstDsOsdCoordExportRecord * a, const GstDsOsdCoordExportRecord * b)
+{
+  if (config->move_threshold > 0) {
+    gfloat d = MAX (fabsf (a->left - b->left), fabsf (a->top - b->top));
+
+    d = MAX (d, fabsf (a->left + a->width - b->left - b->width));
+    d = MAX (d, fabsf (a->top + a->height - b->top - b->height));
+    if (d > config->move_threshold)
+      return TRUE;
+  }
+
+  if (config->iou_threshold > 0) {
+    gfloat w = MIN (a->left + a->width, b->left + b->width) -
+        MAX (a->left, b->left);
+    gfloat h = MIN (a->top + a->height, b->top + b->height) -
+        MAX (a->top, b->top);
+    gfloat inter = MAX (w, 0) * MAX (h, 0);
+    gfloat uni = a->width * a->height + b->width * b->height - inter;
+
+    if (uni > 0 && inter / uni < config->iou_threshold)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/**
+ * Keep record as the last exported one of track. Its mask is left out: the
+ * counts are only valid for the buffer the record was built for.
+ */
+static void
+gst_ds_osdcoord_track_set_record (GstDsOsdCoordTrack * track,
+    const GstDsOsdCoordExportRecord * record)
+{
+  track->record = *record;
+  track->record.fields &= ~DSOSDCOORD_EXPORT_FIELD_MASK;
+  track->record.num_mask_counts = 0;
+  track->record.mask_counts = NULL;
+}
+
+/**
+ * Account record in its track. Returns TRUE and sets the event of record if
+ * it is to be exported; untracked objects always are.
+ */
+gboolean
+gst_ds_osdcoord_tracker_update (GstDsOsdCoordTracker * tracker,
+    GstDsOsdCoordExportRecord * record)
+{
+  const GstDsOsdCoordTrackConfig *config = &tracker->config;
+  GHashTable *tracks;
+  GstDsOsdCoordTrack *track;
+
+  record->event = DSOSDCOORD_TRACK_EVENT_NONE;
+  if (record->object_id == UNTRACKED_OBJECT_ID)
+    return TRUE;
+
+  record->flags |= DSOSDCOORD_RECORD_FLAG_HAS_TRACK;
+  tracks = gst_ds_osdcoord_tracker_get_source (tracker, record->source_id);
+  track = g_hash_table_lookup (tracks, &record->object_id);
+  if (!track) {
+    track = g_new (GstDsOsdCoordTrack, 1);
+    record->event = DSOSDCOORD_TRACK_EVENT_APPEAR;
+    gst_ds_osdcoord_track_set_record (track, record);
+    track->last_seen = record->frame_num;
+    g_hash_table_insert (tracks, &track->record.object_id, track);
+    tracker->num_tracks++;
+    return TRUE;
+  }
+
+  track->last_seen = record->frame_num;
+  if (gst_ds_osdcoord_tracker_moved (config, &track->record, record))
+    record->event = DSOSDCOORD_TRACK_EVENT_MOVE;
+  else if (config->keyframe_interval > 0 &&
+      record->frame_num % config->keyframe_interval == 0)
+    record->event = DSOSDCOORD_TRACK_EVENT_KEYFRAME;
+  else
+    return FALSE;
+
+  gst_ds_osdcoord_track_set_record (track, record);
+  return TRUE;
+}
+
+/**
+ * Drop the tracks of source_id not seen for more than grace_frames as of
+ * frame_num and call func with a disappear record for each.
+ */
+void
+gst_ds_osdcoord_tracker_expire (GstDsOsdCoordTracker * tracker,
+    guint source_id, guint frame_num, GstClockTime pts,
+    GstDsOsdCoordTrackFunc func, gpointer user_data)
+{
+  GHashTable *tracks;
+  GHashTableIter iter;
+  GstDsOsdCoordTrack *track;
+
+  if (source_id >= tracker->sources->len)
+    return;
+  tracks = g_ptr_array_index (tracker->sources, source_id);
+  if (!tracks)
+    return;
+
+  g_hash_table_iter_init (&iter, tracks);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & track)) {
+    /* A source that restarted from a lower frame_num keeps its tracks
+       until they are seen again. */
+    if (frame_num < track->last_seen ||
+        frame_num - track->last_seen <= tracker->config.grace_frames)
+      continue;
+    track->record.frame_num = frame_num;
+    track->record.pts = pts;
+    track->record.event = DSOSDCOORD_TRACK_EVENT_DISAPPEAR;
+    func (&track->record, user_data);
+    g_hash_table_iter_remove (&iter);
+    tracker->num_tracks--;
+  }
+}
+
+/**
+ * Bytes allocated for the tracks, not counting hash table overhead.
+ */
+guint64
+gst_ds_osdcoord_tracker_get_memory_usage (GstDsOsdCoordTracker * tracker)
+{
+  return sizeof (*tracker) + (guint64) tracker->num_tracks *
+      sizeof (GstDsOsdCoordTrack);
+}
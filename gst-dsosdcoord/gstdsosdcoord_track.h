@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_TRACK_H__
+#define __GST_DSOSDCOORD_TRACK_H__
+
+#include <gst/gst.h>
+#include "gstdsosdcoord_exporter.h"
+
+G_BEGIN_DECLS
+
+/**
+ * Settings of export-mode=changes, taken from the element properties at
+ * start().
+ */
+typedef struct _GstDsOsdCoordTrackConfig
+{
+  /** Frames a track may be missing before it is reported as gone. */
+  guint grace_frames;
+  /** Distance any edge of the box must move by to be exported again, 0 to
+      ignore. Boxes are compared as exported, so this is in the units of
+      coord-space: pixels, or fractions of the frame when normalized. */
+  gfloat move_threshold;
+  /** The box is exported again when its IoU with the last exported box
+      drops below this, 0 to ignore. */
+  gfloat iou_threshold;
+  /** Export every track of frames whose frame_num is a multiple of this,
+      0 for no keyframes. */
+  guint keyframe_interval;
+} GstDsOsdCoordTrackConfig;
+
+typedef struct _GstDsOsdCoordTracker GstDsOsdCoordTracker;
+
+/** Called with the records of tracks that disappeared. */
+typedef void (*GstDsOsdCoordTrackFunc) (GstDsOsdCoordExportRecord * record,
+    gpointer user_data);
+
+GstDsOsdCoordTracker *gst_ds_osdcoord_tracker_new (
+    const GstDsOsdCoordTrackConfig * config);
+
+void gst_ds_osdcoord_tracker_free (GstDsOsdCoordTracker * tracker);
+
+gboolean gst_ds_osdcoord_tracker_update (GstDsOsdCoordTracker * tracker,
+    GstDsOsdCoordExportRecord * record);
+
+void gst_ds_osdcoord_tracker_expire (GstDsOsdCoordTracker * tracker,
+    guint source_id, guint frame_num, GstClockTime pts,
+    GstDsOsdCoordTrackFunc func, gpointer user_data);
+
+guint64 gst_ds_osdcoord_tracker_get_memory_usage (
+    GstDsOsdCoordTracker * tracker);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_TRACK_H__ */
@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/* For sendmmsg(). */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gstdsosdcoord_uds.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_ds_osdcoord_debug);
+#define GST_CAT_DEFAULT gst_ds_osdcoord_debug
+
+/**
+ * Unix domain datagram publisher. Units of serialized output, each holding
+ * whole records, are packed into datagrams of at most
+ * DSOSDCOORD_UDS_MAX_DATAGRAM bytes and sent with one sendmmsg() per flush
+ * on a non-blocking socket. Datagrams the receiver has no room for, or that
+ * find no receiver, are dropped. Only used from the exporter thread.
+ */
+struct _GstDsOsdCoordUdsWriter
+{
+  int fd;
+  struct sockaddr_un addr;
+  socklen_t addr_len;
+  /** Payload of the pending datagrams, back to back. */
+  GString *buf;
+  /** End offset in buf and number of records of each pending datagram,
+      the last of which is still open. */
+  gsize ends[DSOSDCOORD_UDS_MAX_BATCH];
+  guint records[DSOSDCOORD_UDS_MAX_BATCH];
+  guint num_datagrams;
+  struct mmsghdr msgs[DSOSDCOORD_UDS_MAX_BATCH];
+  struct iovec iovs[DSOSDCOORD_UDS_MAX_BATCH];
+};
+
+/**
+ * Create a socket sending to path. The receiver need not exist yet.
+ */
+GstDsOsdCoordUdsWriter *
+gst_ds_osdcoord_uds_writer_new (const gchar * path, GError ** error)
+{
+  GstDsOsdCoordUdsWriter *writer;
+  gsize len = path ? strlen (path) : 0;
+  int fd;
+
+  if (len == 0 || len >= sizeof (writer->addr.sun_path)) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "Invalid socket path \"%s\"", path ? path : "");
+    return NULL;
+  }
+
+  fd = socket (AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "socket failed: %s", g_strerror (errno));
+    return NULL;
+  }
+
+  writer = g_new0 (GstDsOsdCoordUdsWriter, 1);
+  writer->fd = fd;
+  writer->addr.sun_family = AF_UNIX;
+  memcpy (writer->addr.sun_path, path, len + 1);
+  writer->addr_len = G_STRUCT_OFFSET (struct sockaddr_un, sun_path) + len + 1;
+  writer->buf = g_string_sized_new (DSOSDCOORD_UDS_MAX_DATAGRAM);
+  writer->num_datagrams = 1;
+  return writer;
+}
+
+void
+gst_ds_osdcoord_uds_writer_free (GstDsOsdCoordUdsWriter * writer)
+{
+  if (!writer)
+    return;
+
+  close (writer->fd);
+  g_string_free (writer->buf, TRUE);
+  g_free (writer);
+}
+
+/**
+ * Send the pending datagrams, reporting each to func if not NULL. Returns
+ * the number of records in the datagrams that were dropped.
+ */
+guint
+gst_ds_osdcoord_uds_writer_flush (GstDsOsdCoordUdsWriter * writer,
+    GstDsOsdCoordUdsResultFunc func, gpointer user_data)
+{
+  guint n = writer->num_datagrams, sent = 0, dropped = 0, i;
+  gsize start = 0;
+
+  /* The open datagram is sent only if it has data. */
+  if (writer->ends[n - 1] == (n > 1 ? writer->ends[n - 2] : 0))
+    n--;
+
+  for (i = 0; i < n; i++) {
+    writer->iovs[i].iov_base = writer->buf->str + start;
+    writer->iovs[i].iov_len = writer->ends[i] - start;
+    memset (&writer->msgs[i], 0, sizeof (writer->msgs[i]));
+    writer->msgs[i].msg_hdr.msg_name = &writer->addr;
+    writer->msgs[i].msg_hdr.msg_namelen = writer->addr_len;
+    writer->msgs[i].msg_hdr.msg_iov = &writer->iovs[i];
+    writer->msgs[i].msg_hdr.msg_iovlen = 1;
+    start = writer->ends[i];
+  }
+
+  while (sent < n) {
+    int ret = sendmmsg (writer->fd, writer->msgs + sent, n - sent, 0);
+
+    if (ret > 0) {
+      for (i = sent; func && i < sent + ret; i++)
+        func (writer->records[i], FALSE, user_data);
+      sent += ret;
+    } else if (ret < 0 && errno == EINTR) {
+      continue;
+    } else if (ret < 0 && errno == EMSGSIZE) {
+      /* Only this datagram is too large, go on with the next one. */
+      if (func)
+        func (writer->records[sent], TRUE, user_data);
+      dropped += writer->records[sent++];
+    } else {
+      /* EAGAIN, ENOBUFS: the receiver is slow. ENOENT, ECONNREFUSED: there
+         is no receiver. Either way the rest is dropped. */
+      GST_LOG ("dropping %u datagrams: %s", n - sent, g_strerror (errno));
+      for (; sent < n; sent++) {
+        if (func)
+          func (writer->records[sent], TRUE, user_data);
+        dropped += writer->records[sent];
+      }
+    }
+  }
+
+  g_string_truncate (writer->buf, 0);
+  writer->ends[0] = 0;
+  writer->records[0] = 0;
+  writer->num_datagrams = 1;
+  return dropped;
+}
+
+/**
+ * Queue len bytes holding records whole records. They go into the open
+ * datagram if it has room, otherwise into a new one. Returns FALSE if
+ * DSOSDCOORD_UDS_MAX_BATCH datagrams are pending already, in which case
+ * the writer must be flushed first.
+ */
+gboolean
+gst_ds_osdcoord_uds_writer_append (GstDsOsdCoordUdsWriter * writer,
+    const gchar * data, gsize len, guint records)
+{
+  guint last = writer->num_datagrams - 1;
+  gsize start = last > 0 ? writer->ends[last - 1] : 0;
+
+  if (writer->ends[last] > start &&
+      writer->ends[last] - start + len > DSOSDCOORD_UDS_MAX_DATAGRAM) {
+    if (writer->num_datagrams == DSOSDCOORD_UDS_MAX_BATCH)
+      return FALSE;
+    last = writer->num_datagrams++;
+    writer->ends[last] = writer->ends[last - 1];
+    writer->records[last] = 0;
+  }
+
+  g_string_append_len (writer->buf, data, len);
+  writer->ends[last] += len;
+  writer->records[last] += records;
+  return TRUE;
+}
+
+gboolean
+gst_ds_osdcoord_uds_writer_is_empty (GstDsOsdCoordUdsWriter * writer)
+{
+  return writer->buf->len == 0;
+}
+
+gsize
+gst_ds_osdcoord_uds_writer_get_size (GstDsOsdCoordUdsWriter * writer)
+{
+  return sizeof (*writer) + writer->buf->allocated_len;
+}
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+#ifndef __GST_DSOSDCOORD_UDS_H__
+#define __GST_DSOSDCOORD_UDS_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/** Largest payload of a datagram, unless a single unit is larger. */
+#define DSOSDCOORD_UDS_MAX_DATAGRAM (32 * 1024)
+/** Datagrams sent with one sendmmsg(). */
+#define DSOSDCOORD_UDS_MAX_BATCH 64
+
+typedef struct _GstDsOsdCoordUdsWriter GstDsOsdCoordUdsWriter;
+
+GstDsOsdCoordUdsWriter *gst_ds_osdcoord_uds_writer_new (const gchar * path,
+    GError ** error);
+
+void gst_ds_osdcoord_uds_writer_free (GstDsOsdCoordUdsWriter * writer);
+
+gboolean gst_ds_osdcoord_uds_writer_append (GstDsOsdCoordUdsWriter * writer,
+    const gchar * data, gsize len, guint records);
+
+/**
+ * Called by gst_ds_osdcoord_uds_writer_flush() for each pending datagram in
+ * the order they were queued, with the number of records it holds and
+ * whether it was dropped.
+ */
+typedef void (*GstDsOsdCoordUdsResultFunc) (guint records, gboolean dropped,
+    gpointer user_data);
+
+guint gst_ds_osdcoord_uds_writer_flush (GstDsOsdCoordUdsWriter * writer,
+    GstDsOsdCoordUdsResultFunc func, gpointer user_data);
+
+gboolean gst_ds_osdcoord_uds_writer_is_empty (GstDsOsdCoordUdsWriter * writer);
+
+gsize gst_ds_osdcoord_uds_writer_get_size (GstDsOsdCoordUdsWriter * writer);
+
+G_END_DECLS
+#endif /* __GST_DSOSDCOORD_UDS_H__ */
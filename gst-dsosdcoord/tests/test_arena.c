@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the per-worker scratch arena: alignment, growth within a buffer
+ * and reuse of the grown arena across buffers.
+ */
+
+#include "gstdsosdcoord_arena.h"
+
+/** Sizes of the allocations of one simulated buffer, cycled through. */
+static const gsize sizes[] = { 1, 40, 7, 128, 3, 1000, 16, 15 };
+
+/**
+ * Allocate what a buffer with n allocations takes from the arena, filling
+ * each with its index, and check that none overlaps another. The addresses
+ * are stored in ptrs.
+ */
+static void
+fill_buffer (GstDsOsdCoordArena * arena, guint n, guint8 ** ptrs)
+{
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    gsize size = sizes[i % G_N_ELEMENTS (sizes)];
+
+    ptrs[i] = gst_ds_osdcoord_arena_alloc (arena, size);
+    g_assert_nonnull (ptrs[i]);
+    g_assert_cmpuint (GPOINTER_TO_SIZE (ptrs[i]) % DSOSDCOORD_ARENA_ALIGN, ==,
+        0);
+    memset (ptrs[i], i & 0xff, size);
+  }
+  for (i = 0; i < n; i++) {
+    gsize size = sizes[i % G_N_ELEMENTS (sizes)], j;
+
+    for (j = 0; j < size; j++)
+      g_assert_cmpuint (ptrs[i][j], ==, i & 0xff);
+  }
+}
+
+/**
+ * A buffer larger than the first chunk grows the arena chunk by chunk; the
+ * reset after it folds the chunks into one, and from then on buffers of
+ * the same size allocate nothing and get the same addresses.
+ */
+static void
+test_reuse (void)
+{
+  GstDsOsdCoordArena arena;
+  guint8 *first[64], *ptrs[64];
+  guint8 *data;
+  gsize capacity;
+  guint allocations, i;
+
+  gst_ds_osdcoord_arena_init (&arena, 64);
+  fill_buffer (&arena, 64, first);
+  g_assert_cmpuint (arena.allocations, >, 1);
+  g_assert_nonnull (arena.full);
+  allocations = arena.allocations;
+  capacity = arena.capacity;
+
+  /* The chunks allocated in the buffer plus the one replacing them. */
+  g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), ==,
+      allocations + 1);
+  g_assert_null (arena.full);
+  g_assert_cmpuint (arena.size, ==, capacity);
+  g_assert_cmpuint (arena.capacity, ==, capacity);
+  g_assert_cmpuint (arena.used, ==, 0);
+  data = arena.data;
+
+  for (i = 0; i < 10; i++) {
+    fill_buffer (&arena, 64, ptrs);
+    g_assert_null (arena.full);
+    g_assert_true (arena.data == data);
+    g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), ==, 0);
+    g_assert_cmpuint (arena.capacity, ==, capacity);
+    if (i > 0)
+      g_assert_cmpmem (ptrs, sizeof (ptrs), first, sizeof (ptrs));
+    memcpy (first, ptrs, sizeof (ptrs));
+  }
+
+  /* A smaller buffer fits as well. */
+  fill_buffer (&arena, 8, ptrs);
+  g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), ==, 0);
+  g_assert_true (ptrs[0] == data);
+
+  gst_ds_osdcoord_arena_clear (&arena);
+  g_assert_null (arena.data);
+  g_assert_cmpuint (arena.capacity, ==, 0);
+}
+
+/**
+ * A larger buffer later on grows the settled arena again, after which it
+ * settles at the new size.
+ */
+static void
+test_larger_buffer (void)
+{
+  GstDsOsdCoordArena arena;
+  guint8 *ptrs[256];
+  gsize capacity;
+
+  gst_ds_osdcoord_arena_init (&arena, 4096);
+  fill_buffer (&arena, 16, ptrs);
+  g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), ==, 0);
+  capacity = arena.capacity;
+  g_assert_cmpuint (capacity, ==, 4096);
+
+  fill_buffer (&arena, 256, ptrs);
+  g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), >, 0);
+  g_assert_cmpuint (arena.capacity, >, capacity);
+  capacity = arena.capacity;
+
+  fill_buffer (&arena, 256, ptrs);
+  g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), ==, 0);
+  g_assert_cmpuint (arena.capacity, ==, capacity);
+  gst_ds_osdcoord_arena_clear (&arena);
+}
+
+/**
+ * An allocation larger than the capacity so far gets a chunk of its own
+ * size; the next one that does not fit starts a chunk the size of the
+ * whole capacity, and the reset folds them all into one.
+ */
+static void
+test_large_allocation (void)
+{
+  GstDsOsdCoordArena arena;
+  guint8 *big, *next;
+
+  gst_ds_osdcoord_arena_init (&arena, 32);
+  big = gst_ds_osdcoord_arena_alloc (&arena, 10000);
+  g_assert_cmpuint (arena.size, ==, 10000);
+  g_assert_cmpuint (arena.capacity, ==, 10032);
+  memset (big, 1, 10000);
+
+  next = gst_ds_osdcoord_arena_alloc (&arena, 16);
+  g_assert_cmpuint (arena.allocations, ==, 2);
+  g_assert_cmpuint (arena.size, ==, 10032);
+  g_assert_false (next >= big && next < big + 10000);
+
+  g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), ==, 3);
+  g_assert_cmpuint (arena.size, ==, 20064);
+  g_assert_cmpuint (gst_ds_osdcoord_arena_reset (&arena), ==, 0);
+  gst_ds_osdcoord_arena_clear (&arena);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/arena/reuse", test_reuse);
+  g_test_add_func ("/arena/larger-buffer", test_larger_buffer);
+  g_test_add_func ("/arena/large-allocation", test_large_allocation);
+
+  return g_test_run ();
+}
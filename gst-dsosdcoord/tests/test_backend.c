@@ -0,0 +1,533 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the osd backends that need no GPU: the null backend and the
+ * cpu backend drawing into an RGBA frame in system memory.
+ */
+
+#include "gstdsosdcoord_backend.h"
+#include "nvbufsurface.h"
+
+GST_DEBUG_CATEGORY (gst_ds_osdcoord_debug);
+
+#define WIDTH 32
+#define HEIGHT 24
+/** Rows are padded so drawing past the row end shows in the padding. */
+#define PITCH (WIDTH * 4 + 16)
+#define CANARY 0xaa
+
+static const guint8 red[4] = { 255, 0, 0, 255 };
+static const guint8 green[4] = { 0, 255, 0, 255 };
+static const guint8 clear[4] = { 0, 0, 0, 0 };
+
+typedef struct
+{
+  guint8 data[PITCH * HEIGHT];
+  NvBufSurfaceParams surface;
+  const GstDsOsdCoordBackend *backend;
+  void *ctx;
+} Frame;
+
+static void
+frame_erase (Frame * frame)
+{
+  gint y;
+
+  for (y = 0; y < HEIGHT; y++)
+    memset (frame->data + y * PITCH, 0, WIDTH * 4);
+}
+
+static void
+frame_init (Frame * frame)
+{
+  memset (frame->data, CANARY, sizeof (frame->data));
+  frame_erase (frame);
+  memset (&frame->surface, 0, sizeof (frame->surface));
+  frame->surface.width = WIDTH;
+  frame->surface.height = HEIGHT;
+  frame->surface.pitch = PITCH;
+  frame->surface.mappedAddr.addr[0] = frame->data;
+
+  frame->backend = gst_ds_osdcoord_backend_get (DSOSDCOORD_BACKEND_CPU);
+  frame->ctx = frame->backend->create_context ();
+  frame->backend->set_params (frame->ctx, WIDTH, HEIGHT);
+}
+
+static void
+frame_clear (Frame * frame)
+{
+  gint y;
+
+  frame->backend->destroy_context (frame->ctx);
+  for (y = 0; y < HEIGHT; y++) {
+    const guint8 *pad = frame->data + y * PITCH + WIDTH * 4;
+    gint i;
+
+    for (i = 0; i < PITCH - WIDTH * 4; i++)
+      g_assert_cmphex (pad[i], ==, CANARY);
+  }
+}
+
+static const guint8 *
+frame_pixel (Frame * frame, gint x, gint y)
+{
+  return frame->data + y * PITCH + x * 4;
+}
+
+static void
+assert_pixel (Frame * frame, gint x, gint y, const guint8 * expected)
+{
+  const guint8 *p = frame_pixel (frame, x, y);
+
+  if (memcmp (p, expected, 4) != 0)
+    g_error ("pixel (%d, %d) is %u %u %u %u, expected %u %u %u %u", x, y,
+        p[0], p[1], p[2], p[3], expected[0], expected[1], expected[2],
+        expected[3]);
+}
+
+static void
+set_color (NvOSD_ColorParams * color, const guint8 * rgba)
+{
+  color->red = rgba[0] / 255.0;
+  color->green = rgba[1] / 255.0;
+  color->blue = rgba[2] / 255.0;
+  color->alpha = rgba[3] / 255.0;
+}
+
+static void
+test_get (void)
+{
+  const GstDsOsdCoordBackend *backend;
+
+  backend = gst_ds_osdcoord_backend_get (DSOSDCOORD_BACKEND_NULL);
+  g_assert_nonnull (backend);
+  g_assert_cmpstr (backend->name, ==, "null");
+  g_assert_true (backend->memory & DSOSDCOORD_BACKEND_MEMORY_NVMM);
+  g_assert_true (backend->memory & DSOSDCOORD_BACKEND_MEMORY_SYSTEM);
+
+  backend = gst_ds_osdcoord_backend_get (DSOSDCOORD_BACKEND_CPU);
+  g_assert_nonnull (backend);
+  g_assert_cmpstr (backend->name, ==, "cpu");
+  g_assert_cmpuint (backend->memory, ==, DSOSDCOORD_BACKEND_MEMORY_SYSTEM);
+  g_assert_null (backend->open_device);
+  g_assert_null (backend->set_device);
+
+#ifdef DSOSDCOORD_NO_NVLL
+  g_assert_null (gst_ds_osdcoord_backend_get (DSOSDCOORD_BACKEND_NVLL));
+#endif
+  g_assert_null (gst_ds_osdcoord_backend_get ((GstDsOsdCoordBackendType) 99));
+}
+
+/**
+ * The null backend accepts every command without a surface.
+ */
+static void
+test_null (void)
+{
+  const GstDsOsdCoordBackend *backend =
+      gst_ds_osdcoord_backend_get (DSOSDCOORD_BACKEND_NULL);
+  NvOSD_RectParams rects[3];
+  NvOSD_TextParams texts[2];
+  NvOSD_FrameRectParams rect_params;
+  NvOSD_FrameTextParams text_params;
+  NvOSD_FrameSegmentMaskParams mask_params;
+  NvOSD_FrameLineParams line_params;
+  NvOSD_FrameArrowParams arrow_params;
+  NvOSD_FrameCircleParams circle_params;
+  void *ctx;
+
+  memset (rects, 0, sizeof (rects));
+  memset (texts, 0, sizeof (texts));
+  memset (&rect_params, 0, sizeof (rect_params));
+  memset (&text_params, 0, sizeof (text_params));
+  memset (&mask_params, 0, sizeof (mask_params));
+  memset (&line_params, 0, sizeof (line_params));
+  memset (&arrow_params, 0, sizeof (arrow_params));
+  memset (&circle_params, 0, sizeof (circle_params));
+
+  g_assert_true (backend->can_draw_in_parallel (MODE_CPU));
+  ctx = backend->create_context ();
+  g_assert_nonnull (ctx);
+  g_assert_null (backend->set_params (ctx, WIDTH, HEIGHT));
+
+  rect_params.num_rects = 3;
+  rect_params.rect_params_list = rects;
+  g_assert_cmpint (backend->draw_rectangles (ctx, &rect_params), ==, 0);
+  text_params.num_strings = 2;
+  text_params.text_params_list = texts;
+  g_assert_cmpint (backend->put_text (ctx, &text_params), ==, 0);
+  g_assert_cmpint (backend->draw_segment_masks (ctx, &mask_params), ==, 0);
+  g_assert_cmpint (backend->draw_lines (ctx, &line_params), ==, 0);
+  g_assert_cmpint (backend->draw_arrows (ctx, &arrow_params), ==, 0);
+  g_assert_cmpint (backend->draw_circles (ctx, &circle_params), ==, 0);
+
+  backend->destroy_context (ctx);
+}
+
+/**
+ * A bordered rect with a background: the border strokes are border_width
+ * pixels wide inside the rect and the background fills the rest.
+ */
+static void
+test_cpu_rect (void)
+{
+  NvOSD_FrameRectParams params;
+  NvOSD_RectParams rect;
+  Frame frame;
+  gint x, y;
+
+  frame_init (&frame);
+  memset (&rect, 0, sizeof (rect));
+  rect.left = 4;
+  rect.top = 3;
+  rect.width = 10;
+  rect.height = 8;
+  rect.border_width = 2;
+  set_color (&rect.border_color, red);
+  rect.has_bg_color = 1;
+  set_color (&rect.bg_color, green);
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &frame.surface;
+  params.num_rects = 1;
+  params.rect_params_list = &rect;
+  g_assert_cmpint (frame.backend->draw_rectangles (frame.ctx, &params), ==,
+      0);
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      gboolean inside = x >= 4 && x < 14 && y >= 3 && y < 11;
+      gboolean interior = x >= 6 && x < 12 && y >= 5 && y < 9;
+
+      assert_pixel (&frame, x, y, interior ? green : inside ? red : clear);
+    }
+  }
+  frame_clear (&frame);
+}
+
+/**
+ * Rects reaching past the frame are clipped to it.
+ */
+static void
+test_cpu_clip (void)
+{
+  NvOSD_FrameRectParams params;
+  NvOSD_RectParams rect;
+  Frame frame;
+  gint x, y;
+
+  frame_init (&frame);
+  memset (&rect, 0, sizeof (rect));
+  rect.left = -5;
+  rect.top = -5;
+  rect.width = WIDTH + 10;
+  rect.height = HEIGHT + 10;
+  rect.border_width = 6;
+  set_color (&rect.border_color, red);
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &frame.surface;
+  params.num_rects = 1;
+  params.rect_params_list = &rect;
+  g_assert_cmpint (frame.backend->draw_rectangles (frame.ctx, &params), ==,
+      0);
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      gboolean border = x < 1 || x >= WIDTH - 1 || y < 1 || y >= HEIGHT - 1;
+
+      assert_pixel (&frame, x, y, border ? red : clear);
+    }
+  }
+  frame_clear (&frame);
+}
+
+/**
+ * A 2x2 mask scaled to an 8x8 rect colors the quadrants above the
+ * threshold with the border color.
+ */
+static void
+test_cpu_mask (void)
+{
+  float values[4] = { 0.9f, 0.1f, 0.5f, 0.6f };
+  NvOSD_FrameSegmentMaskParams params;
+  NvOSD_RectParams rect;
+  NvOSD_MaskParams mask;
+  Frame frame;
+  gint x, y;
+
+  frame_init (&frame);
+  memset (&rect, 0, sizeof (rect));
+  rect.left = 8;
+  rect.top = 4;
+  rect.width = 8;
+  rect.height = 8;
+  set_color (&rect.border_color, red);
+  memset (&mask, 0, sizeof (mask));
+  mask.data = values;
+  mask.size = sizeof (values);
+  mask.threshold = 0.5f;
+  mask.width = 2;
+  mask.height = 2;
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &frame.surface;
+  params.num_segments = 1;
+  params.rect_params_list = &rect;
+  params.mask_params_list = &mask;
+  g_assert_cmpint (frame.backend->draw_segment_masks (frame.ctx, &params), ==,
+      0);
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      gboolean on = (x >= 8 && x < 12 && y >= 4 && y < 8) ||
+          (x >= 12 && x < 16 && y >= 8 && y < 12);
+
+      assert_pixel (&frame, x, y, on ? red : clear);
+    }
+  }
+
+  /* A mask smaller than width x height is skipped. */
+  mask.size = sizeof (float) * 3;
+  frame_erase (&frame);
+  g_assert_cmpint (frame.backend->draw_segment_masks (frame.ctx, &params), ==,
+      0);
+  assert_pixel (&frame, 8, 4, clear);
+  frame_clear (&frame);
+}
+
+/**
+ * Random masks, up to wider than one word of the thresholded row, scaled
+ * up and down to rects partly outside the frame color the same pixels as
+ * scaling each pixel back to its mask value.
+ */
+static void
+test_cpu_mask_scaled (void)
+{
+  NvOSD_FrameSegmentMaskParams params;
+  NvOSD_RectParams rect;
+  NvOSD_MaskParams mask;
+  float values[80 * 30];
+  Frame frame;
+  gint n, x, y;
+
+  frame_init (&frame);
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &frame.surface;
+  params.num_segments = 1;
+  params.rect_params_list = &rect;
+  params.mask_params_list = &mask;
+
+  for (n = 0; n < 200; n++) {
+    guint i;
+
+    memset (&rect, 0, sizeof (rect));
+    rect.left = g_test_rand_int_range (-WIDTH, WIDTH);
+    rect.top = g_test_rand_int_range (-HEIGHT, HEIGHT);
+    rect.width = g_test_rand_int_range (1, 2 * WIDTH);
+    rect.height = g_test_rand_int_range (1, 2 * HEIGHT);
+    set_color (&rect.border_color, red);
+    memset (&mask, 0, sizeof (mask));
+    mask.width = g_test_rand_int_range (1, 80);
+    mask.height = g_test_rand_int_range (1, 30);
+    mask.threshold = 0.5f;
+    for (i = 0; i < mask.width * mask.height; i++)
+      values[i] = g_test_rand_double ();
+    mask.data = values;
+    mask.size = sizeof (float) * mask.width * mask.height;
+
+    frame_erase (&frame);
+    g_assert_cmpint (frame.backend->draw_segment_masks (frame.ctx, &params),
+        ==, 0);
+
+    for (y = 0; y < HEIGHT; y++) {
+      for (x = 0; x < WIDTH; x++) {
+        gint dx = x - (gint) rect.left, dy = y - (gint) rect.top;
+        gboolean on = dx >= 0 && dx < (gint) rect.width && dy >= 0 &&
+            dy < (gint) rect.height &&
+            values[dy * mask.height / (gint) rect.height * mask.width +
+            dx * mask.width / (gint) rect.width] > mask.threshold;
+
+        assert_pixel (&frame, x, y, on ? red : clear);
+      }
+    }
+  }
+  frame_clear (&frame);
+}
+
+/**
+ * Text is drawn as its background box, sized from the font size.
+ */
+static void
+test_cpu_text (void)
+{
+  NvOSD_FrameTextParams params;
+  NvOSD_TextParams text;
+  gchar string[] = "abc";
+  Frame frame;
+  gint x, y;
+
+  frame_init (&frame);
+  memset (&text, 0, sizeof (text));
+  text.display_text = string;
+  text.x_offset = 2;
+  text.y_offset = 1;
+  text.font_params.font_size = 10;
+  text.set_bg_clr = 1;
+  set_color (&text.text_bg_clr, green);
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &frame.surface;
+  params.num_strings = 1;
+  params.text_params_list = &text;
+  g_assert_cmpint (frame.backend->put_text (frame.ctx, &params), ==, 0);
+
+  /* 3 characters of 10 * 3 / 5 pixels, 10 * 3 / 2 pixels high. */
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      gboolean box = x >= 2 && x < 20 && y >= 1 && y < 16;
+
+      assert_pixel (&frame, x, y, box ? green : clear);
+    }
+  }
+  frame_clear (&frame);
+}
+
+static void
+test_cpu_line (void)
+{
+  NvOSD_FrameLineParams params;
+  NvOSD_LineParams lines[2];
+  Frame frame;
+  gint x, y;
+
+  frame_init (&frame);
+  memset (lines, 0, sizeof (lines));
+  lines[0].x1 = 2;
+  lines[0].y1 = 5;
+  lines[0].x2 = 9;
+  lines[0].y2 = 5;
+  lines[0].line_width = 1;
+  set_color (&lines[0].line_color, red);
+  /* Vertical, 3 pixels wide and centered on x = 20. */
+  lines[1].x1 = 20;
+  lines[1].y1 = 10;
+  lines[1].x2 = 20;
+  lines[1].y2 = 14;
+  lines[1].line_width = 3;
+  set_color (&lines[1].line_color, green);
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &frame.surface;
+  params.num_lines = 2;
+  params.line_params_list = lines;
+  g_assert_cmpint (frame.backend->draw_lines (frame.ctx, &params), ==, 0);
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      if (y == 5 && x >= 2 && x <= 9)
+        assert_pixel (&frame, x, y, red);
+      else if (x >= 19 && x <= 21 && y >= 9 && y <= 15)
+        assert_pixel (&frame, x, y, green);
+      else
+        assert_pixel (&frame, x, y, clear);
+    }
+  }
+  frame_clear (&frame);
+}
+
+/**
+ * The outline of a circle stays within its radius and is symmetric.
+ */
+static void
+test_cpu_circle (void)
+{
+  NvOSD_FrameCircleParams params;
+  NvOSD_CircleParams circle;
+  Frame frame;
+  gint x, y;
+
+  frame_init (&frame);
+  memset (&circle, 0, sizeof (circle));
+  circle.xc = 12;
+  circle.yc = 11;
+  circle.radius = 6;
+  set_color (&circle.circle_color, red);
+  circle.has_bg_color = 1;
+  set_color (&circle.bg_color, green);
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &frame.surface;
+  params.num_circles = 1;
+  params.circle_params_list = &circle;
+  g_assert_cmpint (frame.backend->draw_circles (frame.ctx, &params), ==, 0);
+
+  assert_pixel (&frame, 12, 11, green);
+  assert_pixel (&frame, 12, 5, red);
+  assert_pixel (&frame, 12, 17, red);
+  assert_pixel (&frame, 6, 11, red);
+  assert_pixel (&frame, 18, 11, red);
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      gint dx = x - 12, dy = y - 11;
+
+      if (dx * dx + dy * dy > 6 * 6)
+        assert_pixel (&frame, x, y, clear);
+      if (x > 24 || y > 22)
+        continue;
+      g_assert_cmpmem (frame_pixel (&frame, x, y), 4,
+          frame_pixel (&frame, 24 - x, y), 4);
+      g_assert_cmpmem (frame_pixel (&frame, x, y), 4,
+          frame_pixel (&frame, x, 22 - y), 4);
+    }
+  }
+  frame_clear (&frame);
+}
+
+/**
+ * The cpu backend refuses surfaces it cannot reach from the CPU.
+ */
+static void
+test_cpu_unmapped (void)
+{
+  NvOSD_FrameRectParams params;
+  NvOSD_RectParams rect;
+  Frame frame;
+
+  frame_init (&frame);
+  memset (&rect, 0, sizeof (rect));
+  memset (&params, 0, sizeof (params));
+  params.num_rects = 1;
+  params.rect_params_list = &rect;
+  g_assert_cmpint (frame.backend->draw_rectangles (frame.ctx, &params), ==,
+      -1);
+  frame.surface.mappedAddr.addr[0] = NULL;
+  params.buf_ptr = &frame.surface;
+  g_assert_cmpint (frame.backend->draw_rectangles (frame.ctx, &params), ==,
+      -1);
+  frame.surface.mappedAddr.addr[0] = frame.data;
+  frame_clear (&frame);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/backend/get", test_get);
+  g_test_add_func ("/backend/null", test_null);
+  g_test_add_func ("/backend/cpu/rect", test_cpu_rect);
+  g_test_add_func ("/backend/cpu/clip", test_cpu_clip);
+  g_test_add_func ("/backend/cpu/mask", test_cpu_mask);
+  g_test_add_func ("/backend/cpu/mask-scaled", test_cpu_mask_scaled);
+  g_test_add_func ("/backend/cpu/text", test_cpu_text);
+  g_test_add_func ("/backend/cpu/line", test_cpu_line);
+  g_test_add_func ("/backend/cpu/circle", test_cpu_circle);
+  g_test_add_func ("/backend/cpu/unmapped", test_cpu_unmapped);
+
+  return g_test_run ();
+}
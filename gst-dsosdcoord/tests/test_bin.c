@@ -0,0 +1,582 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Round trips of the binary format: records encoded by the exporter on the
+ * stdout sink, decoded with the header-only reader of dsosdcoord_bin.h.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include "gstdsosdcoord_exporter.h"
+#include "gstdsosdcoord_labels.h"
+#include "dsosdcoord_bin.h"
+
+GST_DEBUG_CATEGORY (gst_ds_osdcoord_debug);
+
+static const gchar *labels[] = { "person", "car", "bicycle", "dog" };
+static const gchar *colors[] = { "red", "blue", "car" };
+
+#define ROUND_TRIP_FRAMES 50
+
+/**
+ * Output of the exporters created between capture_start() and
+ * capture_stop(): stdout redirected to a temporary file.
+ */
+typedef struct
+{
+  gchar *path;
+  gint fd;
+  gint saved;
+} Capture;
+
+static void
+capture_start (Capture * capture)
+{
+  fflush (stdout);
+  capture->fd = g_file_open_tmp ("dsosdcoord-bin-XXXXXX", &capture->path,
+      NULL);
+  g_assert_cmpint (capture->fd, >=, 0);
+  capture->saved = dup (STDOUT_FILENO);
+  g_assert_cmpint (dup2 (capture->fd, STDOUT_FILENO), ==, STDOUT_FILENO);
+}
+
+static FILE *
+capture_stop (Capture * capture)
+{
+  FILE *file;
+
+  fflush (stdout);
+  dup2 (capture->saved, STDOUT_FILENO);
+  close (capture->saved);
+  close (capture->fd);
+  file = fopen (capture->path, "rb");
+  g_assert_nonnull (file);
+  g_unlink (capture->path);
+  g_free (capture->path);
+  return file;
+}
+
+static GstDsOsdCoordExporter *
+exporter_new (guint fields)
+{
+  GstDsOsdCoordExportConfig config;
+  GstDsOsdCoordExporter *exporter;
+  GError *error = NULL;
+
+  memset (&config, 0, sizeof (config));
+  config.queue_size = 64;
+  config.overflow_policy = DSOSDCOORD_OVERFLOW_BLOCK;
+  config.sink = DSOSDCOORD_EXPORT_SINK_STDOUT;
+  config.format = DSOSDCOORD_EXPORT_FORMAT_BINARY;
+  config.fields = fields;
+  exporter = gst_ds_osdcoord_exporter_new (&config, &error);
+  g_assert_no_error (error);
+  return exporter;
+}
+
+static void
+exporter_finish (GstDsOsdCoordExporter * exporter)
+{
+  gst_ds_osdcoord_exporter_stop (exporter);
+  g_assert_cmpuint (gst_ds_osdcoord_exporter_get_dropped (exporter), ==, 0);
+  gst_ds_osdcoord_exporter_free (exporter);
+}
+
+static void
+push (GstDsOsdCoordExporter * exporter, GstDsOsdCoordExportRecord * src)
+{
+  GstDsOsdCoordExportRecord *record =
+      gst_ds_osdcoord_exporter_reserve (exporter);
+
+  memcpy (record, src, gst_ds_osdcoord_export_record_size (src));
+  gst_ds_osdcoord_exporter_commit (exporter);
+}
+
+static void
+set_label (GstDsOsdCoordExportRecord * record, const gchar * label)
+{
+  record->label_hash = gst_ds_osdcoord_label_copy (record->label, label,
+      sizeof (record->label));
+}
+
+/**
+ * Number of chunks of each type in file, read from the start.
+ */
+static void
+count_chunks (FILE * file, guint counts[DSOSDCOORD_BIN_CHUNK_MASK + 1])
+{
+  DsOsdCoordBinReader reader;
+  DsOsdCoordBinChunk chunk;
+
+  memset (counts, 0, (DSOSDCOORD_BIN_CHUNK_MASK + 1) * sizeof (guint));
+  rewind (file);
+  dsosdcoord_bin_reader_init (&reader, file);
+  while (dsosdcoord_bin_reader_read (&reader, &chunk, sizeof (chunk), 1) > 0) {
+    g_assert_cmpuint (chunk.type, >=, DSOSDCOORD_BIN_CHUNK_STREAM);
+    g_assert_cmpuint (chunk.type, <=, DSOSDCOORD_BIN_CHUNK_MASK);
+    counts[chunk.type]++;
+    g_assert_cmpint (dsosdcoord_bin_reader_skip (&reader, chunk.size), ==, 0);
+  }
+  g_assert_true (feof (file));
+  rewind (file);
+}
+
+/**
+ * Objects of a frame of the round trip: one to five per frame, with
+ * labels and classifier labels repeating across frames.
+ */
+static void
+make_record (GstDsOsdCoordExportRecord * record, guint frame, guint i)
+{
+  guint label = (frame + i) % G_N_ELEMENTS (labels);
+  guint color = (frame * 3 + i) % G_N_ELEMENTS (colors);
+
+  memset (record, 0, sizeof (*record));
+  record->frame_num = frame;
+  record->pts = frame * 40 * GST_MSECOND;
+  record->source_id = frame % 3;
+  record->batch_id = frame % 2;
+  record->flags = DSOSDCOORD_RECORD_FLAG_HAS_SOURCE;
+  if (i % 2 == 0) {
+    record->flags |= DSOSDCOORD_RECORD_FLAG_HAS_TRACK;
+    record->object_id = frame * 10 + i;
+    record->event = DSOSDCOORD_TRACK_EVENT_MOVE;
+  }
+  record->left = frame + 0.25f;
+  record->top = i + 0.5f;
+  record->width = 10.0f + i;
+  record->height = 20.0f + frame;
+  record->class_id = label;
+  set_label (record, labels[label]);
+
+  record->fields = DSOSDCOORD_EXPORT_FIELD_CONFIDENCE |
+      DSOSDCOORD_EXPORT_FIELD_CLASSIFIER;
+  record->confidence = i / 8.0f;
+  record->num_classifier_results = 1;
+  record->classifier_results[0].component_id = 2;
+  record->classifier_results[0].class_id = color;
+  record->classifier_results[0].prob = 0.75f;
+  record->classifier_results[0].label_hash =
+      gst_ds_osdcoord_label_copy (record->classifier_results[0].label,
+      colors[color], DSOSDCOORD_CLASSIFIER_LABEL_SIZE);
+}
+
+/**
+ * Frames come back with their header and objects as exported, labels
+ * resolve through the string table, and each distinct label, including
+ * one used both as object and as classifier label, is sent once.
+ */
+static void
+test_round_trip (void)
+{
+  GstDsOsdCoordExporter *exporter;
+  GstDsOsdCoordExportRecord record;
+  DsOsdCoordBinReader reader;
+  guint counts[DSOSDCOORD_BIN_CHUNK_MASK + 1];
+  Capture capture;
+  FILE *file;
+  guint frame, i;
+
+  capture_start (&capture);
+  exporter = exporter_new (DSOSDCOORD_EXPORT_FIELD_CONFIDENCE |
+      DSOSDCOORD_EXPORT_FIELD_CLASSIFIER);
+  for (frame = 0; frame < ROUND_TRIP_FRAMES; frame++) {
+    for (i = 0; i < frame % 5 + 1; i++) {
+      make_record (&record, frame, i);
+      push (exporter, &record);
+    }
+    gst_ds_osdcoord_exporter_kick (exporter);
+  }
+  exporter_finish (exporter);
+  file = capture_stop (&capture);
+
+  count_chunks (file, counts);
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_STREAM], ==, 1);
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_STRING], ==, 6);
+  /* A pass of the exporter thread may end a frame chunk mid-frame. */
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_FRAME], >=, ROUND_TRIP_FRAMES);
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_MASK], ==, 0);
+
+  dsosdcoord_bin_reader_init (&reader, file);
+  frame = 0;
+  i = 0;
+  while (dsosdcoord_bin_reader_next (&reader) > 0) {
+    guint j;
+
+    g_assert_cmpuint (reader.object_size, ==, sizeof (DsOsdCoordBinObject) +
+        sizeof (DsOsdCoordBinObjectFields));
+    g_assert_cmpuint (reader.frame.frame_num, ==, frame);
+    g_assert_cmpuint (reader.frame.pts, ==, frame * 40 * GST_MSECOND);
+    g_assert_cmpuint (reader.frame.source_id, ==, frame % 3);
+    g_assert_cmpuint (reader.frame.batch_id, ==, frame % 2);
+    g_assert_cmpuint (reader.frame.flags, ==,
+        DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE);
+    g_assert_cmpuint (i + reader.frame.num_objects, <=, frame % 5 + 1);
+
+    for (j = 0; j < reader.frame.num_objects; j++, i++) {
+      const DsOsdCoordBinObject *object = &reader.objects[j];
+      const DsOsdCoordBinObjectFields *fields = &reader.fields[j];
+
+      make_record (&record, frame, i);
+      g_assert_cmpstr (dsosdcoord_bin_reader_label (&reader,
+              object->label_id), ==, record.label);
+      g_assert_cmpint (object->class_id, ==, record.class_id);
+      g_assert_cmpfloat (object->left, ==, record.left);
+      g_assert_cmpfloat (object->top, ==, record.top);
+      g_assert_cmpfloat (object->width, ==, record.width);
+      g_assert_cmpfloat (object->height, ==, record.height);
+      if (i % 2 == 0) {
+        g_assert_true (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK);
+        g_assert_cmpuint (object->object_id, ==, record.object_id);
+        g_assert_cmpuint (object->event, ==, DSOSDCOORD_BIN_EVENT_MOVE);
+      } else {
+        g_assert_false (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK);
+      }
+
+      g_assert_true (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CONFIDENCE);
+      g_assert_true (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASSIFIER);
+      g_assert_false (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_MASK);
+      g_assert_cmpfloat (fields->confidence, ==, record.confidence);
+      g_assert_cmpuint (fields->num_classifier_results, ==, 1);
+      g_assert_cmpuint (fields->classifier_results[0].class_id, ==,
+          record.classifier_results[0].class_id);
+      g_assert_cmpfloat (fields->classifier_results[0].prob, ==, 0.75f);
+      g_assert_cmpstr (dsosdcoord_bin_reader_label (&reader,
+              fields->classifier_results[0].label_id), ==,
+          record.classifier_results[0].label);
+    }
+    if (i == frame % 5 + 1) {
+      frame++;
+      i = 0;
+    }
+  }
+  g_assert_true (feof (file));
+  g_assert_cmpuint (frame, ==, ROUND_TRIP_FRAMES);
+
+  dsosdcoord_bin_reader_clear (&reader);
+  fclose (file);
+}
+
+/**
+ * More distinct labels than the string table holds restart the stream
+ * with an empty table where it fills up; objects on both sides of the
+ * restart resolve to their own labels.
+ */
+static void
+test_table_full (void)
+{
+  const guint num_labels = DSOSDCOORD_BIN_MAX_STRINGS + 100;
+  GstDsOsdCoordExporter *exporter;
+  GstDsOsdCoordExportRecord record;
+  DsOsdCoordBinReader reader;
+  guint counts[DSOSDCOORD_BIN_CHUNK_MASK + 1];
+  Capture capture;
+  gchar label[32];
+  FILE *file;
+  guint n, i;
+
+  capture_start (&capture);
+  exporter = exporter_new (0);
+  memset (&record, 0, sizeof (record));
+  for (n = 0; n < num_labels; n++) {
+    /* Eight objects per frame, so the restart splits a frame. */
+    record.frame_num = n / 8;
+    record.class_id = n;
+    g_snprintf (label, sizeof (label), "label-%u", n);
+    set_label (&record, label);
+    push (exporter, &record);
+    if (n % 8 == 7)
+      gst_ds_osdcoord_exporter_kick (exporter);
+  }
+  exporter_finish (exporter);
+  file = capture_stop (&capture);
+
+  count_chunks (file, counts);
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_STREAM], ==, 2);
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_STRING], ==, num_labels);
+
+  dsosdcoord_bin_reader_init (&reader, file);
+  n = 0;
+  while (dsosdcoord_bin_reader_next (&reader) > 0) {
+    for (i = 0; i < reader.frame.num_objects; i++, n++) {
+      g_assert_cmpint (reader.objects[i].class_id, ==, n);
+      g_assert_cmpuint (reader.frame.frame_num, ==, n / 8);
+      g_snprintf (label, sizeof (label), "label-%u", n);
+      g_assert_cmpstr (dsosdcoord_bin_reader_label (&reader,
+              reader.objects[i].label_id), ==, label);
+    }
+  }
+  g_assert_true (feof (file));
+  g_assert_cmpuint (n, ==, num_labels);
+
+  dsosdcoord_bin_reader_clear (&reader);
+  fclose (file);
+}
+
+/**
+ * A second exporter appending to the output of a first one, as when the
+ * pipeline is restarted, starts a new stream: its labels get ids anew,
+ * in another order, and its records have another object size; the reader
+ * resolves each stream with its own table.
+ */
+static void
+test_restart (void)
+{
+  static const gchar *first[] = { "person", "car" };
+  static const gchar *second[] = { "truck", "car", "person" };
+  GstDsOsdCoordExporter *exporter;
+  GstDsOsdCoordExportRecord record;
+  DsOsdCoordBinReader reader;
+  guint counts[DSOSDCOORD_BIN_CHUNK_MASK + 1];
+  Capture capture;
+  FILE *file;
+  guint n, i;
+
+  capture_start (&capture);
+  exporter = exporter_new (0);
+  memset (&record, 0, sizeof (record));
+  for (i = 0; i < G_N_ELEMENTS (first); i++) {
+    record.frame_num = 1;
+    record.class_id = i;
+    set_label (&record, first[i]);
+    push (exporter, &record);
+  }
+  exporter_finish (exporter);
+
+  exporter = exporter_new (DSOSDCOORD_EXPORT_FIELD_CONFIDENCE);
+  for (i = 0; i < G_N_ELEMENTS (second); i++) {
+    record.frame_num = 1;
+    record.class_id = 10 + i;
+    record.fields = DSOSDCOORD_EXPORT_FIELD_CONFIDENCE;
+    record.confidence = 0.5f;
+    set_label (&record, second[i]);
+    push (exporter, &record);
+  }
+  exporter_finish (exporter);
+  file = capture_stop (&capture);
+
+  count_chunks (file, counts);
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_STREAM], ==, 2);
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_STRING], ==,
+      G_N_ELEMENTS (first) + G_N_ELEMENTS (second));
+  g_assert_cmpuint (counts[DSOSDCOORD_BIN_CHUNK_FRAME], >=, 2);
+
+  dsosdcoord_bin_reader_init (&reader, file);
+  n = 0;
+  while (dsosdcoord_bin_reader_next (&reader) > 0) {
+    for (i = 0; i < reader.frame.num_objects; i++, n++) {
+      const DsOsdCoordBinObject *object = &reader.objects[i];
+      const gchar *label = dsosdcoord_bin_reader_label (&reader,
+          object->label_id);
+
+      if (n < G_N_ELEMENTS (first)) {
+        g_assert_cmpuint (reader.object_size, ==,
+            sizeof (DsOsdCoordBinObject));
+        g_assert_cmpint (object->class_id, ==, n);
+        g_assert_cmpstr (label, ==, first[n]);
+      } else {
+        guint k = n - G_N_ELEMENTS (first);
+
+        g_assert_cmpuint (reader.object_size, ==,
+            sizeof (DsOsdCoordBinObject) + sizeof (DsOsdCoordBinObjectFields));
+        g_assert_cmpint (object->class_id, ==, 10 + k);
+        g_assert_cmpuint (object->label_id, ==, k);
+        g_assert_cmpstr (label, ==, second[k]);
+        g_assert_cmpfloat (reader.fields[i].confidence, ==, 0.5f);
+      }
+    }
+  }
+  g_assert_true (feof (file));
+  g_assert_cmpuint (n, ==, G_N_ELEMENTS (first) + G_N_ELEMENTS (second));
+
+  dsosdcoord_bin_reader_clear (&reader);
+  fclose (file);
+}
+
+/**
+ * Each record selects its own subset of the export-fields of the stream;
+ * the reader gets back the selected fields with their flags, zeros for the
+ * others, and the classifier labels of up to the most results an object
+ * holds.
+ */
+static void
+test_fields (void)
+{
+  const guint all = DSOSDCOORD_EXPORT_FIELD_CONFIDENCE |
+      DSOSDCOORD_EXPORT_FIELD_TRACKER_CONFIDENCE |
+      DSOSDCOORD_EXPORT_FIELD_CLASSIFIER | DSOSDCOORD_EXPORT_FIELD_USER_META;
+  GstDsOsdCoordExporter *exporter;
+  GstDsOsdCoordExportRecord record;
+  DsOsdCoordBinReader reader;
+  Capture capture;
+  FILE *file;
+  guint n, i, j;
+
+  capture_start (&capture);
+  exporter = exporter_new (all);
+  for (n = 0; n <= all; n++) {
+    memset (&record, 0, sizeof (record));
+    record.frame_num = n / 4;
+    record.class_id = n;
+    set_label (&record, labels[n % G_N_ELEMENTS (labels)]);
+    record.fields = n;
+    record.confidence = n / 16.0f;
+    record.tracker_confidence = 1.0f - n / 16.0f;
+    if (n & DSOSDCOORD_EXPORT_FIELD_CLASSIFIER) {
+      record.num_classifier_results = MIN (n / 3 + 1,
+          DSOSDCOORD_MAX_CLASSIFIER_RESULTS);
+      for (j = 0; j < record.num_classifier_results; j++) {
+        GstDsOsdCoordClassifierResult *result = &record.classifier_results[j];
+
+        result->component_id = j + 2;
+        result->class_id = n + j;
+        result->prob = j / 4.0f;
+        result->label_hash = gst_ds_osdcoord_label_copy (result->label,
+            colors[(n + j) % G_N_ELEMENTS (colors)], sizeof (result->label));
+      }
+    }
+    if (n & DSOSDCOORD_EXPORT_FIELD_USER_META) {
+      record.num_user_meta = n % DSOSDCOORD_MAX_USER_META + 1;
+      for (j = 0; j < record.num_user_meta; j++)
+        record.user_meta_types[j] = 4096 + n * 10 + j;
+    }
+    push (exporter, &record);
+  }
+  exporter_finish (exporter);
+  file = capture_stop (&capture);
+
+  dsosdcoord_bin_reader_init (&reader, file);
+  n = 0;
+  while (dsosdcoord_bin_reader_next (&reader) > 0) {
+    g_assert_cmpuint (reader.object_size, ==,
+        sizeof (DsOsdCoordBinObject) + sizeof (DsOsdCoordBinObjectFields));
+    for (i = 0; i < reader.frame.num_objects; i++, n++) {
+      const DsOsdCoordBinObject *object = &reader.objects[i];
+      const DsOsdCoordBinObjectFields *fields = &reader.fields[i];
+
+      g_assert_cmpint (object->class_id, ==, n);
+      g_assert_cmpstr (dsosdcoord_bin_reader_label (&reader,
+              object->label_id), ==, labels[n % G_N_ELEMENTS (labels)]);
+      g_assert_cmpint (!!(object->flags &
+              DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CONFIDENCE), ==,
+          !!(n & DSOSDCOORD_EXPORT_FIELD_CONFIDENCE));
+      g_assert_cmpint (!!(object->flags &
+              DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACKER_CONFIDENCE), ==,
+          !!(n & DSOSDCOORD_EXPORT_FIELD_TRACKER_CONFIDENCE));
+      g_assert_cmpint (!!(object->flags &
+              DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASSIFIER), ==,
+          !!(n & DSOSDCOORD_EXPORT_FIELD_CLASSIFIER));
+      g_assert_cmpint (!!(object->flags &
+              DSOSDCOORD_BIN_OBJECT_FLAG_HAS_USER_META), ==,
+          !!(n & DSOSDCOORD_EXPORT_FIELD_USER_META));
+      g_assert_false (object->flags & DSOSDCOORD_BIN_OBJECT_FLAG_HAS_MASK);
+
+      g_assert_cmpfloat (fields->confidence, ==,
+          (n & DSOSDCOORD_EXPORT_FIELD_CONFIDENCE) ? n / 16.0f : 0.0f);
+      g_assert_cmpfloat (fields->tracker_confidence, ==,
+          (n & DSOSDCOORD_EXPORT_FIELD_TRACKER_CONFIDENCE) ?
+          1.0f - n / 16.0f : 0.0f);
+
+      if (n & DSOSDCOORD_EXPORT_FIELD_CLASSIFIER) {
+        g_assert_cmpuint (fields->num_classifier_results, ==,
+            MIN (n / 3 + 1, DSOSDCOORD_BIN_MAX_CLASSIFIER_RESULTS));
+        for (j = 0; j < fields->num_classifier_results; j++) {
+          const DsOsdCoordBinClassifierResult *result =
+              &fields->classifier_results[j];
+
+          g_assert_cmpint (result->component_id, ==, j + 2);
+          g_assert_cmpuint (result->class_id, ==, n + j);
+          g_assert_cmpfloat (result->prob, ==, j / 4.0f);
+          g_assert_cmpstr (dsosdcoord_bin_reader_label (&reader,
+                  result->label_id), ==,
+              colors[(n + j) % G_N_ELEMENTS (colors)]);
+        }
+      } else {
+        g_assert_cmpuint (fields->num_classifier_results, ==, 0);
+      }
+
+      if (n & DSOSDCOORD_EXPORT_FIELD_USER_META) {
+        g_assert_cmpuint (fields->num_user_meta, ==,
+            n % DSOSDCOORD_BIN_MAX_USER_META + 1);
+        for (j = 0; j < fields->num_user_meta; j++)
+          g_assert_cmpuint (fields->user_meta_types[j], ==, 4096 + n * 10 + j);
+      } else {
+        g_assert_cmpuint (fields->num_user_meta, ==, 0);
+      }
+    }
+  }
+  g_assert_true (feof (file));
+  g_assert_cmpuint (n, ==, all + 1);
+
+  dsosdcoord_bin_reader_clear (&reader);
+  fclose (file);
+}
+
+/**
+ * Elements sharing the stdout sink register with one engine. One with
+ * other export-fields is refused without taking a reference, so once the
+ * registered exporters are freed the sink is closed and the next exporter
+ * may use other settings.
+ */
+static void
+test_shared (void)
+{
+  GstDsOsdCoordExportConfig config;
+  GstDsOsdCoordExporter *first, *second;
+  GError *error = NULL;
+  Capture capture;
+
+  memset (&config, 0, sizeof (config));
+  config.queue_size = 64;
+  config.overflow_policy = DSOSDCOORD_OVERFLOW_BLOCK;
+  config.sink = DSOSDCOORD_EXPORT_SINK_STDOUT;
+  config.format = DSOSDCOORD_EXPORT_FORMAT_BINARY;
+  config.shared = TRUE;
+
+  capture_start (&capture);
+  first = gst_ds_osdcoord_exporter_new (&config, &error);
+  g_assert_no_error (error);
+  second = gst_ds_osdcoord_exporter_new (&config, &error);
+  g_assert_no_error (error);
+
+  config.fields = DSOSDCOORD_EXPORT_FIELD_CONFIDENCE;
+  g_assert_null (gst_ds_osdcoord_exporter_new (&config, &error));
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_EXIST);
+  g_clear_error (&error);
+
+  exporter_finish (first);
+  g_assert_null (gst_ds_osdcoord_exporter_new (&config, &error));
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_EXIST);
+  g_clear_error (&error);
+
+  exporter_finish (second);
+  first = gst_ds_osdcoord_exporter_new (&config, &error);
+  g_assert_no_error (error);
+  exporter_finish (first);
+  fclose (capture_stop (&capture));
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/bin/round-trip", test_round_trip);
+  g_test_add_func ("/bin/table-full", test_table_full);
+  g_test_add_func ("/bin/restart", test_restart);
+  g_test_add_func ("/bin/fields", test_fields);
+  g_test_add_func ("/bin/shared", test_shared);
+
+  return g_test_run ();
+}
@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Pixel-exact comparison of the span blending kernels the CPU supports,
+ * and of the cpu backend using the fastest of them, with the scalar
+ * kernel.
+ */
+
+#include "gstdsosdcoord_backend.h"
+#include "gstdsosdcoord_blend.h"
+#include "nvbufsurface.h"
+
+GST_DEBUG_CATEGORY (gst_ds_osdcoord_debug);
+
+/** Widths cover the scalar tails after whole SIMD blocks of 4 and 8. */
+#define MAX_SPAN 67
+/** Bytes before the span, so rows start at any alignment. */
+#define MAX_OFFSET 31
+
+static void
+fill_random (GRand * rand, guint8 * data, gsize size)
+{
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    data[i] = (guint8) g_rand_int_range (rand, 0, 256);
+}
+
+static void
+check_impl (const GstDsOsdCoordBlendImpl * impl, GRand * rand, guint8 alpha)
+{
+  guint8 expected[MAX_OFFSET + MAX_SPAN * 4 + 16];
+  guint8 actual[MAX_OFFSET + MAX_SPAN * 4 + 16];
+  GstDsOsdCoordBlendColor color;
+  gint n, offset;
+
+  for (n = 0; n <= MAX_SPAN; n++) {
+    for (offset = 0; offset <= MAX_OFFSET; offset += 1 + offset / 4) {
+      gst_ds_osdcoord_blend_color_init (&color,
+          (guint8) g_rand_int_range (rand, 0, 256),
+          (guint8) g_rand_int_range (rand, 0, 256),
+          (guint8) g_rand_int_range (rand, 0, 256), alpha);
+      fill_random (rand, expected, sizeof (expected));
+      memcpy (actual, expected, sizeof (actual));
+
+      gst_ds_osdcoord_blend_span_scalar (expected + offset, n, &color);
+      impl->blend_span (actual + offset, n, &color);
+      if (memcmp (expected, actual, sizeof (expected)) != 0)
+        g_error ("%s differs from scalar for %d pixels at offset %d, "
+            "alpha %u", impl->name, n, offset, alpha);
+    }
+  }
+}
+
+/**
+ * Every kernel matches the scalar one for every span width up to
+ * MAX_SPAN, at every alignment, with fully transparent, fully opaque and
+ * random alpha, and leaves the bytes around the span alone.
+ */
+static void
+test_kernels (void)
+{
+  const GstDsOsdCoordBlendImpl *impls[DSOSDCOORD_BLEND_MAX_IMPLS];
+  guint n = gst_ds_osdcoord_blend_get_impls (impls), i, a;
+  GRand *rand = g_rand_new_with_seed (1);
+
+  g_assert_cmpuint (n, >=, 1);
+  g_assert_true (impls[0]->blend_span == gst_ds_osdcoord_blend_span_scalar);
+  g_assert_true (gst_ds_osdcoord_blend_get_impl () == impls[n - 1]);
+
+  for (i = 0; i < n; i++) {
+    g_test_message ("checking %s", impls[i]->name);
+    check_impl (impls[i], rand, 0);
+    check_impl (impls[i], rand, 255);
+    for (a = 0; a < 8; a++)
+      check_impl (impls[i], rand, (guint8) g_rand_int_range (rand, 1, 255));
+  }
+  g_rand_free (rand);
+}
+
+/**
+ * Alpha 0 leaves pixels unchanged and alpha 255 replaces them.
+ */
+static void
+test_extremes (void)
+{
+  const GstDsOsdCoordBlendImpl *impls[DSOSDCOORD_BLEND_MAX_IMPLS];
+  guint n = gst_ds_osdcoord_blend_get_impls (impls), i, j;
+  GstDsOsdCoordBlendColor color;
+  guint8 pixels[13 * 4], before[13 * 4];
+  GRand *rand = g_rand_new_with_seed (2);
+
+  for (i = 0; i < n; i++) {
+    fill_random (rand, pixels, sizeof (pixels));
+    memcpy (before, pixels, sizeof (pixels));
+    gst_ds_osdcoord_blend_color_init (&color, 10, 20, 30, 0);
+    g_assert_true (gst_ds_osdcoord_blend_color_is_clear (&color));
+    impls[i]->blend_span (pixels, 13, &color);
+    g_assert_cmpmem (pixels, sizeof (pixels), before, sizeof (before));
+
+    gst_ds_osdcoord_blend_color_init (&color, 10, 20, 30, 255);
+    g_assert_false (gst_ds_osdcoord_blend_color_is_clear (&color));
+    impls[i]->blend_span (pixels, 13, &color);
+    for (j = 0; j < 13; j++) {
+      g_assert_cmpuint (pixels[j * 4], ==, 10);
+      g_assert_cmpuint (pixels[j * 4 + 1], ==, 20);
+      g_assert_cmpuint (pixels[j * 4 + 2], ==, 30);
+      g_assert_cmpuint (pixels[j * 4 + 3], ==, 255);
+    }
+  }
+  g_rand_free (rand);
+}
+
+/**
+ * The cpu backend, blending with the fastest kernel, gives the same frame
+ * as blending the same spans with the scalar kernel, for overlapping
+ * translucent rects at odd positions and sizes in a frame with an odd
+ * pitch.
+ */
+static void
+test_cpu_backend (void)
+{
+  const gint width = 45, height = 19, pitch = width * 4 + 3;
+  const GstDsOsdCoordBackend *backend =
+      gst_ds_osdcoord_backend_get (DSOSDCOORD_BACKEND_CPU);
+  guint8 *actual = g_malloc (pitch * height + 1);
+  guint8 *expected = g_malloc (pitch * height + 1);
+  GRand *rand = g_rand_new_with_seed (3);
+  NvOSD_FrameRectParams params;
+  NvBufSurfaceParams surface;
+  NvOSD_RectParams rects[16];
+  gint i, y;
+  void *ctx;
+
+  /* Rows start one byte into the allocation, so none is aligned. */
+  fill_random (rand, actual, pitch * height + 1);
+  memcpy (expected, actual, pitch * height + 1);
+  memset (&surface, 0, sizeof (surface));
+  surface.width = width;
+  surface.height = height;
+  surface.pitch = pitch;
+  surface.mappedAddr.addr[0] = actual + 1;
+
+  memset (rects, 0, sizeof (rects));
+  for (i = 0; i < (gint) G_N_ELEMENTS (rects); i++) {
+    NvOSD_RectParams *rect = &rects[i];
+    guint8 alpha = i == 0 ? 255 : i == 1 ? 0 :
+        (guint8) g_rand_int_range (rand, 1, 255);
+    GstDsOsdCoordBlendColor color;
+    gint x0, y0, x1, y1;
+
+    rect->left = g_rand_int_range (rand, -4, width);
+    rect->top = g_rand_int_range (rand, -4, height);
+    rect->width = g_rand_int_range (rand, 1, width);
+    rect->height = g_rand_int_range (rand, 1, height);
+    rect->has_bg_color = 1;
+    rect->bg_color.red = g_rand_int_range (rand, 0, 256) / 255.0;
+    rect->bg_color.green = g_rand_int_range (rand, 0, 256) / 255.0;
+    rect->bg_color.blue = g_rand_int_range (rand, 0, 256) / 255.0;
+    rect->bg_color.alpha = alpha / 255.0;
+
+    /* The same fill, blended with the scalar kernel. */
+    gst_ds_osdcoord_blend_color_init (&color,
+        (guint8) (rect->bg_color.red * 255.0 + 0.5),
+        (guint8) (rect->bg_color.green * 255.0 + 0.5),
+        (guint8) (rect->bg_color.blue * 255.0 + 0.5), alpha);
+    x0 = MAX ((gint) rect->left, 0);
+    y0 = MAX ((gint) rect->top, 0);
+    x1 = MIN ((gint) (rect->left + rect->width), width);
+    y1 = MIN ((gint) (rect->top + rect->height), height);
+    for (y = y0; y < y1 && x0 < x1 && alpha > 0; y++)
+      gst_ds_osdcoord_blend_span_scalar (expected + 1 + y * pitch + x0 * 4,
+          x1 - x0, &color);
+  }
+
+  ctx = backend->create_context ();
+  backend->set_params (ctx, width, height);
+  memset (&params, 0, sizeof (params));
+  params.buf_ptr = &surface;
+  params.num_rects = G_N_ELEMENTS (rects);
+  params.rect_params_list = rects;
+  g_assert_cmpint (backend->draw_rectangles (ctx, &params), ==, 0);
+  backend->destroy_context (ctx);
+
+  g_assert_cmpmem (actual, pitch * height + 1, expected, pitch * height + 1);
+
+  g_rand_free (rand);
+  g_free (actual);
+  g_free (expected);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/blend/kernels", test_kernels);
+  g_test_add_func ("/blend/extremes", test_extremes);
+  g_test_add_func ("/blend/cpu-backend", test_cpu_backend);
+
+  return g_test_run ();
+}
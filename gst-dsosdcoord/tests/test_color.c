@@ -0,0 +1,222 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the per-class color table parsed from hw-blend-color-attr.
+ */
+
+#include "gstdsosdcoord_color.h"
+
+static GstDsOsdCoordColorTable *
+parse (const gchar * str)
+{
+  GstDsOsdCoordColorTable *table;
+  GError *error = NULL;
+
+  table = gst_ds_osdcoord_color_table_parse (str, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (table);
+  return table;
+}
+
+/**
+ * Check the color of class_id in table.
+ */
+static void
+assert_color (const GstDsOsdCoordColorTable * table, gint class_id,
+    gdouble red, gdouble green, gdouble blue, gdouble alpha)
+{
+  gint index = gst_ds_osdcoord_color_table_lookup (table, class_id);
+  const NvOSD_Color_info *entry;
+
+  g_assert_cmpint (index, >=, 0);
+  g_assert_cmpuint (index, <, table->num_entries);
+  entry = &table->entries[index];
+  g_assert_cmpint (entry->id, ==, class_id);
+  g_assert_cmpfloat (entry->color.red, ==, red);
+  g_assert_cmpfloat (entry->color.green, ==, green);
+  g_assert_cmpfloat (entry->color.blue, ==, blue);
+  g_assert_cmpfloat (entry->color.alpha, ==, alpha);
+}
+
+/**
+ * The table is indexed by class id up to the largest configured one, past
+ * the 20 classes of nvll_osd; other and negative ids have no color.
+ */
+static void
+test_lookup (void)
+{
+  GstDsOsdCoordColorTable *table =
+      parse ("0,0.0,1.0,0.0,0.3: 80 , 1 ,0.5,0.25,0.75 :5,0,0,1,1");
+  gint i;
+
+  g_assert_cmpuint (table->num_entries, ==, 3);
+  g_assert_cmpuint (table->lut_size, ==, 81);
+  assert_color (table, 0, 0, 1, 0, 0.3);
+  assert_color (table, 80, 1, 0.5, 0.25, 0.75);
+  assert_color (table, 5, 0, 0, 1, 1);
+  /* Entries keep the configured order. */
+  g_assert_cmpint (table->entries[1].id, ==, 80);
+  for (i = 1; i < 80; i++) {
+    if (i != 5)
+      g_assert_cmpint (gst_ds_osdcoord_color_table_lookup (table, i), ==, -1);
+  }
+  g_assert_cmpint (gst_ds_osdcoord_color_table_lookup (table, 81), ==, -1);
+  g_assert_cmpint (gst_ds_osdcoord_color_table_lookup (table, -1), ==, -1);
+  g_assert_cmpint (gst_ds_osdcoord_color_table_lookup (table, G_MAXINT), ==,
+      -1);
+  gst_ds_osdcoord_color_table_unref (table);
+
+  table = parse ("65535,1,1,1,1");
+  g_assert_cmpuint (table->lut_size, ==, DSOSDCOORD_MAX_CLASS_ID + 1);
+  assert_color (table, DSOSDCOORD_MAX_CLASS_ID, 1, 1, 1, 1);
+  gst_ds_osdcoord_color_table_unref (table);
+}
+
+/**
+ * An empty string and empty entries, as the trailing ':' of older
+ * versions, configure nothing.
+ */
+static void
+test_empty (void)
+{
+  GstDsOsdCoordColorTable *table = parse ("");
+  gchar *str;
+
+  g_assert_cmpuint (table->num_entries, ==, 0);
+  g_assert_cmpuint (table->lut_size, ==, 0);
+  g_assert_cmpint (gst_ds_osdcoord_color_table_lookup (table, 0), ==, -1);
+  str = gst_ds_osdcoord_color_table_to_string (table);
+  g_assert_cmpstr (str, ==, "");
+  g_free (str);
+  gst_ds_osdcoord_color_table_unref (table);
+
+  table = parse (NULL);
+  g_assert_cmpuint (table->num_entries, ==, 0);
+  gst_ds_osdcoord_color_table_unref (table);
+
+  table = parse (":1,0,0,0,0:: ");
+  g_assert_cmpuint (table->num_entries, ==, 1);
+  assert_color (table, 1, 0, 0, 0, 0);
+  gst_ds_osdcoord_color_table_unref (table);
+}
+
+/**
+ * The last entry of a class listed more than once wins; the earlier ones
+ * stay in entries but are not looked up.
+ */
+static void
+test_duplicates (void)
+{
+  GstDsOsdCoordColorTable *table =
+      parse ("1,1,0,0,1:2,0,1,0,1:1,0,0,1,0.5:1,0.5,0.5,0.5,0.25");
+
+  g_assert_cmpuint (table->num_entries, ==, 4);
+  g_assert_cmpuint (table->lut_size, ==, 3);
+  g_assert_cmpint (gst_ds_osdcoord_color_table_lookup (table, 1), ==, 3);
+  assert_color (table, 1, 0.5, 0.5, 0.5, 0.25);
+  assert_color (table, 2, 0, 1, 0, 1);
+  gst_ds_osdcoord_color_table_unref (table);
+}
+
+/**
+ * An entry without alpha is opaque.
+ */
+static void
+test_alpha_default (void)
+{
+  GstDsOsdCoordColorTable *table = parse ("3,0.5,0.25,1:4,0,0,0,0.1");
+
+  assert_color (table, 3, 0.5, 0.25, 1, DSOSDCOORD_DEFAULT_ALPHA);
+  g_assert_cmpfloat (DSOSDCOORD_DEFAULT_ALPHA, ==, 1.0);
+  assert_color (table, 4, 0, 0, 0, 0.1);
+  gst_ds_osdcoord_color_table_unref (table);
+}
+
+/**
+ * Entries with too few or too many fields, a class id that is not an
+ * integer between 0 and DSOSDCOORD_MAX_CLASS_ID or a component that is not
+ * a number make the whole string invalid.
+ */
+static void
+test_malformed (void)
+{
+  static const gchar *invalid[] = {
+    "1,0,0",
+    "1,0,0,0,0,0",
+    "1",
+    ",0,0,0,0",
+    "x,0,0,0,0",
+    "1x,0,0,0,0",
+    "1.5,0,0,0,0",
+    "-1,0,0,0,0",
+    "65536,0,0,0,0",
+    "99999999999999999999,0,0,0,0",
+    "1,r,0,0,0",
+    "1,0,,0,0",
+    "1,0,0,0,a",
+    "1,0,0,0,0.5x",
+    "0,0,0,0,0:1;0,0,0,0",
+    "0,0,0,0,0:2,0,0",
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (invalid); i++) {
+    GError *error = NULL;
+
+    g_assert_null (gst_ds_osdcoord_color_table_parse (invalid[i], &error));
+    g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+    g_clear_error (&error);
+  }
+  g_assert_null (gst_ds_osdcoord_color_table_parse ("x", NULL));
+}
+
+/**
+ * The serialized table parses back into the same colors.
+ */
+static void
+test_to_string (void)
+{
+  GstDsOsdCoordColorTable *table = parse ("7,0.5,0.25,0.125:2,1,0,0,0.5");
+  GstDsOsdCoordColorTable *copy;
+  gchar *str;
+
+  str = gst_ds_osdcoord_color_table_to_string (table);
+  copy = parse (str);
+  g_assert_cmpuint (copy->num_entries, ==, 2);
+  g_assert_cmpint (copy->entries[0].id, ==, 7);
+  assert_color (copy, 7, 0.5, 0.25, 0.125, 1);
+  assert_color (copy, 2, 1, 0, 0, 0.5);
+  g_free (str);
+  gst_ds_osdcoord_color_table_unref (copy);
+
+  /* A reference keeps the table alive. */
+  gst_ds_osdcoord_color_table_ref (table);
+  gst_ds_osdcoord_color_table_unref (table);
+  assert_color (table, 2, 1, 0, 0, 0.5);
+  gst_ds_osdcoord_color_table_unref (table);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/color/lookup", test_lookup);
+  g_test_add_func ("/color/empty", test_empty);
+  g_test_add_func ("/color/duplicates", test_duplicates);
+  g_test_add_func ("/color/alpha-default", test_alpha_default);
+  g_test_add_func ("/color/malformed", test_malformed);
+  g_test_add_func ("/color/to-string", test_to_string);
+
+  return g_test_run ();
+}
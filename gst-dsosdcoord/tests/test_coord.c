@@ -0,0 +1,252 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the mapping of exported boxes from muxer pixels into the
+ * coord-space, with coord-clamp and coord-format=int.
+ */
+
+#include <math.h>
+#include "gstdsosdcoord_coord.h"
+
+#define WIDTH 1920
+#define HEIGHT 1080
+
+/**
+ * Map one box of a WIDTH x HEIGHT frame and return it in record.
+ */
+static void
+map_box (GstDsOsdCoordExportRecord * record, GstDsOsdCoordCoordSpace space,
+    guint source_width, guint source_height, gboolean clamp, gboolean round,
+    gfloat left, gfloat top, gfloat width, gfloat height)
+{
+  GstDsOsdCoordTransform transform;
+  GstDsOsdCoordArena arena;
+
+  memset (record, 0, sizeof (*record));
+  record->left = left;
+  record->top = top;
+  record->width = width;
+  record->height = height;
+
+  gst_ds_osdcoord_arena_init (&arena, 64);
+  gst_ds_osdcoord_transform_init (&transform, space, WIDTH, HEIGHT,
+      source_width, source_height, clamp, round);
+  gst_ds_osdcoord_transform_records (&arena, record, 1, &transform);
+  gst_ds_osdcoord_arena_clear (&arena);
+}
+
+static void
+assert_box (const GstDsOsdCoordExportRecord * record, gfloat left,
+    gfloat top, gfloat width, gfloat height)
+{
+  g_assert_cmpfloat_with_epsilon (record->left, left, 1e-5);
+  g_assert_cmpfloat_with_epsilon (record->top, top, 1e-5);
+  g_assert_cmpfloat_with_epsilon (record->width, width, 1e-5);
+  g_assert_cmpfloat_with_epsilon (record->height, height, 1e-5);
+}
+
+/**
+ * Only a mapping that changes something is reported as needed; a frame of
+ * unknown size is only rounded.
+ */
+static void
+test_init (void)
+{
+  GstDsOsdCoordTransform transform;
+
+  g_assert_false (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_MUXER, WIDTH, HEIGHT, 0, 0, FALSE, FALSE));
+  g_assert_true (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_MUXER, WIDTH, HEIGHT, 0, 0, TRUE, FALSE));
+  g_assert_true (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_NORMALIZED, WIDTH, HEIGHT, 0, 0, FALSE,
+          FALSE));
+
+  /* Source pixels fall back to muxer pixels without the source size, and
+   * are the muxer pixels when the sizes match. */
+  g_assert_false (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_SOURCE, WIDTH, HEIGHT, 0, 0, FALSE, FALSE));
+  g_assert_false (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_SOURCE, WIDTH, HEIGHT, WIDTH, HEIGHT, FALSE,
+          FALSE));
+  g_assert_true (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_SOURCE, WIDTH, HEIGHT, 1280, 720, FALSE,
+          FALSE));
+
+  g_assert_false (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_NORMALIZED, 0, 0, 0, 0, TRUE, FALSE));
+  g_assert_true (gst_ds_osdcoord_transform_init (&transform,
+          DSOSDCOORD_COORD_SPACE_NORMALIZED, 0, 0, 0, 0, FALSE, TRUE));
+  g_assert_cmpfloat (transform.scale_x, ==, 1);
+  g_assert_cmpfloat (transform.scale_y, ==, 1);
+}
+
+/**
+ * Normalized boxes are fractions of the frame, clamped to [0, 1].
+ */
+static void
+test_normalized (void)
+{
+  GstDsOsdCoordExportRecord record;
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_NORMALIZED, 0, 0, FALSE, FALSE,
+      480, 270, 960, 540);
+  assert_box (&record, 0.25, 0.25, 0.5, 0.5);
+
+  /* Unclamped, a box past the frame edges goes out of [0, 1]. */
+  map_box (&record, DSOSDCOORD_COORD_SPACE_NORMALIZED, 0, 0, FALSE, FALSE,
+      -192, 540, 384, 1080);
+  assert_box (&record, -0.1, 0.5, 0.2, 1);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_NORMALIZED, 0, 0, TRUE, FALSE,
+      -192, 540, 384, 1080);
+  assert_box (&record, 0, 0.5, 0.1, 0.5);
+}
+
+/**
+ * Source boxes are scaled to the source_width x source_height of the frame
+ * meta and clamped to it.
+ */
+static void
+test_source (void)
+{
+  GstDsOsdCoordExportRecord record;
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_SOURCE, 1280, 720, FALSE, FALSE,
+      300, 150, 600, 300);
+  assert_box (&record, 200, 100, 400, 200);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_SOURCE, 1280, 720, TRUE, FALSE,
+      1800, 1000, 300, 150);
+  assert_box (&record, 1200, 2000.0f / 3, 80, 720 - 2000.0f / 3);
+
+  /* Without the source size the box stays in muxer pixels. */
+  map_box (&record, DSOSDCOORD_COORD_SPACE_SOURCE, 0, 0, FALSE, FALSE,
+      300, 150, 600, 300);
+  assert_box (&record, 300, 150, 600, 300);
+}
+
+/**
+ * Clamping muxer pixels cuts boxes at all four frame edges; a box wholly
+ * outside collapses onto the edge.
+ */
+static void
+test_clamp (void)
+{
+  GstDsOsdCoordExportRecord record;
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, TRUE, FALSE,
+      -10, -20, 100, 100);
+  assert_box (&record, 0, 0, 90, 80);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, TRUE, FALSE,
+      1900, 1000, 100, 100);
+  assert_box (&record, 1900, 1000, 20, 80);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, TRUE, FALSE,
+      -10, -10, WIDTH + 20, HEIGHT + 20);
+  assert_box (&record, 0, 0, WIDTH, HEIGHT);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, TRUE, FALSE,
+      2000, -200, 50, 50);
+  assert_box (&record, WIDTH, 0, 0, 0);
+
+  /* A box inside the frame is kept as it is. */
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, TRUE, FALSE,
+      0, 0, WIDTH, HEIGHT);
+  assert_box (&record, 0, 0, WIDTH, HEIGHT);
+}
+
+/**
+ * In int mode the corners are rounded to the nearest integer, halves to
+ * even, and the size is the difference of the rounded corners; rounding
+ * comes after clamping, so clamped corners stay on the edge.
+ */
+static void
+test_int (void)
+{
+  GstDsOsdCoordExportRecord record;
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, FALSE, TRUE,
+      10.4, 20.6, 30.4, 40.4);
+  assert_box (&record, 10, 21, 31, 40);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, FALSE, TRUE,
+      2.5, 3.5, 1, 1);
+  assert_box (&record, 2, 4, 2, 0);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, FALSE, TRUE,
+      -1.6, -0.4, 1, 1);
+  assert_box (&record, -2, 0, 1, 1);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_SOURCE, 1280, 720, TRUE, TRUE,
+      -5, 1000, 100, 100);
+  assert_box (&record, 0, 667, 63, 53);
+
+  map_box (&record, DSOSDCOORD_COORD_SPACE_MUXER, 0, 0, TRUE, TRUE,
+      1919.7, 1079.6, 5, 5);
+  assert_box (&record, WIDTH, HEIGHT, 0, 0);
+}
+
+/**
+ * Every record of a frame is mapped, whatever the vector width of the
+ * loops.
+ */
+static void
+test_many (void)
+{
+  GstDsOsdCoordExportRecord records[37];
+  GstDsOsdCoordTransform transform;
+  GstDsOsdCoordArena arena;
+  guint i;
+
+  memset (records, 0, sizeof (records));
+  for (i = 0; i < G_N_ELEMENTS (records); i++) {
+    records[i].left = i * 60.0f - 100;
+    records[i].top = i * 30.0f;
+    records[i].width = 200;
+    records[i].height = 100;
+  }
+
+  gst_ds_osdcoord_arena_init (&arena, 64);
+  gst_ds_osdcoord_transform_init (&transform,
+      DSOSDCOORD_COORD_SPACE_SOURCE, WIDTH, HEIGHT, WIDTH / 2, HEIGHT / 2,
+      TRUE, TRUE);
+  gst_ds_osdcoord_transform_records (&arena, records, G_N_ELEMENTS (records),
+      &transform);
+  gst_ds_osdcoord_arena_clear (&arena);
+
+  for (i = 0; i < G_N_ELEMENTS (records); i++) {
+    gfloat x0 = CLAMP (rintf ((i * 60.0f - 100) / 2), 0, WIDTH / 2);
+    gfloat x1 = CLAMP (rintf ((i * 60.0f + 100) / 2), 0, WIDTH / 2);
+    gfloat y0 = CLAMP (rintf (i * 15.0f), 0, HEIGHT / 2);
+    gfloat y1 = CLAMP (rintf (i * 15.0f + 50), 0, HEIGHT / 2);
+
+    assert_box (&records[i], x0, y0, x1 - x0, y1 - y0);
+  }
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/coord/init", test_init);
+  g_test_add_func ("/coord/normalized", test_normalized);
+  g_test_add_func ("/coord/source", test_source);
+  g_test_add_func ("/coord/clamp", test_clamp);
+  g_test_add_func ("/coord/int", test_int);
+  g_test_add_func ("/coord/many", test_many);
+
+  return g_test_run ();
+}
@@ -0,0 +1,355 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the export filter: class bitsets, confidence and area bounds,
+ * and the rasterized ROI polygons.
+ */
+
+#include <string.h>
+#include "gstdsosdcoord_filter.h"
+#include "gstdsosdcoord_color.h"
+
+/**
+ * Compile a filter from the given settings, which must be valid; the
+ * confidence and area bounds are off.
+ */
+static GstDsOsdCoordFilter *
+filter_new (const gchar * class_ids, const gchar * exclude_class_ids,
+    const gchar * roi)
+{
+  GstDsOsdCoordFilterConfig config;
+  GstDsOsdCoordFilter *filter;
+  GError *error = NULL;
+
+  memset (&config, 0, sizeof (config));
+  config.class_ids = (gchar *) class_ids;
+  config.exclude_class_ids = (gchar *) exclude_class_ids;
+  config.roi = (gchar *) roi;
+  config.min_confidence = -1.0f;
+  filter = gst_ds_osdcoord_filter_new (&config, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (filter);
+  return filter;
+}
+
+/**
+ * Check that compiling config fails with G_FILE_ERROR_INVAL.
+ */
+static void
+assert_invalid (const GstDsOsdCoordFilterConfig * config)
+{
+  GError *error = NULL;
+
+  g_assert_null (gst_ds_osdcoord_filter_new (config, &error));
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+  g_clear_error (&error);
+}
+
+static void
+assert_invalid_roi (const gchar * roi)
+{
+  GstDsOsdCoordFilterConfig config;
+
+  memset (&config, 0, sizeof (config));
+  config.min_confidence = -1.0f;
+  config.roi = (gchar *) roi;
+  assert_invalid (&config);
+}
+
+/**
+ * Whether an object of class_id with the given confidence and box of a
+ * frame of source_id passes the filter.
+ */
+static gboolean
+accept (const GstDsOsdCoordFilter * filter, gint class_id, gfloat confidence,
+    gfloat left, gfloat top, gfloat width, gfloat height, guint source_id)
+{
+  NvDsObjectMeta object_meta;
+
+  memset (&object_meta, 0, sizeof (object_meta));
+  object_meta.class_id = class_id;
+  object_meta.confidence = confidence;
+  object_meta.rect_params.left = left;
+  object_meta.rect_params.top = top;
+  object_meta.rect_params.width = width;
+  object_meta.rect_params.height = height;
+  return gst_ds_osdcoord_filter_accept (filter, &object_meta, source_id);
+}
+
+static gboolean
+accept_class (const GstDsOsdCoordFilter * filter, gint class_id)
+{
+  return accept (filter, class_id, 1.0f, 0, 0, 10, 10, 0);
+}
+
+/**
+ * Default settings filter nothing out, and an empty list is no list.
+ */
+static void
+test_pass_all (void)
+{
+  GstDsOsdCoordFilter *filter = filter_new (NULL, " ; ", "");
+
+  g_assert_true (filter->pass_all);
+  g_assert_null (filter->allow);
+  g_assert_null (filter->deny);
+  g_assert_null (filter->rois);
+  g_assert_true (accept_class (filter, -1));
+  g_assert_true (accept_class (filter, G_MAXINT));
+  gst_ds_osdcoord_filter_unref (filter);
+}
+
+/**
+ * class-ids covers the listed ids only: ids past the largest one and
+ * negative ids, which wrap to huge unsigned values, are not exported.
+ * exclude-class-ids wins over class-ids, and ids past it are not denied.
+ */
+static void
+test_classes (void)
+{
+  GstDsOsdCoordFilter *filter = filter_new (" 1 ;3,, 40", "3;64", NULL);
+
+  g_assert_false (filter->pass_all);
+  g_assert_cmpuint (filter->allow_size, ==, 41);
+  g_assert_cmpuint (filter->deny_size, ==, 65);
+  g_assert_false (accept_class (filter, 0));
+  g_assert_true (accept_class (filter, 1));
+  g_assert_false (accept_class (filter, 2));
+  g_assert_false (accept_class (filter, 3));
+  g_assert_true (accept_class (filter, 40));
+  g_assert_false (accept_class (filter, 41));
+  g_assert_false (accept_class (filter, 1000));
+  g_assert_false (accept_class (filter, -1));
+  gst_ds_osdcoord_filter_unref (filter);
+
+  filter = filter_new (NULL, "0;31;32", NULL);
+  g_assert_false (accept_class (filter, 0));
+  g_assert_true (accept_class (filter, 1));
+  g_assert_false (accept_class (filter, 31));
+  g_assert_false (accept_class (filter, 32));
+  g_assert_true (accept_class (filter, 33));
+  g_assert_true (accept_class (filter, DSOSDCOORD_MAX_CLASS_ID));
+  g_assert_true (accept_class (filter, -1));
+  gst_ds_osdcoord_filter_unref (filter);
+
+  filter = filter_new ("65535", NULL, NULL);
+  g_assert_true (accept_class (filter, DSOSDCOORD_MAX_CLASS_ID));
+  g_assert_false (accept_class (filter, DSOSDCOORD_MAX_CLASS_ID + 1));
+  gst_ds_osdcoord_filter_unref (filter);
+}
+
+/**
+ * Ids that are not integers between 0 and DSOSDCOORD_MAX_CLASS_ID are
+ * rejected in both lists.
+ */
+static void
+test_invalid_classes (void)
+{
+  static const gchar *invalid[] = { "1;x", "-1", "1.5", "2 3", "65536",
+    "99999999999999999999"
+  };
+  GstDsOsdCoordFilterConfig config;
+  guint i;
+
+  memset (&config, 0, sizeof (config));
+  config.min_confidence = -1.0f;
+  for (i = 0; i < G_N_ELEMENTS (invalid); i++) {
+    config.class_ids = (gchar *) invalid[i];
+    config.exclude_class_ids = NULL;
+    assert_invalid (&config);
+    config.class_ids = NULL;
+    config.exclude_class_ids = (gchar *) invalid[i];
+    assert_invalid (&config);
+  }
+}
+
+/**
+ * min-confidence and the area bounds are inclusive; a max-area of 0 is no
+ * bound.
+ */
+static void
+test_confidence_area (void)
+{
+  GstDsOsdCoordFilterConfig config;
+  GstDsOsdCoordFilter *filter;
+
+  memset (&config, 0, sizeof (config));
+  config.min_confidence = 0.5f;
+  config.min_area = 100;
+  config.max_area = 400;
+  filter = gst_ds_osdcoord_filter_new (&config, NULL);
+  g_assert_false (filter->pass_all);
+
+  g_assert_false (accept (filter, 0, 0.49f, 0, 0, 10, 10, 0));
+  g_assert_true (accept (filter, 0, 0.5f, 0, 0, 10, 10, 0));
+  g_assert_false (accept (filter, 0, 1.0f, 0, 0, 10, 9.9f, 0));
+  g_assert_true (accept (filter, 0, 1.0f, 0, 0, 20, 20, 0));
+  g_assert_false (accept (filter, 0, 1.0f, 0, 0, 20, 20.1f, 0));
+  gst_ds_osdcoord_filter_unref (filter);
+
+  config.min_confidence = -1.0f;
+  config.max_area = 0;
+  filter = gst_ds_osdcoord_filter_new (&config, NULL);
+  g_assert_false (filter->pass_all);
+  g_assert_true (accept (filter, 0, -0.5f, 0, 0, 10000, 10000, 0));
+  g_assert_false (accept (filter, 0, -0.5f, 0, 0, 1, 1, 0));
+  gst_ds_osdcoord_filter_unref (filter);
+}
+
+/**
+ * In a U shaped polygon, the notch between the legs is outside even though
+ * it is inside the bounding box of the polygon.
+ */
+static void
+test_roi_concave (void)
+{
+  GstDsOsdCoordFilter *filter =
+      filter_new (NULL, NULL, "0:0,0,40,0,40,40,28,40,28,12,12,12,12,40,0,40");
+
+  g_assert_cmpuint (filter->num_rois, ==, 1);
+  g_assert_cmpuint (filter->rois[0]->cols, ==, 10);
+  g_assert_cmpuint (filter->rois[0]->rows, ==, 10);
+
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 0, 6, 30));
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 0, 34, 30));
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 0, 20, 6));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 0, 20, 30));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 0, 14.5f, 20));
+
+  /* The box center decides, not the box. */
+  g_assert_true (accept (filter, 0, 1.0f, 0, 20, 12, 20, 0));
+  g_assert_false (accept (filter, 0, 1.0f, 10, 20, 20, 20, 0));
+  gst_ds_osdcoord_filter_unref (filter);
+}
+
+/**
+ * The grid ends at the largest vertex: points on the right and bottom edge
+ * of the bounding box fall outside the last cell, as do points left of or
+ * above the grid.
+ */
+static void
+test_roi_edge (void)
+{
+  GstDsOsdCoordFilter *filter =
+      filter_new (NULL, NULL, "0:8,8,24,8,24,24,8,24");
+  const GstDsOsdCoordRoiGrid *grid;
+
+  grid = filter->rois[0];
+  g_assert_cmpfloat (grid->x, ==, 8);
+  g_assert_cmpfloat (grid->y, ==, 8);
+  g_assert_cmpuint (grid->cols, ==, 4);
+  g_assert_cmpuint (grid->rows, ==, 4);
+
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 0, 8, 8));
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 0, 23.9f, 23.9f));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 0, 24, 16));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 0, 16, 24));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 0, 7.9f, 16));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 0, 16, 7.9f));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 0, -100, -100));
+  gst_ds_osdcoord_filter_unref (filter);
+
+  /* A polygon with no area still gets one cell. */
+  filter = filter_new (NULL, NULL, "0:5,5,5,5,5,5");
+  g_assert_cmpuint (filter->rois[0]->cols, ==, 1);
+  g_assert_cmpuint (filter->rois[0]->rows, ==, 1);
+  gst_ds_osdcoord_filter_unref (filter);
+}
+
+/**
+ * Polygons of the same source are merged; sources without ROI, listed or
+ * past the last one, accept every point.
+ */
+static void
+test_roi_sources (void)
+{
+  GstDsOsdCoordFilter *filter = filter_new (NULL, NULL,
+      "2:0,0,8,0,8,8,0,8; 2:32,32,40,32,40,40,32,40");
+
+  g_assert_cmpuint (filter->num_rois, ==, 3);
+  g_assert_null (filter->rois[0]);
+  g_assert_null (filter->rois[1]);
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 2, 4, 4));
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 2, 36, 36));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter, 2, 20, 20));
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 0, 20, 20));
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, 3, 20, 20));
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter, G_MAXUINT, 20, 20));
+  gst_ds_osdcoord_filter_unref (filter);
+}
+
+/**
+ * Coordinates are limited to DSOSDCOORD_MAX_ROI_COORD, which bounds the
+ * grid, and source ids to DSOSDCOORD_MAX_SOURCE_ID.
+ */
+static void
+test_roi_limits (void)
+{
+  GstDsOsdCoordFilter *filter = filter_new (NULL, NULL,
+      "1023:0,0,16384,0,16384,16384");
+  const GstDsOsdCoordRoiGrid *grid;
+
+  g_assert_cmpuint (filter->num_rois, ==, DSOSDCOORD_MAX_SOURCE_ID + 1);
+  grid = filter->rois[DSOSDCOORD_MAX_SOURCE_ID];
+  g_assert_cmpuint (grid->cols, ==,
+      DSOSDCOORD_MAX_ROI_COORD / DSOSDCOORD_ROI_CELL_SIZE);
+  g_assert_cmpuint (grid->rows, ==,
+      DSOSDCOORD_MAX_ROI_COORD / DSOSDCOORD_ROI_CELL_SIZE);
+  g_assert_true (gst_ds_osdcoord_filter_in_roi (filter,
+          DSOSDCOORD_MAX_SOURCE_ID, 16383, 1));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter,
+          DSOSDCOORD_MAX_SOURCE_ID, 1, 16383));
+  g_assert_false (gst_ds_osdcoord_filter_in_roi (filter,
+          DSOSDCOORD_MAX_SOURCE_ID, 16384, 1));
+  gst_ds_osdcoord_filter_unref (filter);
+
+  assert_invalid_roi ("0:0,0,16384.5,0,0,10");
+  assert_invalid_roi ("0:0,0,1e9,0,0,10");
+  assert_invalid_roi ("0:0,0,-1,0,0,10");
+  assert_invalid_roi ("0:0,0,nan,0,0,10");
+  assert_invalid_roi ("0:0,0,inf,0,0,10");
+  assert_invalid_roi ("1024:0,0,10,0,0,10");
+  assert_invalid_roi ("-1:0,0,10,0,0,10");
+}
+
+/**
+ * Entries need a source id and at least three complete points.
+ */
+static void
+test_roi_malformed (void)
+{
+  assert_invalid_roi ("0,0,10,0,0,10");
+  assert_invalid_roi (":0,0,10,0,0,10");
+  assert_invalid_roi ("0:0,0,10,0");
+  assert_invalid_roi ("0:0,0,10,0,0");
+  assert_invalid_roi ("0:0,0,10,0,0,x");
+  assert_invalid_roi ("0:0,0,10,0,0,10;1:");
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/filter/pass-all", test_pass_all);
+  g_test_add_func ("/filter/classes", test_classes);
+  g_test_add_func ("/filter/invalid-classes", test_invalid_classes);
+  g_test_add_func ("/filter/confidence-area", test_confidence_area);
+  g_test_add_func ("/filter/roi/concave", test_roi_concave);
+  g_test_add_func ("/filter/roi/edge", test_roi_edge);
+  g_test_add_func ("/filter/roi/sources", test_roi_sources);
+  g_test_add_func ("/filter/roi/limits", test_roi_limits);
+  g_test_add_func ("/filter/roi/malformed", test_roi_malformed);
+
+  return g_test_run ();
+}
@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the label string table of the binary format: ids, lookups under
+ * hash collisions, growth, the label limit and reuse after a reset.
+ */
+
+#include "gstdsosdcoord_labels.h"
+
+#define NUM_LABELS 1000
+
+/**
+ * Intern label i of a test, with its real hash or, if hash is not NULL,
+ * with *hash; returns the id and checks *added against expect_added.
+ */
+static guint32
+intern (GstDsOsdCoordLabels * labels, guint i, const guint32 * hash,
+    gboolean expect_added)
+{
+  gchar label[32], copy[32];
+  guint32 real;
+  gboolean added;
+  guint32 id;
+
+  g_snprintf (label, sizeof (label), "label-%u", i);
+  real = gst_ds_osdcoord_label_copy (copy, label, sizeof (copy));
+  id = gst_ds_osdcoord_labels_intern (labels, copy, hash ? *hash : real,
+      &added);
+  g_assert_cmpint (added, ==, expect_added);
+  return id;
+}
+
+/**
+ * Labels get ids in the order they are added, through the growth of the
+ * table, and are found again without being added twice.
+ */
+static void
+test_intern (void)
+{
+  GstDsOsdCoordLabels *labels = gst_ds_osdcoord_labels_new (NUM_LABELS);
+  gsize usage;
+  guint i;
+
+  for (i = 0; i < NUM_LABELS; i++)
+    g_assert_cmpuint (intern (labels, i, NULL, TRUE), ==, i);
+  usage = gst_ds_osdcoord_labels_get_memory_usage (labels);
+  for (i = 0; i < NUM_LABELS; i++)
+    g_assert_cmpuint (intern (labels, NUM_LABELS - 1 - i, NULL, FALSE), ==,
+        NUM_LABELS - 1 - i);
+  g_assert_cmpuint (gst_ds_osdcoord_labels_get_memory_usage (labels), ==,
+      usage);
+  gst_ds_osdcoord_labels_free (labels);
+}
+
+/**
+ * Different labels with the same hash, and hashes landing on the same
+ * slot, get ids of their own and are told apart by their strings, before
+ * and after the table grows.
+ */
+static void
+test_collisions (void)
+{
+  GstDsOsdCoordLabels *labels = gst_ds_osdcoord_labels_new (NUM_LABELS);
+  const guint32 same = 0x12345678;
+  guint i;
+
+  for (i = 0; i < 20; i++)
+    g_assert_cmpuint (intern (labels, i, &same, TRUE), ==, i);
+  for (i = 0; i < 20; i++)
+    g_assert_cmpuint (intern (labels, i, &same, FALSE), ==, i);
+
+  /* Hashes equal modulo every table size up to 4096 slots. */
+  for (i = 20; i < 200; i++) {
+    guint32 hash = (i - 20) << 12;
+
+    g_assert_cmpuint (intern (labels, i, &hash, TRUE), ==, i);
+  }
+  for (i = 0; i < 200; i++) {
+    guint32 hash = (i - 20) << 12;
+
+    g_assert_cmpuint (intern (labels, i, i < 20 ? &same : &hash, FALSE), ==,
+        i);
+  }
+  gst_ds_osdcoord_labels_free (labels);
+}
+
+/**
+ * Once the table holds max_labels labels, new labels get
+ * DSOSDCOORD_LABEL_ID_NONE and are not added, while those in the table are
+ * still found.
+ */
+static void
+test_full (void)
+{
+  GstDsOsdCoordLabels *labels = gst_ds_osdcoord_labels_new (10);
+  guint i;
+
+  for (i = 0; i < 10; i++)
+    g_assert_cmpuint (intern (labels, i, NULL, TRUE), ==, i);
+  g_assert_cmpuint (intern (labels, 10, NULL, FALSE), ==,
+      DSOSDCOORD_LABEL_ID_NONE);
+  g_assert_cmpuint (intern (labels, 11, NULL, FALSE), ==,
+      DSOSDCOORD_LABEL_ID_NONE);
+  for (i = 0; i < 10; i++)
+    g_assert_cmpuint (intern (labels, i, NULL, FALSE), ==, i);
+  gst_ds_osdcoord_labels_free (labels);
+}
+
+/**
+ * After a reset ids start at 0 again, labels of before are new, and adding
+ * as many labels again takes no more memory.
+ */
+static void
+test_reset (void)
+{
+  GstDsOsdCoordLabels *labels = gst_ds_osdcoord_labels_new (NUM_LABELS);
+  gsize usage;
+  guint i;
+
+  for (i = 0; i < NUM_LABELS; i++)
+    intern (labels, i, NULL, TRUE);
+  usage = gst_ds_osdcoord_labels_get_memory_usage (labels);
+
+  gst_ds_osdcoord_labels_reset (labels);
+  for (i = 0; i < NUM_LABELS; i++)
+    g_assert_cmpuint (intern (labels, NUM_LABELS - 1 - i, NULL, TRUE), ==, i);
+  g_assert_cmpuint (gst_ds_osdcoord_labels_get_memory_usage (labels), ==,
+      usage);
+  gst_ds_osdcoord_labels_free (labels);
+}
+
+/**
+ * gst_ds_osdcoord_label_copy() truncates like g_strlcpy() and hashes the
+ * copy, so a truncated label has the hash of its copy.
+ */
+static void
+test_copy (void)
+{
+  gchar dest[8], full[32];
+  guint32 hash;
+
+  hash = gst_ds_osdcoord_label_copy (dest, "abcdefghij", sizeof (dest));
+  g_assert_cmpstr (dest, ==, "abcdefg");
+  g_assert_cmpuint (hash, ==,
+      gst_ds_osdcoord_label_copy (full, "abcdefg", sizeof (full)));
+  g_assert_cmpuint (hash, !=,
+      gst_ds_osdcoord_label_copy (full, "abcdefgh", sizeof (full)));
+
+  hash = gst_ds_osdcoord_label_copy (dest, NULL, sizeof (dest));
+  g_assert_cmpstr (dest, ==, "");
+  g_assert_cmpuint (hash, ==, gst_ds_osdcoord_label_copy (full, "",
+          sizeof (full)));
+
+  hash = gst_ds_osdcoord_label_copy (dest, "car", 1);
+  g_assert_cmpstr (dest, ==, "");
+  g_assert_cmpuint (hash, ==, gst_ds_osdcoord_label_copy (full, "",
+          sizeof (full)));
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/labels/intern", test_intern);
+  g_test_add_func ("/labels/collisions", test_collisions);
+  g_test_add_func ("/labels/full", test_full);
+  g_test_add_func ("/labels/reset", test_reset);
+  g_test_add_func ("/labels/copy", test_copy);
+
+  return g_test_run ();
+}
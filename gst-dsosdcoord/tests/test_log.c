@@ -0,0 +1,329 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the file sink: segments written by the exporter, read back with
+ * the header-only reader of dsosdcoord_log.h from the start and through
+ * their footer index.
+ */
+
+#include <stdio.h>
+#include <glib/gstdio.h>
+#include "gstdsosdcoord_exporter.h"
+#include "gstdsosdcoord_labels.h"
+#include "gstdsosdcoord_log.h"
+#include "dsosdcoord_log.h"
+
+GST_DEBUG_CATEGORY (gst_ds_osdcoord_debug);
+
+/** Enough frames for several segments of DSOSDCOORD_LOG_MIN_SEGMENT_SIZE. */
+#define NUM_FRAMES 24000
+#define NUM_OBJECTS 8
+#define NUM_SOURCES 2
+#define NUM_LABELS 5
+
+/**
+ * Segments written by the exporter in a temporary directory, in the order
+ * they were written.
+ */
+typedef struct
+{
+  gchar *location;
+  GPtrArray *paths;
+} Segments;
+
+/** Segments written once, shared by the tests, which only read them. */
+static Segments segments;
+
+static gint
+compare_sequence (gconstpointer a, gconstpointer b)
+{
+  /* Names end with the sequence number of the segment. */
+  return g_strcmp0 (strrchr (*(const gchar **) a, '-'),
+      strrchr (*(const gchar **) b, '-'));
+}
+
+/**
+ * Frame f belongs to source f % NUM_SOURCES, its objects numbered
+ * f * NUM_OBJECTS + i in class_id.
+ */
+static void
+write_segments (void)
+{
+  GstDsOsdCoordExportConfig config;
+  GstDsOsdCoordExporter *exporter;
+  GError *error = NULL;
+  const gchar *name;
+  GDir *dir;
+  guint f, i;
+
+  segments.location = g_dir_make_tmp ("dsosdcoord-log-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  memset (&config, 0, sizeof (config));
+  config.queue_size = 1024;
+  config.overflow_policy = DSOSDCOORD_OVERFLOW_BLOCK;
+  config.sink = DSOSDCOORD_EXPORT_SINK_FILE;
+  config.file_location = segments.location;
+  config.file_segment_size = DSOSDCOORD_LOG_MIN_SEGMENT_SIZE;
+  exporter = gst_ds_osdcoord_exporter_new (&config, &error);
+  g_assert_no_error (error);
+
+  for (f = 0; f < NUM_FRAMES; f++) {
+    for (i = 0; i < NUM_OBJECTS; i++) {
+      GstDsOsdCoordExportRecord *record =
+          gst_ds_osdcoord_exporter_reserve (exporter);
+      guint seq = f * NUM_OBJECTS + i;
+      gchar label[32];
+
+      memset (record, 0, gst_ds_osdcoord_export_record_size (record));
+      record->frame_num = f;
+      record->pts = f * 20 * GST_MSECOND;
+      record->source_id = f % NUM_SOURCES;
+      record->flags = DSOSDCOORD_RECORD_FLAG_HAS_SOURCE;
+      record->class_id = seq;
+      record->left = i;
+      g_snprintf (label, sizeof (label), "label-%u", seq % NUM_LABELS);
+      record->label_hash = gst_ds_osdcoord_label_copy (record->label, label,
+          sizeof (record->label));
+      gst_ds_osdcoord_exporter_commit (exporter);
+    }
+    gst_ds_osdcoord_exporter_kick (exporter);
+  }
+  gst_ds_osdcoord_exporter_stop (exporter);
+  g_assert_cmpuint (gst_ds_osdcoord_exporter_get_dropped (exporter), ==, 0);
+  gst_ds_osdcoord_exporter_free (exporter);
+
+  segments.paths = g_ptr_array_new_with_free_func (g_free);
+  dir = g_dir_open (segments.location, 0, &error);
+  g_assert_no_error (error);
+  while ((name = g_dir_read_name (dir)))
+    g_ptr_array_add (segments.paths, g_build_filename (segments.location,
+            name, NULL));
+  g_dir_close (dir);
+  g_ptr_array_sort (segments.paths, compare_sequence);
+}
+
+static void
+remove_segments (void)
+{
+  guint i;
+
+  for (i = 0; i < segments.paths->len; i++)
+    g_unlink (g_ptr_array_index (segments.paths, i));
+  g_rmdir (segments.location);
+  g_ptr_array_unref (segments.paths);
+  g_free (segments.location);
+}
+
+/**
+ * Check the objects of the frame just read: they continue the sequence
+ * from *next, with the frame header and label they were written with.
+ */
+static void
+check_frame (DsOsdCoordLogReader * reader, guint * next)
+{
+  guint i;
+
+  for (i = 0; i < reader->bin.frame.num_objects; i++) {
+    const DsOsdCoordBinObject *object = &reader->bin.objects[i];
+    guint seq = *next, f = seq / NUM_OBJECTS;
+    gchar label[32];
+
+    g_assert_cmpint (object->class_id, ==, seq);
+    g_assert_cmpfloat (object->left, ==, seq % NUM_OBJECTS);
+    g_assert_cmpuint (reader->bin.frame.frame_num, ==, f);
+    g_assert_cmpuint (reader->bin.frame.source_id, ==, f % NUM_SOURCES);
+    g_assert_cmpuint (reader->bin.frame.pts, ==, f * 20 * GST_MSECOND);
+    g_snprintf (label, sizeof (label), "label-%u", seq % NUM_LABELS);
+    g_assert_cmpstr (dsosdcoord_bin_reader_label (&reader->bin,
+            object->label_id), ==, label);
+    (*next)++;
+  }
+}
+
+/**
+ * The records are spread over several closed segments with no more data
+ * than the segment size and an aligned index, each readable on its own
+ * from the start, and together they hold every record in order.
+ */
+static void
+test_rotation (void)
+{
+  guint next = 0, s;
+
+  g_assert_cmpuint (segments.paths->len, >=, 3);
+  for (s = 0; s < segments.paths->len; s++) {
+    const gchar *path = g_ptr_array_index (segments.paths, s);
+    DsOsdCoordLogReader reader;
+    int ret;
+
+    g_assert_cmpint (dsosdcoord_log_reader_open (&reader, path), ==, 0);
+    g_assert_cmpuint (reader.header.data_end, >, sizeof (DsOsdCoordLogHeader));
+    g_assert_cmpuint (reader.header.data_end, <=,
+        DSOSDCOORD_LOG_MIN_SEGMENT_SIZE);
+    g_assert_cmpuint (reader.header.index_offset % 8, ==, 0);
+    g_assert_true (reader.header.flags & DSOSDCOORD_LOG_FLAG_CLOSED);
+    g_assert_cmpint (reader.header.end_time, >=, reader.header.start_time);
+
+    /* Clear the labels from the footer: the stream defines its own. */
+    dsosdcoord_bin_reader_clear_strings (&reader.bin);
+    while ((ret = dsosdcoord_log_reader_next (&reader)) > 0)
+      check_frame (&reader, &next);
+    g_assert_cmpint (ret, ==, 0);
+    dsosdcoord_log_reader_close (&reader);
+  }
+  g_assert_cmpuint (next, ==, NUM_FRAMES * NUM_OBJECTS);
+}
+
+/**
+ * The index of each segment is in file order, points at frame chunks with
+ * the source, frame number and PTS of the entry, starts each source at its
+ * first frame chunk and spaces its entries at least
+ * DSOSDCOORD_LOG_INDEX_INTERVAL apart.
+ */
+static void
+test_index (void)
+{
+  guint s, i;
+
+  for (s = 0; s < segments.paths->len; s++) {
+    DsOsdCoordLogReader reader;
+    guint64 last[NUM_SOURCES] = { 0 };
+    guint64 first[NUM_SOURCES] = { 0 };
+    guint64 prev = 0;
+
+    g_assert_cmpint (dsosdcoord_log_reader_open (&reader,
+            g_ptr_array_index (segments.paths, s)), ==, 0);
+    g_assert_cmpuint (reader.index_count, >, NUM_SOURCES);
+
+    /* The first frame chunk of each source, read from the start. */
+    while (dsosdcoord_log_reader_next (&reader) > 0) {
+      guint source = reader.bin.frame.source_id;
+
+      if (first[source] == 0)
+        first[source] = ftell (reader.bin.file) - sizeof (DsOsdCoordBinChunk)
+            - sizeof (DsOsdCoordBinFrame) -
+            reader.bin.frame.num_objects * reader.bin.object_size;
+    }
+
+    for (i = 0; i < reader.index_count; i++) {
+      const DsOsdCoordLogIndexEntry *entry = &reader.index[i];
+      DsOsdCoordBinChunk chunk;
+      DsOsdCoordBinFrame frame;
+
+      /* Chunks in the stream are not aligned. */
+      memcpy (&chunk, reader.map + entry->offset, sizeof (chunk));
+      memcpy (&frame, reader.map + entry->offset + sizeof (chunk),
+          sizeof (frame));
+
+      g_assert_cmpuint (entry->source_id, <, NUM_SOURCES);
+      g_assert_cmpuint (entry->offset, >, prev);
+      g_assert_cmpuint (entry->offset, <, reader.header.data_end);
+      g_assert_cmpuint (chunk.type, ==, DSOSDCOORD_BIN_CHUNK_FRAME);
+      g_assert_cmpuint (frame.source_id, ==, entry->source_id);
+      g_assert_cmpuint (frame.frame_num, ==, entry->frame_num);
+      g_assert_cmpuint (frame.pts, ==, entry->pts);
+
+      if (last[entry->source_id] == 0)
+        g_assert_cmpuint (entry->offset, ==, first[entry->source_id]);
+      else
+        g_assert_cmpuint (entry->offset - last[entry->source_id], >=,
+            DSOSDCOORD_LOG_INDEX_INTERVAL);
+      last[entry->source_id] = entry->offset;
+      prev = entry->offset;
+    }
+    dsosdcoord_log_reader_close (&reader);
+  }
+}
+
+/**
+ * Seek to a frame of a source by PTS or frame number and read on to it:
+ * the first frame read is an indexed one of the source at or before the
+ * target, and the target is reached, with its labels known from the
+ * footer.
+ */
+static void
+seek_to (DsOsdCoordLogReader * reader, guint f, gboolean by_frame_num)
+{
+  guint source = f % NUM_SOURCES, next;
+  guint64 value = by_frame_num ? f : f * 20 * GST_MSECOND;
+
+  g_assert_cmpint (dsosdcoord_log_reader_seek (reader, source, value,
+          by_frame_num), ==, 0);
+  g_assert_cmpint (dsosdcoord_log_reader_next (reader), ==, 1);
+  g_assert_cmpuint (reader->bin.frame.source_id, ==, source);
+  g_assert_cmpuint (reader->bin.frame.frame_num, <=, f);
+
+  next = reader->bin.objects[0].class_id;
+  for (;;) {
+    check_frame (reader, &next);
+    if (next > f * NUM_OBJECTS)
+      break;
+    g_assert_cmpint (dsosdcoord_log_reader_next (reader), ==, 1);
+  }
+}
+
+static void
+test_seek (void)
+{
+  GRand *rand = g_rand_new_with_seed (1);
+  guint s, n;
+
+  for (s = 0; s < segments.paths->len; s++) {
+    DsOsdCoordLogReader reader;
+    guint first, last;
+
+    g_assert_cmpint (dsosdcoord_log_reader_open (&reader,
+            g_ptr_array_index (segments.paths, s)), ==, 0);
+
+    /* Frames of the segment, from its first and last index entry. */
+    first = reader.index[0].frame_num;
+    last = reader.index[reader.index_count - 1].frame_num;
+    for (n = 0; n < 16; n++) {
+      guint f = g_rand_int_range (rand, first + NUM_SOURCES, last + 1);
+
+      seek_to (&reader, f, n % 2);
+    }
+    seek_to (&reader, last, TRUE);
+
+    /* Before the first entry of a source is its first entry. */
+    g_assert_cmpint (dsosdcoord_log_reader_seek (&reader,
+            reader.index[0].source_id, 0, TRUE), ==, 0);
+    g_assert_cmpint (dsosdcoord_log_reader_next (&reader), ==, 1);
+    g_assert_cmpuint (reader.bin.frame.frame_num, ==, first);
+
+    /* A source without entries leaves the position alone. */
+    g_assert_cmpint (dsosdcoord_log_reader_seek (&reader, NUM_SOURCES, 0,
+            FALSE), ==, -1);
+    g_assert_cmpint (dsosdcoord_log_reader_next (&reader), ==, 1);
+    dsosdcoord_log_reader_close (&reader);
+  }
+  g_rand_free (rand);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int ret;
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/log/rotation", test_rotation);
+  g_test_add_func ("/log/index", test_index);
+  g_test_add_func ("/log/seek", test_seek);
+
+  write_segments ();
+  ret = g_test_run ();
+  remove_segments ();
+  return ret;
+}
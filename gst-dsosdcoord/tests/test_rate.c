@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the export rate limiter of export-interval-frames and
+ * export-max-hz, fed with synthetic PTS.
+ */
+
+#include "gstdsosdcoord_rate.h"
+
+static GstDsOsdCoordRateLimiter *
+limiter_new (guint interval_frames, gdouble max_hz)
+{
+  GstDsOsdCoordRateConfig config;
+
+  config.interval_frames = interval_frames;
+  config.max_hz = max_hz;
+  return gst_ds_osdcoord_rate_limiter_new (&config);
+}
+
+/**
+ * Check frames first to first + n - 1 of source_id at fps frames per
+ * second, starting from PTS start, and return the number exported.
+ */
+static guint
+count_exported (GstDsOsdCoordRateLimiter * limiter, guint source_id,
+    GstClockTime start, guint first, guint n, guint fps)
+{
+  guint i, exported = 0;
+
+  for (i = first; i < first + n; i++)
+    exported += gst_ds_osdcoord_rate_limiter_check (limiter, source_id,
+        start + gst_util_uint64_scale (i, GST_SECOND, fps));
+  return exported;
+}
+
+/**
+ * Each source exports its first frame and every interval_frames-th frame
+ * after it, independently of the others; an interval of 0 is 1.
+ */
+static void
+test_interval (void)
+{
+  GstDsOsdCoordRateLimiter *limiter = limiter_new (3, 0);
+  guint i;
+
+  for (i = 0; i < 12; i++) {
+    g_assert_cmpint (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+            i * GST_MSECOND), ==, i % 3 == 0);
+    g_assert_cmpint (gst_ds_osdcoord_rate_limiter_check (limiter, 5,
+            GST_CLOCK_TIME_NONE), ==, i % 3 == 0);
+  }
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 2, 0));
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+
+  limiter = limiter_new (0, 0);
+  g_assert_cmpuint (count_exported (limiter, 0, 0, 0, 30, 30), ==, 30);
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+}
+
+/**
+ * max-hz limits the frames exported per second of PTS. Deadlines advance
+ * from the previous one, so a frame rate that is not a multiple of max-hz
+ * still exports max-hz frames per second.
+ */
+static void
+test_max_hz (void)
+{
+  GstDsOsdCoordRateLimiter *limiter = limiter_new (1, 10);
+  guint i;
+
+  for (i = 0; i < 9; i++)
+    g_assert_cmpint (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+            gst_util_uint64_scale (i, GST_SECOND, 30)), ==, i % 3 == 0);
+  g_assert_cmpuint (count_exported (limiter, 0, 0, 9, 291, 30), ==, 97);
+  g_assert_cmpuint (count_exported (limiter, 1, 0, 0, 250, 25), ==, 100);
+  g_assert_cmpuint (count_exported (limiter, 2, 0, 0, 100, 10), ==, 100);
+  g_assert_cmpuint (count_exported (limiter, 3, 0, 0, 50, 5), ==, 50);
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+
+  /* Both limits apply. */
+  limiter = limiter_new (2, 10);
+  g_assert_cmpuint (count_exported (limiter, 0, 0, 0, 100, 10), ==, 50);
+  g_assert_cmpuint (count_exported (limiter, 1, 0, 0, 300, 30), ==, 100);
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+}
+
+/**
+ * After a gap in the PTS the deadlines start over from the first frame
+ * after it instead of letting every frame through until they catch up.
+ */
+static void
+test_gap (void)
+{
+  GstDsOsdCoordRateLimiter *limiter = limiter_new (1, 10);
+
+  g_assert_cmpuint (count_exported (limiter, 0, 0, 0, 30, 30), ==, 10);
+  g_assert_cmpuint (count_exported (limiter, 0, 60 * GST_SECOND, 0, 30, 30),
+      ==, 10);
+  g_assert_false (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          61 * GST_SECOND - 1));
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          61 * GST_SECOND));
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+}
+
+/**
+ * When the PTS goes back, as when a source restarts, the first frame is
+ * exported and the deadlines start over from it instead of holding the
+ * frames back until the PTS reaches the old deadline.
+ */
+static void
+test_backwards (void)
+{
+  GstDsOsdCoordRateLimiter *limiter = limiter_new (1, 10);
+
+  g_assert_cmpuint (count_exported (limiter, 0, 100 * GST_SECOND, 0, 30, 30),
+      ==, 10);
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0, 0));
+  g_assert_cmpuint (count_exported (limiter, 0, 0, 1, 29, 30), ==, 9);
+
+  /* A frame within the slot of the last export is held back, one before
+   * it went back. */
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          GST_SECOND));
+  g_assert_false (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          GST_SECOND + 50 * GST_MSECOND));
+  g_assert_false (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          GST_SECOND));
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          GST_SECOND - 1));
+  g_assert_false (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          GST_SECOND + 50 * GST_MSECOND));
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+}
+
+/**
+ * Frames without PTS are only subject to the interval, and leave the
+ * deadlines of the frames with PTS alone.
+ */
+static void
+test_no_pts (void)
+{
+  GstDsOsdCoordRateLimiter *limiter = limiter_new (1, 10);
+  guint i;
+
+  for (i = 0; i < 10; i++)
+    g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+            GST_CLOCK_TIME_NONE));
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0, 0));
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          GST_CLOCK_TIME_NONE));
+  g_assert_false (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          50 * GST_MSECOND));
+  g_assert_true (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+          100 * GST_MSECOND));
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+
+  limiter = limiter_new (2, 10);
+  for (i = 0; i < 10; i++)
+    g_assert_cmpint (gst_ds_osdcoord_rate_limiter_check (limiter, 0,
+            GST_CLOCK_TIME_NONE), ==, i % 2 == 0);
+  gst_ds_osdcoord_rate_limiter_free (limiter);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/rate/interval", test_interval);
+  g_test_add_func ("/rate/max-hz", test_max_hz);
+  g_test_add_func ("/rate/gap", test_gap);
+  g_test_add_func ("/rate/backwards", test_backwards);
+  g_test_add_func ("/rate/no-pts", test_no_pts);
+
+  return g_test_run ();
+}
@@ -0,0 +1,372 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of dsosdcoordreplay in a gst_harness: a recording written chunk by
+ * chunk in the format of dsosdcoord_bin.h, replayed onto buffers and read
+ * back from their NvDsBatchMeta. Built against the stub DeepStream headers
+ * and meta library of the benchmark.
+ */
+
+#include <stdio.h>
+#include <gst/check/gstharness.h>
+#include <glib/gstdio.h>
+#include "gstdsosdcoord_replay.h"
+#include "dsosdcoord_bin.h"
+
+#define MS GST_MSECOND
+
+static gchar *recording;
+
+static void
+write_chunk (FILE * file, guint32 type, gconstpointer data, gsize size,
+    gconstpointer extra, gsize extra_size)
+{
+  DsOsdCoordBinChunk chunk;
+
+  chunk.type = type;
+  chunk.size = size + extra_size;
+  fwrite (&chunk, sizeof (chunk), 1, file);
+  fwrite (data, size, 1, file);
+  if (extra_size > 0)
+    fwrite (extra, extra_size, 1, file);
+}
+
+static void
+write_stream (FILE * file)
+{
+  DsOsdCoordBinStream stream;
+
+  memset (&stream, 0, sizeof (stream));
+  stream.magic = DSOSDCOORD_BIN_MAGIC;
+  stream.version = DSOSDCOORD_BIN_VERSION;
+  stream.object_size = sizeof (DsOsdCoordBinObject);
+  write_chunk (file, DSOSDCOORD_BIN_CHUNK_STREAM, &stream, sizeof (stream),
+      NULL, 0);
+}
+
+static void
+write_string (FILE * file, guint32 id, const gchar * label)
+{
+  DsOsdCoordBinString string;
+
+  string.id = id;
+  string.length = strlen (label);
+  write_chunk (file, DSOSDCOORD_BIN_CHUNK_STRING, &string, sizeof (string),
+      label, string.length);
+}
+
+/**
+ * Write a frame chunk of source with objects given as label id and
+ * class_id pairs, class_id -1 for an object without one.
+ */
+static void
+write_frame (FILE * file, guint source, guint frame_num, GstClockTime pts,
+    guint num_objects, const gint * objects)
+{
+  DsOsdCoordBinFrame frame;
+  DsOsdCoordBinObject bin[4];
+  guint i;
+
+  memset (&frame, 0, sizeof (frame));
+  frame.source_id = source;
+  frame.batch_id = source;
+  frame.frame_num = frame_num;
+  frame.flags = DSOSDCOORD_BIN_FRAME_FLAG_HAS_SOURCE;
+  frame.pts = pts;
+  frame.num_objects = num_objects;
+
+  memset (bin, 0, sizeof (bin));
+  for (i = 0; i < num_objects; i++) {
+    bin[i].label_id = objects[i * 2];
+    if (objects[i * 2 + 1] >= 0) {
+      bin[i].flags = DSOSDCOORD_BIN_OBJECT_FLAG_HAS_CLASS;
+      bin[i].class_id = objects[i * 2 + 1];
+    }
+    bin[i].left = 10.0f * frame_num + i;
+    bin[i].top = 20.0f + source;
+    bin[i].width = 30.0f;
+    bin[i].height = 40.0f;
+    if (source == 0 && i == 0) {
+      bin[i].flags |= DSOSDCOORD_BIN_OBJECT_FLAG_HAS_TRACK;
+      bin[i].object_id = 7;
+    }
+  }
+  write_chunk (file, DSOSDCOORD_BIN_CHUNK_FRAME, &frame, sizeof (frame), bin,
+      num_objects * sizeof (DsOsdCoordBinObject));
+}
+
+/**
+ * Two sources at 40 ms, three batches. Frame 1 of source 0 is split over
+ * two chunks, and the stream restarts before the last batch with other
+ * label ids: "car" is 1 in the first stream and 0 in the second.
+ */
+static void
+write_recording (void)
+{
+  static const gint f0s0[] = { 0, 0, 1, 2 };
+  static const gint f0s1[] = { 1, 2 };
+  static const gint f1s0a[] = { 0, 0 };
+  static const gint f1s0b[] = { 1, 2 };
+  static const gint f2s0[] = { 0, 2, 1, 5 };
+  static const gint f1s1[] = { 1, -1 };
+  gint fd = g_file_open_tmp ("dsosdcoord-replay-XXXXXX", &recording, NULL);
+  FILE *file = fdopen (fd, "wb");
+
+  write_stream (file);
+  write_string (file, 0, "person");
+  write_string (file, 1, "car");
+  write_frame (file, 0, 0, 0, 2, f0s0);
+  write_frame (file, 1, 0, 0, 1, f0s1);
+  write_frame (file, 0, 1, 40 * MS, 1, f1s0a);
+  write_frame (file, 0, 1, 40 * MS, 1, f1s0b);
+
+  write_stream (file);
+  write_string (file, 0, "car");
+  write_string (file, 1, "dog");
+  write_frame (file, 0, 2, 80 * MS, 2, f2s0);
+  write_frame (file, 1, 1, 80 * MS, 1, f1s1);
+  fclose (file);
+}
+
+static GstHarness *
+replay_new (const gchar * rate, gboolean loop)
+{
+  GstElement *replay = g_object_new (GST_TYPE_DSOSDCOORD_REPLAY,
+      "location", recording, "loop", loop, NULL);
+  GstHarness *h;
+
+  gst_util_set_object_arg (G_OBJECT (replay), "replay-rate", rate);
+  h = gst_harness_new_with_element (replay, "sink", "src");
+  gst_object_unref (replay);
+  gst_harness_set_src_caps_str (h, "video/x-raw,format=RGBA,width=64,"
+      "height=64,framerate=25/1");
+  return h;
+}
+
+static GstBuffer *
+replay_buffer (GstHarness * h, GstClockTime pts)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, 64, NULL);
+
+  GST_BUFFER_PTS (buf) = pts;
+  g_assert_cmpint (gst_harness_push (h, buf), ==, GST_FLOW_OK);
+  return gst_harness_pull (h);
+}
+
+static NvDsFrameMeta *
+find_frame (NvDsBatchMeta * batch_meta, guint source_id)
+{
+  NvDsFrameMetaList *l;
+
+  for (l = batch_meta->frame_meta_list; l; l = l->next) {
+    NvDsFrameMeta *frame_meta = (NvDsFrameMeta *) l->data;
+
+    if (frame_meta->source_id == source_id)
+      return frame_meta;
+  }
+  g_assert_not_reached ();
+  return NULL;
+}
+
+/**
+ * Display text of the object of frame_meta with class_id.
+ */
+static const gchar *
+object_text (NvDsFrameMeta * frame_meta, gint class_id)
+{
+  NvDsObjectMetaList *l;
+
+  for (l = frame_meta->obj_meta_list; l; l = l->next) {
+    NvDsObjectMeta *obj_meta = (NvDsObjectMeta *) l->data;
+
+    if (obj_meta->class_id == class_id)
+      return obj_meta->text_params.display_text;
+  }
+  g_assert_not_reached ();
+  return NULL;
+}
+
+/**
+ * Check the object of frame_meta with class_id: its label, box and track.
+ */
+static void
+check_object (NvDsFrameMeta * frame_meta, gint class_id, const gchar * label,
+    guint i)
+{
+  NvDsObjectMetaList *l;
+
+  for (l = frame_meta->obj_meta_list; l; l = l->next) {
+    NvDsObjectMeta *obj_meta = (NvDsObjectMeta *) l->data;
+
+    if (obj_meta->class_id != class_id)
+      continue;
+    g_assert_cmpstr (obj_meta->obj_label, ==, label);
+    g_assert_cmpstr (obj_meta->text_params.display_text, ==, label);
+    g_assert_cmpfloat (obj_meta->rect_params.left, ==,
+        10.0f * frame_meta->frame_num + i);
+    g_assert_cmpfloat (obj_meta->rect_params.top, ==,
+        20.0f + frame_meta->source_id);
+    g_assert_cmpfloat (obj_meta->rect_params.width, ==, 30.0f);
+    g_assert_cmpfloat (obj_meta->rect_params.height, ==, 40.0f);
+    if (frame_meta->source_id == 0 && i == 0)
+      g_assert_cmpuint (obj_meta->object_id, ==, 7);
+    else
+      g_assert_cmpuint (obj_meta->object_id, ==, UNTRACKED_OBJECT_ID);
+    return;
+  }
+  g_assert_not_reached ();
+}
+
+static void
+check_frame (NvDsBatchMeta * batch_meta, guint source_id, gint frame_num,
+    GstClockTime pts, guint num_objects)
+{
+  NvDsFrameMeta *frame_meta = find_frame (batch_meta, source_id);
+
+  g_assert_cmpint (frame_meta->frame_num, ==, frame_num);
+  g_assert_cmpuint (frame_meta->batch_id, ==, source_id);
+  g_assert_cmpuint (frame_meta->buf_pts, ==, pts);
+  g_assert_cmpuint (frame_meta->num_obj_meta, ==, num_objects);
+}
+
+/**
+ * Frames with the same PTS share a batch, the chunks of a split frame are
+ * merged, labels keep their names across the stream restart and objects
+ * without class_id get the id of their label in the order labels first
+ * appear. Buffers keep their timestamps and the stream ends with the
+ * recording.
+ */
+static void
+test_batches (void)
+{
+  GstHarness *h = replay_new ("fast", FALSE);
+  NvDsBatchMeta *batch_meta;
+  GstBuffer *buf;
+
+  buf = replay_buffer (h, 1000);
+  g_assert_cmpuint (GST_BUFFER_PTS (buf), ==, 1000);
+  batch_meta = gst_buffer_get_nvds_batch_meta (buf);
+  g_assert_nonnull (batch_meta);
+  g_assert_cmpuint (batch_meta->num_frames_in_batch, ==, 2);
+  check_frame (batch_meta, 0, 0, 0, 2);
+  check_object (find_frame (batch_meta, 0), 0, "person", 0);
+  check_object (find_frame (batch_meta, 0), 2, "car", 1);
+  check_frame (batch_meta, 1, 0, 0, 1);
+  check_object (find_frame (batch_meta, 1), 2, "car", 0);
+  /* Objects with the same label share its text, interned at load time. */
+  g_assert_true (object_text (find_frame (batch_meta, 0), 2) ==
+      object_text (find_frame (batch_meta, 1), 2));
+  gst_buffer_unref (buf);
+
+  buf = replay_buffer (h, 2000);
+  batch_meta = gst_buffer_get_nvds_batch_meta (buf);
+  g_assert_cmpuint (batch_meta->num_frames_in_batch, ==, 1);
+  check_frame (batch_meta, 0, 1, 40 * MS, 2);
+  check_object (find_frame (batch_meta, 0), 0, "person", 0);
+  check_object (find_frame (batch_meta, 0), 2, "car", 0);
+  gst_buffer_unref (buf);
+
+  buf = replay_buffer (h, 3000);
+  batch_meta = gst_buffer_get_nvds_batch_meta (buf);
+  g_assert_cmpuint (batch_meta->num_frames_in_batch, ==, 2);
+  check_frame (batch_meta, 0, 2, 80 * MS, 2);
+  check_object (find_frame (batch_meta, 0), 2, "car", 0);
+  check_object (find_frame (batch_meta, 0), 5, "dog", 1);
+  /* person, car, dog: dog is label 2 of the recording. */
+  check_frame (batch_meta, 1, 1, 80 * MS, 1);
+  check_object (find_frame (batch_meta, 1), 2, "dog", 0);
+  gst_buffer_unref (buf);
+
+  g_assert_cmpint (gst_harness_push (h, gst_buffer_new ()), ==,
+      GST_FLOW_EOS);
+  gst_harness_teardown (h);
+}
+
+/**
+ * replay-rate=recorded restamps buffers with the recorded PTS from 0, with
+ * the time to the next batch as duration, and loop=true carries on after
+ * the last batch one average batch interval later.
+ */
+static void
+test_recorded_loop (void)
+{
+  static const GstClockTime durations[] = {
+    40 * MS, 40 * MS, GST_CLOCK_TIME_NONE
+  };
+  GstHarness *h = replay_new ("recorded", TRUE);
+  guint i;
+
+  for (i = 0; i < 7; i++) {
+    GstBuffer *buf = replay_buffer (h, 5 * GST_SECOND);
+    NvDsBatchMeta *batch_meta = gst_buffer_get_nvds_batch_meta (buf);
+
+    g_assert_cmpuint (GST_BUFFER_PTS (buf), ==, i * 40 * MS);
+    g_assert_cmpuint (GST_BUFFER_DURATION (buf), ==, durations[i % 3]);
+    /* The frame meta keeps the recorded PTS. */
+    g_assert_cmpuint (find_frame (batch_meta, 0)->buf_pts, ==,
+        (i % 3) * 40 * MS);
+    gst_buffer_unref (buf);
+  }
+  gst_harness_teardown (h);
+}
+
+/**
+ * The batch meta of a freed buffer is reused for the next one, while a
+ * buffer still held keeps its own.
+ */
+static void
+test_pool (void)
+{
+  GstHarness *h = replay_new ("fast", TRUE);
+  NvDsBatchMeta *first, *second;
+  GstBuffer *buf, *held;
+
+  buf = replay_buffer (h, 0);
+  first = gst_buffer_get_nvds_batch_meta (buf);
+  gst_buffer_unref (buf);
+
+  held = replay_buffer (h, 0);
+  g_assert_true (gst_buffer_get_nvds_batch_meta (held) == first);
+  buf = replay_buffer (h, 0);
+  second = gst_buffer_get_nvds_batch_meta (buf);
+  g_assert_true (second != first);
+  gst_buffer_unref (buf);
+  gst_buffer_unref (held);
+
+  /* Both are idle now; the last one released is taken first. */
+  buf = replay_buffer (h, 0);
+  g_assert_true (gst_buffer_get_nvds_batch_meta (buf) == first);
+  g_assert_cmpuint (find_frame (gst_buffer_get_nvds_batch_meta (buf),
+          0)->frame_num, ==, 0);
+  gst_buffer_unref (buf);
+  gst_harness_teardown (h);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int ret;
+
+  gst_init (&argc, &argv);
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/replay/batches", test_batches);
+  g_test_add_func ("/replay/recorded-loop", test_recorded_loop);
+  g_test_add_func ("/replay/pool", test_pool);
+
+  write_recording ();
+  ret = g_test_run ();
+  g_unlink (recording);
+  g_free (recording);
+  return ret;
+}
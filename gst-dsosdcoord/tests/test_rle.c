@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Golden vectors of the run-length encoding of masks, checked with every
+ * threshold kernel the CPU supports, and the kernels compared with the
+ * scalar one on random masks.
+ */
+
+#include <math.h>
+#include "gstdsosdcoord_rle.h"
+
+#define THRESHOLD 0.5f
+/** Longest random mask, past several 64-pixel words. */
+#define MAX_PIXELS 300
+
+/**
+ * Hand-written masks: '0' below the threshold, '1' above it, '=' at it
+ * and 'n' NaN, which both count as not above.
+ */
+static const struct
+{
+  const gchar *mask;
+  guint num_counts;
+  guint32 counts[8];
+} strings[] = {
+  {"0", 1, {1}},
+  {"1", 2, {0, 1}},
+  {"0000", 1, {4}},
+  {"1111", 2, {0, 4}},
+  {"0110", 3, {1, 2, 1}},
+  {"1010", 5, {0, 1, 1, 1, 1}},
+  {"=1=1", 4, {1, 1, 1, 1}},
+  {"n11n0", 3, {1, 2, 2}},
+  {"00111", 2, {2, 3}},
+};
+
+/**
+ * Masks given by their runs, starting with one below the threshold: the
+ * counts must come back as given. They end, or change, around the 64-pixel
+ * words the runs are found in.
+ */
+static const guint32 runs[][8] = {
+  {63, 1},
+  {64},
+  {0, 64},
+  {64, 1},
+  {0, 63, 2},
+  {1, 126, 1},
+  {0, 128},
+  {65, 62, 3},
+  {0, 1, 63, 1, 63, 1},
+  {5, 300, 7},
+  {127, 1, 1, 1, 127},
+};
+
+static gfloat
+pixel (GRand * rand, gboolean above)
+{
+  return above ? (gfloat) g_rand_double_range (rand, THRESHOLD + 1e-3, 2.0) :
+      (gfloat) g_rand_double_range (rand, -2.0, THRESHOLD);
+}
+
+/**
+ * Encode the n pixels of data with impl and compare with the counts
+ * expected. data is copied one float past an aligned buffer so the kernels
+ * see unaligned loads.
+ */
+static void
+check_counts (const GstDsOsdCoordRleImpl * impl, GstDsOsdCoordArena * arena,
+    const gfloat * data, guint n, const guint32 * expected,
+    guint num_expected)
+{
+  gfloat *copy = g_new (gfloat, n + 1);
+  guint32 *counts;
+  guint num_counts;
+
+  memcpy (copy + 1, data, n * sizeof (gfloat));
+  counts = gst_ds_osdcoord_rle_encode (impl, arena, copy + 1, n, THRESHOLD,
+      G_MAXUINT, &num_counts);
+  g_assert_nonnull (counts);
+  if (num_counts != num_expected ||
+      memcmp (counts, expected, num_counts * sizeof (guint32)) != 0)
+    g_error ("%s: wrong runs for a mask of %u pixels", impl->name, n);
+  gst_ds_osdcoord_arena_reset (arena);
+  g_free (copy);
+}
+
+/**
+ * The hand-written masks and those given by their runs encode to their
+ * golden counts with every kernel.
+ */
+static void
+test_golden (void)
+{
+  const GstDsOsdCoordRleImpl *impls[DSOSDCOORD_RLE_MAX_IMPLS];
+  guint n = gst_ds_osdcoord_rle_get_impls (impls), i, j, k;
+  GRand *rand = g_rand_new_with_seed (1);
+  GstDsOsdCoordArena arena;
+  gfloat data[1024];
+
+  g_assert_cmpuint (n, >=, 1);
+  g_assert_true (impls[0]->threshold == gst_ds_osdcoord_rle_threshold_scalar);
+  g_assert_true (gst_ds_osdcoord_rle_get_impl () == impls[n - 1]);
+  gst_ds_osdcoord_arena_init (&arena, 256);
+
+  for (i = 0; i < n; i++) {
+    g_test_message ("checking %s", impls[i]->name);
+    for (j = 0; j < G_N_ELEMENTS (strings); j++) {
+      const gchar *mask = strings[j].mask;
+      guint len = strlen (mask);
+
+      for (k = 0; k < len; k++)
+        data[k] = mask[k] == '1' ? 0.75f : mask[k] == '=' ? THRESHOLD :
+            mask[k] == 'n' ? NAN : 0.25f;
+      check_counts (impls[i], &arena, data, len, strings[j].counts,
+          strings[j].num_counts);
+    }
+
+    for (j = 0; j < G_N_ELEMENTS (runs); j++) {
+      guint num_runs = 0, len = 0, r;
+
+      for (r = 0; r < G_N_ELEMENTS (runs[j]) && (r == 0 || runs[j][r]); r++) {
+        for (k = 0; k < runs[j][r]; k++)
+          data[len++] = pixel (rand, r % 2);
+        num_runs++;
+      }
+      check_counts (impls[i], &arena, data, len, runs[j], num_runs);
+    }
+  }
+  gst_ds_osdcoord_arena_clear (&arena);
+  g_rand_free (rand);
+}
+
+/**
+ * Every kernel gives the counts of the scalar one for random masks of
+ * every size up to MAX_PIXELS, with short and long runs.
+ */
+static void
+test_kernels (void)
+{
+  const GstDsOsdCoordRleImpl *impls[DSOSDCOORD_RLE_MAX_IMPLS];
+  guint n = gst_ds_osdcoord_rle_get_impls (impls), i, size, k;
+  GRand *rand = g_rand_new_with_seed (2);
+  GstDsOsdCoordArena arena;
+  gfloat data[MAX_PIXELS];
+
+  gst_ds_osdcoord_arena_init (&arena, 256);
+  for (size = 1; size <= MAX_PIXELS; size++) {
+    gdouble flip = g_rand_boolean (rand) ? 0.5 : 0.05;
+    gboolean above = g_rand_boolean (rand);
+    guint32 *counts, expected[MAX_PIXELS + 1];
+    guint num_expected;
+
+    for (k = 0; k < size; k++) {
+      if (g_rand_double (rand) < flip)
+        above = !above;
+      data[k] = pixel (rand, above);
+    }
+    counts = gst_ds_osdcoord_rle_encode (impls[0], &arena, data, size,
+        THRESHOLD, G_MAXUINT, &num_expected);
+    memcpy (expected, counts, num_expected * sizeof (guint32));
+    gst_ds_osdcoord_arena_reset (&arena);
+    for (i = 1; i < n; i++)
+      check_counts (impls[i], &arena, data, size, expected, num_expected);
+  }
+  gst_ds_osdcoord_arena_clear (&arena);
+  g_rand_free (rand);
+}
+
+/**
+ * A mask with more runs than max_counts gives NULL, with the number of
+ * runs it has; one with exactly max_counts is encoded.
+ */
+static void
+test_max_counts (void)
+{
+  GstDsOsdCoordArena arena;
+  gfloat data[200];
+  guint32 *counts;
+  guint num_counts, i;
+
+  for (i = 0; i < G_N_ELEMENTS (data); i++)
+    data[i] = (i / 10) % 2 ? 1.0f : 0.0f;
+  gst_ds_osdcoord_arena_init (&arena, 256);
+
+  counts = gst_ds_osdcoord_rle_encode (gst_ds_osdcoord_rle_get_impl (),
+      &arena, data, G_N_ELEMENTS (data), THRESHOLD, 20, &num_counts);
+  g_assert_nonnull (counts);
+  g_assert_cmpuint (num_counts, ==, 20);
+  for (i = 0; i < num_counts; i++)
+    g_assert_cmpuint (counts[i], ==, 10);
+
+  counts = gst_ds_osdcoord_rle_encode (gst_ds_osdcoord_rle_get_impl (),
+      &arena, data, G_N_ELEMENTS (data), THRESHOLD, 19, &num_counts);
+  g_assert_null (counts);
+  g_assert_cmpuint (num_counts, ==, 20);
+
+  gst_ds_osdcoord_arena_clear (&arena);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/rle/golden", test_golden);
+  g_test_add_func ("/rle/kernels", test_kernels);
+  g_test_add_func ("/rle/max-counts", test_max_counts);
+
+  return g_test_run ();
+}
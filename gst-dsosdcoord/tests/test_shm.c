@@ -0,0 +1,394 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the shared memory ring: gstdsosdcoord_shm.c writing, the
+ * header-only reader of dsosdcoord_shm.h reading, in the same and in
+ * another process.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "gstdsosdcoord_shm.h"
+
+#define CROSS_PROCESS_RECORDS 200000
+#define CROSS_PROCESS_BURST 1000
+
+static gchar *
+shm_name (const gchar * test)
+{
+  return g_strdup_printf ("/dsosdcoord-test-%s-%d", test, (int) getpid ());
+}
+
+/**
+ * Fill record with values derived from index, so a reader can tell a
+ * record mixing two writes apart from a whole one.
+ */
+static void
+make_record (GstDsOsdCoordExportRecord * record, guint64 index)
+{
+  memset (record, 0, sizeof (*record));
+  record->frame_num = (guint) index;
+  record->pts = index * 40 * GST_MSECOND;
+  record->source_id = (guint) (index % 7);
+  record->batch_id = (guint) (index % 3);
+  record->flags = DSOSDCOORD_RECORD_FLAG_HAS_SOURCE;
+  record->object_id = index * 31;
+  record->left = (gfloat) (index % 1000);
+  record->top = (gfloat) (index % 500);
+  record->width = 10;
+  record->height = 20;
+  record->class_id = (gint) (index % 5);
+  g_snprintf (record->label, sizeof (record->label), "object-%" G_GUINT64_FORMAT,
+      index);
+}
+
+static gboolean
+record_is_whole (const DsOsdCoordShmRecord * record)
+{
+  gchar label[DSOSDCOORD_SHM_LABEL_SIZE];
+  guint64 index = record->index;
+
+  g_snprintf (label, sizeof (label), "object-%" G_GUINT64_FORMAT, index);
+  return record->frame_num == (guint32) index &&
+      record->pts == index * 40 * GST_MSECOND &&
+      record->source_id == index % 7 && record->batch_id == index % 3 &&
+      record->flags == DSOSDCOORD_SHM_FLAG_HAS_SOURCE &&
+      record->object_id == index * 31 &&
+      record->left == (float) (index % 1000) &&
+      record->top == (float) (index % 500) &&
+      record->class_id == (int32_t) (index % 5) &&
+      strcmp (record->label, label) == 0;
+}
+
+static void
+write_records (GstDsOsdCoordShmWriter * writer, guint64 first, guint64 count)
+{
+  GstDsOsdCoordExportRecord record;
+  guint64 i;
+
+  for (i = first; i < first + count; i++) {
+    make_record (&record, i);
+    gst_ds_osdcoord_shm_writer_write (writer, &record);
+  }
+}
+
+/** Writable mapping of the ring, to corrupt it behind the writer's back. */
+static DsOsdCoordShmHeader *
+map_ring (const gchar * name, gsize * size)
+{
+  struct stat st;
+  void *addr;
+  int fd;
+
+  fd = shm_open (name, O_RDWR, 0);
+  g_assert_cmpint (fd, >=, 0);
+  g_assert_cmpint (fstat (fd, &st), ==, 0);
+  addr = mmap (NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  g_assert_true (addr != MAP_FAILED);
+  *size = st.st_size;
+  return (DsOsdCoordShmHeader *) addr;
+}
+
+static void
+test_read_write (void)
+{
+  gchar *name = shm_name ("rw");
+  GstDsOsdCoordShmWriter *writer;
+  DsOsdCoordShmReader reader;
+  DsOsdCoordShmRecord record;
+  GError *error = NULL;
+  guint64 i;
+
+  writer = gst_ds_osdcoord_shm_writer_new (name, 16, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 0), ==, 0);
+  g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 0);
+
+  write_records (writer, 0, 10);
+  g_assert_cmpuint (dsosdcoord_shm_reader_available (&reader), ==, 10);
+  for (i = 0; i < 10; i++) {
+    g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 1);
+    g_assert_cmpuint (record.index, ==, i);
+    g_assert_true (record_is_whole (&record));
+  }
+  g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 0);
+  g_assert_cmpuint (reader.lost, ==, 0);
+
+  dsosdcoord_shm_reader_close (&reader);
+  gst_ds_osdcoord_shm_writer_free (writer);
+  g_free (name);
+}
+
+/**
+ * A reader lapped by the writer skips to the oldest record still in the
+ * ring and counts the ones it missed.
+ */
+static void
+test_wrap_around (void)
+{
+  gchar *name = shm_name ("wrap");
+  GstDsOsdCoordShmWriter *writer;
+  DsOsdCoordShmReader reader, late;
+  DsOsdCoordShmRecord record;
+  GError *error = NULL;
+  guint64 i;
+
+  writer = gst_ds_osdcoord_shm_writer_new (name, 8, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 1), ==, 0);
+  g_assert_cmpuint (reader.read_index, ==, 0);
+
+  write_records (writer, 0, 20);
+  for (i = 12; i < 20; i++) {
+    g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 1);
+    g_assert_cmpuint (record.index, ==, i);
+    g_assert_true (record_is_whole (&record));
+  }
+  g_assert_cmpuint (reader.lost, ==, 12);
+  g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 0);
+
+  /* Opened from the start after the wrap, only the ring is left. */
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&late, name, 1), ==, 0);
+  g_assert_cmpint (dsosdcoord_shm_reader_next (&late, &record), ==, 1);
+  g_assert_cmpuint (record.index, ==, 12);
+  g_assert_cmpuint (late.lost, ==, 0);
+  dsosdcoord_shm_reader_close (&late);
+
+  /* The slot index keeps wrapping past several laps. */
+  write_records (writer, 20, 8 * 5 + 3);
+  g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 1);
+  g_assert_cmpuint (record.index, ==, 20 + 8 * 5 + 3 - 8);
+  g_assert_true (record_is_whole (&record));
+  g_assert_cmpuint (reader.lost, ==, 12 + 8 * 5 + 3 - 8);
+
+  dsosdcoord_shm_reader_close (&reader);
+  gst_ds_osdcoord_shm_writer_free (writer);
+  g_free (name);
+}
+
+typedef struct
+{
+  DsOsdCoordShmRecord *slot;
+  guint64 index;
+} FinishWrite;
+
+static gpointer
+finish_write (gpointer data)
+{
+  FinishWrite *finish = (FinishWrite *) data;
+  DsOsdCoordShmRecord *slot = finish->slot;
+
+  g_usleep (50000);
+  slot->frame_num = (guint32) finish->index;
+  g_snprintf (slot->label, sizeof (slot->label), "object-%" G_GUINT64_FORMAT,
+      finish->index);
+  __atomic_store_n (&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/**
+ * A slot caught mid-write, its sequence odd and its data half updated, is
+ * only returned once the write is complete.
+ */
+static void
+test_torn_slot (void)
+{
+  gchar *name = shm_name ("torn");
+  GstDsOsdCoordShmWriter *writer;
+  DsOsdCoordShmHeader *header;
+  DsOsdCoordShmReader reader;
+  DsOsdCoordShmRecord record, *slot;
+  FinishWrite finish;
+  GError *error = NULL;
+  GThread *thread;
+  gsize size;
+
+  writer = gst_ds_osdcoord_shm_writer_new (name, 4, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 1), ==, 0);
+  write_records (writer, 0, 7);
+  g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 1);
+  g_assert_cmpuint (record.index, ==, 3);
+  g_assert_cmpuint (reader.lost, ==, 3);
+  while (dsosdcoord_shm_reader_next (&reader, &record));
+  g_assert_cmpuint (reader.read_index, ==, 7);
+
+  /* Start writing record 7 over record 3 by hand, publishing its index
+     before the slot is complete. */
+  header = map_ring (name, &size);
+  slot = &dsosdcoord_shm_records (header)[7 % 4];
+  __atomic_store_n (&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+  slot->index = 7;
+  slot->frame_num = 0xdead;
+  __atomic_store_n (&header->write_index, 8, __ATOMIC_RELEASE);
+
+  finish.slot = slot;
+  finish.index = 7;
+  thread = g_thread_new ("finish-write", finish_write, &finish);
+  g_assert_cmpint (dsosdcoord_shm_reader_next (&reader, &record), ==, 1);
+  g_thread_join (thread);
+  g_assert_cmpuint (record.index, ==, 7);
+  g_assert_cmpuint (record.frame_num, ==, 7);
+  g_assert_cmpstr (record.label, ==, "object-7");
+  g_assert_cmpuint (reader.lost, ==, 3);
+
+  munmap (header, size);
+  dsosdcoord_shm_reader_close (&reader);
+  gst_ds_osdcoord_shm_writer_free (writer);
+  g_free (name);
+}
+
+static void
+test_open_errors (void)
+{
+  gchar *name = shm_name ("errors");
+  GstDsOsdCoordShmWriter *writer;
+  DsOsdCoordShmHeader *header;
+  DsOsdCoordShmReader reader;
+  GError *error = NULL;
+  gsize size;
+
+  errno = 0;
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 0), ==, -1);
+  g_assert_cmpint (errno, ==, ENOENT);
+
+  writer = gst_ds_osdcoord_shm_writer_new (name, 4, &error);
+  g_assert_no_error (error);
+  header = map_ring (name, &size);
+
+  header->version = DSOSDCOORD_SHM_VERSION + 1;
+  errno = 0;
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 0), ==, -1);
+  g_assert_cmpint (errno, ==, EPROTO);
+  g_assert_null (reader.header);
+  header->version = DSOSDCOORD_SHM_VERSION;
+
+  header->magic = 0;
+  errno = 0;
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 0), ==, -1);
+  g_assert_cmpint (errno, ==, EPROTO);
+  header->magic = DSOSDCOORD_SHM_MAGIC;
+
+  header->record_size = sizeof (DsOsdCoordShmRecord) - 8;
+  errno = 0;
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 0), ==, -1);
+  g_assert_cmpint (errno, ==, EPROTO);
+  header->record_size = sizeof (DsOsdCoordShmRecord);
+
+  header->capacity = 5;
+  errno = 0;
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 0), ==, -1);
+  g_assert_cmpint (errno, ==, EPROTO);
+  header->capacity = 4;
+
+  g_assert_cmpint (dsosdcoord_shm_reader_open (&reader, name, 0), ==, 0);
+  dsosdcoord_shm_reader_close (&reader);
+
+  munmap (header, size);
+  gst_ds_osdcoord_shm_writer_free (writer);
+  g_free (name);
+}
+
+/**
+ * Read the ring from a child process until the last record. Every record
+ * must be whole and the records read plus the ones lost must add up.
+ * Returns the exit status of the child.
+ */
+static int
+read_ring (const gchar * name, int ready_fd)
+{
+  DsOsdCoordShmReader reader;
+  DsOsdCoordShmRecord record;
+  guint64 read = 0, next = 0;
+  gint64 deadline = g_get_monotonic_time () + 60 * G_USEC_PER_SEC;
+
+  if (dsosdcoord_shm_reader_open (&reader, name, 1) < 0)
+    return 1;
+  if (write (ready_fd, "", 1) != 1)
+    return 2;
+
+  while (next < CROSS_PROCESS_RECORDS) {
+    if (!dsosdcoord_shm_reader_next (&reader, &record)) {
+      if (g_get_monotonic_time () > deadline)
+        return 3;
+      continue;
+    }
+    if (record.index < next || !record_is_whole (&record))
+      return 4;
+    next = record.index + 1;
+    read++;
+  }
+  if (read + reader.lost != CROSS_PROCESS_RECORDS)
+    return 5;
+  dsosdcoord_shm_reader_close (&reader);
+  return 0;
+}
+
+/**
+ * The writer runs flat out in bursts while a reader in another process
+ * keeps up as well as it can, so it both retries slots caught mid-write
+ * and gets lapped.
+ */
+static void
+test_cross_process (void)
+{
+  gchar *name = shm_name ("process");
+  GstDsOsdCoordShmWriter *writer;
+  GError *error = NULL;
+  int fds[2], status;
+  gchar ready;
+  pid_t pid;
+  guint64 i;
+
+  writer = gst_ds_osdcoord_shm_writer_new (name, 16, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (pipe (fds), ==, 0);
+
+  pid = fork ();
+  g_assert_cmpint (pid, >=, 0);
+  if (pid == 0) {
+    close (fds[0]);
+    _exit (read_ring (name, fds[1]));
+  }
+  close (fds[1]);
+  g_assert_cmpint (read (fds[0], &ready, 1), ==, 1);
+  close (fds[0]);
+
+  for (i = 0; i < CROSS_PROCESS_RECORDS; i += CROSS_PROCESS_BURST) {
+    write_records (writer, i, CROSS_PROCESS_BURST);
+    g_usleep (100);
+  }
+
+  g_assert_cmpint (waitpid (pid, &status, 0), ==, pid);
+  g_assert_true (WIFEXITED (status));
+  g_assert_cmpint (WEXITSTATUS (status), ==, 0);
+
+  gst_ds_osdcoord_shm_writer_free (writer);
+  g_free (name);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/shm/read-write", test_read_write);
+  g_test_add_func ("/shm/wrap-around", test_wrap_around);
+  g_test_add_func ("/shm/torn-slot", test_torn_slot);
+  g_test_add_func ("/shm/open-errors", test_open_errors);
+  g_test_add_func ("/shm/cross-process", test_cross_process);
+
+  return g_test_run ();
+}
@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the log-linear duration histogram of the stats: bucket index,
+ * bucket bounds and percentiles.
+ */
+
+#include "gstdsosdcoord_stats.h"
+
+#define SUB_BUCKETS (1 << DSOSDCOORD_HISTOGRAM_SUB_BITS)
+
+/**
+ * Upper bound of the bucket of ns, as reported by the percentiles.
+ */
+static guint64
+bucket_max (guint64 ns)
+{
+  GstDsOsdCoordHistogram histogram;
+
+  memset (&histogram, 0, sizeof (histogram));
+  histogram.counts[gst_ds_osdcoord_histogram_index (ns)] = 1;
+  return gst_ds_osdcoord_histogram_percentile (&histogram, 50);
+}
+
+/**
+ * Durations below two groups of sub-buckets are counted exactly; then
+ * each power of two is split into SUB_BUCKETS equal buckets.
+ */
+static void
+test_index_edges (void)
+{
+  guint64 ns;
+  guint group;
+
+  for (ns = 0; ns < 2 * SUB_BUCKETS; ns++) {
+    g_assert_cmpuint (gst_ds_osdcoord_histogram_index (ns), ==, ns);
+    g_assert_cmpuint (bucket_max (ns), ==, ns);
+  }
+
+  /* 32 and 33 share the first bucket of the next group. */
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_index (32), ==, 32);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_index (33), ==, 32);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_index (34), ==, 33);
+  g_assert_cmpuint (bucket_max (32), ==, 33);
+
+  /* The first and last value of each group and of each sub-bucket. */
+  for (group = 2; group <= DSOSDCOORD_HISTOGRAM_MAX_BITS -
+      DSOSDCOORD_HISTOGRAM_SUB_BITS; group++) {
+    guint64 base = (guint64) SUB_BUCKETS << (group - 1);
+    guint64 width = G_GUINT64_CONSTANT (1) << (group - 1);
+    guint sub;
+
+    for (sub = 0; sub < SUB_BUCKETS; sub++) {
+      guint64 first = base + sub * width;
+      guint index = group * SUB_BUCKETS + sub;
+
+      g_assert_cmpuint (gst_ds_osdcoord_histogram_index (first), ==, index);
+      g_assert_cmpuint (gst_ds_osdcoord_histogram_index (first + width - 1),
+          ==, index);
+      g_assert_cmpuint (bucket_max (first), ==, first + width - 1);
+    }
+    g_assert_cmpuint (gst_ds_osdcoord_histogram_index (base - 1), ==,
+        group * SUB_BUCKETS - 1);
+  }
+}
+
+/**
+ * Every duration lands in a bucket whose upper bound is at most 1 /
+ * SUB_BUCKETS above it, and the index never decreases with the duration.
+ */
+static void
+test_index_precision (void)
+{
+  guint last = 0;
+  guint64 ns;
+
+  for (ns = 0; ns < (1 << 16); ns++) {
+    guint index = gst_ds_osdcoord_histogram_index (ns);
+    guint64 max = bucket_max (ns);
+
+    g_assert_cmpuint (index, >=, last);
+    g_assert_cmpuint (index, <=, last + 1);
+    g_assert_cmpuint (max, >=, ns);
+    g_assert_cmpuint ((max - ns) * SUB_BUCKETS, <=, ns);
+    last = index;
+  }
+
+  for (ns = 1 << 16; ns < (G_GUINT64_CONSTANT (1) <<
+          DSOSDCOORD_HISTOGRAM_MAX_BITS); ns += ns / 7 + 1) {
+    guint64 max = bucket_max (ns);
+
+    g_assert_cmpuint (max, >=, ns);
+    g_assert_cmpuint ((max - ns) * SUB_BUCKETS, <=, ns);
+  }
+}
+
+/**
+ * Durations of 2^MAX_BITS ns and more share the last bucket, which
+ * reports 2^MAX_BITS - 1.
+ */
+static void
+test_index_max (void)
+{
+  guint64 limit = G_GUINT64_CONSTANT (1) << DSOSDCOORD_HISTOGRAM_MAX_BITS;
+
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_index (limit - 1), ==,
+      DSOSDCOORD_HISTOGRAM_BUCKETS - 1);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_index (limit), ==,
+      DSOSDCOORD_HISTOGRAM_BUCKETS - 1);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_index (G_MAXUINT64), ==,
+      DSOSDCOORD_HISTOGRAM_BUCKETS - 1);
+  g_assert_cmpuint (bucket_max (limit - 1), ==, limit - 1);
+  g_assert_cmpuint (bucket_max (G_MAXUINT64), ==, limit - 1);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_index (limit / 2 - 1), <,
+      DSOSDCOORD_HISTOGRAM_BUCKETS - SUB_BUCKETS);
+}
+
+/**
+ * Percentiles pick the bucket holding the sample of rank percentile / 100
+ * of the count, rounded and at least the first; 0 if there is none.
+ */
+static void
+test_percentile (void)
+{
+  GstDsOsdCoordHistogram histogram;
+  guint i;
+
+  memset (&histogram, 0, sizeof (histogram));
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 50), ==,
+      0);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 100),
+      ==, 0);
+
+  /* 1 to 100 ns, one sample each. */
+  for (i = 1; i <= 100; i++)
+    histogram.counts[gst_ds_osdcoord_histogram_index (i)]++;
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 0), ==,
+      1);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 1), ==,
+      1);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 20), ==,
+      20);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 50), ==,
+      51);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 99), ==,
+      99);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 100),
+      ==, 103);
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 1000),
+      ==, 103);
+
+  /* One outlier moves the max but not p99. */
+  memset (&histogram, 0, sizeof (histogram));
+  histogram.counts[gst_ds_osdcoord_histogram_index (1000)] = 999;
+  histogram.counts[gst_ds_osdcoord_histogram_index (G_MAXUINT64)] = 1;
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 99), ==,
+      bucket_max (1000));
+  g_assert_cmpuint (gst_ds_osdcoord_histogram_percentile (&histogram, 100),
+      ==, (G_GUINT64_CONSTANT (1) << DSOSDCOORD_HISTOGRAM_MAX_BITS) - 1);
+}
+
+/**
+ * Subtracting a snapshot from the sum gives back the interval.
+ */
+static void
+test_add_subtract (void)
+{
+  GstDsOsdCoordStats *a = g_new0 (GstDsOsdCoordStats, 1);
+  GstDsOsdCoordStats *b = g_new0 (GstDsOsdCoordStats, 1);
+  GstDsOsdCoordStats *sum = g_new0 (GstDsOsdCoordStats, 1);
+
+  a->buffers = 3;
+  a->objects = 10;
+  a->stages[DSOSDCOORD_STAGE_BUFFER].counts[5] = 2;
+  b->buffers = 4;
+  b->suppressed = 1;
+  b->stages[DSOSDCOORD_STAGE_BUFFER].counts[5] = 1;
+  b->stages[DSOSDCOORD_STAGE_EXPORT].counts[DSOSDCOORD_HISTOGRAM_BUCKETS -
+      1] = 7;
+
+  gst_ds_osdcoord_stats_add (sum, a);
+  gst_ds_osdcoord_stats_add (sum, b);
+  g_assert_cmpuint (sum->buffers, ==, 7);
+  g_assert_cmpuint (sum->stages[DSOSDCOORD_STAGE_BUFFER].counts[5], ==, 3);
+  g_assert_cmpuint (sum->stages[DSOSDCOORD_STAGE_EXPORT].
+      counts[DSOSDCOORD_HISTOGRAM_BUCKETS - 1], ==, 7);
+
+  gst_ds_osdcoord_stats_subtract (sum, a);
+  g_assert_cmpmem (sum, sizeof (*sum), b, sizeof (*b));
+
+  g_free (a);
+  g_free (b);
+  g_free (sum);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/stats/index/edges", test_index_edges);
+  g_test_add_func ("/stats/index/precision", test_index_precision);
+  g_test_add_func ("/stats/index/max", test_index_max);
+  g_test_add_func ("/stats/percentile", test_percentile);
+  g_test_add_func ("/stats/add-subtract", test_add_subtract);
+
+  return g_test_run ();
+}
@@ -0,0 +1,284 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the track table of export-mode=changes: appear, move, keyframe
+ * and disappear events, and the grace period.
+ */
+
+#include <string.h>
+#include "gstdsosdcoord_track.h"
+#include "gstnvdsmeta.h"
+
+/** Records passed to the disappear callback. */
+typedef struct
+{
+  GstDsOsdCoordExportRecord records[8];
+  guint num_records;
+} Gone;
+
+static void
+gone_add (GstDsOsdCoordExportRecord * record, gpointer user_data)
+{
+  Gone *gone = user_data;
+
+  g_assert_cmpuint (gone->num_records, <, G_N_ELEMENTS (gone->records));
+  gone->records[gone->num_records++] = *record;
+}
+
+static GstDsOsdCoordTracker *
+tracker_new (guint grace_frames, gfloat move_threshold, gfloat iou_threshold,
+    guint keyframe_interval)
+{
+  GstDsOsdCoordTrackConfig config;
+
+  config.grace_frames = grace_frames;
+  config.move_threshold = move_threshold;
+  config.iou_threshold = iou_threshold;
+  config.keyframe_interval = keyframe_interval;
+  return gst_ds_osdcoord_tracker_new (&config);
+}
+
+/**
+ * Pass the box of object_id in frame_num of source_id through the tracker.
+ * Returns the event, or -1 if the record is not to be exported.
+ */
+static gint
+update (GstDsOsdCoordTracker * tracker, guint source_id, guint64 object_id,
+    guint frame_num, gfloat left, gfloat top, gfloat width, gfloat height)
+{
+  GstDsOsdCoordExportRecord record;
+
+  memset (&record, 0, sizeof (record));
+  record.source_id = source_id;
+  record.object_id = object_id;
+  record.frame_num = frame_num;
+  record.left = left;
+  record.top = top;
+  record.width = width;
+  record.height = height;
+  if (!gst_ds_osdcoord_tracker_update (tracker, &record))
+    return -1;
+  if (object_id != UNTRACKED_OBJECT_ID)
+    g_assert_true (record.flags & DSOSDCOORD_RECORD_FLAG_HAS_TRACK);
+  return record.event;
+}
+
+/**
+ * A new object_id appears once; the same id in another source is another
+ * track. Untracked objects are always exported without an event.
+ */
+static void
+test_appear (void)
+{
+  GstDsOsdCoordTracker *tracker = tracker_new (30, 4, 0, 0);
+  guint64 usage = gst_ds_osdcoord_tracker_get_memory_usage (tracker);
+
+  g_assert_cmpint (update (tracker, 0, 7, 0, 10, 10, 50, 50), ==,
+      DSOSDCOORD_TRACK_EVENT_APPEAR);
+  g_assert_cmpint (update (tracker, 0, 7, 1, 10, 10, 50, 50), ==, -1);
+  g_assert_cmpint (update (tracker, 1, 7, 1, 10, 10, 50, 50), ==,
+      DSOSDCOORD_TRACK_EVENT_APPEAR);
+  g_assert_cmpuint (gst_ds_osdcoord_tracker_get_memory_usage (tracker), >,
+      usage);
+
+  g_assert_cmpint (update (tracker, 0, UNTRACKED_OBJECT_ID, 2, 1, 1, 1, 1),
+      ==, DSOSDCOORD_TRACK_EVENT_NONE);
+  g_assert_cmpint (update (tracker, 0, UNTRACKED_OBJECT_ID, 3, 1, 1, 1, 1),
+      ==, DSOSDCOORD_TRACK_EVENT_NONE);
+  gst_ds_osdcoord_tracker_free (tracker);
+}
+
+/**
+ * A track moves when an edge moves by more than the threshold from the
+ * last exported box, not from the last seen one, so a slow drift is
+ * exported once it adds up.
+ */
+static void
+test_move (void)
+{
+  GstDsOsdCoordTracker *tracker = tracker_new (30, 4, 0, 0);
+
+  update (tracker, 0, 1, 0, 100, 100, 50, 50);
+  g_assert_cmpint (update (tracker, 0, 1, 1, 104, 100, 50, 50), ==, -1);
+  g_assert_cmpint (update (tracker, 0, 1, 2, 103, 97, 50, 50), ==, -1);
+  g_assert_cmpint (update (tracker, 0, 1, 3, 104.5f, 100, 50, 50), ==,
+      DSOSDCOORD_TRACK_EVENT_MOVE);
+  g_assert_cmpint (update (tracker, 0, 1, 4, 106, 100, 50, 50), ==, -1);
+
+  /* Growing moves the bottom right corner. */
+  g_assert_cmpint (update (tracker, 0, 1, 5, 104.5f, 100, 55, 50), ==,
+      DSOSDCOORD_TRACK_EVENT_MOVE);
+  g_assert_cmpint (update (tracker, 0, 1, 6, 104.5f, 100, 55, 54), ==, -1);
+  g_assert_cmpint (update (tracker, 0, 1, 7, 104.5f, 100, 55, 55), ==,
+      DSOSDCOORD_TRACK_EVENT_MOVE);
+  gst_ds_osdcoord_tracker_free (tracker);
+
+  /* A threshold of 0 ignores the distance. */
+  tracker = tracker_new (30, 0, 0, 0);
+  update (tracker, 0, 1, 0, 100, 100, 50, 50);
+  g_assert_cmpint (update (tracker, 0, 1, 1, 500, 500, 50, 50), ==, -1);
+  gst_ds_osdcoord_tracker_free (tracker);
+}
+
+/**
+ * Boxes are compared as they are passed in, that is in coord-space: with
+ * normalized boxes the threshold is a fraction of the frame.
+ */
+static void
+test_move_normalized (void)
+{
+  GstDsOsdCoordTracker *tracker = tracker_new (30, 4, 0, 0);
+
+  update (tracker, 0, 1, 0, 0.1f, 0.1f, 0.2f, 0.2f);
+  g_assert_cmpint (update (tracker, 0, 1, 1, 0.9f, 0.7f, 0.1f, 0.1f), ==,
+      -1);
+  gst_ds_osdcoord_tracker_free (tracker);
+
+  tracker = tracker_new (30, 0.01f, 0, 0);
+  update (tracker, 0, 1, 0, 0.1f, 0.1f, 0.2f, 0.2f);
+  g_assert_cmpint (update (tracker, 0, 1, 1, 0.105f, 0.1f, 0.2f, 0.2f), ==,
+      -1);
+  g_assert_cmpint (update (tracker, 0, 1, 2, 0.115f, 0.1f, 0.2f, 0.2f), ==,
+      DSOSDCOORD_TRACK_EVENT_MOVE);
+  gst_ds_osdcoord_tracker_free (tracker);
+}
+
+/**
+ * A track moves when the IoU with the last exported box drops below the
+ * threshold.
+ */
+static void
+test_iou (void)
+{
+  GstDsOsdCoordTracker *tracker = tracker_new (30, 0, 0.5f, 0);
+
+  update (tracker, 0, 1, 0, 0, 0, 100, 100);
+  /* IoU 80 / 120 */
+  g_assert_cmpint (update (tracker, 0, 1, 1, 20, 0, 100, 100), ==, -1);
+  /* IoU 60 / 140 */
+  g_assert_cmpint (update (tracker, 0, 1, 2, 40, 0, 100, 100), ==,
+      DSOSDCOORD_TRACK_EVENT_MOVE);
+  gst_ds_osdcoord_tracker_free (tracker);
+}
+
+/**
+ * Unchanged tracks are exported in frames whose frame_num is a multiple of
+ * the keyframe interval; a move takes precedence.
+ */
+static void
+test_keyframe (void)
+{
+  GstDsOsdCoordTracker *tracker = tracker_new (30, 4, 0, 5);
+  guint frame;
+
+  g_assert_cmpint (update (tracker, 0, 1, 3, 0, 0, 10, 10), ==,
+      DSOSDCOORD_TRACK_EVENT_APPEAR);
+  for (frame = 4; frame <= 16; frame++)
+    g_assert_cmpint (update (tracker, 0, 1, frame, 0, 0, 10, 10), ==,
+        frame % 5 == 0 ? DSOSDCOORD_TRACK_EVENT_KEYFRAME : -1);
+  g_assert_cmpint (update (tracker, 0, 1, 20, 10, 0, 10, 10), ==,
+      DSOSDCOORD_TRACK_EVENT_MOVE);
+  gst_ds_osdcoord_tracker_free (tracker);
+}
+
+/**
+ * A track disappears once it has not been seen for more than grace_frames,
+ * with its last exported box and the frame_num and pts it was found gone
+ * in; only the tracks of the expired source are dropped, and a track seen
+ * again within the grace period stays.
+ */
+static void
+test_disappear (void)
+{
+  GstDsOsdCoordTracker *tracker = tracker_new (2, 4, 0, 0);
+  guint64 usage = gst_ds_osdcoord_tracker_get_memory_usage (tracker);
+  Gone gone = { 0 };
+
+  update (tracker, 0, 1, 10, 5, 6, 7, 8);
+  update (tracker, 0, 1, 11, 6, 6, 7, 8);
+  update (tracker, 0, 2, 10, 0, 0, 1, 1);
+  update (tracker, 1, 1, 10, 0, 0, 1, 1);
+
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 12, 1200, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 0);
+
+  /* Track 2 was last seen in frame 10, 3 frames ago. */
+  update (tracker, 0, 1, 13, 6, 6, 7, 8);
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 13, 1300, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 1);
+  g_assert_cmpuint (gone.records[0].object_id, ==, 2);
+
+  /* Track 1 was last seen in frame 13 but last exported in frame 10. */
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 16, 1600, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 2);
+  g_assert_cmpuint (gone.records[1].object_id, ==, 1);
+  g_assert_cmpint (gone.records[1].event, ==,
+      DSOSDCOORD_TRACK_EVENT_DISAPPEAR);
+  g_assert_cmpuint (gone.records[1].frame_num, ==, 16);
+  g_assert_cmpuint (gone.records[1].pts, ==, 1600);
+  g_assert_cmpfloat (gone.records[1].left, ==, 5);
+  g_assert_cmpfloat (gone.records[1].height, ==, 8);
+
+  /* Gone tracks appear again; the track of source 1 is still there. */
+  g_assert_cmpint (update (tracker, 0, 1, 17, 6, 6, 7, 8), ==,
+      DSOSDCOORD_TRACK_EVENT_APPEAR);
+  g_assert_cmpint (update (tracker, 1, 1, 17, 0, 0, 1, 1), ==, -1);
+  gst_ds_osdcoord_tracker_expire (tracker, 1, 30, 0, gone_add, &gone);
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 30, 0, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 4);
+  g_assert_cmpuint (gst_ds_osdcoord_tracker_get_memory_usage (tracker), ==,
+      usage);
+
+  /* Sources never seen have nothing to expire. */
+  gst_ds_osdcoord_tracker_expire (tracker, 5, 100, 0, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 4);
+  gst_ds_osdcoord_tracker_free (tracker);
+}
+
+/**
+ * With a grace period of 0 a track disappears in the first frame it is
+ * missing from; a source restarting from a lower frame_num keeps its
+ * tracks until their frame_num is reached again.
+ */
+static void
+test_grace (void)
+{
+  GstDsOsdCoordTracker *tracker = tracker_new (0, 4, 0, 0);
+  Gone gone = { 0 };
+
+  update (tracker, 0, 1, 100, 0, 0, 1, 1);
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 100, 0, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 0);
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 0, 0, gone_add, &gone);
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 50, 0, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 0);
+  gst_ds_osdcoord_tracker_expire (tracker, 0, 101, 0, gone_add, &gone);
+  g_assert_cmpuint (gone.num_records, ==, 1);
+  gst_ds_osdcoord_tracker_free (tracker);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/track/appear", test_appear);
+  g_test_add_func ("/track/move", test_move);
+  g_test_add_func ("/track/move-normalized", test_move_normalized);
+  g_test_add_func ("/track/iou", test_iou);
+  g_test_add_func ("/track/keyframe", test_keyframe);
+  g_test_add_func ("/track/disappear", test_disappear);
+  g_test_add_func ("/track/grace", test_grace);
+
+  return g_test_run ();
+}
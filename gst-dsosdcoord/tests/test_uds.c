@@ -0,0 +1,295 @@
+/**
+ * Copyright (c) 2016-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * NVIDIA Corporation and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA Corporation is strictly prohibited.
+ *
+ * version: 0.1
+ */
+
+/**
+ * Tests of the uds sink: the exporter sending binary datagrams to a
+ * receiver socket of the test, decoded datagram by datagram with the
+ * reader of dsosdcoord_bin.h as the README describes.
+ */
+
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <glib/gstdio.h>
+#include "gstdsosdcoord_exporter.h"
+#include "gstdsosdcoord_labels.h"
+#include "gstdsosdcoord_uds.h"
+#include "dsosdcoord_bin.h"
+
+GST_DEBUG_CATEGORY (gst_ds_osdcoord_debug);
+
+#define ORDER_FRAMES 20000
+#define ORDER_OBJECTS 8
+#define LATE_FRAMES 200
+#define LATE_OBJECTS 3
+#define NUM_LABELS 7
+
+/**
+ * Receiver socket bound by the test and the datagrams it got, read by a
+ * thread until stopped.
+ */
+typedef struct
+{
+  gchar *path;
+  int fd;
+  GThread *thread;
+  gint done;
+  GPtrArray *datagrams;
+} Receiver;
+
+static gchar *
+socket_path (const gchar * test)
+{
+  return g_strdup_printf ("%s/dsosdcoord-test-%s-%d.sock", g_get_tmp_dir (),
+      test, (int) getpid ());
+}
+
+static gpointer
+receiver_thread (gpointer data)
+{
+  Receiver *receiver = (Receiver *) data;
+  gchar *buf = g_malloc (DSOSDCOORD_UDS_MAX_DATAGRAM * 2);
+
+  for (;;) {
+    struct pollfd pfd = { receiver->fd, POLLIN, 0 };
+    ssize_t n;
+
+    /* Whatever was sent before stop is queued once stop returns. */
+    if (poll (&pfd, 1, 20) == 0) {
+      if (g_atomic_int_get (&receiver->done))
+        break;
+      continue;
+    }
+    n = recv (receiver->fd, buf, DSOSDCOORD_UDS_MAX_DATAGRAM * 2, 0);
+    g_assert_cmpint (n, >, 0);
+    g_ptr_array_add (receiver->datagrams, g_bytes_new (buf, n));
+  }
+  g_free (buf);
+  return NULL;
+}
+
+static void
+receiver_start (Receiver * receiver, const gchar * path)
+{
+  struct sockaddr_un addr;
+  int size = 4 * 1024 * 1024;
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  g_strlcpy (addr.sun_path, path, sizeof (addr.sun_path));
+  receiver->fd = socket (AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  g_assert_cmpint (receiver->fd, >=, 0);
+  setsockopt (receiver->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof (size));
+  g_assert_cmpint (bind (receiver->fd, (struct sockaddr *) &addr,
+          sizeof (addr)), ==, 0);
+  receiver->path = g_strdup (path);
+  receiver->done = 0;
+  receiver->datagrams = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      g_bytes_unref);
+  receiver->thread = g_thread_new ("receiver", receiver_thread, receiver);
+}
+
+static void
+receiver_stop (Receiver * receiver)
+{
+  g_atomic_int_set (&receiver->done, 1);
+  g_thread_join (receiver->thread);
+  close (receiver->fd);
+  g_unlink (receiver->path);
+  g_free (receiver->path);
+}
+
+static GstDsOsdCoordExporter *
+exporter_new (const gchar * path)
+{
+  GstDsOsdCoordExportConfig config;
+  GstDsOsdCoordExporter *exporter;
+  GError *error = NULL;
+
+  memset (&config, 0, sizeof (config));
+  config.queue_size = 1024;
+  config.overflow_policy = DSOSDCOORD_OVERFLOW_BLOCK;
+  config.sink = DSOSDCOORD_EXPORT_SINK_UDS;
+  config.format = DSOSDCOORD_EXPORT_FORMAT_BINARY;
+  config.uds_path = path;
+  exporter = gst_ds_osdcoord_exporter_new (&config, &error);
+  g_assert_no_error (error);
+  return exporter;
+}
+
+/**
+ * Queue the objects of a frame; class_id numbers the records in the order
+ * they were pushed and picks their label.
+ */
+static void
+push_frame (GstDsOsdCoordExporter * exporter, guint frame, guint objects)
+{
+  guint i;
+
+  for (i = 0; i < objects; i++) {
+    GstDsOsdCoordExportRecord *record =
+        gst_ds_osdcoord_exporter_reserve (exporter);
+    guint seq = frame * objects + i;
+    gchar label[32];
+
+    memset (record, 0, gst_ds_osdcoord_export_record_size (record));
+    record->frame_num = frame;
+    record->pts = frame * 40 * GST_MSECOND;
+    record->class_id = seq;
+    g_snprintf (label, sizeof (label), "label-%u", seq % NUM_LABELS);
+    record->label_hash = gst_ds_osdcoord_label_copy (record->label, label,
+        sizeof (record->label));
+    gst_ds_osdcoord_exporter_commit (exporter);
+  }
+  gst_ds_osdcoord_exporter_kick (exporter);
+}
+
+/**
+ * Decode the datagrams received, checking that each holds whole chunks,
+ * that records come in the order they were pushed, skipping only dropped
+ * ones, and that every label resolves. Returns the number of records.
+ */
+static guint
+decode (GPtrArray * datagrams, guint objects)
+{
+  DsOsdCoordBinReader reader;
+  gint last = -1;
+  guint received = 0, d, i;
+
+  dsosdcoord_bin_reader_init (&reader, NULL);
+  for (d = 0; d < datagrams->len; d++) {
+    gsize size;
+    gconstpointer data = g_bytes_get_data (g_ptr_array_index (datagrams, d),
+        &size);
+    int ret;
+
+    reader.file = fmemopen ((void *) data, size, "rb");
+    g_assert_nonnull (reader.file);
+    while ((ret = dsosdcoord_bin_reader_next (&reader)) > 0) {
+      for (i = 0; i < reader.frame.num_objects; i++, received++) {
+        const DsOsdCoordBinObject *object = &reader.objects[i];
+        gchar label[32];
+
+        g_assert_cmpint (object->class_id, >, last);
+        last = object->class_id;
+        g_assert_cmpuint (reader.frame.frame_num, ==, last / objects);
+        g_assert_cmpuint (reader.frame.pts, ==,
+            (last / objects) * 40 * GST_MSECOND);
+        g_snprintf (label, sizeof (label), "label-%u", last % NUM_LABELS);
+        g_assert_cmpstr (dsosdcoord_bin_reader_label (&reader,
+                object->label_id), ==, label);
+      }
+    }
+    g_assert_cmpint (ret, ==, 0);
+    fclose (reader.file);
+  }
+  dsosdcoord_bin_reader_clear (&reader);
+  return received;
+}
+
+/**
+ * With a receiver reading along, records arrive in order and every record
+ * is either received or counted as dropped.
+ */
+static void
+test_order (void)
+{
+  const guint total = ORDER_FRAMES * ORDER_OBJECTS;
+  gchar *path = socket_path ("order");
+  GstDsOsdCoordExporter *exporter;
+  Receiver receiver;
+  guint64 dropped;
+  gint64 start, elapsed;
+  guint frame, received;
+
+  receiver_start (&receiver, path);
+  exporter = exporter_new (path);
+  start = g_get_monotonic_time ();
+  for (frame = 0; frame < ORDER_FRAMES; frame++)
+    push_frame (exporter, frame, ORDER_OBJECTS);
+  gst_ds_osdcoord_exporter_stop (exporter);
+  elapsed = g_get_monotonic_time () - start;
+  dropped = gst_ds_osdcoord_exporter_get_dropped (exporter);
+  gst_ds_osdcoord_exporter_free (exporter);
+  receiver_stop (&receiver);
+
+  received = decode (receiver.datagrams, ORDER_OBJECTS);
+  g_test_message ("%u records in %u datagrams, %" G_GUINT64_FORMAT
+      " dropped, %.0f records/s", received, receiver.datagrams->len, dropped,
+      total * 1e6 / MAX (elapsed, 1));
+  g_assert_cmpuint (received + dropped, ==, total);
+  g_assert_cmpuint (received, >, 0);
+
+  g_ptr_array_unref (receiver.datagrams);
+  g_free (path);
+}
+
+/**
+ * Records sent before the receiver exists are dropped, labels included;
+ * the stream restarts on the drop, so the first datagram the receiver gets
+ * starts with a STREAM chunk and resends the labels it needs.
+ */
+static void
+test_late_receiver (void)
+{
+  gchar *path = socket_path ("late");
+  GstDsOsdCoordExporter *exporter;
+  const DsOsdCoordBinChunk *chunk;
+  Receiver receiver;
+  guint64 dropped;
+  gint64 deadline;
+  guint frame, received;
+
+  g_unlink (path);
+  exporter = exporter_new (path);
+  for (frame = 0; frame < LATE_FRAMES / 2; frame++)
+    push_frame (exporter, frame, LATE_OBJECTS);
+  /* Wait for the exporter thread to have tried, and failed, to send. */
+  deadline = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+  while (gst_ds_osdcoord_exporter_get_dropped (exporter) <
+      LATE_FRAMES / 2 * LATE_OBJECTS) {
+    g_assert_cmpint (g_get_monotonic_time (), <, deadline);
+    g_usleep (1000);
+  }
+
+  receiver_start (&receiver, path);
+  for (; frame < LATE_FRAMES; frame++)
+    push_frame (exporter, frame, LATE_OBJECTS);
+  gst_ds_osdcoord_exporter_stop (exporter);
+  dropped = gst_ds_osdcoord_exporter_get_dropped (exporter);
+  gst_ds_osdcoord_exporter_free (exporter);
+  receiver_stop (&receiver);
+
+  g_assert_cmpuint (receiver.datagrams->len, >, 0);
+  chunk = g_bytes_get_data (g_ptr_array_index (receiver.datagrams, 0), NULL);
+  g_assert_cmpuint (chunk->type, ==, DSOSDCOORD_BIN_CHUNK_STREAM);
+
+  received = decode (receiver.datagrams, LATE_OBJECTS);
+  g_assert_cmpuint (received + dropped, ==, LATE_FRAMES * LATE_OBJECTS);
+  g_assert_cmpuint (received, >, 0);
+
+  g_ptr_array_unref (receiver.datagrams);
+  g_free (path);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/uds/order", test_order);
+  g_test_add_func ("/uds/late-receiver", test_late_receiver);
+
+  return g_test_run ();
+}